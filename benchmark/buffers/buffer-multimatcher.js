@@ -0,0 +1,47 @@
+'use strict';
+const common = require('../common.js');
+const fs = require('fs');
+const path = require('path');
+const MultiMatcher = require('buffer').MultiMatcher;
+
+const words = ['Alice', 'Gryphon', 'Panther', 'Caterpillar', 'Hatter',
+               'Queen', 'Turtle', 'Dormouse', 'Rabbit', 'Duchess', 'King',
+               'Mock', 'Pigeon', 'Cheshire', 'March', 'Knave'];
+
+const bench = common.createBenchmark(main, {
+  method: ['MultiMatcher', 'indexOf'],
+  patterns: [1, 4, 16],
+  n: [100]
+});
+
+function main(conf) {
+  const n = conf.n | 0;
+  const patterns = words.slice(0, conf.patterns | 0);
+  const aliceBuffer = fs.readFileSync(
+    path.resolve(__dirname, '../fixtures/alice.html')
+  );
+  var count = 0;
+  var i;
+
+  if (conf.method === 'MultiMatcher') {
+    const matcher = new MultiMatcher(patterns);
+    bench.start();
+    for (i = 0; i < n; i++)
+      count += matcher.search(aliceBuffer).length;
+    bench.end(n);
+  } else {
+    bench.start();
+    for (i = 0; i < n; i++) {
+      for (const pattern of patterns) {
+        var index = aliceBuffer.indexOf(pattern);
+        while (index !== -1) {
+          count++;
+          index = aliceBuffer.indexOf(pattern, index + 1);
+        }
+      }
+    }
+    bench.end(n);
+  }
+  if (count === 0)
+    throw new Error('no matches');
+}
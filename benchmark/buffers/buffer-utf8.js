@@ -0,0 +1,42 @@
+'use strict';
+
+const common = require('../common.js');
+
+const bench = common.createBenchmark(main, {
+  content: ['ascii', 'latin1', 'wide'],
+  op: ['toString', 'write'],
+  len: [16, 256, 64 * 1024],
+  n: [1e5]
+});
+
+const chars = {
+  ascii: 'hello world ',
+  latin1: 'héllo wörld ',
+  wide: 'hello 世界 😀 '
+};
+
+function main(conf) {
+  const len = conf.len | 0;
+  const n = conf.n | 0;
+  const base = chars[conf.content];
+
+  var str = base.repeat(Math.ceil(len / base.length)).slice(0, len);
+  // Don't leave half a surrogate pair at the end.
+  if (/[\ud800-\udbff]$/.test(str))
+    str = str.slice(0, -1);
+  const buf = Buffer.from(str);
+  const out = Buffer.allocUnsafe(buf.length);
+
+  var i;
+  if (conf.op === 'toString') {
+    bench.start();
+    for (i = 0; i < n; i++)
+      buf.toString('utf8');
+    bench.end(n);
+  } else {
+    bench.start();
+    for (i = 0; i < n; i++)
+      out.write(str, 0, 'utf8');
+    bench.end(n);
+  }
+}
@@ -0,0 +1,42 @@
+// compares hashing many small buffers with createHash(), the one-shot
+// hash() and a single hashBatch() call
+'use strict';
+var common = require('../common.js');
+var crypto = require('crypto');
+
+var bench = common.createBenchmark(main, {
+  n: [1e5],
+  algo: ['sha1', 'sha256'],
+  len: [64, 1024],
+  api: ['createHash', 'hash', 'hashBatch']
+});
+
+function main(conf) {
+  var n = +conf.n;
+  var algo = conf.algo;
+  var buffers = new Array(n);
+  for (var i = 0; i < n; i++)
+    buffers[i] = crypto.randomBytes(+conf.len);
+
+  switch (conf.api) {
+    case 'createHash':
+      bench.start();
+      for (i = 0; i < n; i++)
+        crypto.createHash(algo).update(buffers[i]).digest();
+      bench.end(n);
+      break;
+    case 'hash':
+      bench.start();
+      for (i = 0; i < n; i++)
+        crypto.hash(algo, buffers[i]);
+      bench.end(n);
+      break;
+    case 'hashBatch':
+      bench.start();
+      crypto.hashBatch(algo, buffers);
+      bench.end(n);
+      break;
+    default:
+      throw new Error('unknown api: ' + conf.api);
+  }
+}
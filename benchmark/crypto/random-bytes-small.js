@@ -0,0 +1,29 @@
+// generates many small random values, e.g. identifiers
+'use strict';
+var common = require('../common.js');
+var crypto = require('crypto');
+
+var bench = common.createBenchmark(main, {
+  n: [1e6],
+  size: [16, 64],
+  api: ['randomBytes', 'randomFillSync']
+});
+
+function main(conf) {
+  var n = +conf.n;
+  var size = +conf.size;
+  var i;
+
+  if (conf.api === 'randomBytes') {
+    bench.start();
+    for (i = 0; i < n; i++)
+      crypto.randomBytes(size);
+    bench.end(n);
+  } else {
+    var buf = Buffer.alloc(size);
+    bench.start();
+    for (i = 0; i < n; i++)
+      crypto.randomFillSync(buf);
+    bench.end(n);
+  }
+}
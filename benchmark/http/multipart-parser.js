@@ -0,0 +1,43 @@
+'use strict';
+
+const common = require('../common');
+const MultipartParser = require('http').MultipartParser;
+
+const bench = common.createBenchmark(main, {
+  size: [1024, 64 * 1024, 16 * 1024 * 1024],
+  chunk: [16 * 1024, 64 * 1024],
+  n: [64 * 1024 * 1024]
+});
+
+
+function main(conf) {
+  const size = conf.size >>> 0;
+  const chunkSize = conf.chunk >>> 0;
+  const boundary = '----formdata-0123456789';
+  const parts = Math.max(1, Math.floor((conf.n >>> 0) / size));
+
+  const part = Buffer.concat([
+    Buffer.from(`--${boundary}\r\n` +
+                'Content-Disposition: form-data; name="file"; ' +
+                'filename="upload.bin"\r\n' +
+                'Content-Type: application/octet-stream\r\n\r\n'),
+    Buffer.alloc(size, 'x'),
+    Buffer.from('\r\n')
+  ]);
+  const chunks = [];
+  for (var i = 0; i < part.length; i += chunkSize)
+    chunks.push(part.slice(i, i + chunkSize));
+
+  const parser = new MultipartParser(boundary);
+  var bytes = 0;
+  parser.on('data', (data) => bytes += data.length);
+
+  // The same part over and over, the close delimiter only comes at the end.
+  bench.start();
+  for (i = 0; i < parts; i++) {
+    for (var j = 0; j < chunks.length; j++)
+      parser.write(chunks[j]);
+  }
+  parser.end(`--${boundary}--\r\n`);
+  bench.end(bytes / (1024 * 1024));
+}
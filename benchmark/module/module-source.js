@@ -0,0 +1,61 @@
+'use strict';
+var fs = require('fs');
+var path = require('path');
+var common = require('../common.js');
+
+var tmpDirectory = path.join(__dirname, '..', 'tmp');
+var benchmarkDirectory = path.join(tmpDirectory, 'nodejs-benchmark-source');
+
+// Measures loading modules with sizeable sources, which is dominated by
+// reading the file and turning it into a string.
+var bench = common.createBenchmark(main, {
+  n: [2000],
+  kilobytes: [4, 64],
+  encoding: ['ascii', 'utf8']
+});
+
+function main(conf) {
+  var n = +conf.n;
+  var body = makeSource(+conf.kilobytes * 1024, conf.encoding === 'utf8');
+
+  rmrf(tmpDirectory);
+  try { fs.mkdirSync(tmpDirectory); } catch (e) {}
+  fs.mkdirSync(benchmarkDirectory);
+
+  for (var i = 0; i < n; i++)
+    fs.writeFileSync(path.join(benchmarkDirectory, i + '.js'), body);
+
+  bench.start();
+  for (i = 0; i < n; i++)
+    require(path.join(benchmarkDirectory, i + '.js'));
+  bench.end(n);
+
+  rmrf(tmpDirectory);
+}
+
+function makeSource(size, unicode) {
+  var line = unicode ? '// résumé — comment line\n' :
+                       '// ascii comment line padding......\n';
+  var source = 'module.exports = 1;\n';
+  while (source.length < size)
+    source += line;
+  return source;
+}
+
+function rmrf(location) {
+  try {
+    var things = fs.readdirSync(location);
+    things.forEach(function(thing) {
+      var cur = path.join(location, thing),
+        isDirectory = fs.statSync(cur).isDirectory();
+      if (isDirectory) {
+        rmrf(cur);
+        return;
+      }
+      fs.unlinkSync(cur);
+    });
+    fs.rmdirSync(location);
+  } catch (err) {
+    // Ignore error
+  }
+}
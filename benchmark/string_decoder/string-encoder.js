@@ -0,0 +1,38 @@
+'use strict';
+const common = require('../common.js');
+const StringEncoder = require('string_decoder').StringEncoder;
+
+const bench = common.createBenchmark(main, {
+  encoding: ['base64', 'base64-mime', 'hex'],
+  len: [64 * 1024, 4 * 1024 * 1024],
+  chunk: [1000, 16 * 1024],
+  n: [50]
+});
+
+function main(conf) {
+  const len = conf.len | 0;
+  const chunkLen = conf.chunk | 0;
+  const n = conf.n | 0;
+  const encoding = conf.encoding === 'hex' ? 'hex' : 'base64';
+
+  const bytes = Buffer.alloc(len);
+  for (var i = 0; i < len; i++)
+    bytes[i] = (i * 7919) & 0xff;
+  var str = bytes.toString(encoding);
+  // MIME bodies break base64 into lines of 76 characters.
+  if (conf.encoding === 'base64-mime')
+    str = str.replace(/.{76}/g, '$&\r\n');
+
+  const chunks = [];
+  for (i = 0; i < str.length; i += chunkLen)
+    chunks.push(str.slice(i, i + chunkLen));
+
+  bench.start();
+  for (i = 0; i < n; i++) {
+    const encoder = new StringEncoder(encoding);
+    for (var j = 0; j < chunks.length; j++)
+      encoder.write(chunks[j]);
+    encoder.end();
+  }
+  bench.end(n);
+}
@@ -0,0 +1,35 @@
+'use strict';
+var common = require('../common.js');
+var timers = require('timers');
+
+// Idle timeouts like those of sockets: many timers, re-armed over and over
+// and cancelled before they expire.
+var bench = common.createBenchmark(main, {
+  timers: [1e3, 1e5, 5e5],
+  millions: [5]
+});
+
+function main(conf) {
+  var count = conf.timers | 0;
+  var n = +conf.millions * 1e6;
+  var items = new Array(count);
+  var i;
+
+  function onTimeout() {
+    throw new Error('idle timeout fired');
+  }
+
+  for (i = 0; i < count; i++) {
+    items[i] = { _onTimeout: onTimeout };
+    timers.enroll(items[i], 120000);
+    timers._unrefActive(items[i]);
+  }
+
+  bench.start();
+  for (i = 0; i < n; i++)
+    timers._unrefActive(items[i % count]);
+  bench.end(n / 1e6);
+
+  for (i = 0; i < count; i++)
+    timers.unenroll(items[i]);
+}
@@ -0,0 +1,35 @@
+// decompresses many small gzip bodies, e.g. request payloads
+'use strict';
+var common = require('../common.js');
+var zlib = require('zlib');
+
+var bench = common.createBenchmark(main, {
+  n: [1e5],
+  size: [256, 4096],
+  api: ['gunzipSync', 'gunzip']
+});
+
+function main(conf) {
+  var n = +conf.n;
+  var size = +conf.size;
+  var body = Buffer.alloc(size);
+  for (var j = 0; j < size; j++)
+    body[j] = 97 + (j * 7 + (j >> 4)) % 26;
+  var compressed = zlib.gzipSync(body);
+  var i;
+
+  if (conf.api === 'gunzipSync') {
+    bench.start();
+    for (i = 0; i < n; i++)
+      zlib.gunzipSync(compressed);
+    bench.end(n);
+  } else {
+    i = 0;
+    bench.start();
+    (function next() {
+      if (i++ === n)
+        return bench.end(n);
+      zlib.gunzip(compressed, next);
+    })();
+  }
+}
@@ -569,7 +569,21 @@ enum uv_udp_flags {
    * (provided they all set the flag) but only the last one to bind will receive
    * any traffic, in effect "stealing" the port from the previous listener.
    */
-  UV_UDP_REUSEADDR = 4
+  UV_UDP_REUSEADDR = 4,
+  /*
+   * Indicates that the message was received by recvmmsg(), so the buffer
+   * passed to uv_udp_recv_cb points into the buffer handed out by the
+   * uv_alloc_cb and must not be freed by the callback. Once all messages of
+   * a batch have been delivered, uv_udp_recv_cb is called one last time with
+   * nread == 0, addr == NULL and the original buffer.
+   */
+  UV_UDP_MMSG_CHUNK = 8,
+  /*
+   * Indicates that recvmmsg() should be used, if available. Passed to
+   * uv_udp_init_ex(). The batched path is only taken when the uv_alloc_cb
+   * returns a buffer large enough for at least two maximum sized datagrams.
+   */
+  UV_UDP_RECVMMSG = 256
 };
 
 typedef void (*uv_udp_send_cb)(uv_udp_send_t* req, int status);
@@ -633,6 +647,12 @@ UV_EXTERN int uv_udp_try_send(uv_udp_t* handle,
                               const uv_buf_t bufs[],
                               unsigned int nbufs,
                               const struct sockaddr* addr);
+UV_EXTERN int uv_udp_try_send2(uv_udp_t* handle,
+                               unsigned int count,
+                               uv_buf_t* bufs[/*count*/],
+                               unsigned int nbufs[/*count*/],
+                               struct sockaddr* addrs[/*count*/],
+                               unsigned int flags);
 UV_EXTERN int uv_udp_recv_start(uv_udp_t* handle,
                                 uv_alloc_cb alloc_cb,
                                 uv_udp_recv_cb recv_cb);
@@ -973,6 +993,41 @@ UV_EXTERN int uv_queue_work(uv_loop_t* loop,
                             uv_work_cb work_cb,
                             uv_after_work_cb after_work_cb);
 
+typedef enum {
+  UV_WORK_DEFAULT = 0,
+  UV_WORK_FS,
+  UV_WORK_DNS,
+  UV_WORK_CRYPTO,
+  UV_WORK_COMPRESSION,
+  UV_WORK_CLASS_MAX
+} uv_work_class_t;
+
+typedef struct {
+  uint64_t queued;
+  uint64_t running;
+  uint64_t dispatched;
+  uint64_t wait_time;
+  uint64_t max_wait_time;
+} uv_work_class_stats_t;
+
+typedef struct {
+  unsigned int threads;
+  unsigned int idle_threads;
+  unsigned int min_threads;
+  unsigned int max_threads;
+  uv_work_class_stats_t classes[UV_WORK_CLASS_MAX];
+} uv_threadpool_stats_t;
+
+UV_EXTERN int uv_queue_work_ex(uv_loop_t* loop,
+                               uv_work_t* req,
+                               uv_work_class_t work_class,
+                               uv_work_cb work_cb,
+                               uv_after_work_cb after_work_cb);
+
+UV_EXTERN int uv_threadpool_set_limits(unsigned int min_threads,
+                                       unsigned int max_threads);
+UV_EXTERN void uv_threadpool_get_stats(uv_threadpool_stats_t* stats);
+
 UV_EXTERN int uv_cancel(uv_req_t* req);
 
 
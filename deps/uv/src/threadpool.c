@@ -38,18 +38,52 @@ static void uv__req_init(uv_loop_t* loop,
 #endif
 
 #include <stdlib.h>
+#include <string.h>
 
 #define MAX_THREADPOOL_SIZE 128
+#define DEFAULT_THREADPOOL_SIZE 4
+
+/* Threads above the minimum exit after being idle for this long (in ns). */
+#define IDLE_TIMEOUT ((uint64_t) 5 * 1000 * 1000 * 1000)
+
+enum {
+  SLOT_FREE,
+  SLOT_RUNNING,
+  SLOT_EXITED   /* Waiting to be joined. */
+};
+
+struct thread_slot {
+  uv_thread_t tid;
+  int state;
+};
+
+/* Bookkeeping for a request while it waits for a thread.  It is kept out of
+ * struct uv__work, which is embedded in the public request types, so that
+ * their layout stays the same.  While the request is queued the first
+ * pointer of its wq field points to the entry; a thread that takes the
+ * request resets wq to an empty queue, which tells uv_cancel() that the
+ * request is executing.
+ */
+struct work_entry {
+  QUEUE wq;  /* In a class queue, or in free_entries when unused. */
+  struct uv__work* w;
+  uint64_t queued_at;
+  unsigned int work_class;
+};
 
 static uv_once_t once = UV_ONCE_INIT;
 static uv_cond_t cond;
 static uv_mutex_t mutex;
 static unsigned int idle_threads;
 static unsigned int nthreads;
-static uv_thread_t* threads;
-static uv_thread_t default_threads[4];
-static QUEUE exit_message;
-static QUEUE wq;
+static unsigned int min_threads;
+static unsigned int max_threads;
+static struct thread_slot slots[MAX_THREADPOOL_SIZE];
+static QUEUE wq[UV_WORK_CLASS_MAX];
+static QUEUE free_entries;
+static uv_work_class_stats_t class_stats[UV_WORK_CLASS_MAX];
+static unsigned int next_class;
+static int stopping;
 static volatile int initialized;
 
 
@@ -58,40 +92,125 @@ static void uv__cancelled(struct uv__work* w) {
 }
 
 
+/* Requests that block on the network, like getaddrinfo(), may occupy all
+ * threads but one, so that the other classes always have a thread to run on.
+ * A pool of a single thread is shared.
+ */
+static unsigned int class_limit(unsigned int work_class) {
+  if (work_class == UV_WORK_DNS)
+    return max_threads > 1 ? max_threads - 1 : 1;
+  return max_threads;
+}
+
+
+/* Must be called with the global mutex held. */
+static struct work_entry* entry_alloc(void) {
+  QUEUE* q;
+
+  if (QUEUE_EMPTY(&free_entries)) {
+    struct work_entry* entry = uv__malloc(sizeof(*entry));
+    if (entry == NULL)
+      abort();
+    return entry;
+  }
+
+  q = QUEUE_HEAD(&free_entries);
+  QUEUE_REMOVE(q);
+  return QUEUE_DATA(q, struct work_entry, wq);
+}
+
+
+/* Must be called with the global mutex held. */
+static void entry_free(struct work_entry* entry) {
+  QUEUE_INSERT_HEAD(&free_entries, &entry->wq);
+}
+
+
+/* Picks the next request, going round-robin over the classes so that a burst
+ * in one class doesn't hold up the others.  Must be called with the global
+ * mutex held.
+ */
+static QUEUE* next_work(void) {
+  unsigned int work_class;
+  unsigned int i;
+
+  for (i = 0; i < UV_WORK_CLASS_MAX; i++) {
+    work_class = (next_class + i) % UV_WORK_CLASS_MAX;
+    if (QUEUE_EMPTY(&wq[work_class]))
+      continue;
+    if (class_stats[work_class].running >= class_limit(work_class))
+      continue;
+    next_class = (work_class + 1) % UV_WORK_CLASS_MAX;
+    return QUEUE_HEAD(&wq[work_class]);
+  }
+
+  return NULL;
+}
+
+
 /* To avoid deadlock with uv_cancel() it's crucial that the worker
  * never holds the global mutex and the loop-local mutex at the same time.
  */
 static void worker(void* arg) {
+  struct thread_slot* slot;
+  uv_work_class_stats_t* stats;
+  struct work_entry* entry;
   struct uv__work* w;
+  unsigned int work_class;
+  uint64_t wait_time;
+  int timed_out;
   QUEUE* q;
 
-  (void) arg;
+  slot = arg;
+
+  uv_mutex_lock(&mutex);
 
   for (;;) {
-    uv_mutex_lock(&mutex);
+    timed_out = 0;
+
+    for (;;) {
+      q = next_work();
+      if (q != NULL)
+        break;
+
+      /* Shrink when the pool is stopping, was made smaller or when this
+       * thread has been idle for a while.
+       */
+      if (stopping || nthreads > max_threads)
+        break;
+      if (timed_out && nthreads > min_threads)
+        break;
 
-    while (QUEUE_EMPTY(&wq)) {
       idle_threads += 1;
-      uv_cond_wait(&cond, &mutex);
+      if (nthreads > min_threads)
+        timed_out = uv_cond_timedwait(&cond, &mutex, IDLE_TIMEOUT) != 0;
+      else
+        uv_cond_wait(&cond, &mutex);
       idle_threads -= 1;
     }
 
-    q = QUEUE_HEAD(&wq);
+    if (q == NULL)
+      break;
 
-    if (q == &exit_message)
-      uv_cond_signal(&cond);
-    else {
-      QUEUE_REMOVE(q);
-      QUEUE_INIT(q);  /* Signal uv_cancel() that the work req is
-                             executing. */
-    }
+    QUEUE_REMOVE(q);
+    entry = QUEUE_DATA(q, struct work_entry, wq);
+    w = entry->w;
+    work_class = entry->work_class;
+    wait_time = uv_hrtime() - entry->queued_at;
+    entry_free(entry);
+    QUEUE_INIT(&w->wq);  /* Signal uv_cancel() that the work req is
+                            executing. */
+
+    stats = &class_stats[work_class];
+    stats->queued -= 1;
+    stats->running += 1;
+    stats->dispatched += 1;
+    stats->wait_time += wait_time;
+    if (wait_time > stats->max_wait_time)
+      stats->max_wait_time = wait_time;
 
     uv_mutex_unlock(&mutex);
 
-    if (q == &exit_message)
-      break;
-
-    w = QUEUE_DATA(q, struct uv__work, wq);
     w->work(w);
 
     uv_mutex_lock(&w->loop->wq_mutex);
@@ -100,15 +219,74 @@ static void worker(void* arg) {
     QUEUE_INSERT_TAIL(&w->loop->wq, &w->wq);
     uv_async_send(&w->loop->wq_async);
     uv_mutex_unlock(&w->loop->wq_mutex);
+
+    /* Don't touch w from here on, the loop thread may already have freed it. */
+    uv_mutex_lock(&mutex);
+    class_stats[work_class].running -= 1;
+
+    /* Requests that were held back by the class limit can run now. */
+    if (idle_threads > 0 && !QUEUE_EMPTY(&wq[work_class]))
+      uv_cond_signal(&cond);
+  }
+
+  nthreads -= 1;
+  slot->state = SLOT_EXITED;
+  uv_mutex_unlock(&mutex);
+}
+
+
+/* Must be called with the global mutex held. */
+static int spawn_thread(void) {
+  struct thread_slot* slot;
+  unsigned int i;
+  int err;
+
+  for (i = 0; i < ARRAY_SIZE(slots); i++)
+    if (slots[i].state != SLOT_RUNNING)
+      break;
+
+  if (i == ARRAY_SIZE(slots))
+    return UV_EAGAIN;
+
+  slot = &slots[i];
+  if (slot->state == SLOT_EXITED) {
+    /* The thread is done with the mutex, this won't block for long. */
+    if (uv_thread_join(&slot->tid))
+      abort();
+    slot->state = SLOT_FREE;
   }
+
+  slot->state = SLOT_RUNNING;
+  err = uv_thread_create(&slot->tid, worker, slot);
+  if (err) {
+    slot->state = SLOT_FREE;
+    return err;
+  }
+
+  nthreads += 1;
+  return 0;
 }
 
 
-static void post(QUEUE* q) {
+static void post(struct uv__work* w, unsigned int work_class) {
+  struct work_entry* entry;
+  uint64_t now;
+
+  now = uv_hrtime();
+
   uv_mutex_lock(&mutex);
-  QUEUE_INSERT_TAIL(&wq, q);
+  entry = entry_alloc();
+  entry->w = w;
+  entry->queued_at = now;
+  entry->work_class = work_class;
+  w->wq[0] = entry;
+  w->wq[1] = NULL;
+  QUEUE_INSERT_TAIL(&wq[work_class], &entry->wq);
+  class_stats[work_class].queued += 1;
   if (idle_threads > 0)
     uv_cond_signal(&cond);
+  else if (nthreads < max_threads)
+    spawn_thread();  /* Not fatal, the work runs when a thread frees up. */
   uv_mutex_unlock(&mutex);
 }
 
@@ -120,48 +298,64 @@ UV_DESTRUCTOR(static void cleanup(void)) {
   if (initialized == 0)
     return;
 
-  post(&exit_message);
+  uv_mutex_lock(&mutex);
+  stopping = 1;
+  uv_cond_broadcast(&cond);
+  uv_mutex_unlock(&mutex);
 
-  for (i = 0; i < nthreads; i++)
-    if (uv_thread_join(threads + i))
+  for (i = 0; i < ARRAY_SIZE(slots); i++) {
+    if (slots[i].state == SLOT_FREE)
+      continue;
+    if (uv_thread_join(&slots[i].tid))
       abort();
+    slots[i].state = SLOT_FREE;
+  }
 
-  if (threads != default_threads)
-    uv__free(threads);
+  while (!QUEUE_EMPTY(&free_entries)) {
+    QUEUE* q = QUEUE_HEAD(&free_entries);
+    QUEUE_REMOVE(q);
+    uv__free(QUEUE_DATA(q, struct work_entry, wq));
+  }
 
   uv_mutex_destroy(&mutex);
   uv_cond_destroy(&cond);
 
-  threads = NULL;
   nthreads = 0;
+  stopping = 0;
   initialized = 0;
 }
 #endif
 
 
-static void init_once(void) {
-  unsigned int i;
+static unsigned int getenv_threads(const char* name, unsigned int def) {
   const char* val = NULL;
+  unsigned int n;
 
-  nthreads = ARRAY_SIZE(default_threads);
 #ifndef UWP_DLL
-  val = getenv("UV_THREADPOOL_SIZE");
+  val = getenv(name);
 #endif
-  if (val != NULL)
-    nthreads = atoi(val);
-  if (nthreads == 0)
-    nthreads = 1;
-  if (nthreads > MAX_THREADPOOL_SIZE)
-    nthreads = MAX_THREADPOOL_SIZE;
-
-  threads = default_threads;
-  if (nthreads > ARRAY_SIZE(default_threads)) {
-    threads = uv__malloc(nthreads * sizeof(threads[0]));
-    if (threads == NULL) {
-      nthreads = ARRAY_SIZE(default_threads);
-      threads = default_threads;
-    }
-  }
+  if (val == NULL)
+    return def;
+
+  n = atoi(val);
+  if (n == 0)
+    n = 1;
+  if (n > MAX_THREADPOOL_SIZE)
+    n = MAX_THREADPOOL_SIZE;
+  return n;
+}
+
+
+static void init_once(void) {
+  unsigned int i;
+
+  /* UV_THREADPOOL_SIZE is the number of threads that are always kept around,
+   * UV_THREADPOOL_MAX_SIZE how far the pool may grow under load.
+   */
+  min_threads = getenv_threads("UV_THREADPOOL_SIZE", DEFAULT_THREADPOOL_SIZE);
+  max_threads = getenv_threads("UV_THREADPOOL_MAX_SIZE", min_threads);
+  if (max_threads < min_threads)
+    max_threads = min_threads;
 
   if (uv_cond_init(&cond))
     abort();
@@ -169,11 +363,15 @@ static void init_once(void) {
   if (uv_mutex_init(&mutex))
     abort();
 
-  QUEUE_INIT(&wq);
+  for (i = 0; i < ARRAY_SIZE(wq); i++)
+    QUEUE_INIT(&wq[i]);
+  QUEUE_INIT(&free_entries);
 
-  for (i = 0; i < nthreads; i++)
-    if (uv_thread_create(threads + i, worker, NULL))
+  uv_mutex_lock(&mutex);
+  for (i = 0; i < min_threads; i++)
+    if (spawn_thread())
       abort();
+  uv_mutex_unlock(&mutex);
 
   initialized = 1;
 }
@@ -181,25 +379,31 @@ static void init_once(void) {
 
 void uv__work_submit(uv_loop_t* loop,
                      struct uv__work* w,
+                     uv_work_class_t work_class,
                      void (*work)(struct uv__work* w),
                      void (*done)(struct uv__work* w, int status)) {
   uv_once(&once, init_once);
   w->loop = loop;
   w->work = work;
   w->done = done;
-  post(&w->wq);
+  post(w, work_class);
 }
 
 
 static int uv__work_cancel(uv_loop_t* loop, uv_req_t* req, struct uv__work* w) {
+  struct work_entry* entry;
   int cancelled;
 
   uv_mutex_lock(&mutex);
   uv_mutex_lock(&w->loop->wq_mutex);
 
   cancelled = !QUEUE_EMPTY(&w->wq) && w->work != NULL;
-  if (cancelled)
-    QUEUE_REMOVE(&w->wq);
+  if (cancelled) {
+    entry = w->wq[0];
+    QUEUE_REMOVE(&entry->wq);
+    class_stats[entry->work_class].queued -= 1;
+    entry_free(entry);
+  }
 
   uv_mutex_unlock(&w->loop->wq_mutex);
   uv_mutex_unlock(&mutex);
@@ -240,6 +444,39 @@ void uv__work_done(uv_async_t* handle) {
 }
 
 
+int uv_threadpool_set_limits(unsigned int min, unsigned int max) {
+  if (min == 0 || min > max || max > MAX_THREADPOOL_SIZE)
+    return UV_EINVAL;
+
+  uv_once(&once, init_once);
+
+  uv_mutex_lock(&mutex);
+  min_threads = min;
+  max_threads = max;
+  while (nthreads < min_threads)
+    if (spawn_thread())
+      break;
+  /* Wake up idle threads so that the surplus ones exit. */
+  uv_cond_broadcast(&cond);
+  uv_mutex_unlock(&mutex);
+
+  return 0;
+}
+
+
+void uv_threadpool_get_stats(uv_threadpool_stats_t* stats) {
+  uv_once(&once, init_once);
+
+  uv_mutex_lock(&mutex);
+  stats->threads = nthreads;
+  stats->idle_threads = idle_threads;
+  stats->min_threads = min_threads;
+  stats->max_threads = max_threads;
+  memcpy(stats->classes, class_stats, sizeof(class_stats));
+  uv_mutex_unlock(&mutex);
+}
+
+
 static void uv__queue_work(struct uv__work* w) {
   uv_work_t* req = container_of(w, uv_work_t, work_req);
 
@@ -264,14 +501,30 @@ int uv_queue_work(uv_loop_t* loop,
                   uv_work_t* req,
                   uv_work_cb work_cb,
                   uv_after_work_cb after_work_cb) {
+  return uv_queue_work_ex(loop, req, UV_WORK_DEFAULT, work_cb, after_work_cb);
+}
+
+
+int uv_queue_work_ex(uv_loop_t* loop,
+                     uv_work_t* req,
+                     uv_work_class_t work_class,
+                     uv_work_cb work_cb,
+                     uv_after_work_cb after_work_cb) {
   if (work_cb == NULL)
     return UV_EINVAL;
 
+  if ((unsigned int) work_class >= UV_WORK_CLASS_MAX)
+    return UV_EINVAL;
+
   uv__req_init(loop, req, UV_WORK);
   req->loop = loop;
   req->work_cb = work_cb;
   req->after_work_cb = after_work_cb;
-  uv__work_submit(loop, &req->work_req, uv__queue_work, uv__queue_done);
+  uv__work_submit(loop,
+                  &req->work_req,
+                  work_class,
+                  uv__queue_work,
+                  uv__queue_done);
   return 0;
 }
 
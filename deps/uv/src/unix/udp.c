@@ -36,6 +36,22 @@
 # define IPV6_DROP_MEMBERSHIP IPV6_LEAVE_GROUP
 #endif
 
+#if defined(__linux__)
+# define HAVE_MMSG 1
+#endif
+
+#define UV__UDP_DGRAM_MAXSIZE (64 * 1024)
+#define UV__MMSG_MAXWIDTH 20
+
+#if HAVE_MMSG
+/* Cleared the first time the kernel reports ENOSYS, after which we stick
+ * with recvmsg() and sendmsg().  Racy across threads but only ever goes
+ * from 1 to 0.
+ */
+static int uv__recvmmsg_avail = 1;
+static int uv__sendmmsg_avail = 1;
+#endif
+
 
 static void uv__udp_run_completed(uv_udp_t* handle);
 static void uv__udp_io(uv_loop_t* loop, uv__io_t* w, unsigned int revents);
@@ -145,6 +161,76 @@ static void uv__udp_io(uv_loop_t* loop, uv__io_t* w, unsigned int revents) {
 }
 
 
+#if HAVE_MMSG
+static ssize_t uv__udp_recvmmsg(uv_udp_t* handle, uv_buf_t* buf) {
+  struct sockaddr_storage peers[UV__MMSG_MAXWIDTH];
+  struct iovec iov[UV__MMSG_MAXWIDTH];
+  struct uv__mmsghdr msgs[UV__MMSG_MAXWIDTH];
+  ssize_t nread;
+  uv_buf_t chunk_buf;
+  size_t chunks;
+  int flags;
+  size_t k;
+
+  /* Carve the buffer up into slots that can each hold a maximum sized
+   * datagram so nothing gets truncated.
+   */
+  chunks = buf->len / UV__UDP_DGRAM_MAXSIZE;
+  if (chunks > ARRAY_SIZE(iov))
+    chunks = ARRAY_SIZE(iov);
+
+  for (k = 0; k < chunks; ++k) {
+    iov[k].iov_base = buf->base + k * UV__UDP_DGRAM_MAXSIZE;
+    iov[k].iov_len = UV__UDP_DGRAM_MAXSIZE;
+    memset(&msgs[k], 0, sizeof(msgs[k]));
+    msgs[k].msg_hdr.msg_iov = iov + k;
+    msgs[k].msg_hdr.msg_iovlen = 1;
+    msgs[k].msg_hdr.msg_name = peers + k;
+    msgs[k].msg_hdr.msg_namelen = sizeof(peers[0]);
+  }
+
+  do
+    nread = uv__recvmmsg(handle->io_watcher.fd, msgs, chunks, 0, NULL);
+  while (nread == -1 && errno == EINTR);
+
+  if (nread == -1 && errno == ENOSYS) {
+    uv__recvmmsg_avail = 0;
+    errno = 0;
+    return -ENOSYS;
+  }
+
+  if (nread < 1) {
+    if (nread == 0 || errno == EAGAIN || errno == EWOULDBLOCK)
+      handle->recv_cb(handle, 0, buf, NULL, 0);
+    else
+      handle->recv_cb(handle, -errno, buf, NULL, 0);
+    return -1;
+  }
+
+  /* Pass each datagram to the application... */
+  for (k = 0; k < (size_t) nread && handle->recv_cb != NULL; k++) {
+    flags = UV_UDP_MMSG_CHUNK;
+    if (msgs[k].msg_hdr.msg_flags & MSG_TRUNC)
+      flags |= UV_UDP_PARTIAL;
+
+    chunk_buf = uv_buf_init(iov[k].iov_base, iov[k].iov_len);
+    handle->recv_cb(handle,
+                    msgs[k].msg_len,
+                    &chunk_buf,
+                    msgs[k].msg_hdr.msg_namelen == 0 ?
+                        NULL : (const struct sockaddr*) &peers[k],
+                    flags);
+  }
+
+  /* ...and hand back the original buffer so it can be released. */
+  if (handle->recv_cb != NULL)
+    handle->recv_cb(handle, 0, buf, NULL, 0);
+
+  return nread;
+}
+#endif
+
+
 static void uv__udp_recvmsg(uv_udp_t* handle) {
   struct sockaddr_storage peer;
   struct msghdr h;
@@ -172,6 +258,21 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
     }
     assert(buf.base != NULL);
 
+#if HAVE_MMSG
+    if ((handle->flags & UV_UDP_RECVMMSG_ENABLED) &&
+        uv__recvmmsg_avail &&
+        buf.len >= 2 * UV__UDP_DGRAM_MAXSIZE) {
+      nread = uv__udp_recvmmsg(handle, &buf);
+      if (nread > 0) {
+        count -= nread;
+        continue;
+      }
+      if (nread != -ENOSYS)
+        break;
+      /* Fall through to recvmsg() with the same buffer. */
+    }
+#endif
+
     h.msg_namelen = sizeof(peer);
     h.msg_iov = (void*) &buf;
     h.msg_iovlen = 1;
@@ -209,12 +310,89 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
 }
 
 
+#if HAVE_MMSG
+/* Returns 0 when the write queue has been processed or the socket is full,
+ * -ENOSYS when the caller should fall back to sendmsg().
+ */
+static int uv__udp_sendmmsg(uv_udp_t* handle) {
+  uv_udp_send_t* req;
+  struct uv__mmsghdr h[UV__MMSG_MAXWIDTH];
+  struct uv__mmsghdr* p;
+  QUEUE* q;
+  ssize_t npkts;
+  size_t pkts;
+  size_t i;
+
+  while (!QUEUE_EMPTY(&handle->write_queue)) {
+    for (pkts = 0, q = QUEUE_HEAD(&handle->write_queue);
+         pkts < UV__MMSG_MAXWIDTH && q != &handle->write_queue;
+         ++pkts, q = QUEUE_NEXT(q)) {
+      req = QUEUE_DATA(q, uv_udp_send_t, queue);
+
+      p = &h[pkts];
+      memset(p, 0, sizeof(*p));
+      p->msg_hdr.msg_name = &req->addr;
+      p->msg_hdr.msg_namelen = (req->addr.ss_family == AF_INET6 ?
+        sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in));
+      p->msg_hdr.msg_iov = (struct iovec*) req->bufs;
+      p->msg_hdr.msg_iovlen = req->nbufs;
+    }
+
+    do
+      npkts = uv__sendmmsg(handle->io_watcher.fd, h, pkts, 0);
+    while (npkts == -1 && errno == EINTR);
+
+    if (npkts == -1) {
+      if (errno == ENOSYS) {
+        uv__sendmmsg_avail = 0;
+        return -ENOSYS;
+      }
+
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        return 0;
+
+      /* The error applies to the first datagram of the batch, the others are
+       * retried on the next iteration.
+       */
+      q = QUEUE_HEAD(&handle->write_queue);
+      req = QUEUE_DATA(q, uv_udp_send_t, queue);
+      req->status = -errno;
+      QUEUE_REMOVE(&req->queue);
+      QUEUE_INSERT_TAIL(&handle->write_completed_queue, &req->queue);
+      uv__io_feed(handle->loop, &handle->io_watcher);
+      continue;
+    }
+
+    for (i = 0; i < (size_t) npkts; i++) {
+      q = QUEUE_HEAD(&handle->write_queue);
+      req = QUEUE_DATA(q, uv_udp_send_t, queue);
+      req->status = h[i].msg_len;
+      QUEUE_REMOVE(&req->queue);
+      QUEUE_INSERT_TAIL(&handle->write_completed_queue, &req->queue);
+    }
+    uv__io_feed(handle->loop, &handle->io_watcher);
+  }
+
+  return 0;
+}
+#endif
+
+
 static void uv__udp_sendmsg(uv_udp_t* handle) {
   uv_udp_send_t* req;
   QUEUE* q;
   struct msghdr h;
   ssize_t size;
 
+#if HAVE_MMSG
+  /* Batching only pays off when there is more than one datagram queued. */
+  if (uv__sendmmsg_avail &&
+      QUEUE_NEXT(QUEUE_HEAD(&handle->write_queue)) != &handle->write_queue) {
+    if (uv__udp_sendmmsg(handle) == 0)
+      return;
+  }
+#endif
+
   while (!QUEUE_EMPTY(&handle->write_queue)) {
     q = QUEUE_HEAD(&handle->write_queue);
     assert(q != NULL);
@@ -471,6 +649,84 @@ int uv__udp_try_send(uv_udp_t* handle,
 }
 
 
+int uv__udp_try_send2(uv_udp_t* handle,
+                      unsigned int count,
+                      uv_buf_t* bufs[],
+                      unsigned int nbufs[],
+                      struct sockaddr* addrs[]) {
+  unsigned int i;
+  ssize_t size;
+  int err;
+
+  /* Datagrams that are already queued would be overtaken. */
+  if (handle->send_queue_count != 0)
+    return -EAGAIN;
+
+  err = uv__udp_maybe_deferred_bind(handle, addrs[0]->sa_family, 0);
+  if (err)
+    return err;
+
+#if HAVE_MMSG
+  if (uv__sendmmsg_avail) {
+    struct uv__mmsghdr h[UV__MMSG_MAXWIDTH];
+    unsigned int sent;
+    unsigned int n;
+
+    for (sent = 0; sent < count; sent += n) {
+      n = count - sent;
+      if (n > ARRAY_SIZE(h))
+        n = ARRAY_SIZE(h);
+
+      memset(h, 0, n * sizeof(h[0]));
+      for (i = 0; i < n; i++) {
+        h[i].msg_hdr.msg_name = addrs[sent + i];
+        h[i].msg_hdr.msg_namelen = (addrs[sent + i]->sa_family == AF_INET6 ?
+          sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in));
+        h[i].msg_hdr.msg_iov = (struct iovec*) bufs[sent + i];
+        h[i].msg_hdr.msg_iovlen = nbufs[sent + i];
+      }
+
+      do
+        size = uv__sendmmsg(handle->io_watcher.fd, h, n, 0);
+      while (size == -1 && errno == EINTR);
+
+      if (size == -1) {
+        if (errno == ENOSYS && sent == 0) {
+          uv__sendmmsg_avail = 0;
+          break;
+        }
+        if (sent > 0)
+          return sent;
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+          return -EAGAIN;
+        return -errno;
+      }
+
+      if ((unsigned int) size < n)
+        return sent + size;
+    }
+
+    if (sent == count)
+      return count;
+  }
+#endif
+
+  for (i = 0; i < count; i++) {
+    size = uv__udp_try_send(handle,
+                            bufs[i],
+                            nbufs[i],
+                            addrs[i],
+                            addrs[i]->sa_family == AF_INET6 ?
+                              sizeof(struct sockaddr_in6) :
+                              sizeof(struct sockaddr_in));
+    if (size < 0)
+      return i > 0 ? (int) i : (int) size;
+  }
+
+  return count;
+}
+
+
 static int uv__udp_set_membership4(uv_udp_t* handle,
                                    const struct sockaddr_in* multicast_addr,
                                    const char* interface_addr,
@@ -567,7 +823,7 @@ int uv_udp_init_ex(uv_loop_t* loop, uv_udp_t* handle, unsigned int flags) {
   if (domain != AF_INET && domain != AF_INET6 && domain != AF_UNSPEC)
     return -EINVAL;
 
-  if (flags & ~0xFF)
+  if (flags & ~(0xFF | UV_UDP_RECVMMSG))
     return -EINVAL;
 
   if (domain != AF_UNSPEC) {
@@ -587,6 +843,10 @@ int uv_udp_init_ex(uv_loop_t* loop, uv_udp_t* handle, unsigned int flags) {
   uv__io_init(&handle->io_watcher, uv__udp_io, fd);
   QUEUE_INIT(&handle->write_queue);
   QUEUE_INIT(&handle->write_completed_queue);
+
+  if (flags & UV_UDP_RECVMMSG)
+    handle->flags |= UV_UDP_RECVMMSG_ENABLED;
+
   return 0;
 }
 
@@ -326,6 +326,28 @@ int uv_udp_try_send(uv_udp_t* handle,
 }
 
 
+int uv_udp_try_send2(uv_udp_t* handle,
+                     unsigned int count,
+                     uv_buf_t* bufs[],
+                     unsigned int nbufs[],
+                     struct sockaddr* addrs[],
+                     unsigned int flags) {
+  unsigned int i;
+
+  if (handle->type != UV_UDP || flags != 0)
+    return UV_EINVAL;
+
+  if (count < 1)
+    return UV_EINVAL;
+
+  for (i = 0; i < count; i++)
+    if (addrs[i]->sa_family != AF_INET && addrs[i]->sa_family != AF_INET6)
+      return UV_EINVAL;
+
+  return uv__udp_try_send2(handle, count, bufs, nbufs, addrs);
+}
+
+
 int uv_udp_recv_start(uv_udp_t* handle,
                       uv_alloc_cb alloc_cb,
                       uv_udp_recv_cb recv_cb) {
@@ -132,7 +132,8 @@ int uv_udp_init_ex(uv_loop_t* loop, uv_udp_t* handle, unsigned int flags) {
   if (domain != AF_INET && domain != AF_INET6 && domain != AF_UNSPEC)
     return UV_EINVAL;
 
-  if (flags & ~0xFF)
+  /* UV_UDP_RECVMMSG is accepted but has no effect on Windows. */
+  if (flags & ~(0xFF | UV_UDP_RECVMMSG))
     return UV_EINVAL;
 
   uv__handle_init(loop, (uv_handle_t*) handle, UV_UDP);
@@ -925,3 +926,27 @@ int uv__udp_try_send(uv_udp_t* handle,
                      unsigned int addrlen) {
   return UV_ENOSYS;
 }
+
+
+int uv__udp_try_send2(uv_udp_t* handle,
+                      unsigned int count,
+                      uv_buf_t* bufs[],
+                      unsigned int nbufs[],
+                      struct sockaddr* addrs[]) {
+  unsigned int i;
+  int r;
+
+  for (i = 0; i < count; i++) {
+    r = uv__udp_try_send(handle,
+                         bufs[i],
+                         nbufs[i],
+                         addrs[i],
+                         addrs[i]->sa_family == AF_INET6 ?
+                           sizeof(struct sockaddr_in6) :
+                           sizeof(struct sockaddr_in));
+    if (r < 0)
+      return i > 0 ? (int) i : r;
+  }
+
+  return (int) count;
+}
@@ -0,0 +1,144 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#define NUM_BLOCKING 4
+
+static uv_barrier_t barrier;
+static uv_sem_t release;
+static unsigned int release_count;
+static uv_work_t reqs[NUM_BLOCKING + 1];
+static int after_work_cb_count;
+
+
+static void barrier_work_cb(uv_work_t* req) {
+  /* Only returns once NUM_BLOCKING threads are running at the same time. */
+  uv_barrier_wait(&barrier);
+}
+
+
+static void blocking_work_cb(uv_work_t* req) {
+  uv_sem_wait(&release);
+}
+
+
+static void release_work_cb(uv_work_t* req) {
+  unsigned int i;
+
+  for (i = 0; i < release_count; i++)
+    uv_sem_post(&release);
+}
+
+
+static void after_work_cb(uv_work_t* req, int status) {
+  ASSERT(status == 0);
+  after_work_cb_count++;
+}
+
+
+TEST_IMPL(threadpool_set_limits_einval) {
+  ASSERT(uv_threadpool_set_limits(0, 1) == UV_EINVAL);
+  ASSERT(uv_threadpool_set_limits(4, 2) == UV_EINVAL);
+  ASSERT(uv_threadpool_set_limits(1, 1024) == UV_EINVAL);
+  ASSERT(uv_queue_work_ex(uv_default_loop(),
+                          &reqs[0],
+                          UV_WORK_CLASS_MAX,
+                          blocking_work_cb,
+                          after_work_cb) == UV_EINVAL);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+TEST_IMPL(threadpool_grow) {
+  uv_threadpool_stats_t stats;
+  int i;
+
+  ASSERT(0 == uv_threadpool_set_limits(1, NUM_BLOCKING));
+  ASSERT(0 == uv_barrier_init(&barrier, NUM_BLOCKING));
+
+  for (i = 0; i < NUM_BLOCKING; i++)
+    ASSERT(0 == uv_queue_work_ex(uv_default_loop(),
+                                 &reqs[i],
+                                 UV_WORK_CRYPTO,
+                                 barrier_work_cb,
+                                 after_work_cb));
+
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+  ASSERT(after_work_cb_count == NUM_BLOCKING);
+
+  uv_threadpool_get_stats(&stats);
+  ASSERT(stats.min_threads == 1);
+  ASSERT(stats.max_threads == NUM_BLOCKING);
+  ASSERT(stats.threads >= 1 && stats.threads <= NUM_BLOCKING);
+  ASSERT(stats.classes[UV_WORK_CRYPTO].queued == 0);
+  ASSERT(stats.classes[UV_WORK_CRYPTO].dispatched == NUM_BLOCKING);
+  ASSERT(stats.classes[UV_WORK_DEFAULT].dispatched == 0);
+  ASSERT(stats.classes[UV_WORK_CRYPTO].max_wait_time <=
+         stats.classes[UV_WORK_CRYPTO].wait_time);
+
+  uv_barrier_destroy(&barrier);
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+TEST_IMPL(threadpool_dns_limit) {
+  uv_threadpool_stats_t stats;
+  unsigned int i;
+
+  /* With the default limits, as many DNS requests as there are threads get
+   * all threads but one, and that one is left for the request that unblocks
+   * them.
+   */
+  uv_threadpool_get_stats(&stats);
+  ASSERT(stats.max_threads > 1);
+  ASSERT(stats.max_threads <= NUM_BLOCKING);
+  ASSERT(0 == uv_sem_init(&release, 0));
+  release_count = stats.max_threads;
+
+  for (i = 0; i < release_count; i++)
+    ASSERT(0 == uv_queue_work_ex(uv_default_loop(),
+                                 &reqs[i],
+                                 UV_WORK_DNS,
+                                 blocking_work_cb,
+                                 after_work_cb));
+
+  ASSERT(0 == uv_queue_work_ex(uv_default_loop(),
+                               &reqs[release_count],
+                               UV_WORK_FS,
+                               release_work_cb,
+                               after_work_cb));
+
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+  ASSERT(after_work_cb_count == (int) release_count + 1);
+
+  uv_threadpool_get_stats(&stats);
+  ASSERT(stats.classes[UV_WORK_DNS].dispatched == release_count);
+  ASSERT(stats.classes[UV_WORK_FS].dispatched == 1);
+
+  uv_sem_destroy(&release);
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
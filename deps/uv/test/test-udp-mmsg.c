@@ -0,0 +1,164 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECK_HANDLE(handle) \
+  ASSERT((uv_udp_t*)(handle) == &recver || (uv_udp_t*)(handle) == &sender)
+
+#define BUFFER_MULTIPLIER 8
+#define MAX_DGRAM_SIZE (64 * 1024)
+#define NUM_SENDS 40
+
+static uv_udp_t recver;
+static uv_udp_t sender;
+static int recv_cb_called;
+static int free_cb_called;
+static int chunk_cb_called;
+static int close_cb_called;
+static int alloc_cb_called;
+
+
+static void alloc_cb(uv_handle_t* handle,
+                     size_t suggested_size,
+                     uv_buf_t* buf) {
+  size_t buffer_size;
+  CHECK_HANDLE(handle);
+
+  /* Only allocate enough room for multiple dgrams if we can actually recv
+   * them.
+   */
+  buffer_size = MAX_DGRAM_SIZE * BUFFER_MULTIPLIER;
+  buf->base = malloc(buffer_size);
+  ASSERT(buf->base != NULL);
+  buf->len = buffer_size;
+  alloc_cb_called++;
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  CHECK_HANDLE(handle);
+  close_cb_called++;
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* rcvbuf,
+                    const struct sockaddr* addr,
+                    unsigned flags) {
+  ASSERT(nread >= 0);
+
+  if (nread == 0 && addr == NULL) {
+    /* Either "nothing to read" or the end of a recvmmsg() batch, which
+     * hands back the buffer from alloc_cb.  Free it in both cases.
+     */
+    free(rcvbuf->base);
+    free_cb_called++;
+    return;
+  }
+
+  ASSERT(nread == 4);
+  ASSERT(addr != NULL);
+  ASSERT(memcmp("PING", rcvbuf->base, nread) == 0);
+
+  if (flags & UV_UDP_MMSG_CHUNK)
+    chunk_cb_called++;
+  else
+    free(rcvbuf->base);  /* Plain recvmsg() path, we own the buffer. */
+
+  if (++recv_cb_called == NUM_SENDS) {
+    uv_close((uv_handle_t*) handle, close_cb);
+    uv_close((uv_handle_t*) &sender, close_cb);
+  }
+}
+
+
+TEST_IMPL(udp_mmsg) {
+  struct sockaddr_in addr;
+  struct sockaddr* addrs[NUM_SENDS];
+  uv_buf_t bufs[NUM_SENDS];
+  uv_buf_t* bufp[NUM_SENDS];
+  unsigned int nbufs[NUM_SENDS];
+  int sent;
+  int i;
+
+  ASSERT(0 == uv_ip4_addr("0.0.0.0", TEST_PORT, &addr));
+  ASSERT(0 == uv_udp_init_ex(uv_default_loop(),
+                             &recver,
+                             AF_UNSPEC | UV_UDP_RECVMMSG));
+  ASSERT(0 == uv_udp_bind(&recver, (const struct sockaddr*) &addr, 0));
+  ASSERT(0 == uv_udp_recv_start(&recver, alloc_cb, recv_cb));
+
+  ASSERT(0 == uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+  ASSERT(0 == uv_udp_init(uv_default_loop(), &sender));
+
+  for (i = 0; i < NUM_SENDS; i++) {
+    bufs[i] = uv_buf_init("PING", 4);
+    bufp[i] = &bufs[i];
+    nbufs[i] = 1;
+    addrs[i] = (struct sockaddr*) &addr;
+  }
+
+  ASSERT(UV_EINVAL == uv_udp_try_send2(&sender, NUM_SENDS, bufp, nbufs,
+                                       addrs, 1));
+
+#ifdef _WIN32
+  /* uv_udp_try_send() is not implemented on Windows. */
+  ASSERT(UV_ENOSYS == uv_udp_try_send2(&sender, NUM_SENDS, bufp, nbufs,
+                                       addrs, 0));
+  uv_close((uv_handle_t*) &recver, close_cb);
+  uv_close((uv_handle_t*) &sender, close_cb);
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+#else
+  for (sent = 0; sent < NUM_SENDS; sent += i) {
+    i = uv_udp_try_send2(&sender,
+                         NUM_SENDS - sent,
+                         bufp + sent,
+                         nbufs + sent,
+                         addrs + sent,
+                         0);
+    ASSERT(i > 0);
+  }
+
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+
+  ASSERT(recv_cb_called == NUM_SENDS);
+#if defined(__linux__)
+  ASSERT(chunk_cb_called == NUM_SENDS);
+  ASSERT(alloc_cb_called < NUM_SENDS);  /* Datagrams were batched. */
+#endif
+  /* Every buffer that was handed out must have been handed back. */
+  ASSERT(alloc_cb_called == free_cb_called + NUM_SENDS - chunk_cb_called);
+#endif
+
+  ASSERT(close_cb_called == 2);
+  ASSERT(sender.send_queue_size == 0);
+  ASSERT(recver.send_queue_size == 0);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
@@ -398,6 +398,7 @@
         'test/test-tcp-write-queue-order.c',
         'test/test-threadpool.c',
         'test/test-threadpool-cancel.c',
+        'test/test-threadpool-classes.c',
         'test/test-thread-equal.c',
         'test/test-tmpdir.c',
         'test/test-mutexes.c',
@@ -426,6 +427,7 @@
         'test/test-udp-multicast-interface.c',
         'test/test-udp-multicast-interface6.c',
         'test/test-udp-try-send.c',
+        'test/test-udp-mmsg.c',
       ],
       'conditions': [
         [ 'OS=="win"', {
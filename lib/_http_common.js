@@ -42,9 +42,11 @@ function parserOnHeaders(headers, url) {
 // this request.
 // `url` is not set for response parsers but that's not applicable here since
 // all our parsers are request parsers.
+// `headersObject` is the ready-made `incoming.headers` object that the native
+// parser builds alongside `headers` in the fast case.
 function parserOnHeadersComplete(versionMajor, versionMinor, headers, method,
                                  url, statusCode, statusMessage, upgrade,
-                                 shouldKeepAlive) {
+                                 shouldKeepAlive, headersObject) {
   var parser = this;
 
   if (!headers) {
@@ -69,7 +71,12 @@ function parserOnHeadersComplete(versionMajor, versionMinor, headers, method,
   if (parser.maxHeaderPairs > 0)
     n = Math.min(n, parser.maxHeaderPairs);
 
-  parser.incoming._addHeaderLines(headers, n);
+  if (headersObject !== undefined && n === headers.length) {
+    parser.incoming.rawHeaders = headers;
+    parser.incoming.headers = headersObject;
+  } else {
+    parser.incoming._addHeaderLines(headers, n);
+  }
 
   if (typeof method === 'number') {
     // server only
@@ -152,6 +159,9 @@ function parserOnMessageComplete() {
 var parsers = new FreeList('parsers', 1000, function() {
   var parser = new HTTPParser(HTTPParser.REQUEST);
 
+  // Let the parser build `incoming.headers` natively.
+  parser.useNativeHeaders(true);
+
   parser._headers = [];
   parser._url = '';
   parser._consumed = false;
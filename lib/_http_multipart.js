@@ -0,0 +1,107 @@
+'use strict';
+
+const util = require('util');
+const Buffer = require('buffer').Buffer;
+const Writable = require('stream').Writable;
+const binding = process.binding('multipart_parser');
+
+const NativeParser = binding.MultipartParser;
+const kOnPart = NativeParser.kOnPart | 0;
+const kOnBody = NativeParser.kOnBody | 0;
+const kOnPartEnd = NativeParser.kOnPartEnd | 0;
+
+// RFC 2046, section 5.1.1: up to 70 characters, not ending in a space.
+const boundaryExpression =
+  /^[0-9A-Za-z'()+_,\-./:=? ]{0,69}[0-9A-Za-z'()+_,\-./:=?]$/;
+
+// Same limit as http_parser's.
+const kDefaultMaxHeaderSize = 80 * 1024;
+
+
+// Parses a multipart body, such as that of a multipart/form-data upload, as
+// it is written. Emits 'part' with the headers of each part, 'data' with the
+// pieces of its body, which are slices of the written Buffers, and 'partEnd'.
+function MultipartParser(boundary, options) {
+  if (!(this instanceof MultipartParser))
+    return new MultipartParser(boundary, options);
+
+  if (typeof boundary !== 'string' || !boundaryExpression.test(boundary))
+    throw new TypeError('"boundary" argument must be a valid boundary');
+
+  options = options || {};
+  var maxHeaderSize = kDefaultMaxHeaderSize;
+  if (options.maxHeaderSize !== undefined) {
+    maxHeaderSize = options.maxHeaderSize;
+    if (!Number.isInteger(maxHeaderSize) || maxHeaderSize < 0 ||
+        maxHeaderSize > 0xffffffff) {
+      throw new TypeError('"maxHeaderSize" must be a non-negative integer');
+    }
+  }
+
+  // The parser takes Buffers only, so strings are always decoded and object
+  // mode is not available.
+  Writable.call(this, {
+    highWaterMark: options.highWaterMark,
+    defaultEncoding: options.defaultEncoding
+  });
+
+  const handle = new NativeParser(Buffer.from(boundary, 'latin1'),
+                                  maxHeaderSize);
+  handle.owner = this;
+  handle[kOnPart] = parserOnPart;
+  handle[kOnBody] = parserOnBody;
+  handle[kOnPartEnd] = parserOnPartEnd;
+  this._handle = handle;
+
+  this.on('prefinish', onPrefinish);
+}
+util.inherits(MultipartParser, Writable);
+
+
+MultipartParser.prototype._write = function(chunk, encoding, cb) {
+  if (typeof chunk === 'string') {
+    chunk = Buffer.from(chunk, encoding);
+  } else if (!(chunk instanceof Buffer)) {
+    cb(new TypeError('"chunk" argument must be a Buffer or string'));
+    return;
+  }
+  const ret = this._handle.execute(chunk);
+  cb(ret instanceof Error ? ret : null);
+};
+
+
+function parserOnPart(rawHeaders) {
+  const headers = {};
+  for (var i = 0; i < rawHeaders.length; i += 2) {
+    const name = rawHeaders[i].toLowerCase();
+    const value = rawHeaders[i + 1];
+    if (headers[name] === undefined)
+      headers[name] = value;
+    else
+      headers[name] += ', ' + value;
+  }
+  this.owner.emit('part', headers, rawHeaders);
+}
+
+
+function parserOnBody(b, start, len) {
+  this.owner.emit('data', b.slice(start, start + len));
+}
+
+
+function parserOnPartEnd() {
+  this.owner.emit('partEnd');
+}
+
+
+// The input must not stop before the close delimiter.
+function onPrefinish() {
+  const ret = this._handle.finish();
+  if (ret instanceof Error && !this._writableState.errorEmitted) {
+    this._writableState.errorEmitted = true;
+    this.emit('error', ret);
+  }
+}
+
+
+exports.MultipartParser = MultipartParser;
@@ -2,26 +2,15 @@
 
 const assert = require('assert').ok;
 const Stream = require('stream');
-const timers = require('timers');
 const util = require('util');
 const internalUtil = require('internal/util');
 const Buffer = require('buffer').Buffer;
 const common = require('_http_common');
+const serializer = process.binding('http_serializer');
 
 const CRLF = common.CRLF;
-const trfrEncChunkExpression = common.chunkExpression;
 const debug = common.debug;
 
-const upgradeExpression = /^Upgrade$/i;
-const transferEncodingExpression = /^Transfer-Encoding$/i;
-const contentLengthExpression = /^Content-Length$/i;
-const dateExpression = /^Date$/i;
-const expectExpression = /^Expect$/i;
-const trailerExpression = /^Trailer$/i;
-const connectionExpression = /^Connection$/i;
-const connCloseExpression = /(^|\W)close(\W|$)/i;
-const connUpgradeExpression = /(^|\W)upgrade(\W|$)/i;
-
 const automaticHeaders = {
   connection: true,
   'content-length': true,
@@ -29,20 +18,21 @@ const automaticHeaders = {
   date: true
 };
 
-
-var dateCache;
-function utcDate() {
-  if (!dateCache) {
-    var d = new Date();
-    dateCache = d.toUTCString();
-    timers.enroll(utcDate, 1000 - d.getMilliseconds());
-    timers._unrefActive(utcDate);
-  }
-  return dateCache;
-}
-utcDate._onTimeout = function() {
-  dateCache = undefined;
-};
+const serializeHeader = serializer.serializeHeader;
+const serializerState = new Uint32Array(1);
+const kSendDate = serializer.kSendDate;
+const kUseChunkedEncodingByDefault = serializer.kUseChunkedEncodingByDefault;
+const kHasAgent = serializer.kHasAgent;
+const kRemovedConnection = serializer.kRemovedConnection;
+const kRemovedContentLength = serializer.kRemovedContentLength;
+const kRemovedTransferEncoding = serializer.kRemovedTransferEncoding;
+const kHasBody = serializer.kHasBody;
+const kNoContent = serializer.kNoContent;
+const kShouldKeepAlive = serializer.kShouldKeepAlive;
+const kChunkedEncoding = serializer.kChunkedEncoding;
+const kLast = serializer.kLast;
+const kUpgrading = serializer.kUpgrading;
+const kSentExpect = serializer.kSentExpect;
 
 
 function OutgoingMessage() {
@@ -193,17 +183,7 @@ OutgoingMessage.prototype._buffer = function(data, encoding, callback) {
 OutgoingMessage.prototype._storeHeader = function(firstLine, headers) {
   // firstLine in the case of request is: 'GET /index.html HTTP/1.1\r\n'
   // in the case of response it is: 'HTTP/1.1 200 OK\r\n'
-  var state = {
-    sentConnectionHeader: false,
-    sentConnectionUpgrade: false,
-    sentContentLengthHeader: false,
-    sentTransferEncodingHeader: false,
-    sentDateHeader: false,
-    sentExpect: false,
-    sentTrailer: false,
-    sentUpgrade: false,
-    messageHeader: firstLine
-  };
+  var list = [];
 
   if (headers) {
     var keys = Object.keys(headers);
@@ -222,22 +202,33 @@ OutgoingMessage.prototype._storeHeader = function(firstLine, headers) {
 
       if (Array.isArray(value)) {
         for (var j = 0; j < value.length; j++) {
-          storeHeader(this, state, field, value[j]);
+          list.push(field, value[j]);
         }
       } else {
-        storeHeader(this, state, field, value);
+        list.push(field, value);
       }
     }
   }
 
-  // Are we upgrading the connection?
-  if (state.sentConnectionUpgrade && state.sentUpgrade)
-    this.upgrading = true;
-
-  // Date header
-  if (this.sendDate === true && state.sentDateHeader === false) {
-    state.messageHeader += 'Date: ' + utcDate() + CRLF;
-  }
+  var flags = 0;
+  if (this.sendDate === true)
+    flags |= kSendDate;
+  if (this.useChunkedEncodingByDefault)
+    flags |= kUseChunkedEncodingByDefault;
+  if (this.agent)
+    flags |= kHasAgent;
+  if (this._removedHeader.connection)
+    flags |= kRemovedConnection;
+  if (this._removedHeader['content-length'])
+    flags |= kRemovedContentLength;
+  if (this._removedHeader['transfer-encoding'])
+    flags |= kRemovedTransferEncoding;
+  if (this._hasBody)
+    flags |= kHasBody;
+  if (this.shouldKeepAlive)
+    flags |= kShouldKeepAlive;
+  if (this.chunkedEncoding === true)
+    flags |= kChunkedEncoding;
 
   // Force the connection to close when the response is a 204 No Content or
   // a 304 Not Modified and the user has set a "Transfer-Encoding: chunked"
@@ -251,100 +242,40 @@ OutgoingMessage.prototype._storeHeader = function(firstLine, headers) {
   // of creating security liabilities, so suppress the zero chunk and force
   // the connection to close.
   var statusCode = this.statusCode;
-  if ((statusCode === 204 || statusCode === 304) &&
-      this.chunkedEncoding === true) {
-    debug(statusCode + ' response should not use chunked encoding,' +
-          ' closing connection.');
-    this.chunkedEncoding = false;
-    this.shouldKeepAlive = false;
-  }
+  if (statusCode === 204 || statusCode === 304)
+    flags |= kNoContent;
 
-  // keep-alive logic
-  if (this._removedHeader.connection) {
-    this._last = true;
-    this.shouldKeepAlive = false;
-  } else if (state.sentConnectionHeader === false) {
-    var shouldSendKeepAlive = this.shouldKeepAlive &&
-        (state.sentContentLengthHeader ||
-         this.useChunkedEncodingByDefault ||
-         this.agent);
-    if (shouldSendKeepAlive) {
-      state.messageHeader += 'Connection: keep-alive\r\n';
-    } else {
-      this._last = true;
-      state.messageHeader += 'Connection: close\r\n';
-    }
+  // Validates the headers and adds Date, Connection, Content-Length and
+  // Transfer-Encoding as needed, see src/node_http_serializer.cc.
+  var contentLength = this._contentLength;
+  if (typeof contentLength !== 'number') {
+    contentLength = -1;
+  } else if (!Number.isSafeInteger(contentLength) || contentLength < 0) {
+    throw new RangeError('Content-Length must be a non-negative safe integer');
   }
+  var header = serializeHeader(list, flags, contentLength, serializerState);
+  var result = serializerState[0];
 
-  if (state.sentContentLengthHeader === false &&
-      state.sentTransferEncodingHeader === false) {
-    if (!this._hasBody) {
-      // Make sure we don't end the 0\r\n\r\n at the end of the message.
-      this.chunkedEncoding = false;
-    } else if (!this.useChunkedEncodingByDefault) {
-      this._last = true;
-    } else {
-      if (!state.sentTrailer &&
-          !this._removedHeader['content-length'] &&
-          typeof this._contentLength === 'number') {
-        state.messageHeader += 'Content-Length: ' + this._contentLength +
-                               '\r\n';
-      } else if (!this._removedHeader['transfer-encoding']) {
-        state.messageHeader += 'Transfer-Encoding: chunked\r\n';
-        this.chunkedEncoding = true;
-      } else {
-        // We should only be able to get here if both Content-Length and
-        // Transfer-Encoding are removed by the user.
-        // See: test/parallel/test-http-remove-header-stays-removed.js
-        debug('Both Content-Length and Transfer-Encoding are removed');
-      }
-    }
+  if (result & kLast)
+    this._last = true;
+  if (result & kUpgrading)
+    this.upgrading = true;
+  if ((flags & kNoContent) && (result & kChunkedEncoding) === 0 &&
+      this.chunkedEncoding === true) {
+    debug(statusCode + ' response should not use chunked encoding,' +
+          ' closing connection.');
   }
+  this.shouldKeepAlive = (result & kShouldKeepAlive) !== 0;
+  this.chunkedEncoding = (result & kChunkedEncoding) !== 0;
 
-  this._header = state.messageHeader + CRLF;
+  this._header = firstLine + header;
   this._headerSent = false;
 
   // wait until the first body chunk, or close(), is sent to flush,
   // UNLESS we're sending Expect: 100-continue.
-  if (state.sentExpect) this._send('');
+  if (result & kSentExpect) this._send('');
 };
 
-function storeHeader(self, state, field, value) {
-  if (!common._checkIsHttpToken(field)) {
-    throw new TypeError(
-      'Header name must be a valid HTTP Token ["' + field + '"]');
-  }
-  if (common._checkInvalidHeaderChar(value) === true) {
-    throw new TypeError('The header content contains invalid characters');
-  }
-  state.messageHeader += field + ': ' + escapeHeaderValue(value) + CRLF;
-
-  if (connectionExpression.test(field)) {
-    state.sentConnectionHeader = true;
-    if (connCloseExpression.test(value)) {
-      self._last = true;
-    } else {
-      self.shouldKeepAlive = true;
-    }
-    if (connUpgradeExpression.test(value))
-      state.sentConnectionUpgrade = true;
-  } else if (transferEncodingExpression.test(field)) {
-    state.sentTransferEncodingHeader = true;
-    if (trfrEncChunkExpression.test(value)) self.chunkedEncoding = true;
-
-  } else if (contentLengthExpression.test(field)) {
-    state.sentContentLengthHeader = true;
-  } else if (dateExpression.test(field)) {
-    state.sentDateHeader = true;
-  } else if (expectExpression.test(field)) {
-    state.sentExpect = true;
-  } else if (trailerExpression.test(field)) {
-    state.sentTrailer = true;
-  } else if (upgradeExpression.test(field)) {
-    state.sentUpgrade = true;
-  }
-}
-
 
 OutgoingMessage.prototype.setHeader = function(name, value) {
   if (!common._checkIsHttpToken(name))
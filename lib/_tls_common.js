@@ -11,6 +11,7 @@ var crypto = null;
 
 const binding = process.binding('crypto');
 const NativeSecureContext = binding.SecureContext;
+const NativeSessionCache = binding.SessionCache;
 
 function SecureContext(secureProtocol, flags, context) {
   if (!(this instanceof SecureContext)) {
@@ -35,6 +36,37 @@ function SecureContext(secureProtocol, flags, context) {
 exports.SecureContext = SecureContext;
 
 
+function SessionCache(options) {
+  if (!(this instanceof SessionCache))
+    return new SessionCache(options);
+
+  if (!options) options = {};
+
+  var maxEntries = options.maxEntries;
+  if (maxEntries === undefined)
+    maxEntries = NativeSessionCache.kDefaultMaxEntries;
+  var timeout = options.timeout;
+  if (timeout === undefined)
+    timeout = NativeSessionCache.kDefaultTimeout;
+
+  this._handle = new NativeSessionCache(maxEntries, timeout);
+}
+
+SessionCache.prototype.getStats = function getStats() {
+  return this._handle.getStats();
+};
+
+SessionCache.prototype.clear = function clear() {
+  this._handle.clear();
+};
+
+exports.SessionCache = SessionCache;
+
+exports.createSessionCache = function createSessionCache(options) {
+  return new SessionCache(options);
+};
+
+
 exports.createSecureContext = function createSecureContext(options, context) {
   if (!options) options = {};
 
@@ -122,6 +154,13 @@ exports.createSecureContext = function createSecureContext(options, context) {
     c.context.setSessionIdContext(options.sessionIdContext);
   }
 
+  if (options.sessionCache) {
+    if (!(options.sessionCache instanceof SessionCache))
+      throw new TypeError('sessionCache must be created by ' +
+                          'tls.createSessionCache()');
+    c.context.setSessionCache(options.sessionCache._handle);
+  }
+
   if (options.pfx) {
     var pfx = options.pfx;
     var passphrase = options.passphrase;
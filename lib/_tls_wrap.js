@@ -17,6 +17,15 @@ const tls_wrap = process.binding('tls_wrap');
 const TCP = process.binding('tcp_wrap').TCP;
 const Pipe = process.binding('pipe_wrap').Pipe;
 
+// Bulk data of at least this many bytes is encrypted and decrypted on the
+// threadpool when the `offload` option is `true`.
+const DEFAULT_OFFLOAD_THRESHOLD = 32 * 1024;
+
+// Session ticket keys: a 16-byte name, a 16-byte HMAC key and a 16-byte AES
+// key. By default rotateTicketKeys() keeps the previous key for decryption.
+const TICKET_KEY_LENGTH = 48;
+const DEFAULT_MAX_TICKET_KEYS = 2;
+
 function onhandshakestart() {
   debug('onhandshakestart');
 
@@ -463,6 +472,14 @@ TLSSocket.prototype._init = function(socket, wrap) {
     ssl.setALPNProtocols(ssl._secureContext.alpnBuffer);
   }
 
+  if (options.offload) {
+    ssl.enableOffload(typeof options.offload === 'number' ?
+                        options.offload : DEFAULT_OFFLOAD_THRESHOLD);
+  }
+
+  if (options.isServer && options.asyncKeyOps)
+    ssl.enableAsyncKeyOps();
+
   if (options.handshakeTimeout > 0)
     this.setTimeout(options.handshakeTimeout, this._handleTimeout);
 
@@ -629,6 +646,14 @@ TLSSocket.prototype.getSession = function() {
   return null;
 };
 
+TLSSocket.prototype.getMemoryUsage = function() {
+  if (this._handle) {
+    return this._handle.getMemoryUsage() || null;
+  }
+
+  return null;
+};
+
 TLSSocket.prototype.isSessionReused = function() {
   if (this._handle) {
     return this._handle.isSessionReused();
@@ -759,7 +784,8 @@ function Server(/* [options], listener */) {
     secureOptions: self.secureOptions,
     honorCipherOrder: self.honorCipherOrder,
     crl: self.crl,
-    sessionIdContext: self.sessionIdContext
+    sessionIdContext: self.sessionIdContext,
+    sessionCache: self.sessionCache
   });
   this._sharedCreds = sharedCreds;
 
@@ -777,6 +803,16 @@ function Server(/* [options], listener */) {
     sharedCreds.context.setTicketKeys(self.ticketKeys);
   }
 
+  if (self.ticketKeyRotation > 0) {
+    this._ticketKeyTimer = setInterval(function() {
+      self.rotateTicketKeys();
+    }, self.ticketKeyRotation);
+    this._ticketKeyTimer.unref();
+    this.once('close', function() {
+      clearInterval(self._ticketKeyTimer);
+    });
+  }
+
   // constructor call
   net.Server.call(this, function(raw_socket) {
     var socket = new TLSSocket(raw_socket, {
@@ -788,7 +824,9 @@ function Server(/* [options], listener */) {
       handshakeTimeout: timeout,
       NPNProtocols: self.NPNProtocols,
       ALPNProtocols: self.ALPNProtocols,
-      SNICallback: options.SNICallback || SNICallback
+      SNICallback: options.SNICallback || SNICallback,
+      offload: self.offload,
+      asyncKeyOps: self.asyncKeyOps
     });
 
     socket.on('secure', function() {
@@ -865,6 +903,19 @@ Server.prototype.setTicketKeys = function setTicketKeys(keys) {
 };
 
 
+Server.prototype.rotateTicketKeys = function rotateTicketKeys(key) {
+  if (key === undefined)
+    key = crypto.randomBytes(TICKET_KEY_LENGTH);
+  if (!(key instanceof Buffer) || key.length !== TICKET_KEY_LENGTH)
+    throw new TypeError('Ticket key must be a 48-byte Buffer');
+
+  const max = this.maxTicketKeys || DEFAULT_MAX_TICKET_KEYS;
+  const keys = this.getTicketKeys();
+  const kept = keys.slice(0, (max - 1) * TICKET_KEY_LENGTH);
+  this.setTicketKeys(Buffer.concat([key, kept]));
+};
+
+
 Server.prototype.setOptions = function(options) {
   if (typeof options.requestCert === 'boolean') {
     this.requestCert = options.requestCert;
@@ -891,6 +942,13 @@ Server.prototype.setOptions = function(options) {
   if (options.dhparam) this.dhparam = options.dhparam;
   if (options.sessionTimeout) this.sessionTimeout = options.sessionTimeout;
   if (options.ticketKeys) this.ticketKeys = options.ticketKeys;
+  if (options.ticketKeyRotation)
+    this.ticketKeyRotation = options.ticketKeyRotation;
+  if (options.maxTicketKeys) this.maxTicketKeys = options.maxTicketKeys;
+  if (options.sessionCache) this.sessionCache = options.sessionCache;
+  if (options.offload !== undefined) this.offload = options.offload;
+  if (options.asyncKeyOps !== undefined)
+    this.asyncKeyOps = !!options.asyncKeyOps;
   var secureOptions = options.secureOptions || 0;
   if (options.honorCipherOrder !== undefined)
     this.honorCipherOrder = !!options.honorCipherOrder;
@@ -1011,7 +1069,8 @@ exports.connect = function(/* [port, host], options, cb */) {
     session: options.session,
     NPNProtocols: NPN.NPNProtocols,
     ALPNProtocols: ALPN.ALPNProtocols,
-    requestOCSP: options.requestOCSP
+    requestOCSP: options.requestOCSP,
+    offload: options.offload
   });
 
   if (cb)
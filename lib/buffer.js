@@ -1365,3 +1365,59 @@ Buffer.prototype.swap64 = function swap64() {
 };
 
 Buffer.prototype.toLocaleString = Buffer.prototype.toString;
+
+
+// Finds all occurrences of a set of patterns in one pass, see
+// src/multi_string_search.h.
+class MultiMatcher {
+  constructor(patterns, encoding) {
+    if (!Array.isArray(patterns) || patterns.length === 0)
+      throw new TypeError('"patterns" argument must be a non-empty array');
+    const buffers = new Array(patterns.length);
+    this._lengths = new Array(patterns.length);
+    for (var i = 0; i < patterns.length; i++) {
+      var pattern = patterns[i];
+      if (typeof pattern === 'string')
+        pattern = Buffer.from(pattern, encoding);
+      else if (!(pattern instanceof Uint8Array))
+        throw new TypeError('Patterns must be strings, Buffers or Uint8Arrays');
+      if (pattern.length === 0)
+        throw new TypeError('Patterns must not be empty');
+      buffers[i] = pattern;
+      this._lengths[i] = pattern.length;
+    }
+    this._handle = new binding.MultiStringSearch(buffers);
+  }
+
+  search(buffer, byteOffset) {
+    if (!(buffer instanceof Uint8Array))
+      throw new TypeError('"buffer" argument must be a Buffer or Uint8Array');
+    byteOffset = +byteOffset || 0;
+    if (byteOffset < 0)
+      byteOffset = Math.max(buffer.length + byteOffset, 0);
+    byteOffset = Math.min(Math.floor(byteOffset), buffer.length);
+    return toMatches(this._handle.search(buffer, byteOffset), this._lengths);
+  }
+
+  write(chunk) {
+    if (!(chunk instanceof Uint8Array))
+      throw new TypeError('"chunk" argument must be a Buffer or Uint8Array');
+    return toMatches(this._handle.write(chunk), this._lengths);
+  }
+
+  reset() {
+    this._handle.reset();
+  }
+}
+
+// The binding returns pattern indices and end offsets, in pairs.
+function toMatches(pairs, lengths) {
+  const matches = new Array(pairs.length >>> 1);
+  for (var i = 0; i < matches.length; i++) {
+    const pattern = pairs[2 * i];
+    matches[i] = { index: pairs[2 * i + 1] - lengths[pattern], pattern };
+  }
+  return matches;
+}
+
+exports.MultiMatcher = MultiMatcher;
@@ -81,6 +81,28 @@ Hash.prototype.digest = function(outputEncoding) {
 };
 
 
+exports.hash = function hash(algorithm, data, outputEncoding) {
+  outputEncoding = outputEncoding || exports.DEFAULT_ENCODING;
+  return binding.hash(algorithm, data, 'utf8', outputEncoding);
+};
+
+
+exports.hashBatch = function hashBatch(algorithm, buffers, callback) {
+  if (!Array.isArray(buffers))
+    throw new TypeError('"buffers" argument must be an array of Buffers');
+  if (callback !== undefined && typeof callback !== 'function')
+    throw new TypeError('"callback" argument must be a function');
+
+  if (callback === undefined)
+    return binding.hashBatch(algorithm, buffers);
+
+  const result = binding.hashBatch(algorithm, buffers, callback);
+  // Small batches are hashed inline
+  if (result instanceof Buffer)
+    process.nextTick(callback, null, result);
+};
+
+
 exports.createHmac = exports.Hmac = Hmac;
 
 function Hmac(hmac, key, options) {
@@ -107,6 +129,19 @@ function getDecoder(decoder, encoding) {
 }
 
 
+// Stream chunks of at least this many bytes are encrypted or decrypted on the
+// threadpool when the `offload` option is `true`.
+const DEFAULT_OFFLOAD_THRESHOLD = 64 * 1024;
+
+function offloadThreshold(options) {
+  if (!options || !options.offload)
+    return Infinity;
+  if (typeof options.offload === 'number')
+    return options.offload;
+  return DEFAULT_OFFLOAD_THRESHOLD;
+}
+
+
 exports.createCipher = exports.Cipher = Cipher;
 function Cipher(cipher, password, options) {
   if (!(this instanceof Cipher))
@@ -115,6 +150,7 @@ function Cipher(cipher, password, options) {
 
   this._handle.init(cipher, toBuf(password));
   this._decoder = null;
+  this._offload = offloadThreshold(options);
 
   LazyTransform.call(this, options);
 }
@@ -122,6 +158,11 @@ function Cipher(cipher, password, options) {
 util.inherits(Cipher, LazyTransform);
 
 Cipher.prototype._transform = function(chunk, encoding, callback) {
+  // The stream hands over one chunk at a time, which keeps them in order
+  if (chunk instanceof Buffer && chunk.length >= this._offload) {
+    this._handle.updateAsync(chunk, callback);
+    return;
+  }
   this.push(this._handle.update(chunk, encoding));
   callback();
 };
@@ -189,6 +230,7 @@ function Cipheriv(cipher, key, iv, options) {
   this._handle = new binding.CipherBase(true);
   this._handle.initiv(cipher, toBuf(key), toBuf(iv));
   this._decoder = null;
+  this._offload = offloadThreshold(options);
 
   LazyTransform.call(this, options);
 }
@@ -212,6 +254,7 @@ function Decipher(cipher, password, options) {
   this._handle = new binding.CipherBase(false);
   this._handle.init(cipher, toBuf(password));
   this._decoder = null;
+  this._offload = offloadThreshold(options);
 
   LazyTransform.call(this, options);
 }
@@ -237,6 +280,7 @@ function Decipheriv(cipher, key, iv, options) {
   this._handle = new binding.CipherBase(false);
   this._handle.initiv(cipher, toBuf(key), toBuf(iv));
   this._decoder = null;
+  this._offload = offloadThreshold(options);
 
   LazyTransform.call(this, options);
 }
@@ -630,6 +674,46 @@ exports.setEngine = function setEngine(id, flags) {
 
 exports.randomBytes = exports.pseudoRandomBytes = randomBytes;
 
+function assertRandomFillArgs(buf, offset, size) {
+  if (!(buf instanceof Uint8Array))
+    throw new TypeError('"buf" argument must be a Buffer or Uint8Array');
+  if (typeof offset !== 'number' || offset < 0 || offset > buf.length ||
+      offset !== (offset >>> 0))
+    throw new RangeError('"offset" is out of range');
+  if (typeof size !== 'number' || size < 0 || size > buf.length - offset ||
+      size !== (size >>> 0))
+    throw new RangeError('"size" is out of range');
+}
+
+exports.randomFillSync = function randomFillSync(buf, offset, size) {
+  if (offset === undefined) offset = 0;
+  if (size === undefined && buf instanceof Uint8Array)
+    size = buf.length - offset;
+  assertRandomFillArgs(buf, offset, size);
+  binding.randomFill(buf, offset, size);
+  return buf;
+};
+
+exports.randomFill = function randomFill(buf, offset, size, callback) {
+  if (typeof offset === 'function') {
+    callback = offset;
+    offset = 0;
+    size = undefined;
+  } else if (typeof size === 'function') {
+    callback = size;
+    size = undefined;
+  }
+  if (typeof callback !== 'function')
+    throw new TypeError('"callback" argument must be a function');
+  if (size === undefined && buf instanceof Uint8Array)
+    size = buf.length - offset;
+  assertRandomFillArgs(buf, offset, size);
+
+  // Served from the pool right away
+  if (binding.randomFill(buf, offset, size, callback))
+    process.nextTick(callback, null, buf);
+};
+
 exports.rng = exports.prng = randomBytes;
 
 exports.getCiphers = internalUtil.cachedResult(() => {
@@ -50,6 +50,7 @@ function newHandle(type) {
     handle.lookup = lookup6;
     handle.bind = handle.bind6;
     handle.send = handle.send6;
+    handle.sendBatch = handle.sendBatch6;
     return handle;
   }
 
@@ -95,6 +96,10 @@ function Socket(type, listener) {
   // If true - UV_UDP_REUSEADDR flag will be set
   this._reuseAddr = options && options.reuseAddr;
 
+  // If true - datagrams are received in batches with recvmmsg() where
+  // the platform supports it
+  this._recvBatch = !!(options && options.recvBatch);
+
   if (typeof listener === 'function')
     this.on('message', listener);
 }
@@ -109,8 +114,9 @@ exports.createSocket = function(type, listener) {
 
 function startListening(socket) {
   socket._handle.onmessage = onMessage;
+  socket._handle.onmessagebatch = onMessageBatch;
   // Todo: handle errors
-  socket._handle.recvStart();
+  socket._handle.recvStart(socket._recvBatch);
   socket._receiving = true;
   socket._bindState = BIND_STATE_BOUND;
   socket.fd = -42; // compatibility hack
@@ -124,6 +130,7 @@ function replaceHandle(self, newHandle) {
   newHandle.lookup = self._handle.lookup;
   newHandle.bind = self._handle.bind;
   newHandle.send = self._handle.send;
+  newHandle.sendBatch = self._handle.sendBatch;
   newHandle.owner = self;
 
   // Replace the existing handle by the handle we got from master.
@@ -399,6 +406,92 @@ function doSend(ex, self, ip, list, address, port, callback) {
   }
 }
 
+// sendBatch(messages, port, address, callback)
+// sendBatch(messages, port, address)
+// sendBatch(messages, port)
+Socket.prototype.sendBatch = function(messages, port, address, callback) {
+  const self = this;
+  let list;
+
+  if (!Array.isArray(messages) || !(list = fixBufferList(messages)))
+    throw new TypeError('Messages must be an array of buffers or strings');
+
+  port = port >>> 0;
+  if (port === 0 || port > 65535)
+    throw new RangeError('Port should be > 0 and < 65536');
+
+  if (typeof address === 'function') {
+    callback = address;
+    address = undefined;
+  }
+
+  if (typeof callback !== 'function')
+    callback = undefined;
+
+  self._healthCheck();
+
+  if (list.length === 0) {
+    if (callback)
+      process.nextTick(callback, null, 0);
+    return;
+  }
+
+  if (self._bindState == BIND_STATE_UNBOUND)
+    self.bind({port: 0, exclusive: true}, null);
+
+  if (self._bindState != BIND_STATE_BOUND) {
+    enqueue(self, self.sendBatch.bind(self, list, port, address, callback));
+    return;
+  }
+
+  self._handle.lookup(address, function afterDns(ex, ip) {
+    doSendBatch(ex, self, ip, list, address, port, callback);
+  });
+};
+
+
+function doSendBatch(ex, self, ip, list, address, port, callback) {
+  if (ex) {
+    if (typeof callback === 'function') {
+      callback(ex);
+      return;
+    }
+
+    self.emit('error', ex);
+    return;
+  } else if (!self._handle) {
+    return;
+  }
+
+  var req = new SendWrap();
+  req.list = list;  // Keep reference alive.
+  req.address = address;
+  req.port = port;
+  if (callback) {
+    req.callback = callback;
+    req.oncomplete = afterSend;
+  }
+  var err = self._handle.sendBatch(req,
+                                   list,
+                                   list.length,
+                                   port,
+                                   ip,
+                                   !!callback);
+  if (err) {
+    if (callback) {
+      // don't emit as error, same as send()
+      const ex = exceptionWithHostPort(err, 'send', address, port);
+      process.nextTick(callback, ex);
+    }
+  } else if (!req.async && callback) {
+    // Every datagram went out synchronously.
+    var sent = 0;
+    for (var i = 0; i < list.length; i++)
+      sent += list[i].length;
+    process.nextTick(callback, null, sent);
+  }
+}
+
 function afterSend(err, sent) {
   if (err) {
     err = exceptionWithHostPort(err, 'send', this.address, this.port);
@@ -548,6 +641,22 @@ function onMessage(nread, handle, buf, rinfo) {
 }
 
 
+function onMessageBatch(handle, slab, lengths, rinfos) {
+  var self = handle.owner;
+  var offset = 0;
+  for (var i = 0; i < lengths.length; i++) {
+    const buf = slab.slice(offset, offset + lengths[i]);
+    const rinfo = rinfos[i];
+    offset += lengths[i];
+    rinfo.size = buf.length; // compatibility
+    self.emit('message', buf, rinfo);
+    // A listener may have closed the socket.
+    if (!self._handle)
+      return;
+  }
+}
+
+
 Socket.prototype.ref = function() {
   if (this._handle)
     this._handle.ref();
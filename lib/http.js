@@ -3,6 +3,8 @@ exports.IncomingMessage = require('_http_incoming').IncomingMessage;
 
 exports.OutgoingMessage = require('_http_outgoing').OutgoingMessage;
 
+exports.MultipartParser = require('_http_multipart').MultipartParser;
+
 exports.METHODS = require('_http_common').methods.slice().sort();
 
 const agent = require('_http_agent');
@@ -8,9 +8,15 @@ const vm = require('vm');
 const assert = require('assert').ok;
 const fs = require('fs');
 const path = require('path');
+const originalReadFileSync = fs.readFileSync;
 const internalModuleReadFile = process.binding('fs').internalModuleReadFile;
 const internalModuleStat = process.binding('fs').internalModuleStat;
+const internalModuleStatCache = process.binding('fs').internalModuleStatCache;
+const internalModuleResolve = process.binding('fs').internalModuleResolve;
 const preserveSymlinks = !!process.binding('config').preserveSymlinks;
+const useCodeCache = !!process.binding('config').usingCodeCache;
+const kCodeCachePrivateSymbolIndex =
+    process.binding('util').code_cache_private_symbol;
 
 // If obj.hasOwnProperty has been overridden, then calling
 // obj.hasOwnProperty(prop) will break.
@@ -20,18 +26,10 @@ function hasOwnProperty(obj, prop) {
 }
 
 
+// Results are cached natively while internalModuleStatCache() is on.
 function stat(filename) {
-  filename = path._makeLong(filename);
-  const cache = stat.cache;
-  if (cache !== null) {
-    const result = cache.get(filename);
-    if (result !== undefined) return result;
-  }
-  const result = internalModuleStat(filename);
-  if (cache !== null) cache.set(filename, result);
-  return result;
+  return internalModuleStat(path._makeLong(filename));
 }
-stat.cache = null;
 
 
 function Module(id, parent) {
@@ -146,16 +144,60 @@ Module._findPath = function(request, paths, isMain) {
     return Module._pathCache[cacheKey];
   }
 
-  var exts;
+  const exts = Object.keys(Module._extensions);
   const trailingSlash = request.length > 0 &&
                         request.charCodeAt(request.length - 1) === 47/*/*/;
 
+  // Let the binding try all candidates at once; it only gives up on the
+  // cases that need a proper exception, like a broken package.json.
+  const basePaths = new Array(paths.length);
+  for (var i = 0; i < paths.length; i++)
+    basePaths[i] = path.resolve(paths[i], request);
+  const result = internalModuleResolve(basePaths, paths, exts, trailingSlash,
+                                       path.resolve);
+  if (result === undefined)
+    return false;
+
+  var filename;
+  if (result === null) {
+    i = findPath(basePaths, paths, exts, trailingSlash, isMain);
+    if (i === -1)
+      return false;
+    filename = findPath.filename;
+  } else {
+    i = result[0];
+    if (preserveSymlinks && !isMain) {
+      filename = path.resolve(result[1]);
+    } else {
+      filename = fs.realpathSync(result[1]);
+    }
+  }
+
+  // Warn once if '.' resolved outside the module dir
+  if (request === '.' && i > 0) {
+    if (!warned) {
+      warned = true;
+      process.emitWarning(
+        'warning: require(\'.\') resolved outside the package ' +
+        'directory. This functionality is deprecated and will be removed ' +
+        'soon.',
+        'DeprecationWarning');
+    }
+  }
+
+  Module._pathCache[cacheKey] = filename;
+  return filename;
+};
+
+// The JS version of internalModuleResolve().  Returns the index of the
+// matching path and stores the filename in findPath.filename, or returns -1.
+function findPath(basePaths, paths, exts, trailingSlash, isMain) {
   // For each path
   for (var i = 0; i < paths.length; i++) {
     // Don't search further if path doesn't exist
     const curPath = paths[i];
     if (curPath && stat(curPath) < 1) continue;
-    var basePath = path.resolve(curPath, request);
+    var basePath = basePaths[i];
     var filename;
 
     if (!trailingSlash) {
@@ -167,51 +209,32 @@ Module._findPath = function(request, paths, isMain) {
           filename = fs.realpathSync(basePath);
         }
       } else if (rc === 1) {  // Directory.
-        if (exts === undefined)
-          exts = Object.keys(Module._extensions);
         filename = tryPackage(basePath, exts, isMain);
       }
 
       if (!filename) {
         // try it with each of the extensions
-        if (exts === undefined)
-          exts = Object.keys(Module._extensions);
         filename = tryExtensions(basePath, exts, isMain);
       }
     }
 
     if (!filename) {
-      if (exts === undefined)
-        exts = Object.keys(Module._extensions);
       filename = tryPackage(basePath, exts, isMain);
     }
 
     if (!filename) {
       // try it with each of the extensions at "index"
-      if (exts === undefined)
-        exts = Object.keys(Module._extensions);
       filename = tryExtensions(path.resolve(basePath, 'index'), exts, isMain);
     }
 
     if (filename) {
-      // Warn once if '.' resolved outside the module dir
-      if (request === '.' && i > 0) {
-        if (!warned) {
-          warned = true;
-          process.emitWarning(
-            'warning: require(\'.\') resolved outside the package ' +
-            'directory. This functionality is deprecated and will be removed ' +
-            'soon.',
-            'DeprecationWarning');
-        }
-      }
-
-      Module._pathCache[cacheKey] = filename;
-      return filename;
+      findPath.filename = filename;
+      return i;
     }
   }
-  return false;
-};
+  return -1;
+}
+findPath.filename = null;
 
 // 'node_modules' character codes reversed
 var nmChars = [ 115, 101, 108, 117, 100, 111, 109, 95, 101, 100, 111, 110 ];
@@ -529,11 +552,15 @@ Module.prototype._compile = function(content, filename) {
   // create wrapper function
   var wrapper = Module.wrap(content);
 
-  var compiledWrapper = vm.runInThisContext(wrapper, {
+  var options = {
     filename: filename,
     lineOffset: 0,
     displayErrors: true
-  });
+  };
+  // Not a vm option, so that only the module loader can use the cache.
+  if (useCodeCache)
+    internalUtil.setHiddenValue(options, kCodeCachePrivateSymbolIndex, true);
+  var compiledWrapper = vm.runInThisContext(wrapper, options);
 
   if (process._debugWaitConnect) {
     if (!resolvedArgv) {
@@ -556,17 +583,25 @@ Module.prototype._compile = function(content, filename) {
   var require = internalModule.makeRequireFunction.call(this);
   var args = [this.exports, require, this, filename, dirname];
   var depth = internalModule.requireDepth;
-  if (depth === 0) stat.cache = new Map();
+  if (depth === 0) internalModuleStatCache(true);
   var result = compiledWrapper.apply(this.exports, args);
-  if (depth === 0) stat.cache = null;
+  if (depth === 0) internalModuleStatCache(false);
   return result;
 };
 
 
 // Native extension for .js
 Module._extensions['.js'] = function(module, filename) {
-  var content = fs.readFileSync(filename, 'utf8');
-  module._compile(internalModule.stripBOM(content), filename);
+  // internalModuleReadFile() strips the BOM and doesn't throw; go through
+  // fs for a proper error when the file can't be read.  Only take the fast
+  // path while fs.readFileSync() is the original one, tools such as mock-fs
+  // replace it to serve sources that aren't on disk.
+  var content;
+  if (fs.readFileSync === originalReadFileSync)
+    content = internalModuleReadFile(path._makeLong(filename));
+  if (content === undefined)
+    content = internalModule.stripBOM(fs.readFileSync(filename, 'utf8'));
+  module._compile(content, filename);
 };
 
 
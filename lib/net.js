@@ -115,6 +115,8 @@ function initSocketHandle(self) {
 
 
 const BYTES_READ = Symbol('bytesRead');
+const SEND_FILE_REQUEST = Symbol('sendFileRequest');
+const SEND_FILE_FALLBACK_CHUNK = 64 * 1024;
 
 
 function Socket(options) {
@@ -716,14 +718,172 @@ Socket.prototype._writeGeneric = function(writev, data, encoding, cb) {
 
 
 Socket.prototype._writev = function(chunks, cb) {
-  this._writeGeneric(true, chunks, '', cb);
+  var i;
+  for (i = 0; i < chunks.length; i++) {
+    if (chunks[i].chunk[SEND_FILE_REQUEST] !== undefined)
+      break;
+  }
+
+  if (i === chunks.length) {
+    this._writeGeneric(true, chunks, '', cb);
+    return;
+  }
+
+  // A sendFile() request splits the batch: flush what was written before
+  // it, hand the file over to the handle, then continue with the rest.
+  const request = chunks[i].chunk[SEND_FILE_REQUEST];
+  const rest = chunks.slice(i + 1);
+  const sendFile = (err) => {
+    if (err) return cb(err);
+    this._sendFile(request, (err) => {
+      if (err) return cb(err);
+      if (rest.length === 0) return cb();
+      this._writev(rest, cb);
+    });
+  };
+
+  if (i === 0)
+    sendFile();
+  else
+    this._writeGeneric(true, chunks.slice(0, i), '', sendFile);
 };
 
 
 Socket.prototype._write = function(data, encoding, cb) {
+  if (data[SEND_FILE_REQUEST] !== undefined) {
+    this._sendFile(data[SEND_FILE_REQUEST], cb);
+    return;
+  }
   this._writeGeneric(false, data, encoding, cb);
 };
 
+
+Socket.prototype.sendFile = function(fd, options, cb) {
+  if (typeof options === 'function') {
+    cb = options;
+    options = {};
+  } else if (options === undefined || options === null) {
+    options = {};
+  }
+
+  if (!Number.isSafeInteger(fd) || fd < 0)
+    throw new TypeError('"fd" must be a non-negative integer');
+
+  const offset = options.offset === undefined ? 0 : options.offset;
+  if (!Number.isSafeInteger(offset) || offset < 0)
+    throw new TypeError('"offset" must be a non-negative integer');
+
+  const length = options.length === undefined ? -1 : options.length;
+  if (!Number.isSafeInteger(length) || length < -1)
+    throw new TypeError('"length" must be a non-negative integer or -1');
+
+  // The request travels through the Writable machinery as an empty chunk so
+  // that it is ordered correctly with respect to the surrounding writes.
+  const marker = Buffer.alloc(0);
+  marker[SEND_FILE_REQUEST] = { fd, offset, length };
+  return stream.Duplex.prototype.write.call(this, marker, cb);
+};
+
+
+Socket.prototype._sendFile = function(request, cb) {
+  if (this.connecting) {
+    this.once('connect', function() {
+      this._sendFile(request, cb);
+    });
+    return;
+  }
+
+  this._unrefTimer();
+
+  if (!this._handle) {
+    this._destroy(new Error('This socket is closed'), cb);
+    return;
+  }
+
+  // Handles that can't splice the file into the socket themselves (TLS, or
+  // platforms without a usable sendfile()) get the data through JS.
+  if (typeof this._handle.sendFile !== 'function') {
+    sendFileFallback(this, request, cb);
+    return;
+  }
+
+  var req = new WriteWrap();
+  req.oncomplete = afterSendFile;
+  req.cb = cb;
+
+  var err = this._handle.sendFile(req,
+                                  request.fd,
+                                  request.offset,
+                                  request.length);
+  // EBUSY: data written to the handle directly is still queued in libuv and
+  // would be overtaken by sendfile(). The fallback queues up behind it.
+  if (err === uv.UV_ENOSYS || err === uv.UV_EBUSY) {
+    sendFileFallback(this, request, cb);
+    return;
+  }
+
+  if (err)
+    this._destroy(errnoException(err, 'sendfile'), cb);
+};
+
+
+function afterSendFile(status, handle, req) {
+  var self = handle.owner;
+  debug('afterSendFile', status);
+
+  if (self.destroyed) {
+    debug('afterSendFile destroyed');
+    return;
+  }
+
+  self._bytesDispatched += req.bytes;
+
+  if (status < 0) {
+    self._destroy(errnoException(status, 'sendfile'), req.cb);
+    return;
+  }
+
+  self._unrefTimer();
+  req.cb.call(self);
+}
+
+
+function sendFileFallback(self, request, cb) {
+  const fs = require('fs');
+  var offset = request.offset;
+  var remaining = request.length;
+
+  function readChunk() {
+    var size = SEND_FILE_FALLBACK_CHUNK;
+    if (remaining >= 0 && remaining < size)
+      size = remaining;
+    if (size === 0)
+      return cb();
+
+    const buffer = Buffer.allocUnsafe(size);
+    fs.read(request.fd, buffer, 0, size, offset, function(err, bytesRead) {
+      if (err)
+        return self._destroy(err, cb);
+      if (bytesRead === 0)
+        return cb();
+
+      offset += bytesRead;
+      if (remaining > 0)
+        remaining -= bytesRead;
+
+      self._writeGeneric(false, buffer.slice(0, bytesRead), 'buffer', onwrite);
+    });
+  }
+
+  function onwrite(err) {
+    if (err)
+      return cb(err);
+    readChunk();
+  }
+
+  readChunk();
+}
+
 function createWriteReq(req, handle, data, encoding) {
   switch (encoding) {
     case 'latin1':
@@ -3,6 +3,8 @@
 const Buffer = require('buffer').Buffer;
 const internalUtil = require('internal/util');
 const isEncoding = Buffer[internalUtil.kIsEncodingSymbol];
+const StringCodec = process.binding('buffer').StringCodec;
+const kEmptyBuffer = Buffer.alloc(0);
 
 // Do not cache `Buffer.isEncoding` when checking encoding names as some
 // modules monkey-patch it to support additional encodings
@@ -32,10 +34,11 @@ function StringDecoder(encoding) {
       nb = 4;
       break;
     case 'base64':
-      this.text = base64Text;
+      // The bytes that don't make up a group of three are held natively.
+      this.codec = new StringCodec('base64');
+      this.write = base64Write;
       this.end = base64End;
-      nb = 3;
-      break;
+      return;
     default:
       this.write = simpleWrite;
       this.end = simpleEnd;
@@ -229,27 +232,20 @@ function utf16End(buf) {
   return r;
 }
 
-function base64Text(buf, i) {
-  const n = (buf.length - i) % 3;
-  if (n === 0)
-    return buf.toString('base64', i);
-  this.lastNeed = 3 - n;
-  this.lastTotal = 3;
-  if (n === 1) {
-    this.lastChar[0] = buf[buf.length - 1];
-  } else {
-    this.lastChar[0] = buf[buf.length - 2];
-    this.lastChar[1] = buf[buf.length - 1];
-  }
-  return buf.toString('base64', i, buf.length - n);
+function base64Write(buf) {
+  if (!(buf instanceof Uint8Array))
+    throw new TypeError('"buf" argument must be a Buffer');
+  if (buf.length === 0)
+    return '';
+  return this.codec.encode(buf, false);
 }
 
-
 function base64End(buf) {
-  const r = (buf && buf.length ? this.write(buf) : '');
-  if (this.lastNeed)
-    return r + this.lastChar.toString('base64', 0, 3 - this.lastNeed);
-  return r;
+  if (!buf)
+    buf = kEmptyBuffer;
+  else if (!(buf instanceof Uint8Array))
+    throw new TypeError('"buf" argument must be a Buffer');
+  return this.codec.encode(buf, true);
 }
 
 // Pass bytes on through for single-byte encodings (e.g. ascii, latin1, hex)
@@ -260,3 +256,29 @@ function simpleWrite(buf) {
 function simpleEnd(buf) {
   return (buf && buf.length ? this.write(buf) : '');
 }
+
+// StringEncoder does the reverse for base64 and hex: it turns a series of
+// strings into buffers without breaking apart the groups of characters that
+// encode bytes together.  The characters that don't make up a group yet are
+// held natively until the next call.
+exports.StringEncoder = StringEncoder;
+function StringEncoder(encoding) {
+  this.encoding = normalizeEncoding(encoding);
+  if (this.encoding !== 'base64' && this.encoding !== 'hex')
+    throw new Error(`Unsupported encoding: ${encoding}`);
+  this.codec = new StringCodec(this.encoding);
+}
+
+StringEncoder.prototype.write = function(str) {
+  if (typeof str !== 'string')
+    throw new TypeError('"str" argument must be a string');
+  return this.codec.decode(str, false);
+};
+
+StringEncoder.prototype.end = function(str) {
+  if (str === undefined)
+    str = '';
+  else if (typeof str !== 'string')
+    throw new TypeError('"str" argument must be a string');
+  return this.codec.decode(str, true);
+};
@@ -1,6 +1,7 @@
 'use strict';
 
 const TimerWrap = process.binding('timer_wrap').Timer;
+const TimerWheel = process.binding('timer_wrap').TimerWheel;
 const L = require('internal/linkedlist');
 const assert = require('assert');
 const util = require('util');
@@ -83,31 +84,71 @@ const TIMEOUT_MAX = 2147483647; // 2^31-1
 // timers within (or creation of a new list).
 // However, these operations combined have shown to be trivial in comparison to
 // other alternative timers architectures.
+//
+// Timers scheduled with `_unrefActive()` are kept elsewhere: mostly they are
+// socket idle timeouts, which are re-armed on every read and write and rarely
+// fire, and of which there can be hundreds of thousands. They are handed to a
+// hierarchical timing wheel in C++ (src/timer_wheel.h) that schedules and
+// cancels them in constant time without touching a libuv timer, and fires the
+// ones that expire together with a single callback.
 
 
-// Object maps containing linked lists of timers, keyed and sorted by their
-// duration in milliseconds.
-//
-// The difference between these two objects is that the former contains timers
-// that will keep the process open if they are the only thing left, while the
-// latter will not.
+// Object map containing linked lists of timers, keyed and sorted by their
+// duration in milliseconds. These timers keep the process open if they are the
+// only thing left.
 //
 // - key = time in milliseconds
 // - value = linked list
 const refedLists = {};
-const unrefedLists = {};
+
+
+// The timers in the wheel, which does not keep the process open.
+//
+// - key = wheel id, `timer._wheelId`
+// - value = timer
+const wheelTimers = [];
+const wheelFreeIds = [];
+// The ids of the timers that expired, written by the wheel before it calls
+// wheelOnTimeout() with their count.
+const wheelExpired = new Uint32Array(1024);
+var wheel = null;
+
+// `timer._wheelId` of timers that expired but whose callback has not run yet.
+const kExpiring = -2;
 
 
 // Schedule or re-schedule a timer.
 // The item must have been enroll()'d first.
 const active = exports.active = function(item) {
-  insert(item, false);
+  insert(item);
 };
 
 // Internal APIs that need timeouts should use `_unrefActive()` instead of
 // `active()` so that they do not unnecessarily keep the process open.
 exports._unrefActive = function(item) {
-  insert(item, true);
+  const msecs = item._idleTimeout;
+  if (msecs < 0 || msecs === undefined) return;
+
+  // Take the timer off its list if `active()` put it on one.
+  if (item._idleNext !== item) {
+    L.remove(item);
+    L.init(item);
+  }
+
+  if (wheel === null) {
+    wheel = new TimerWheel(wheelExpired);
+    wheel.unref();
+    wheel[kOnTimeout] = wheelOnTimeout;
+  }
+
+  var id = item._wheelId;
+  if (id === undefined || id < 0) {
+    id = wheelFreeIds.length > 0 ? wheelFreeIds.pop() : wheelTimers.length;
+    wheelTimers[id] = item;
+    item._wheelId = id;
+  }
+
+  item._idleStart = wheel.start(id, msecs);
 };
 
 
@@ -116,28 +157,27 @@ exports._unrefActive = function(item) {
 // Appends a timer onto the end of an existing timers list, or creates a new
 // TimerWrap backed list if one does not already exist for the specified timeout
 // duration.
-function insert(item, unrefed) {
+function insert(item) {
   const msecs = item._idleTimeout;
   if (msecs < 0 || msecs === undefined) return;
 
-  item._idleStart = TimerWrap.now();
+  if (item._wheelId !== undefined) wheelRemove(item);
 
-  const lists = unrefed === true ? unrefedLists : refedLists;
+  item._idleStart = TimerWrap.now();
 
   // Use an existing list if there is one, otherwise we need to make a new one.
-  var list = lists[msecs];
+  var list = refedLists[msecs];
   if (!list) {
     debug('no %d list was found in insert, creating a new one', msecs);
     // Make a new linked list of timers, and create a TimerWrap to schedule
     // processing for the list.
-    list = new TimersList(msecs, unrefed);
+    list = new TimersList(msecs);
     L.init(list);
     list._timer._list = list;
 
-    if (unrefed === true) list._timer.unref();
     list._timer.start(msecs);
 
-    lists[msecs] = list;
+    refedLists[msecs] = list;
     list._timer[kOnTimeout] = listOnTimeout;
   }
 
@@ -145,11 +185,10 @@ function insert(item, unrefed) {
   assert(!L.isEmpty(list)); // list is not empty
 }
 
-function TimersList(msecs, unrefed) {
+function TimersList(msecs) {
   this._idleNext = null; // Create the list with the linkedlist properties to
   this._idlePrev = null; // prevent any unnecessary hidden class changes.
   this._timer = new TimerWrap();
-  this._unrefed = unrefed;
   this.msecs = msecs;
 }
 
@@ -212,17 +251,94 @@ function listOnTimeout() {
   assert(L.isEmpty(list));
   this.close();
 
-  // Either refedLists[msecs] or unrefedLists[msecs] may have been removed and
-  // recreated since the reference to `list` was created. Make sure they're
-  // the same instance of the list before destroying.
-  if (list._unrefed === true && list === unrefedLists[msecs]) {
-    delete unrefedLists[msecs];
-  } else if (list === refedLists[msecs]) {
+  // refedLists[msecs] may have been removed and recreated since the reference
+  // to `list` was created. Make sure they're the same instance of the list
+  // before destroying.
+  if (list === refedLists[msecs]) {
     delete refedLists[msecs];
   }
 }
 
 
+// Called by the wheel with the number of timers that expired, the ids of which
+// are in `wheelExpired`. They are taken out of the wheel before any callback
+// runs, as the callbacks may schedule or cancel any of them.
+function wheelOnTimeout(count) {
+  debug('wheel timeout, %d expired', count);
+
+  const timers = new Array(count);
+  for (var i = 0; i < count; i++) {
+    const id = wheelExpired[i];
+    const timer = wheelTimers[id];
+    wheelTimers[id] = undefined;
+    wheelFreeIds.push(id);
+    timer._wheelId = kExpiring;
+    timers[i] = timer;
+  }
+
+  wheelRunExpired(timers, 0);
+}
+
+
+function wheelRunExpired(timers, start) {
+  for (var i = start; i < timers.length; i++) {
+    const timer = timers[i];
+
+    // Skip the timers that an earlier callback cancelled or re-armed.
+    if (timer._wheelId !== kExpiring) continue;
+    timer._wheelId = -1;
+    L.remove(timer);
+
+    if (!timer._onTimeout) continue;
+
+    var domain = timer.domain;
+    if (domain) {
+      // See listOnTimeout().
+      if (domain._disposed)
+        continue;
+
+      domain.enter();
+    }
+
+    tryOnWheelTimeout(timers, i);
+
+    if (domain)
+      domain.exit();
+  }
+}
+
+
+// Like tryOnTimeout(), the rest of the batch runs in nextTick if the callback
+// throws.
+function tryOnWheelTimeout(timers, i) {
+  const timer = timers[i];
+  timer._called = true;
+  var threw = true;
+  try {
+    timer._onTimeout();
+    threw = false;
+  } finally {
+    if (threw) {
+      const domain = process.domain;
+      process.domain = null;
+      process.nextTick(wheelRunExpired, timers, i + 1);
+      process.domain = domain;
+    }
+  }
+}
+
+
+function wheelRemove(item) {
+  const id = item._wheelId;
+  if (id >= 0) {
+    wheel.stop(id);
+    wheelTimers[id] = undefined;
+    wheelFreeIds.push(id);
+  }
+  item._wheelId = -1;
+}
+
+
 // An optimization so that the try/finally only de-optimizes (since at least v8
 // 4.7) what is in this smaller function.
 function tryOnTimeout(timer, list) {
@@ -258,6 +374,7 @@ function listOnTimeoutNT(list) {
 // Re-using an existing handle allows us to skip that, so that a second `uv_run`
 // will return no active handles, even when running `setTimeout(fn).unref()`.
 function reuse(item) {
+  if (item._wheelId !== undefined) wheelRemove(item);
   L.remove(item);
 
   var list = refedLists[item._idleTimeout];
@@ -228,6 +228,7 @@ exports.parseCertString = function parseCertString(s) {
 // Public API
 exports.createSecureContext = require('_tls_common').createSecureContext;
 exports.SecureContext = require('_tls_common').SecureContext;
+exports.createSessionCache = require('_tls_common').createSessionCache;
 exports.TLSSocket = require('_tls_wrap').TLSSocket;
 exports.Server = require('_tls_wrap').Server;
 exports.createServer = require('_tls_wrap').createServer;
@@ -15,6 +15,7 @@
 'use strict';
 
 const v8binding = process.binding('v8');
+const codeCacheBinding = process.binding('code_cache');
 
 // Properties for heap statistics buffer extraction.
 const heapStatisticsBuffer =
@@ -55,6 +56,10 @@ exports.getHeapStatistics = function() {
 
 exports.setFlagsFromString = v8binding.setFlagsFromString;
 
+exports.getCodeCacheStatistics = function() {
+  return codeCacheBinding.getStatistics();
+};
+
 exports.getHeapSpaceStatistics = function() {
   const heapSpaceStatistics = new Array(kNumberOfHeapSpaces);
   const buffer = heapSpaceStatisticsBuffer;
@@ -4,6 +4,7 @@ const Buffer = require('buffer').Buffer;
 const Transform = require('_stream_transform');
 const binding = process.binding('zlib');
 const util = require('util');
+const os = require('os');
 const assert = require('assert').ok;
 const kMaxLength = require('buffer').kMaxLength;
 const kRangeErrorMessage = 'Cannot create final Buffer. It would be larger ' +
@@ -57,6 +58,7 @@ exports.Gunzip = Gunzip;
 exports.DeflateRaw = DeflateRaw;
 exports.InflateRaw = InflateRaw;
 exports.Unzip = Unzip;
+exports.ParallelGzip = ParallelGzip;
 
 exports.createDeflate = function(o) {
   return new Deflate(o);
@@ -86,6 +88,10 @@ exports.createUnzip = function(o) {
   return new Unzip(o);
 };
 
+exports.createParallelGzip = function(o) {
+  return new ParallelGzip(o);
+};
+
 
 // Convenience methods.
 // compress/decompress a string or buffer in one step.
@@ -98,7 +104,7 @@ exports.deflate = function(buffer, opts, callback) {
 };
 
 exports.deflateSync = function(buffer, opts) {
-  return zlibBufferSync(new Deflate(opts), buffer);
+  return zlibBufferSync(constants.DEFLATE, buffer, opts);
 };
 
 exports.gzip = function(buffer, opts, callback) {
@@ -110,7 +116,7 @@ exports.gzip = function(buffer, opts, callback) {
 };
 
 exports.gzipSync = function(buffer, opts) {
-  return zlibBufferSync(new Gzip(opts), buffer);
+  return zlibBufferSync(constants.GZIP, buffer, opts);
 };
 
 exports.deflateRaw = function(buffer, opts, callback) {
@@ -122,7 +128,7 @@ exports.deflateRaw = function(buffer, opts, callback) {
 };
 
 exports.deflateRawSync = function(buffer, opts) {
-  return zlibBufferSync(new DeflateRaw(opts), buffer);
+  return zlibBufferSync(constants.DEFLATERAW, buffer, opts);
 };
 
 exports.unzip = function(buffer, opts, callback) {
@@ -134,7 +140,7 @@ exports.unzip = function(buffer, opts, callback) {
 };
 
 exports.unzipSync = function(buffer, opts) {
-  return zlibBufferSync(new Unzip(opts), buffer);
+  return zlibBufferSync(constants.UNZIP, buffer, opts);
 };
 
 exports.inflate = function(buffer, opts, callback) {
@@ -146,7 +152,7 @@ exports.inflate = function(buffer, opts, callback) {
 };
 
 exports.inflateSync = function(buffer, opts) {
-  return zlibBufferSync(new Inflate(opts), buffer);
+  return zlibBufferSync(constants.INFLATE, buffer, opts);
 };
 
 exports.gunzip = function(buffer, opts, callback) {
@@ -158,7 +164,7 @@ exports.gunzip = function(buffer, opts, callback) {
 };
 
 exports.gunzipSync = function(buffer, opts) {
-  return zlibBufferSync(new Gunzip(opts), buffer);
+  return zlibBufferSync(constants.GUNZIP, buffer, opts);
 };
 
 exports.inflateRaw = function(buffer, opts, callback) {
@@ -170,7 +176,7 @@ exports.inflateRaw = function(buffer, opts, callback) {
 };
 
 exports.inflateRawSync = function(buffer, opts) {
-  return zlibBufferSync(new InflateRaw(opts), buffer);
+  return zlibBufferSync(constants.INFLATERAW, buffer, opts);
 };
 
 function zlibBuffer(engine, buffer, callback) {
@@ -214,15 +220,43 @@ function zlibBuffer(engine, buffer, callback) {
   }
 }
 
-function zlibBufferSync(engine, buffer) {
+// The whole buffer goes through zlib in a single call into the binding,
+// with a pooled stream instead of a Zlib instance of its own.
+function zlibBufferSync(mode, buffer, opts) {
   if (typeof buffer === 'string')
     buffer = Buffer.from(buffer);
   if (!(buffer instanceof Buffer))
     throw new TypeError('Not a string or buffer');
 
-  var flushFlag = engine._finishFlushFlag;
+  opts = opts || {};
+  checkOptions(opts);
+
+  var flushFlag = typeof opts.finishFlush !== 'undefined' ?
+    opts.finishFlush : constants.Z_FINISH;
+
+  var level = constants.Z_DEFAULT_COMPRESSION;
+  if (typeof opts.level === 'number') level = opts.level;
+
+  var strategy = constants.Z_DEFAULT_STRATEGY;
+  if (typeof opts.strategy === 'number') strategy = opts.strategy;
+
+  var windowBits = opts.windowBits || constants.Z_DEFAULT_WINDOWBITS;
+  var memLevel = opts.memLevel || constants.Z_DEFAULT_MEMLEVEL;
+
+  var result = binding.zlibSync(mode, buffer, flushFlag, windowBits, level,
+                                memLevel, strategy, opts.dictionary);
 
-  return engine._processChunk(buffer, flushFlag);
+  if (result === null)
+    throw new RangeError(kRangeErrorMessage);
+
+  if (Array.isArray(result)) {
+    var error = new Error(result[0]);
+    error.errno = result[1];
+    error.code = exports.codes[result[1]];
+    throw error;
+  }
+
+  return result;
 }
 
 // generic zlib
@@ -268,6 +302,242 @@ function Unzip(opts) {
   Zlib.call(this, opts, constants.UNZIP);
 }
 
+// parallel gzip, pigz style - the input is cut into blocks of a fixed size
+// that are compressed concurrently on the threadpool, each one primed with
+// the last 32 KiB of the block before it, and stitched together into a single
+// gzip member. The output only depends on the options, not on how the input
+// was written or on the order the blocks completed in.
+const PARALLEL_GZIP_WINDOW = 32 * 1024;
+const PARALLEL_GZIP_MAX_BLOCK = 64 * 1024 * 1024;
+
+function ParallelGzip(opts) {
+  if (!(this instanceof ParallelGzip)) return new ParallelGzip(opts);
+  opts = opts || {};
+
+  var blockSize = 128 * 1024;
+  if (opts.blockSize !== undefined) {
+    blockSize = opts.blockSize;
+    if (typeof blockSize !== 'number' || blockSize % 1 !== 0 ||
+        blockSize < PARALLEL_GZIP_WINDOW ||
+        blockSize > PARALLEL_GZIP_MAX_BLOCK) {
+      throw new RangeError('Invalid block size: ' + opts.blockSize);
+    }
+  }
+
+  var parallel = os.cpus().length || 1;
+  if (opts.parallel !== undefined) {
+    parallel = opts.parallel;
+    if (typeof parallel !== 'number' || parallel % 1 !== 0 || parallel < 1)
+      throw new RangeError('Invalid parallel: ' + opts.parallel);
+  }
+
+  if (opts.level) {
+    if (opts.level < constants.Z_MIN_LEVEL ||
+        opts.level > constants.Z_MAX_LEVEL) {
+      throw new Error('Invalid compression level: ' + opts.level);
+    }
+  }
+
+  if (opts.memLevel) {
+    if (opts.memLevel < constants.Z_MIN_MEMLEVEL ||
+        opts.memLevel > constants.Z_MAX_MEMLEVEL) {
+      throw new Error('Invalid memLevel: ' + opts.memLevel);
+    }
+  }
+
+  if (opts.strategy) {
+    if (opts.strategy != constants.Z_FILTERED &&
+        opts.strategy != constants.Z_HUFFMAN_ONLY &&
+        opts.strategy != constants.Z_RLE &&
+        opts.strategy != constants.Z_FIXED &&
+        opts.strategy != constants.Z_DEFAULT_STRATEGY) {
+      throw new Error('Invalid strategy: ' + opts.strategy);
+    }
+  }
+
+  Transform.call(this, opts);
+
+  this._level = constants.Z_DEFAULT_COMPRESSION;
+  if (typeof opts.level === 'number') this._level = opts.level;
+  this._memLevel = opts.memLevel || constants.Z_DEFAULT_MEMLEVEL;
+  this._strategy = constants.Z_DEFAULT_STRATEGY;
+  if (typeof opts.strategy === 'number') this._strategy = opts.strategy;
+
+  this._blockSize = blockSize;
+  this._parallel = parallel;
+  this._block = null;
+  this._blockLength = 0;
+  this._chunk = null;  // the input that is being cut into blocks
+  this._chunkOffset = 0;
+  this._chunkBlocks = 0;  // blocks in flight that are slices of the chunk
+  this._blockShared = false;
+  this._dictionary = null;
+  this._dictionaryShared = false;
+  this._blocks = [];  // compressed or in flight, in stream order
+  this._inFlight = 0;
+  this._crc = 0;
+  this._size = 0;
+  this._waiting = null;
+  this._flushCallback = null;
+  this._hadError = false;
+
+  this.push(gzipHeader(this._level, this._strategy));
+
+  this.once('end', this.close);
+}
+
+function gzipHeader(level, strategy) {
+  // No name, no mtime and an unknown OS, so that the output is reproducible.
+  // The extra flags follow zlib.
+  var xfl = 0;
+  if (level === 9)
+    xfl = 2;
+  else if (strategy >= constants.Z_HUFFMAN_ONLY || (level >= 0 && level < 2))
+    xfl = 4;
+  return Buffer.from([0x1f, 0x8b, 8, 0, 0, 0, 0, 0, xfl, 0xff]);
+}
+
+ParallelGzip.prototype._transform = function(chunk, encoding, cb) {
+  if (!(chunk instanceof Buffer))
+    return cb(new Error('invalid input'));
+  if (this._hadError)
+    return cb(new Error('zlib binding closed'));
+
+  this._chunk = chunk;
+  this._chunkOffset = 0;
+  this._waiting = cb;
+  this._consume();
+};
+
+// Cuts the current chunk into blocks and compresses the full ones, as long as
+// fewer than `parallel` blocks are in flight. The rest of the chunk waits for
+// blocks to complete. Whole blocks are slices of the chunk; only the pieces
+// that don't fill a block are copied. The writer may reuse the chunk once the
+// transform callback runs, so that waits until the threadpool is done with
+// every slice, and a dictionary that still points into the chunk is copied.
+ParallelGzip.prototype._consume = function() {
+  var chunk = this._chunk;
+  while (this._chunkOffset < chunk.length && this._inFlight < this._parallel) {
+    var offset = this._chunkOffset;
+    var n;
+    if (this._blockLength === 0 &&
+        chunk.length - offset >= this._blockSize) {
+      n = this._blockSize;
+      this._block = chunk.slice(offset, offset + n);
+      this._blockShared = true;
+    } else {
+      if (this._block === null)
+        this._block = Buffer.allocUnsafe(this._blockSize);
+      n = chunk.copy(this._block, this._blockLength, offset);
+    }
+    this._blockLength += n;
+    this._chunkOffset += n;
+    if (this._blockLength === this._blockSize)
+      this._compressBlock(false);
+  }
+
+  if (this._chunkOffset === chunk.length && this._chunkBlocks === 0) {
+    if (this._dictionaryShared) {
+      this._dictionary = Buffer.from(this._dictionary);
+      this._dictionaryShared = false;
+    }
+    var cb = this._waiting;
+    this._chunk = null;
+    this._waiting = null;
+    cb();
+  }
+};
+
+ParallelGzip.prototype._flush = function(callback) {
+  if (this._hadError)
+    return callback(new Error('zlib binding closed'));
+  this._flushCallback = callback;
+  // The last block is there even if empty, to terminate the deflate stream
+  this._compressBlock(true);
+};
+
+ParallelGzip.prototype._compressBlock = function(last) {
+  var input = this._block === null ?
+      Buffer.alloc(0) : this._block.slice(0, this._blockLength);
+  var shared = this._blockShared;
+  var block = { input: input, output: null, crc: 0, done: false };
+  var self = this;
+
+  this._blocks.push(block);
+  this._inFlight++;
+  if (shared)
+    this._chunkBlocks++;
+  binding.deflateBlock(input,
+                       this._dictionary,
+                       last,
+                       this._level,
+                       this._memLevel,
+                       this._strategy,
+                       function(errno, output, crc) {
+                         self._inFlight--;
+                         if (shared)
+                           self._chunkBlocks--;
+                         if (errno !== null)
+                           return self._onBlockError(errno);
+                         block.output = output;
+                         block.crc = crc;
+                         block.done = true;
+                         self._drainBlocks();
+                       });
+
+  // All blocks but the last are full, and at least as large as the window
+  this._dictionary = last ? null :
+      input.slice(input.length - PARALLEL_GZIP_WINDOW);
+  this._dictionaryShared = shared && !last;
+  this._block = null;
+  this._blockLength = 0;
+  this._blockShared = false;
+};
+
+ParallelGzip.prototype._drainBlocks = function() {
+  if (this._hadError)
+    return;
+
+  while (this._blocks.length > 0 && this._blocks[0].done) {
+    var block = this._blocks.shift();
+    this._crc = binding.crc32Combine(this._crc, block.crc,
+                                     block.input.length);
+    this._size += block.input.length;
+    this.push(block.output);
+  }
+
+  if (this._chunk !== null && this._inFlight < this._parallel)
+    this._consume();
+
+  if (this._flushCallback !== null && this._blocks.length === 0) {
+    var trailer = Buffer.allocUnsafe(8);
+    trailer.writeUInt32LE(this._crc, 0);
+    trailer.writeUInt32LE(this._size % 0x100000000, 4);
+    this.push(trailer);
+    var callback = this._flushCallback;
+    this._flushCallback = null;
+    callback();
+  }
+};
+
+ParallelGzip.prototype._onBlockError = function(errno) {
+  if (this._hadError)
+    return;
+  this._hadError = true;
+  this._blocks = [];
+
+  var error = new Error('Zlib error');
+  error.errno = errno;
+  error.code = exports.codes[errno];
+  this.emit('error', error);
+};
+
+ParallelGzip.prototype.close = function(callback) {
+  if (callback)
+    process.nextTick(callback);
+  process.nextTick(emitCloseNT, this);
+};
+
 function isValidFlushFlag(flag) {
   return flag === constants.Z_NO_FLUSH ||
          flag === constants.Z_PARTIAL_FLUSH ||
@@ -277,17 +547,7 @@ function isValidFlushFlag(flag) {
          flag === constants.Z_BLOCK;
 }
 
-// the Zlib class they all inherit from
-// This thing manages the queue of requests, and returns
-// true or false if there is anything in the queue when
-// you call the .write() method.
-
-function Zlib(opts, mode) {
-  this._opts = opts = opts || {};
-  this._chunkSize = opts.chunkSize || constants.Z_DEFAULT_CHUNK;
-
-  Transform.call(this, opts);
-
+function checkOptions(opts) {
   if (opts.flush && !isValidFlushFlag(opts.flush)) {
     throw new Error('Invalid flush flag: ' + opts.flush);
   }
@@ -295,10 +555,6 @@ function Zlib(opts, mode) {
     throw new Error('Invalid flush flag: ' + opts.finishFlush);
   }
 
-  this._flushFlag = opts.flush || constants.Z_NO_FLUSH;
-  this._finishFlushFlag = typeof opts.finishFlush !== 'undefined' ?
-    opts.finishFlush : constants.Z_FINISH;
-
   if (opts.chunkSize) {
     if (opts.chunkSize < constants.Z_MIN_CHUNK ||
         opts.chunkSize > constants.Z_MAX_CHUNK) {
@@ -342,6 +598,24 @@ function Zlib(opts, mode) {
       throw new Error('Invalid dictionary: it should be a Buffer instance');
     }
   }
+}
+
+// the Zlib class they all inherit from
+// This thing manages the queue of requests, and returns
+// true or false if there is anything in the queue when
+// you call the .write() method.
+
+function Zlib(opts, mode) {
+  this._opts = opts = opts || {};
+  this._chunkSize = opts.chunkSize || constants.Z_DEFAULT_CHUNK;
+
+  Transform.call(this, opts);
+
+  checkOptions(opts);
+
+  this._flushFlag = opts.flush || constants.Z_NO_FLUSH;
+  this._finishFlushFlag = typeof opts.finishFlush !== 'undefined' ?
+    opts.finishFlush : constants.Z_FINISH;
 
   this._handle = new binding.Zlib(mode);
 
@@ -633,3 +907,4 @@ util.inherits(Gunzip, Zlib);
 util.inherits(DeflateRaw, Zlib);
 util.inherits(InflateRaw, Zlib);
 util.inherits(Unzip, Zlib);
+util.inherits(ParallelGzip, Transform);
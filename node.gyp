@@ -43,6 +43,7 @@
       'lib/_http_client.js',
       'lib/_http_common.js',
       'lib/_http_incoming.js',
+      'lib/_http_multipart.js',
       'lib/_http_outgoing.js',
       'lib/_http_server.js',
       'lib/https.js',
@@ -148,16 +149,21 @@
         'src/connection_wrap.cc',
         'src/connect_wrap.cc',
         'src/handle_wrap.cc',
+        'src/http_header_cache.cc',
         'src/js_stream.cc',
+        'src/multi_string_search.cc',
         'src/node.cc',
         'src/node_buffer.cc',
+        'src/node_code_cache.cc',
         'src/node_config.cc',
         'src/node_constants.cc',
         'src/node_contextify.cc',
         'src/node_file.cc',
         'src/node_http_parser.cc',
+        'src/node_http_serializer.cc',
         'src/node_javascript.cc',
         'src/node_main.cc',
+        'src/node_multipart_parser.cc',
         'src/node_os.cc',
         'src/node_revert.cc',
         'src/node_util.cc',
@@ -168,16 +174,20 @@
         'src/node_i18n.cc',
         'src/pipe_wrap.cc',
         'src/signal_wrap.cc',
+        'src/slab_allocator.cc',
         'src/spawn_sync.cc',
         'src/string_bytes.cc',
+        'src/string_simd.cc',
         'src/stream_base.cc',
         'src/stream_wrap.cc',
         'src/tcp_wrap.cc',
+        'src/timer_wheel.cc',
         'src/timer_wrap.cc',
         'src/tty_wrap.cc',
         'src/process_wrap.cc',
         'src/udp_wrap.cc',
         'src/uv.cc',
+        'src/zlib_stream_pool.cc',
         # headers to make for a more pleasant IDE experience
         'src/async-wrap.h',
         'src/async-wrap-inl.h',
@@ -189,9 +199,12 @@
         'src/env.h',
         'src/env-inl.h',
         'src/handle_wrap.h',
+        'src/http_header_cache.h',
         'src/js_stream.h',
+        'src/multi_string_search.h',
         'src/node.h',
         'src/node_buffer.h',
+        'src/node_code_cache.h',
         'src/node_constants.h',
         'src/node_file.h',
         'src/node_http_parser.h',
@@ -210,14 +223,18 @@
         'src/udp_wrap.h',
         'src/req-wrap.h',
         'src/req-wrap-inl.h',
+        'src/slab_allocator.h',
         'src/string_bytes.h',
+        'src/string_simd.h',
         'src/stream_base.h',
         'src/stream_base-inl.h',
         'src/stream_wrap.h',
+        'src/timer_wheel.h',
         'src/tree.h',
         'src/util.h',
         'src/util-inl.h',
         'src/util.cc',
+        'src/zlib_stream_pool.h',
         'src/string_search.cc',
         'deps/http_parser/http_parser.h',
         'deps/v8/include/v8.h',
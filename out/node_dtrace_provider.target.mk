@@ -0,0 +1,18 @@
+# This file is generated by gyp; do not edit.
+
+TOOLSET := target
+TARGET := node_dtrace_provider
+### Rules for final target.
+$(obj).target/node_dtrace_provider.stamp: TOOLSET := $(TOOLSET)
+$(obj).target/node_dtrace_provider.stamp:  FORCE_DO_CMD
+	$(call do_cmd,touch)
+
+all_deps += $(obj).target/node_dtrace_provider.stamp
+# Add target alias
+.PHONY: node_dtrace_provider
+node_dtrace_provider: $(obj).target/node_dtrace_provider.stamp
+
+# Add target alias to "all" target.
+.PHONY: all
+all: node_dtrace_provider
+
@@ -3,6 +3,7 @@
 
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
+#include "string_simd.h"
 #include "util.h"
 
 #include <stddef.h>
@@ -85,31 +86,103 @@ size_t base64_decode_slow(char* dst, size_t dstlen,
 }
 
 
+// Decodes the next group of four characters the way base64_decode_slow()
+// does, skipping whitespace and other illegal characters in between.  Leaves
+// everything alone and returns false at padding, at the end of the input or
+// if there is no room for the group.
 template <typename TypeName>
-size_t base64_decode_fast(char* const dst, const size_t dstlen,
-                          const TypeName* const src, const size_t srclen,
-                          const size_t decoded_size) {
-  const size_t available = dstlen < decoded_size ? dstlen : decoded_size;
-  const size_t max_i = srclen / 4 * 4;
-  const size_t max_k = available / 3 * 3;
+bool base64_decode_group_slow(char* const dst, const size_t dstlen,
+                              const TypeName* const src, const size_t srclen,
+                              size_t* const i, size_t* const k) {
+  if (*k + 3 > dstlen)
+    return false;
+  uint8_t v[4];
+  size_t n = 0;
+  size_t j = *i;
+  while (n < 4) {
+    if (j >= srclen)
+      return false;
+    const uint8_t c = src[j];
+    const uint8_t lo = unbase64(c);
+    j += 1;
+    if (lo < 64)
+      v[n++] = lo;
+    else if (c == '=')
+      return false;
+  }
+  dst[*k + 0] = (v[0] << 2) | (v[1] >> 4);
+  dst[*k + 1] = (v[1] << 4) | (v[2] >> 2);
+  dst[*k + 2] = (v[2] << 6) | (v[3] >> 0);
+  *i = j;
+  *k += 3;
+  return true;
+}
+
+
+// The vector decoder only takes one-byte strings.
+template <typename TypeName>
+size_t base64_decode_blocks(char* const dst, const size_t dstlen,
+                            const TypeName* const src, const size_t srclen) {
+  return 0;
+}
+
+
+inline size_t base64_decode_blocks(char* const dst, const size_t dstlen,
+                                   const char* const src,
+                                   const size_t srclen) {
+  return simd::Base64DecodeBlocks(src, srclen, dst, dstlen);
+}
+
+
+// Decodes whole groups of four characters from the start of |src| and returns
+// the number of bytes written.  *consumed is set to the number of characters
+// used; decoding stops at padding, before an incomplete group at the end of
+// the input, and when |dstlen| is reached.
+template <typename TypeName>
+size_t base64_decode_groups(char* const dst, const size_t dstlen,
+                            const TypeName* const src, const size_t srclen,
+                            size_t* const consumed) {
+  const size_t max_k = dstlen / 3 * 3;
   size_t i = 0;
   size_t k = 0;
-  while (i < max_i && k < max_k) {
-    const uint32_t v =
-        unbase64(src[i + 0]) << 24 |
-        unbase64(src[i + 1]) << 16 |
-        unbase64(src[i + 2]) << 8 |
-        unbase64(src[i + 3]);
-    // If MSB is set, input contains whitespace or is not valid base64.
-    if (v & 0x80808080) {
-      break;
+  for (;;) {
+    const size_t n = base64_decode_blocks(dst + k, max_k - k,
+                                          src + i, srclen - i);
+    i += n / 3 * 4;
+    k += n;
+    while (i + 4 <= srclen && k < max_k) {
+      const uint32_t v =
+          unbase64(src[i + 0]) << 24 |
+          unbase64(src[i + 1]) << 16 |
+          unbase64(src[i + 2]) << 8 |
+          unbase64(src[i + 3]);
+      // If MSB is set, input contains whitespace or is not valid base64.
+      if (v & 0x80808080) {
+        break;
+      }
+      dst[k + 0] = ((v >> 22) & 0xFC) | ((v >> 20) & 0x03);
+      dst[k + 1] = ((v >> 12) & 0xF0) | ((v >> 10) & 0x0F);
+      dst[k + 2] = ((v >>  2) & 0xC0) | ((v >>  0) & 0x3F);
+      i += 4;
+      k += 3;
     }
-    dst[k + 0] = ((v >> 22) & 0xFC) | ((v >> 20) & 0x03);
-    dst[k + 1] = ((v >> 12) & 0xF0) | ((v >> 10) & 0x0F);
-    dst[k + 2] = ((v >>  2) & 0xC0) | ((v >>  0) & 0x3F);
-    i += 4;
-    k += 3;
+    // Step over the whitespace, line breaks in MIME bodies for example, and
+    // go back to the fast loops after it.
+    if (!base64_decode_group_slow(dst, max_k, src, srclen, &i, &k))
+      break;
   }
+  *consumed = i;
+  return k;
+}
+
+
+template <typename TypeName>
+size_t base64_decode_fast(char* const dst, const size_t dstlen,
+                          const TypeName* const src, const size_t srclen,
+                          const size_t decoded_size) {
+  const size_t available = dstlen < decoded_size ? dstlen : decoded_size;
+  size_t i;
+  const size_t k = base64_decode_groups(dst, available, src, srclen, &i);
   if (i < srclen && k < dstlen) {
     return k + base64_decode_slow(dst + k, dstlen - k, src + i, srclen - i);
   }
@@ -145,9 +218,9 @@ static size_t base64_encode(const char* src,
                               "abcdefghijklmnopqrstuvwxyz"
                               "0123456789+/";
 
-  i = 0;
-  k = 0;
   n = slen / 3 * 3;
+  i = simd::Base64EncodeBlocks(src, n, dst);
+  k = i / 3 * 4;
 
   while (i < n) {
     a = src[i + 0] & 0xff;
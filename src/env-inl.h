@@ -178,6 +178,8 @@ inline Environment::Environment(IsolateData* isolate_data,
 #endif
       handle_cleanup_waiting_(0),
       http_parser_buffer_(nullptr),
+      read_slab_allocator_(context->GetIsolate()),
+      zlib_stream_pool_(context->GetIsolate()),
       context_(context->GetIsolate(), context) {
   // We'll be creating new objects so make sure we've entered the context.
   v8::HandleScope handle_scope(isolate());
@@ -331,6 +333,18 @@ inline void Environment::set_http_parser_buffer(char* buffer) {
   http_parser_buffer_ = buffer;
 }
 
+inline HttpHeaderCache* Environment::http_header_cache() {
+  return &http_header_cache_;
+}
+
+inline SlabAllocator* Environment::read_slab_allocator() {
+  return &read_slab_allocator_;
+}
+
+inline ZlibStreamPool* Environment::zlib_stream_pool() {
+  return &zlib_stream_pool_;
+}
+
 inline Environment* Environment::from_cares_timer_handle(uv_timer_t* handle) {
   return ContainerOf(&Environment::cares_timer_handle_, handle);
 }
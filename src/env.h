@@ -9,10 +9,13 @@
 #include "inspector_agent.h"
 #endif
 #include "handle_wrap.h"
+#include "http_header_cache.h"
 #include "req-wrap.h"
+#include "slab_allocator.h"
 #include "tree.h"
 #include "util.h"
 #include "uv.h"
+#include "zlib_stream_pool.h"
 #include "v8.h"
 
 #include <stdint.h>
@@ -55,6 +58,7 @@ namespace node {
 #define PER_ISOLATE_PRIVATE_SYMBOL_PROPERTIES(V)                              \
   V(alpn_buffer_private_symbol, "node:alpnBuffer")                            \
   V(arrow_message_private_symbol, "node:arrowMessage")                        \
+  V(code_cache_private_symbol, "node:codeCache")                              \
   V(contextify_context_private_symbol, "node:contextify:context")             \
   V(contextify_global_private_symbol, "node:contextify:global")               \
   V(decorated_private_symbol, "node:decorated")                               \
@@ -151,6 +155,7 @@ namespace node {
   V(onhandshakedone_string, "onhandshakedone")                                \
   V(onhandshakestart_string, "onhandshakestart")                              \
   V(onmessage_string, "onmessage")                                            \
+  V(onmessagebatch_string, "onmessagebatch")                                  \
   V(onnewsession_string, "onnewsession")                                      \
   V(onnewsessiondone_string, "onnewsessiondone")                              \
   V(onocspresponse_string, "onocspresponse")                                  \
@@ -249,6 +254,7 @@ namespace node {
   V(script_context_constructor_template, v8::FunctionTemplate)                \
   V(script_data_constructor_function, v8::Function)                           \
   V(secure_context_constructor_template, v8::FunctionTemplate)                \
+  V(session_cache_constructor_template, v8::FunctionTemplate)                 \
   V(tcp_constructor_template, v8::FunctionTemplate)                           \
   V(tick_callback_function, v8::Function)                                     \
   V(tls_wrap_constructor_function, v8::Function)                              \
@@ -472,6 +478,12 @@ class Environment {
   inline char* http_parser_buffer() const;
   inline void set_http_parser_buffer(char* buffer);
 
+  inline HttpHeaderCache* http_header_cache();
+
+  inline SlabAllocator* read_slab_allocator();
+
+  inline ZlibStreamPool* zlib_stream_pool();
+
   inline void ThrowError(const char* errmsg);
   inline void ThrowTypeError(const char* errmsg);
   inline void ThrowRangeError(const char* errmsg);
@@ -580,6 +592,12 @@ class Environment {
 
   char* http_parser_buffer_;
 
+  HttpHeaderCache http_header_cache_;
+
+  SlabAllocator read_slab_allocator_;
+
+  ZlibStreamPool zlib_stream_pool_;
+
 #define V(PropertyName, TypeName)                                             \
   v8::Persistent<TypeName> PropertyName ## _;
   ENVIRONMENT_STRONG_PERSISTENT_PROPERTIES(V)
@@ -0,0 +1,74 @@
+#include "http_header_cache.h"
+
+#include "util.h"
+#include "util-inl.h"
+
+#include <inttypes.h>  // PRId64
+#include <stdio.h>  // snprintf()
+
+namespace node {
+
+HttpHeaderCache::HttpHeaderCache() : date_time_(-1), date_length_(0) {
+  for (size_t i = 0; i < kContentLengthLines; i++) {
+    content_length_lines_[i].value = -1;
+    content_length_lines_[i].length = 0;
+  }
+}
+
+
+const char* HttpHeaderCache::DateLine(size_t* length) {
+  static const char days[7][4] = {
+    "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
+  };
+  static const char months[12][4] = {
+    "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+    "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+  };
+
+  const time_t now = time(nullptr);
+  if (now != date_time_) {
+    struct tm tm;
+#ifdef _WIN32
+    gmtime_s(&tm, &now);
+#else
+    gmtime_r(&now, &tm);
+#endif
+    int n = snprintf(date_line_,
+                     sizeof(date_line_),
+                     "Date: %s, %02d %s %04d %02d:%02d:%02d GMT\r\n",
+                     days[tm.tm_wday],
+                     tm.tm_mday,
+                     months[tm.tm_mon],
+                     tm.tm_year + 1900,
+                     tm.tm_hour,
+                     tm.tm_min,
+                     tm.tm_sec);
+    CHECK(n > 0 && static_cast<size_t>(n) < sizeof(date_line_));
+    date_length_ = n;
+    date_time_ = now;
+  }
+
+  *length = date_length_;
+  return date_line_;
+}
+
+
+const char* HttpHeaderCache::ContentLengthLine(int64_t value,
+                                               size_t* length) {
+  CHECK_GE(value, 0);
+  Line* line = &content_length_lines_[value % kContentLengthLines];
+  if (line->value != value) {
+    int n = snprintf(line->data,
+                     sizeof(line->data),
+                     "Content-Length: %" PRId64 "\r\n",
+                     value);
+    CHECK(n > 0 && static_cast<size_t>(n) < sizeof(line->data));
+    line->length = n;
+    line->value = value;
+  }
+
+  *length = line->length;
+  return line->data;
+}
+
+}  // namespace node
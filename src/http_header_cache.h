@@ -0,0 +1,52 @@
+#ifndef SRC_HTTP_HEADER_CACHE_H_
+#define SRC_HTTP_HEADER_CACHE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "util.h"
+
+#include <stddef.h>  // size_t
+#include <stdint.h>  // int64_t
+#include <time.h>  // time_t
+
+namespace node {
+
+// Preformatted Date and Content-Length header lines for the HTTP header
+// serializer in node_http_serializer.cc.  Each Environment has its own, so
+// isolates that run on different threads don't share any state.
+class HttpHeaderCache {
+ public:
+  HttpHeaderCache();
+
+  // "Date: Thu, 01 Jan 1970 00:00:00 GMT\r\n" for the current time,
+  // formatted again once per second.
+  const char* DateLine(size_t* length);
+
+  // "Content-Length: 1234\r\n".  Services tend to send the same handful of
+  // sizes over and over, the most recent lines are remembered.  |value| must
+  // not be negative.
+  const char* ContentLengthLine(int64_t value, size_t* length);
+
+ private:
+  struct Line {
+    int64_t value;
+    char data[48];
+    size_t length;
+  };
+
+  static const size_t kContentLengthLines = 64;
+
+  time_t date_time_;
+  char date_line_[64];
+  size_t date_length_;
+
+  Line content_length_lines_[kContentLengthLines];
+
+  DISALLOW_COPY_AND_ASSIGN(HttpHeaderCache);
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_HTTP_HEADER_CACHE_H_
@@ -0,0 +1,264 @@
+#include "multi_string_search.h"
+
+#include "base-object.h"
+#include "base-object-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "node_buffer.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <string.h>
+
+namespace node {
+
+using v8::Array;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::Integer;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::Value;
+
+
+MultiStringSearch::MultiStringSearch() : class_count_(1), first_byte_(-1) {
+  memset(classes_, 0, sizeof(classes_));
+  transitions_.assign(class_count_, 0);
+  outputs_.assign(1, -1);
+  output_links_.assign(1, -1);
+}
+
+
+bool MultiStringSearch::Compile(const std::vector<std::string>& patterns) {
+  // Bytes that no pattern contains all behave the same.
+  bool used[256] = {};
+  for (const std::string& pattern : patterns) {
+    CHECK(!pattern.empty());
+    for (char c : pattern)
+      used[static_cast<uint8_t>(c)] = true;
+  }
+  size_t used_count = 0;
+  for (bool u : used)
+    used_count += u;
+  class_count_ = used_count == 256 ? 0 : 1;
+  for (int b = 0; b < 256; b++)
+    classes_[b] = used[b] ? class_count_++ : 0;
+
+  // The trie, with 0 for missing transitions; no edge leads to the root.
+  // States are numbered here and turned into row offsets at the end.
+  const size_t C = class_count_;
+  transitions_.assign(C, 0);
+  outputs_.assign(1, -1);
+  duplicates_.assign(patterns.size(), -1);
+  for (size_t i = 0; i < patterns.size(); i++) {
+    size_t state = 0;
+    for (char c : patterns[i]) {
+      const size_t cls = classes_[static_cast<uint8_t>(c)];
+      if (transitions_[state * C + cls] == 0) {
+        const size_t next = outputs_.size();
+        if ((next + 1) * C > kMaxTableSize)
+          return false;
+        transitions_[state * C + cls] = next;
+        transitions_.resize(transitions_.size() + C, 0);
+        outputs_.push_back(-1);
+      }
+      state = transitions_[state * C + cls];
+    }
+    if (outputs_[state] == -1) {
+      outputs_[state] = i;
+    } else {
+      int32_t p = outputs_[state];
+      while (duplicates_[p] != -1)
+        p = duplicates_[p];
+      duplicates_[p] = i;
+    }
+  }
+
+  // Breadth first, so that the failure state of every state, which is
+  // shallower, already has its row filled in when the state's is.
+  const size_t state_count = outputs_.size();
+  std::vector<uint32_t> failure(state_count, 0);
+  std::vector<uint32_t> queue;
+  queue.reserve(state_count);
+  output_links_.assign(state_count, -1);
+  queue.push_back(0);
+  for (size_t head = 0; head < queue.size(); head++) {
+    const uint32_t state = queue[head];
+    uint32_t* const row = &transitions_[state * C];
+    const uint32_t* const fallback = &transitions_[failure[state] * C];
+    for (size_t cls = 0; cls < C; cls++) {
+      const uint32_t next = row[cls];
+      if (next == 0) {
+        row[cls] = state == 0 ? 0 : fallback[cls];
+        continue;
+      }
+      const uint32_t link = state == 0 ? 0 : fallback[cls];
+      failure[next] = link;
+      output_links_[next] =
+          outputs_[link] != -1 ? static_cast<int32_t>(link) :
+                                 output_links_[link];
+      queue.push_back(next);
+    }
+  }
+
+  for (uint32_t& next : transitions_) {
+    const bool reports = outputs_[next] != -1 || output_links_[next] != -1;
+    next = next * C | (reports ? kReportBit : 0);
+  }
+
+  first_byte_ = static_cast<uint8_t>(patterns[0][0]);
+  for (const std::string& pattern : patterns) {
+    if (static_cast<uint8_t>(pattern[0]) != first_byte_)
+      first_byte_ = -1;
+  }
+
+  return true;
+}
+
+
+void MultiStringSearch::Report(uint32_t state,
+                               size_t end,
+                               std::vector<Match>* matches) const {
+  int32_t s = outputs_[state] != -1 ? static_cast<int32_t>(state) :
+                                      output_links_[state];
+  while (s != -1) {
+    for (int32_t p = outputs_[s]; p != -1; p = duplicates_[p])
+      matches->push_back(Match { static_cast<uint32_t>(p), end });
+    s = output_links_[s];
+  }
+}
+
+
+uint32_t MultiStringSearch::Scan(const uint8_t* data,
+                                 size_t length,
+                                 uint32_t state,
+                                 std::vector<Match>* matches) const {
+  const uint32_t* const transitions = transitions_.data();
+  size_t i = 0;
+  while (i < length) {
+    if (state == kInitialState && first_byte_ != -1) {
+      const void* next = memchr(data + i, first_byte_, length - i);
+      if (next == nullptr)
+        break;
+      i = static_cast<const uint8_t*>(next) - data;
+    }
+    const uint32_t next = transitions[state + classes_[data[i]]];
+    state = next & ~kReportBit;
+    i++;
+    if (next & kReportBit)
+      Report(state / class_count_, i, matches);
+  }
+  return state;
+}
+
+
+MultiStringSearchWrap::MultiStringSearchWrap(Environment* env,
+                                             Local<Object> wrap)
+    : BaseObject(env, wrap),
+      state_(MultiStringSearch::kInitialState),
+      position_(0) {
+  MakeWeak<MultiStringSearchWrap>(this);
+}
+
+
+void MultiStringSearchWrap::Initialize(Environment* env,
+                                       Local<Object> target) {
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+
+  env->SetProtoMethod(t, "search", Search);
+  env->SetProtoMethod(t, "write", Write);
+  env->SetProtoMethod(t, "reset", Reset);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "MultiStringSearch"),
+              t->GetFunction());
+}
+
+
+// new MultiStringSearch(patterns), an array of non-empty Uint8Arrays.
+void MultiStringSearchWrap::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args.IsConstructCall());
+  CHECK(args[0]->IsArray());
+  Local<Array> array = args[0].As<Array>();
+
+  std::vector<std::string> patterns(array->Length());
+  for (size_t i = 0; i < patterns.size(); i++) {
+    Local<Value> pattern = array->Get(env->context(), i).ToLocalChecked();
+    CHECK(pattern->IsUint8Array());
+    patterns[i].assign(Buffer::Data(pattern), Buffer::Length(pattern));
+  }
+
+  MultiStringSearchWrap* wrap = new MultiStringSearchWrap(env, args.This());
+  if (!wrap->search_.Compile(patterns))
+    return env->ThrowRangeError("Too many or too long patterns");
+}
+
+
+Local<Array> MultiStringSearchWrap::ToArray(double base) const {
+  Environment* env = this->env();
+  Local<Context> context = env->context();
+  Local<Array> array = Array::New(env->isolate(), 2 * matches_.size());
+  for (size_t i = 0; i < matches_.size(); i++) {
+    const MultiStringSearch::Match& match = matches_[i];
+    array->Set(context,
+               2 * i,
+               Integer::NewFromUnsigned(env->isolate(), match.pattern))
+        .FromJust();
+    array->Set(context,
+               2 * i + 1,
+               Number::New(env->isolate(), base + match.end)).FromJust();
+  }
+  return array;
+}
+
+
+// search(buffer, start), matches from the initial state.
+void MultiStringSearchWrap::Search(const FunctionCallbackInfo<Value>& args) {
+  MultiStringSearchWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+  CHECK(args[0]->IsUint8Array());
+  CHECK(args[1]->IsUint32());
+  const uint8_t* data = reinterpret_cast<uint8_t*>(Buffer::Data(args[0]));
+  const size_t length = Buffer::Length(args[0]);
+  const size_t start = args[1]->Uint32Value();
+  CHECK_LE(start, length);
+
+  wrap->matches_.clear();
+  wrap->search_.Scan(data + start,
+                     length - start,
+                     MultiStringSearch::kInitialState,
+                     &wrap->matches_);
+  args.GetReturnValue().Set(wrap->ToArray(start));
+}
+
+
+// write(chunk), matches from where the last chunk left off.  The offsets are
+// from the start of the stream.
+void MultiStringSearchWrap::Write(const FunctionCallbackInfo<Value>& args) {
+  MultiStringSearchWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+  CHECK(args[0]->IsUint8Array());
+  const uint8_t* data = reinterpret_cast<uint8_t*>(Buffer::Data(args[0]));
+  const size_t length = Buffer::Length(args[0]);
+
+  wrap->matches_.clear();
+  wrap->state_ = wrap->search_.Scan(data, length, wrap->state_,
+                                    &wrap->matches_);
+  args.GetReturnValue().Set(wrap->ToArray(wrap->position_));
+  wrap->position_ += length;
+}
+
+
+void MultiStringSearchWrap::Reset(const FunctionCallbackInfo<Value>& args) {
+  MultiStringSearchWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+  wrap->state_ = MultiStringSearch::kInitialState;
+  wrap->position_ = 0;
+}
+
+}  // namespace node
@@ -0,0 +1,108 @@
+#ifndef SRC_MULTI_STRING_SEARCH_H_
+#define SRC_MULTI_STRING_SEARCH_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "base-object.h"
+#include "env.h"
+#include "v8.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace node {
+
+// Aho-Corasick automaton that finds all occurrences of a set of byte patterns
+// in one pass over the input.  The automaton is compiled into a DFA over the
+// classes of bytes that the patterns tell apart, so every input byte costs one
+// table lookup.  The state can be carried over from one chunk of input to the
+// next to find matches that straddle chunks.
+class MultiStringSearch {
+ public:
+  // States are opaque to the caller, this is the one to start scanning in.
+  static const uint32_t kInitialState = 0;
+
+  // Compiled tables are limited to this many entries, 64 MB.
+  static const size_t kMaxTableSize = 16 * 1024 * 1024;
+
+  struct Match {
+    uint32_t pattern;
+    // Offset just past the last byte of the match.
+    size_t end;
+  };
+
+  MultiStringSearch();
+
+  // Compiles the automaton, returns false if the patterns need a table larger
+  // than kMaxTableSize.  The patterns must not be empty.
+  bool Compile(const std::vector<std::string>& patterns);
+
+  // Scans |data| starting in |state| and appends the matches that end in it,
+  // ordered by their end offset and the longest first for the same end.
+  // Returns the state to continue from with the next chunk.
+  uint32_t Scan(const uint8_t* data,
+                size_t length,
+                uint32_t state,
+                std::vector<Match>* matches) const;
+
+ private:
+  inline void Report(uint32_t state,
+                     size_t end,
+                     std::vector<Match>* matches) const;
+
+  // Set in a transition when the state it leads to reports matches.
+  static const uint32_t kReportBit = 0x80000000;
+
+  // Byte to class, class 0 is for the bytes that appear in no pattern unless
+  // all of them do.
+  uint8_t classes_[256];
+  size_t class_count_;
+  // The DFA, class_count_ entries for each state.  States are identified by
+  // the offset of their row, which saves a multiplication for every byte,
+  // and transitions carry kReportBit.
+  std::vector<uint32_t> transitions_;
+  // By state number: the pattern that ends in the state or -1, and the
+  // nearest state for a proper suffix that has one, or -1.
+  std::vector<int32_t> outputs_;
+  std::vector<int32_t> output_links_;
+  // By pattern: the next pattern with the same bytes, or -1.
+  std::vector<int32_t> duplicates_;
+  // When all patterns start with the same byte, the scan skips ahead to it
+  // with memchr() in the initial state.
+  int first_byte_;
+
+  DISALLOW_COPY_AND_ASSIGN(MultiStringSearch);
+};
+
+
+// The JS side of MultiStringSearch, buffer.MultiMatcher in lib/buffer.js.
+class MultiStringSearchWrap : public BaseObject {
+ public:
+  static void Initialize(Environment* env, v8::Local<v8::Object> target);
+
+ private:
+  MultiStringSearchWrap(Environment* env, v8::Local<v8::Object> wrap);
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Search(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Write(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Reset(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  // Returns the matches as a flat array of pattern index and end offset
+  // pairs, with |base| added to the offsets.
+  v8::Local<v8::Array> ToArray(double base) const;
+
+  MultiStringSearch search_;
+  // Streaming state, for write().
+  uint32_t state_;
+  double position_;
+  std::vector<MultiStringSearch::Match> matches_;
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_MULTI_STRING_SEARCH_H_
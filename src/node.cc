@@ -1,5 +1,6 @@
 #include "node.h"
 #include "node_buffer.h"
+#include "node_code_cache.h"
 #include "node_constants.h"
 #include "node_file.h"
 #include "node_http_parser.h"
@@ -173,6 +174,9 @@ static node_module* modlist_addon;
 static const char* icu_data_dir = nullptr;
 #endif
 
+// Directory for the compiled code cache of CommonJS modules.
+static const char* code_cache_dir = nullptr;
+
 // used by C++ modules as well
 bool no_deprecation = false;
 
@@ -2332,6 +2336,76 @@ void CPUUsage(const FunctionCallbackInfo<Value>& args) {
   fields[1] = MICROS_PER_SEC * rusage.ru_stime.tv_sec + rusage.ru_stime.tv_usec;
 }
 
+// Nanoseconds in a microsecond, used in ThreadpoolUsage() below
+#define NANOS_PER_MICRO 1e3
+
+// Returns the size of the libuv threadpool and, per class of work, the number
+// of queued and running requests and how long requests waited for a thread.
+// Wait times are in microseconds.
+void ThreadpoolUsage(const FunctionCallbackInfo<Value>& args) {
+  static const char* const class_names[UV_WORK_CLASS_MAX] = {
+    "default", "fs", "dns", "crypto", "compression"
+  };
+
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+  Local<Context> context = env->context();
+
+  uv_threadpool_stats_t stats;
+  uv_threadpool_get_stats(&stats);
+
+  Local<Object> info = Object::New(isolate);
+#define V(key, value)                                                         \
+  info->Set(context,                                                          \
+            FIXED_ONE_BYTE_STRING(isolate, key),                              \
+            Number::New(isolate, static_cast<double>(value))).FromJust();
+  V("threads", stats.threads)
+  V("idleThreads", stats.idle_threads)
+  V("minThreads", stats.min_threads)
+  V("maxThreads", stats.max_threads)
+#undef V
+
+  Local<Object> queues = Object::New(isolate);
+  for (int i = 0; i < UV_WORK_CLASS_MAX; i++) {
+    const uv_work_class_stats_t& s = stats.classes[i];
+    Local<Object> queue = Object::New(isolate);
+#define V(key, value)                                                         \
+    queue->Set(context,                                                       \
+               FIXED_ONE_BYTE_STRING(isolate, key),                           \
+               Number::New(isolate, static_cast<double>(value))).FromJust();
+    V("queued", s.queued)
+    V("running", s.running)
+    V("dispatched", s.dispatched)
+    V("waitTime", s.wait_time / NANOS_PER_MICRO)
+    V("maxWaitTime", s.max_wait_time / NANOS_PER_MICRO)
+#undef V
+    queues->Set(context,
+                OneByteString(isolate, class_names[i]),
+                queue).FromJust();
+  }
+  info->Set(context, FIXED_ONE_BYTE_STRING(isolate, "queues"), queues)
+      .FromJust();
+
+  args.GetReturnValue().Set(info);
+}
+
+
+// Sets the number of threads that the libuv threadpool keeps around and how
+// far it may grow when work queues up.
+void SetThreadpoolSize(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  if (!args[0]->IsUint32())
+    return env->ThrowTypeError("min must be an unsigned integer");
+  if (!args[1]->IsUndefined() && !args[1]->IsUint32())
+    return env->ThrowTypeError("max must be an unsigned integer");
+
+  const uint32_t min = args[0]->Uint32Value();
+  const uint32_t max = args[1]->IsUndefined() ? min : args[1]->Uint32Value();
+  if (uv_threadpool_set_limits(min, max) != 0)
+    return env->ThrowRangeError("Invalid threadpool size");
+}
+
 extern "C" void node_module_register(void* m) {
   struct node_module* mp = reinterpret_cast<struct node_module*>(m);
 
@@ -3347,6 +3421,9 @@ void SetupProcessObject(Environment* env,
   env->SetMethod(process, "uptime", Uptime);
   env->SetMethod(process, "memoryUsage", MemoryUsage);
 
+  env->SetMethod(process, "threadpoolUsage", ThreadpoolUsage);
+  env->SetMethod(process, "setThreadpoolSize", SetThreadpoolSize);
+
   env->SetMethod(process, "binding", Binding);
   env->SetMethod(process, "_linkedBinding", LinkedBinding);
 
@@ -3583,6 +3660,8 @@ static void PrintHelp() {
          "                        Buffer and SlowBuffer instances\n"
          "  --v8-options          print v8 command line options\n"
          "  --v8-pool-size=num    set v8's thread pool size\n"
+         "  --code-cache-dir=dir  cache compiled modules in dir\n"
+         "                        (overrides NODE_CODE_CACHE_DIR)\n"
 #if HAVE_OPENSSL
          "  --tls-cipher-list=val use an alternative default TLS cipher list\n"
 #if NODE_FIPS_MODE
@@ -3616,6 +3695,7 @@ static void PrintHelp() {
 #endif
 #endif
          "NODE_REPL_HISTORY        path to the persistent REPL history file\n"
+         "NODE_CODE_CACHE_DIR      directory for the compiled module cache\n"
          "\n"
          "Documentation can be found at https://nodejs.org/\n");
 }
@@ -3740,6 +3820,8 @@ static void ParseArgs(int* argc,
       new_v8_argc += 1;
     } else if (strncmp(arg, "--v8-pool-size=", 15) == 0) {
       v8_thread_pool_size = atoi(arg + 15);
+    } else if (strncmp(arg, "--code-cache-dir=", 17) == 0) {
+      code_cache_dir = arg + 17;
 #if HAVE_OPENSSL
     } else if (strncmp(arg, "--tls-cipher-list=", 18) == 0) {
       default_cipher_list = arg + 18;
@@ -4271,6 +4353,10 @@ void Init(int* argc,
                      "(check NODE_ICU_DATA or --icu-data-dir parameters)");
   }
 #endif
+
+  if (code_cache_dir == nullptr)
+    code_cache_dir = secure_getenv("NODE_CODE_CACHE_DIR");
+  code_cache::SetDirectory(code_cache_dir);
   // The const_cast doesn't violate conceptual const-ness.  V8 doesn't modify
   // the argv array or the elements it points to.
   if (v8_argc > 1)
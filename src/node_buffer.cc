@@ -3,6 +3,7 @@
 
 #include "env.h"
 #include "env-inl.h"
+#include "multi_string_search.h"
 #include "string_bytes.h"
 #include "string_search.h"
 #include "util.h"
@@ -1340,6 +1341,9 @@ void Initialize(Local<Object> target,
   env->SetMethod(target, "swap32", Swap32);
   env->SetMethod(target, "swap64", Swap64);
 
+  MultiStringSearchWrap::Initialize(env, target);
+  StringCodec::Initialize(env, target);
+
   target->Set(env->context(),
               FIXED_ONE_BYTE_STRING(env->isolate(), "kMaxLength"),
               Integer::NewFromUnsigned(env->isolate(), kMaxLength)).FromJust();
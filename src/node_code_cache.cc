@@ -0,0 +1,346 @@
+#include "node_code_cache.h"
+#include "node.h"
+#include "node_internals.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+
+#include <fcntl.h>  // O_RDONLY, O_WRONLY, ...
+#include <inttypes.h>  // PRIx64
+#include <stdio.h>  // snprintf()
+#include <stdlib.h>  // free()
+#include <string.h>  // memcmp(), memcpy(), strlen()
+
+namespace node {
+namespace code_cache {
+
+using v8::Boolean;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Isolate;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::ScriptCompiler;
+using v8::String;
+using v8::Value;
+
+static const char kMagic[8] = { 'N', 'O', 'D', 'E', 'C', 'C', '0', '1' };
+
+// Layout of an entry: the header, the script's file name and the data.
+struct Header {
+  char magic[sizeof(kMagic)];
+  uint64_t mtime;
+  uint64_t source_hash;
+  uint32_t source_length;
+  uint32_t filename_length;
+  uint32_t data_length;
+  uint32_t reserved;
+};
+
+static char* directory = nullptr;
+static Statistics statistics;
+
+
+static inline uint64_t Hash(uint64_t hash, const uint8_t* data, size_t size) {
+  // FNV-1a
+  for (size_t i = 0; i < size; i++) {
+    hash ^= data[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+static const uint64_t kHashSeed = 14695981039346656037ull;
+
+
+static uint64_t HashSource(Local<String> source) {
+  // Hash the UTF-16 code units so that the result doesn't depend on how V8
+  // happens to store the string.
+  String::Value value(source);
+  return Hash(kHashSeed,
+              reinterpret_cast<const uint8_t*>(*value),
+              value.length() * sizeof(**value));
+}
+
+
+#ifdef _WIN32
+static bool IsPathSeparator(char c) { return c == '\\' || c == '/'; }
+#else
+static bool IsPathSeparator(char c) { return c == '/'; }
+#endif
+
+
+// Creates the cache directory and the missing directories above it.  They
+// are private to the user, the entries are code that gets executed.
+static void MakeDirectories(uv_loop_t* loop, const std::string& path) {
+  for (size_t i = 1; i <= path.size(); i++) {
+    if (i < path.size() && !IsPathSeparator(path[i]))
+      continue;
+    uv_fs_t req;
+    uv_fs_mkdir(loop, &req, path.substr(0, i).c_str(), 0700, nullptr);
+    uv_fs_req_cleanup(&req);
+  }
+}
+
+
+// Synchronous file helpers that read or write at the current position,
+// return false on error.
+static bool ReadAll(uv_loop_t* loop, uv_file fd, char* data, size_t size) {
+  while (size > 0) {
+    uv_fs_t req;
+    uv_buf_t buf = uv_buf_init(data, size);
+    int err = uv_fs_read(loop, &req, fd, &buf, 1, -1, nullptr);
+    uv_fs_req_cleanup(&req);
+    if (err <= 0)
+      return false;
+    data += err;
+    size -= err;
+  }
+  return true;
+}
+
+
+static bool WriteAll(uv_loop_t* loop, uv_file fd, uv_buf_t* bufs, int nbufs) {
+  while (nbufs > 0) {
+    uv_fs_t req;
+    int err = uv_fs_write(loop, &req, fd, bufs, nbufs, -1, nullptr);
+    uv_fs_req_cleanup(&req);
+    if (err < 0)
+      return false;
+    size_t written = err;
+    while (nbufs > 0 && written >= bufs->len) {
+      written -= bufs->len;
+      bufs++;
+      nbufs--;
+    }
+    if (nbufs > 0) {
+      bufs->base += written;
+      bufs->len -= written;
+    }
+  }
+  return true;
+}
+
+
+static void Close(uv_loop_t* loop, uv_file fd) {
+  uv_fs_t req;
+  uv_fs_close(loop, &req, fd, nullptr);
+  uv_fs_req_cleanup(&req);
+}
+
+
+static void Unlink(uv_loop_t* loop, const char* path) {
+  uv_fs_t req;
+  uv_fs_unlink(loop, &req, path, nullptr);
+  uv_fs_req_cleanup(&req);
+}
+
+
+void SetDirectory(const char* dir) {
+  free(directory);
+  directory = nullptr;
+  if (dir != nullptr && dir[0] != '\0') {
+    const size_t size = strlen(dir) + 1;
+    directory = static_cast<char*>(node::Malloc(size));
+    CHECK_NE(directory, nullptr);
+    memcpy(directory, dir, size);
+  }
+}
+
+
+bool IsEnabled() {
+  return directory != nullptr;
+}
+
+
+void GetStatistics(Statistics* stats) {
+  *stats = statistics;
+}
+
+
+Entry::Entry(uv_loop_t* loop,
+             Isolate* isolate,
+             Local<String> filename,
+             Local<String> source)
+    : loop_(loop),
+      mtime_(0),
+      source_hash_(0),
+      source_length_(0),
+      cacheable_(false) {
+  if (!IsEnabled())
+    return;
+
+  node::Utf8Value name(isolate, filename);
+  uv_fs_t req;
+  int err = uv_fs_stat(loop_, &req, *name, nullptr);
+  if (err == 0 && (req.statbuf.st_mode & S_IFMT) == S_IFREG) {
+    mtime_ = req.statbuf.st_mtim.tv_sec * 1000000000ull +
+             req.statbuf.st_mtim.tv_nsec;
+    cacheable_ = true;
+  }
+  uv_fs_req_cleanup(&req);
+  if (!cacheable_)
+    return;
+
+  filename_.assign(*name, name.length());
+  source_hash_ = HashSource(source);
+  source_length_ = source->Length();
+
+  char basename[32];
+  uint64_t name_hash =
+      Hash(kHashSeed,
+           reinterpret_cast<const uint8_t*>(filename_.data()),
+           filename_.size());
+  snprintf(basename, sizeof(basename), "%016" PRIx64 ".cache", name_hash);
+  path_ = std::string(directory) + "/" + basename;
+}
+
+
+ScriptCompiler::CachedData* Entry::Load() {
+  CHECK(cacheable_);
+
+  uv_fs_t req;
+  const uv_file fd = uv_fs_open(loop_, &req, path_.c_str(), O_RDONLY, 0,
+                                nullptr);
+  uv_fs_req_cleanup(&req);
+  if (fd < 0) {
+    statistics.misses += 1;
+    return nullptr;
+  }
+
+  Header header;
+  bool ok = ReadAll(loop_, fd, reinterpret_cast<char*>(&header),
+                    sizeof(header)) &&
+            memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 &&
+            header.mtime == mtime_ &&
+            header.source_hash == source_hash_ &&
+            header.source_length == source_length_ &&
+            header.filename_length == filename_.size() &&
+            header.data_length > 0;
+
+  if (ok) {
+    MaybeStackBuffer<char, 1024> name(header.filename_length);
+    ok = ReadAll(loop_, fd, *name, header.filename_length) &&
+         memcmp(*name, filename_.data(), filename_.size()) == 0;
+  }
+
+  uint8_t* data = nullptr;
+  if (ok) {
+    data = new uint8_t[header.data_length];
+    ok = ReadAll(loop_, fd, reinterpret_cast<char*>(data), header.data_length);
+  }
+
+  Close(loop_, fd);
+
+  if (!ok) {
+    delete[] data;
+    statistics.misses += 1;
+    return nullptr;
+  }
+
+  statistics.hits += 1;
+  return new ScriptCompiler::CachedData(
+      data, header.data_length, ScriptCompiler::CachedData::BufferOwned);
+}
+
+
+void Entry::Store(const ScriptCompiler::CachedData* data) {
+  CHECK(cacheable_);
+  if (data == nullptr || data->length <= 0)
+    return;
+
+  // Write to a temporary file first so that concurrent processes never see
+  // a partial entry.
+  char suffix[32];
+  snprintf(suffix, sizeof(suffix), ".%" PRIx64 ".tmp", uv_hrtime());
+  const std::string tmp = path_ + suffix;
+
+  uv_fs_t req;
+  uv_file fd = uv_fs_open(loop_, &req, tmp.c_str(),
+                          O_WRONLY | O_CREAT | O_TRUNC, 0666, nullptr);
+  uv_fs_req_cleanup(&req);
+  if (fd == UV_ENOENT) {
+    MakeDirectories(loop_, directory);
+    fd = uv_fs_open(loop_, &req, tmp.c_str(),
+                    O_WRONLY | O_CREAT | O_TRUNC, 0666, nullptr);
+    uv_fs_req_cleanup(&req);
+  }
+  if (fd < 0)
+    return;
+
+  Header header;
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.mtime = mtime_;
+  header.source_hash = source_hash_;
+  header.source_length = source_length_;
+  header.filename_length = filename_.size();
+  header.data_length = data->length;
+  header.reserved = 0;
+
+  uv_buf_t bufs[] = {
+    uv_buf_init(reinterpret_cast<char*>(&header), sizeof(header)),
+    uv_buf_init(const_cast<char*>(filename_.data()), filename_.size()),
+    uv_buf_init(reinterpret_cast<char*>(const_cast<uint8_t*>(data->data)),
+                data->length)
+  };
+  const bool ok = WriteAll(loop_, fd, bufs, arraysize(bufs));
+  Close(loop_, fd);
+
+  if (ok) {
+    int err = uv_fs_rename(loop_, &req, tmp.c_str(), path_.c_str(), nullptr);
+    uv_fs_req_cleanup(&req);
+    if (err == 0) {
+      statistics.stored += 1;
+      return;
+    }
+  }
+
+  Unlink(loop_, tmp.c_str());
+}
+
+
+void Entry::Reject() {
+  CHECK(cacheable_);
+  // Counted as a hit by Load(), take it back.
+  statistics.hits -= 1;
+  statistics.rejected += 1;
+  Unlink(loop_, path_.c_str());
+}
+
+
+static void GetStatistics(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Statistics stats;
+  GetStatistics(&stats);
+
+  Local<Object> obj = Object::New(env->isolate());
+  obj->Set(env->context(),
+           FIXED_ONE_BYTE_STRING(env->isolate(), "enabled"),
+           Boolean::New(env->isolate(), IsEnabled())).FromJust();
+#define V(name, key)                                                          \
+  obj->Set(env->context(),                                                    \
+           FIXED_ONE_BYTE_STRING(env->isolate(), key),                        \
+           Number::New(env->isolate(), static_cast<double>(stats.name)))      \
+      .FromJust();
+  V(hits, "hits")
+  V(misses, "misses")
+  V(rejected, "rejected")
+  V(stored, "stored")
+#undef V
+  args.GetReturnValue().Set(obj);
+}
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  env->SetMethod(target, "getStatistics", GetStatistics);
+}
+
+}  // namespace code_cache
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(code_cache, node::code_cache::Initialize)
@@ -0,0 +1,65 @@
+#ifndef SRC_NODE_CODE_CACHE_H_
+#define SRC_NODE_CODE_CACHE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "uv.h"
+#include "v8.h"
+
+#include <stdint.h>  // uint64_t
+
+#include <string>
+
+namespace node {
+namespace code_cache {
+
+// On-disk cache for the code V8 produces when compiling a script, enabled
+// with --code-cache-dir or NODE_CODE_CACHE_DIR.  Entries are keyed by the
+// script's file name and are only used when the file's mtime and a hash of
+// the source still match, so a stale entry is never consumed.  V8 itself
+// rejects data produced by a different V8 version or with different flags.
+
+struct Statistics {
+  uint64_t hits;      // Entries consumed by V8.
+  uint64_t misses;    // Lookups that found no usable entry.
+  uint64_t rejected;  // Entries V8 refused; they are discarded.
+  uint64_t stored;    // Entries written.
+};
+
+void SetDirectory(const char* directory);
+bool IsEnabled();
+void GetStatistics(Statistics* stats);
+
+class Entry {
+ public:
+  Entry(uv_loop_t* loop,
+        v8::Isolate* isolate,
+        v8::Local<v8::String> filename,
+        v8::Local<v8::String> source);
+
+  // False if the script doesn't come from a regular file.
+  inline bool IsCacheable() const { return cacheable_; }
+
+  // Returns the cached data, or nullptr on a miss.  The caller owns the
+  // returned object.
+  v8::ScriptCompiler::CachedData* Load();
+  void Store(const v8::ScriptCompiler::CachedData* data);
+  // The data returned by Load() was rejected by V8.
+  void Reject();
+
+ private:
+  uv_loop_t* const loop_;
+  std::string filename_;
+  std::string path_;
+  uint64_t mtime_;
+  uint64_t source_hash_;
+  uint32_t source_length_;
+  bool cacheable_;
+};
+
+}  // namespace code_cache
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_CODE_CACHE_H_
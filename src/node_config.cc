@@ -1,4 +1,5 @@
 #include "node.h"
+#include "node_code_cache.h"
 #include "node_i18n.h"
 #include "env.h"
 #include "env-inl.h"
@@ -44,6 +45,9 @@ void InitConfig(Local<Object> target,
 
   if (config_preserve_symlinks)
     READONLY_BOOLEAN_PROPERTY("preserveSymlinks");
+
+  if (code_cache::IsEnabled())
+    READONLY_BOOLEAN_PROPERTY("usingCodeCache");
 }  // InitConfig
 
 }  // namespace node
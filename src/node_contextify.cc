@@ -1,5 +1,6 @@
 #include "node.h"
 #include "node_internals.h"
+#include "node_code_cache.h"
 #include "node_watchdog.h"
 #include "base-object.h"
 #include "base-object-inl.h"
@@ -9,6 +10,8 @@
 #include "util-inl.h"
 #include "v8-debug.h"
 
+#include <memory>  // std::unique_ptr
+
 namespace node {
 
 using v8::Array;
@@ -491,6 +494,7 @@ class ContextifyScript : public BaseObject {
     bool display_errors = GetDisplayErrorsArg(args, 1);
     MaybeLocal<Uint8Array> cached_data_buf = GetCachedData(env, args, 1);
     bool produce_cached_data = GetProduceCachedData(env, args, 1);
+    bool use_code_cache = GetUseCodeCache(env, args, 1);
     if (try_catch.HasCaught()) {
       try_catch.ReThrow();
       return;
@@ -505,6 +509,24 @@ class ContextifyScript : public BaseObject {
           ui8->ByteLength());
     }
 
+    // Explicitly passed cached data takes precedence over the on-disk cache.
+    std::unique_ptr<code_cache::Entry> cache_entry;
+    if (use_code_cache &&
+        cached_data == nullptr &&
+        !produce_cached_data &&
+        code_cache::IsEnabled()) {
+      cache_entry.reset(new code_cache::Entry(env->event_loop(),
+                                              env->isolate(),
+                                              filename,
+                                              code));
+      if (cache_entry->IsCacheable()) {
+        cached_data = cache_entry->Load();
+        produce_cached_data = cached_data == nullptr;
+      } else {
+        cache_entry.reset();
+      }
+    }
+
     ScriptOrigin origin(filename, lineOffset, columnOffset);
     ScriptCompiler::Source source(code, origin, cached_data);
     ScriptCompiler::CompileOptions compile_options =
@@ -530,6 +552,16 @@ class ContextifyScript : public BaseObject {
     contextify_script->script_.Reset(env->isolate(),
                                      v8_script.ToLocalChecked());
 
+    if (cache_entry) {
+      if (compile_options == ScriptCompiler::kConsumeCodeCache) {
+        if (source.GetCachedData()->rejected)
+          cache_entry->Reject();
+      } else {
+        cache_entry->Store(source.GetCachedData());
+      }
+      return;
+    }
+
     if (compile_options == ScriptCompiler::kConsumeCodeCache) {
       args.This()->Set(
           env->cached_data_rejected_string(),
@@ -794,6 +826,22 @@ class ContextifyScript : public BaseObject {
   }
 
 
+  // Set by the module loader only, the option is not part of the vm API.
+  static bool GetUseCodeCache(
+      Environment* env,
+      const FunctionCallbackInfo<Value>& args,
+      const int i) {
+    if (!args[i]->IsObject()) {
+      return false;
+    }
+    auto maybe_value =
+        args[i].As<Object>()->GetPrivate(env->context(),
+                                         env->code_cache_private_symbol());
+    Local<Value> value;
+    return maybe_value.ToLocal(&value) && value->IsTrue();
+  }
+
+
   static Local<Integer> GetLineOffsetArg(
                                       const FunctionCallbackInfo<Value>& args,
                                       const int i) {
@@ -9,6 +9,7 @@
 #include "async-wrap-inl.h"
 #include "env.h"
 #include "env-inl.h"
+#include "node_mutex.h"
 #include "string_bytes.h"
 #include "util.h"
 #include "util-inl.h"
@@ -24,6 +25,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(_MSC_VER)
+#define getpid GetCurrentProcessId
+#else
+#include <unistd.h>  // getpid()
+#endif
+
 #define THROW_AND_RETURN_IF_NOT_STRING_OR_BUFFER(val, prefix)                  \
   do {                                                                         \
     if (!Buffer::HasInstance(val) && !val->IsString()) {                       \
@@ -77,6 +84,7 @@ using v8::Integer;
 using v8::Isolate;
 using v8::Local;
 using v8::Null;
+using v8::Number;
 using v8::Object;
 using v8::Persistent;
 using v8::PropertyAttribute;
@@ -268,6 +276,123 @@ bool EntropySource(unsigned char* buffer, size_t length) {
 }
 
 
+void SessionCache::Initialize(Environment* env, Local<Object> target) {
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+  t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "SessionCache"));
+
+  env->SetProtoMethod(t, "getStats", GetStats);
+  env->SetProtoMethod(t, "clear", Clear);
+
+  t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kDefaultMaxEntries"),
+         Integer::NewFromUnsigned(env->isolate(), kDefaultMaxEntries));
+  t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kDefaultTimeout"),
+         Integer::NewFromUnsigned(env->isolate(), kDefaultTimeout));
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "SessionCache"),
+              t->GetFunction());
+  env->set_session_cache_constructor_template(t);
+}
+
+
+void SessionCache::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  if (!args[0]->IsUint32() || args[0]->Uint32Value() == 0)
+    return env->ThrowTypeError("Maximum number of entries must be > 0");
+  if (!args[1]->IsUint32())
+    return env->ThrowTypeError("Session timeout must be a uint32");
+
+  new SessionCache(env,
+                   args.This(),
+                   args[0]->Uint32Value(),
+                   args[1]->Uint32Value());
+}
+
+
+void SessionCache::Add(SSL_SESSION* sess) {
+  std::string id(reinterpret_cast<const char*>(sess->session_id),
+                 sess->session_id_length);
+
+  auto it = index_.find(id);
+  if (it != index_.end())
+    Remove(it->second);
+
+  Entry entry = { id, sess, uv_now(env()->event_loop()) + timeout_ * 1000ull };
+  entries_.push_front(entry);
+  index_[id] = entries_.begin();
+
+  while (entries_.size() > max_entries_) {
+    Remove(--entries_.end());
+    evictions_++;
+  }
+}
+
+
+SSL_SESSION* SessionCache::Get(const unsigned char* id, int len) {
+  auto it = index_.find(std::string(reinterpret_cast<const char*>(id), len));
+  if (it == index_.end()) {
+    misses_++;
+    return nullptr;
+  }
+
+  EntryList::iterator entry = it->second;
+  if (entry->expires <= uv_now(env()->event_loop())) {
+    Remove(entry);
+    expired_++;
+    misses_++;
+    return nullptr;
+  }
+
+  entries_.splice(entries_.begin(), entries_, entry);
+  hits_++;
+  return entry->sess;
+}
+
+
+void SessionCache::Remove(EntryList::iterator it) {
+  SSL_SESSION_free(it->sess);
+  index_.erase(it->id);
+  entries_.erase(it);
+}
+
+
+void SessionCache::Clear() {
+  for (Entry& entry : entries_)
+    SSL_SESSION_free(entry.sess);
+  entries_.clear();
+  index_.clear();
+}
+
+
+void SessionCache::GetStats(const FunctionCallbackInfo<Value>& args) {
+  SessionCache* cache;
+  ASSIGN_OR_RETURN_UNWRAP(&cache, args.Holder());
+  Environment* env = cache->env();
+
+  Local<Object> obj = Object::New(env->isolate());
+#define V(key, value)                                                         \
+  obj->Set(env->context(),                                                    \
+           FIXED_ONE_BYTE_STRING(env->isolate(), key),                        \
+           Number::New(env->isolate(), static_cast<double>(value)))           \
+      .FromJust();
+  V("size", cache->entries_.size())
+  V("hits", cache->hits_)
+  V("misses", cache->misses_)
+  V("evictions", cache->evictions_)
+  V("expired", cache->expired_)
+#undef V
+  args.GetReturnValue().Set(obj);
+}
+
+
+void SessionCache::Clear(const FunctionCallbackInfo<Value>& args) {
+  SessionCache* cache;
+  ASSIGN_OR_RETURN_UNWRAP(&cache, args.Holder());
+  cache->Clear();
+}
+
+
 void SecureContext::Initialize(Environment* env, Local<Object> target) {
   Local<FunctionTemplate> t = env->NewFunctionTemplate(SecureContext::New);
   t->InstanceTemplate()->SetInternalFieldCount(1);
@@ -287,6 +412,7 @@ void SecureContext::Initialize(Environment* env, Local<Object> target) {
                       SecureContext::SetSessionIdContext);
   env->SetProtoMethod(t, "setSessionTimeout",
                       SecureContext::SetSessionTimeout);
+  env->SetProtoMethod(t, "setSessionCache", SecureContext::SetSessionCache);
   env->SetProtoMethod(t, "close", SecureContext::Close);
   env->SetProtoMethod(t, "loadPKCS12", SecureContext::LoadPKCS12);
   env->SetProtoMethod(t, "getTicketKeys", SecureContext::GetTicketKeys);
@@ -932,6 +1058,23 @@ void SecureContext::SetSessionTimeout(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void SecureContext::SetSessionCache(const FunctionCallbackInfo<Value>& args) {
+  SecureContext* sc;
+  ASSIGN_OR_RETURN_UNWRAP(&sc, args.Holder());
+  Environment* env = sc->env();
+
+  if (args.Length() != 1 ||
+      !env->session_cache_constructor_template()->HasInstance(args[0])) {
+    return env->ThrowTypeError("Must give a SessionCache as first argument");
+  }
+
+  SessionCache* cache;
+  ASSIGN_OR_RETURN_UNWRAP(&cache, args[0].As<Object>());
+  sc->session_cache_ = cache;
+  sc->session_cache_object_.Reset(env->isolate(), args[0].As<Object>());
+}
+
+
 void SecureContext::Close(const FunctionCallbackInfo<Value>& args) {
   SecureContext* sc;
   ASSIGN_OR_RETURN_UNWRAP(&sc, args.Holder());
@@ -1030,6 +1173,15 @@ void SecureContext::GetTicketKeys(const FunctionCallbackInfo<Value>& args) {
   SecureContext* wrap;
   ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
 
+  if (!wrap->ticket_keys_.empty()) {
+    const size_t size = wrap->ticket_keys_.size() * sizeof(TicketKey);
+    Local<Object> buff =
+        Buffer::Copy(wrap->env(),
+                     reinterpret_cast<char*>(&wrap->ticket_keys_[0]),
+                     size).ToLocalChecked();
+    return args.GetReturnValue().Set(buff);
+  }
+
   Local<Object> buff = Buffer::New(wrap->env(), 48).ToLocalChecked();
   if (SSL_CTX_get_tlsext_ticket_keys(wrap->ctx_,
                                      Buffer::Data(buff),
@@ -1042,6 +1194,10 @@ void SecureContext::GetTicketKeys(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Takes one or more 48 byte keys, the first one encrypts new tickets and all
+// of them decrypt, which allows rotating keys without invalidating the
+// tickets that are out there.  A callback installed with
+// enableTicketKeyCallback() takes precedence over the keys.
 void SecureContext::SetTicketKeys(const FunctionCallbackInfo<Value>& args) {
 #if !defined(OPENSSL_NO_TLSEXT) && defined(SSL_CTX_get_tlsext_ticket_keys)
   SecureContext* wrap;
@@ -1054,16 +1210,23 @@ void SecureContext::SetTicketKeys(const FunctionCallbackInfo<Value>& args) {
 
   THROW_AND_RETURN_IF_NOT_BUFFER(args[0], "Ticket keys");
 
-  if (Buffer::Length(args[0]) != 48) {
-    return env->ThrowTypeError("Ticket keys length must be 48 bytes");
+  const size_t length = Buffer::Length(args[0]);
+  if (length == 0 || length % sizeof(TicketKey) != 0) {
+    return env->ThrowTypeError(
+        "Ticket keys length must be a multiple of 48 bytes");
   }
 
   if (SSL_CTX_set_tlsext_ticket_keys(wrap->ctx_,
                                      Buffer::Data(args[0]),
-                                     Buffer::Length(args[0])) != 1) {
+                                     sizeof(TicketKey)) != 1) {
     return env->ThrowError("Failed to fetch tls ticket keys");
   }
 
+  wrap->ticket_keys_.resize(length / sizeof(TicketKey));
+  memcpy(&wrap->ticket_keys_[0], Buffer::Data(args[0]), length);
+  if (!wrap->ticket_key_callback_)
+    SSL_CTX_set_tlsext_ticket_key_cb(wrap->ctx_, TicketKeyRingCallback);
+
   args.GetReturnValue().Set(true);
 #endif  // !def(OPENSSL_NO_TLSEXT) && def(SSL_CTX_get_tlsext_ticket_keys)
 }
@@ -1082,6 +1245,7 @@ void SecureContext::EnableTicketKeyCallback(
   SecureContext* wrap;
   ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
 
+  wrap->ticket_key_callback_ = true;
   SSL_CTX_set_tlsext_ticket_key_cb(wrap->ctx_, TicketKeyCallback);
 }
 
@@ -1165,6 +1329,55 @@ int SecureContext::TicketKeyCallback(SSL* ssl,
 }
 
 
+int SecureContext::TicketKeyRingCallback(SSL* ssl,
+                                         unsigned char* name,
+                                         unsigned char* iv,
+                                         EVP_CIPHER_CTX* ectx,
+                                         HMAC_CTX* hctx,
+                                         int enc) {
+  SecureContext* sc = static_cast<SecureContext*>(
+      SSL_CTX_get_app_data(ssl->initial_ctx));
+  const std::vector<TicketKey>& keys = sc->ticket_keys_;
+
+  size_t index = 0;
+  if (enc) {
+    if (RAND_bytes(iv, EVP_MAX_IV_LENGTH) <= 0)
+      return -1;
+    memcpy(name, keys[0].name, sizeof(keys[0].name));
+  } else {
+    while (index < keys.size() &&
+           memcmp(name, keys[index].name, sizeof(keys[index].name)) != 0) {
+      index++;
+    }
+    // Unknown or expired key, do a full handshake
+    if (index == keys.size())
+      return 0;
+  }
+
+  HMAC_Init_ex(hctx,
+               keys[index].hmac_key,
+               sizeof(keys[index].hmac_key),
+               EVP_sha256(),
+               nullptr);
+  if (enc) {
+    EVP_EncryptInit_ex(ectx,
+                       EVP_aes_128_cbc(),
+                       nullptr,
+                       keys[index].aes_key,
+                       iv);
+  } else {
+    EVP_DecryptInit_ex(ectx,
+                       EVP_aes_128_cbc(),
+                       nullptr,
+                       keys[index].aes_key,
+                       iv);
+  }
+
+  // Tickets encrypted with an older key get renewed
+  return index == 0 ? 1 : 2;
+}
+
+
 
 
 void SecureContext::CtxGetter(Local<String> property,
@@ -1279,8 +1492,17 @@ SSL_SESSION* SSLWrap<Base>::GetSessionCallback(SSL* s,
   *copy = 0;
   SSL_SESSION* sess = w->next_sess_;
   w->next_sess_ = nullptr;
+  if (sess != nullptr)
+    return sess;
+
+  SecureContext* sc =
+      static_cast<SecureContext*>(SSL_CTX_get_app_data(s->session_ctx));
+  if (sc->session_cache_ == nullptr)
+    return nullptr;
 
-  return sess;
+  // The cache keeps its own reference
+  *copy = 1;
+  return sc->session_cache_->Get(key, len);
 }
 
 
@@ -1291,13 +1513,22 @@ int SSLWrap<Base>::NewSessionCallback(SSL* s, SSL_SESSION* sess) {
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
 
+  // Returning 1 hands our reference over to the cache
+  int stored = 0;
+  SecureContext* sc =
+      static_cast<SecureContext*>(SSL_CTX_get_app_data(s->session_ctx));
+  if (sc->session_cache_ != nullptr) {
+    sc->session_cache_->Add(sess);
+    stored = 1;
+  }
+
   if (!w->session_callbacks_)
-    return 0;
+    return stored;
 
   // Check if session is small enough to be stored
   int size = i2d_SSL_SESSION(sess, nullptr);
   if (size > SecureContext::kMaxSessionSize)
-    return 0;
+    return stored;
 
   // Serialize session
   Local<Object> buff = Buffer::New(env, size).ToLocalChecked();
@@ -1314,7 +1545,7 @@ int SSLWrap<Base>::NewSessionCallback(SSL* s, SSL_SESSION* sess) {
   w->new_session_wait_ = true;
   w->MakeCallback(env->onnewsession_string(), arraysize(argv), argv);
 
-  return 0;
+  return stored;
 }
 
 
@@ -2018,6 +2249,14 @@ int SSLWrap<Base>::AdvertiseNextProtoCallback(SSL* s,
                                               unsigned int* len,
                                               void* arg) {
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
+
+  // Runs on the threadpool, see StartKeyOp()
+  if (w->key_op_ == kKeyOpRunning) {
+    *data = reinterpret_cast<const unsigned char*>(w->key_op_npn_.data());
+    *len = w->key_op_npn_.size();
+    return SSL_TLSEXT_ERR_OK;
+  }
+
   Environment* env = w->env();
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
@@ -2162,18 +2401,29 @@ int SSLWrap<Base>::SelectALPNCallback(SSL* s,
                                       unsigned int inlen,
                                       void* arg) {
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
-  Environment* env = w->env();
-  HandleScope handle_scope(env->isolate());
-  Context::Scope context_scope(env->context());
+  const unsigned char* alpn_protos;
+  unsigned alpn_protos_len;
+
+  if (w->key_op_ == kKeyOpRunning) {
+    // Runs on the threadpool, see StartKeyOp()
+    alpn_protos =
+        reinterpret_cast<const unsigned char*>(w->key_op_alpn_.data());
+    alpn_protos_len = w->key_op_alpn_.size();
+  } else {
+    Environment* env = w->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+
+    Local<Value> alpn_buffer =
+        w->object()->GetPrivate(
+            env->context(),
+            env->alpn_buffer_private_symbol()).ToLocalChecked();
+    CHECK(Buffer::HasInstance(alpn_buffer));
+    alpn_protos =
+        reinterpret_cast<const unsigned char*>(Buffer::Data(alpn_buffer));
+    alpn_protos_len = Buffer::Length(alpn_buffer);
+  }
 
-  Local<Value> alpn_buffer =
-      w->object()->GetPrivate(
-          env->context(),
-          env->alpn_buffer_private_symbol()).ToLocalChecked();
-  CHECK(Buffer::HasInstance(alpn_buffer));
-  const unsigned char* alpn_protos =
-      reinterpret_cast<const unsigned char*>(Buffer::Data(alpn_buffer));
-  unsigned alpn_protos_len = Buffer::Length(alpn_buffer);
   int status = SSL_select_next_proto(const_cast<unsigned char**>(out), outlen,
                                      alpn_protos, alpn_protos_len, in, inlen);
 
@@ -2248,6 +2498,24 @@ void SSLWrap<Base>::SetALPNProtocols(
 template <class Base>
 int SSLWrap<Base>::TLSExtStatusCallback(SSL* s, void* arg) {
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
+
+  // Outgoing response on the threadpool, see StartKeyOp()
+  if (w->key_op_ == kKeyOpRunning) {
+    if (w->key_op_ocsp_.empty())
+      return SSL_TLSEXT_ERR_NOACK;
+
+    const size_t len = w->key_op_ocsp_.size();
+    char* data = reinterpret_cast<char*>(node::Malloc(len));
+    CHECK_NE(data, nullptr);
+    memcpy(data, w->key_op_ocsp_.data(), len);
+
+    if (!SSL_set_tlsext_status_ocsp_resp(s, data, len))
+      free(data);
+    w->key_op_ocsp_.clear();
+
+    return SSL_TLSEXT_ERR_OK;
+  }
+
   Environment* env = w->env();
   HandleScope handle_scope(env->isolate());
 
@@ -2308,7 +2576,7 @@ int SSLWrap<Base>::SSLCertCallback(SSL* s, void* arg) {
     return 1;
 
   if (!w->is_waiting_cert_cb())
-    return 1;
+    return w->SuspendForKeyOp();
 
   if (w->cert_cb_running_)
     return -1;
@@ -2345,13 +2613,84 @@ int SSLWrap<Base>::SSLCertCallback(SSL* s, void* arg) {
   w->MakeCallback(env->oncertcb_string(), arraysize(argv), argv);
 
   if (!w->cert_cb_running_)
-    return 1;
+    return w->SuspendForKeyOp();
 
   // Performing async action, wait...
   return -1;
 }
 
 
+// The handshake step that follows the certificate callback picks the cipher,
+// sends the server's first flight and signs the ServerKeyExchange message.
+// Resumed sessions don't sign anything and never get here.
+template <class Base>
+int SSLWrap<Base>::SuspendForKeyOp() {
+  switch (key_op_) {
+    case kKeyOpNone:
+      if (!async_key_ops_)
+        return 1;
+      key_op_ = kKeyOpWanted;
+      return -1;
+    case kKeyOpWanted:
+      return -1;
+    case kKeyOpRunning:
+      return 1;
+  }
+  return 1;
+}
+
+
+// Copies the data the server callbacks would read from JS land, the step
+// runs on the threadpool once this returns.
+template <class Base>
+void SSLWrap<Base>::StartKeyOp() {
+  CHECK_EQ(key_op_, kKeyOpWanted);
+  Base* w = static_cast<Base*>(this);
+  Environment* env = w->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+#ifdef OPENSSL_NPN_NEGOTIATED
+  Local<Value> npn_buffer =
+      w->object()->GetPrivate(
+          env->context(),
+          env->npn_buffer_private_symbol()).ToLocalChecked();
+  if (Buffer::HasInstance(npn_buffer))
+    key_op_npn_.assign(Buffer::Data(npn_buffer), Buffer::Length(npn_buffer));
+#endif  // OPENSSL_NPN_NEGOTIATED
+
+#ifdef TLSEXT_TYPE_application_layer_protocol_negotiation
+  Local<Value> alpn_buffer =
+      w->object()->GetPrivate(
+          env->context(),
+          env->alpn_buffer_private_symbol()).ToLocalChecked();
+  if (Buffer::HasInstance(alpn_buffer)) {
+    key_op_alpn_.assign(Buffer::Data(alpn_buffer),
+                        Buffer::Length(alpn_buffer));
+  }
+#endif  // TLSEXT_TYPE_application_layer_protocol_negotiation
+
+#ifdef NODE__HAVE_TLSEXT_STATUS_CB
+  if (!ocsp_response_.IsEmpty()) {
+    Local<Object> obj = PersistentToLocal(env->isolate(), ocsp_response_);
+    key_op_ocsp_.assign(Buffer::Data(obj), Buffer::Length(obj));
+    ocsp_response_.Reset();
+  }
+#endif  // NODE__HAVE_TLSEXT_STATUS_CB
+
+  key_op_ = kKeyOpRunning;
+}
+
+
+template <class Base>
+void SSLWrap<Base>::FinishKeyOp() {
+  key_op_ = kKeyOpNone;
+  key_op_npn_.clear();
+  key_op_alpn_.clear();
+  key_op_ocsp_.clear();
+}
+
+
 template <class Base>
 void SSLWrap<Base>::CertCbDone(const FunctionCallbackInfo<Value>& args) {
   Base* w;
@@ -2437,6 +2776,7 @@ void SSLWrap<Base>::DestroySSL() {
   SSL_free(ssl_);
   env_->isolate()->AdjustAmountOfExternalAllocatedMemory(-kExternalSize);
   ssl_ = nullptr;
+  FinishKeyOp();
 }
 
 
@@ -3160,6 +3500,7 @@ void CipherBase::Initialize(Environment* env, Local<Object> target) {
   env->SetProtoMethod(t, "init", Init);
   env->SetProtoMethod(t, "initiv", InitIv);
   env->SetProtoMethod(t, "update", Update);
+  env->SetProtoMethod(t, "updateAsync", UpdateAsync);
   env->SetProtoMethod(t, "final", Final);
   env->SetProtoMethod(t, "setAutoPadding", SetAutoPadding);
   env->SetProtoMethod(t, "getAuthTag", GetAuthTag);
@@ -3341,6 +3682,8 @@ void CipherBase::GetAuthTag(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   CipherBase* cipher;
   ASSIGN_OR_RETURN_UNWRAP(&cipher, args.Holder());
+  if (cipher->pending_)
+    return env->ThrowError("Cipher operation in progress");
 
   char* out = nullptr;
   unsigned int out_len = 0;
@@ -3375,6 +3718,8 @@ void CipherBase::SetAuthTag(const FunctionCallbackInfo<Value>& args) {
 
   CipherBase* cipher;
   ASSIGN_OR_RETURN_UNWRAP(&cipher, args.Holder());
+  if (cipher->pending_)
+    return env->ThrowError("Cipher operation in progress");
 
   if (!cipher->SetAuthTag(Buffer::Data(buf), Buffer::Length(buf)))
     env->ThrowError("Attempting to set auth tag in unsupported state");
@@ -3403,6 +3748,8 @@ void CipherBase::SetAAD(const FunctionCallbackInfo<Value>& args) {
 
   CipherBase* cipher;
   ASSIGN_OR_RETURN_UNWRAP(&cipher, args.Holder());
+  if (cipher->pending_)
+    return env->ThrowError("Cipher operation in progress");
 
   if (!cipher->SetAAD(Buffer::Data(args[0]), Buffer::Length(args[0])))
     env->ThrowError("Attempting to set AAD in unsupported state");
@@ -3426,8 +3773,10 @@ bool CipherBase::Update(const char* data,
     auth_tag_ = nullptr;
   }
 
+  // Allocated with malloc() so that a Buffer can take it over
   *out_len = len + EVP_CIPHER_CTX_block_size(&ctx_);
-  *out = new unsigned char[*out_len];
+  *out = static_cast<unsigned char*>(node::Malloc(*out_len));
+  CHECK_NE(*out, nullptr);
   return EVP_CipherUpdate(&ctx_,
                           *out,
                           out_len,
@@ -3441,6 +3790,8 @@ void CipherBase::Update(const FunctionCallbackInfo<Value>& args) {
 
   CipherBase* cipher;
   ASSIGN_OR_RETURN_UNWRAP(&cipher, args.Holder());
+  if (cipher->pending_)
+    return env->ThrowError("Cipher operation in progress");
 
   THROW_AND_RETURN_IF_NOT_STRING_OR_BUFFER(args[0], "Cipher data");
 
@@ -3461,7 +3812,7 @@ void CipherBase::Update(const FunctionCallbackInfo<Value>& args) {
   }
 
   if (!r) {
-    delete[] out;
+    free(out);
     return ThrowCryptoError(env,
                             ERR_get_error(),
                             "Trying to add data in unsupported state");
@@ -3469,14 +3820,129 @@ void CipherBase::Update(const FunctionCallbackInfo<Value>& args) {
 
   CHECK(out != nullptr || out_len == 0);
   Local<Object> buf =
-      Buffer::Copy(env, reinterpret_cast<char*>(out), out_len).ToLocalChecked();
-  if (out)
-    delete[] out;
+      Buffer::New(env, reinterpret_cast<char*>(out), out_len).ToLocalChecked();
 
   args.GetReturnValue().Set(buf);
 }
 
 
+// Runs Update() for one chunk on the threadpool, the main thread leaves the
+// cipher alone until the request completes.
+class CipherBase::UpdateRequest : public AsyncWrap {
+ public:
+  UpdateRequest(Environment* env,
+                Local<Object> object,
+                CipherBase* cipher,
+                const char* data,
+                int len)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_CRYPTO),
+        cipher_(cipher),
+        data_(data),
+        len_(len),
+        ok_(false),
+        error_(0),
+        out_(nullptr),
+        out_len_(0) {
+    Wrap(object, this);
+    cipher_->pending_ = true;
+  }
+
+  ~UpdateRequest() override {
+    free(out_);
+    ClearWrap(object());
+    persistent().Reset();
+  }
+
+  uv_work_t* work_req() {
+    return &work_req_;
+  }
+
+  static void Work(uv_work_t* work_req) {
+    UpdateRequest* req = ContainerOf(&UpdateRequest::work_req_, work_req);
+    req->ok_ = req->cipher_->Update(req->data_,
+                                    req->len_,
+                                    &req->out_,
+                                    &req->out_len_);
+    if (!req->ok_) {
+      req->error_ = ERR_get_error();
+      ERR_clear_error();
+    }
+  }
+
+  static void After(uv_work_t* work_req, int status) {
+    CHECK_EQ(status, 0);
+    UpdateRequest* req = ContainerOf(&UpdateRequest::work_req_, work_req);
+    Environment* env = req->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    req->cipher_->pending_ = false;
+
+    Local<Value> argv[2];
+    if (req->ok_) {
+      CHECK(req->out_ != nullptr || req->out_len_ == 0);
+      argv[0] = Null(env->isolate());
+      argv[1] = Buffer::New(env,
+                            reinterpret_cast<char*>(req->out_),
+                            req->out_len_).ToLocalChecked();
+      req->out_ = nullptr;
+    } else {
+      char errmsg[128] = "Trying to add data in unsupported state";
+      if (req->error_ != 0)
+        ERR_error_string_n(req->error_, errmsg, sizeof(errmsg));
+      argv[0] = Exception::Error(OneByteString(env->isolate(), errmsg));
+      argv[1] = Null(env->isolate());
+    }
+    req->MakeCallback(env->ondone_string(), arraysize(argv), argv);
+    delete req;
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+  uv_work_t work_req_;
+
+ private:
+  CipherBase* const cipher_;
+  const char* const data_;
+  const int len_;
+  bool ok_;
+  unsigned long error_;  // NOLINT(runtime/int)
+  unsigned char* out_;
+  int out_len_;
+};
+
+
+void CipherBase::UpdateAsync(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CipherBase* cipher;
+  ASSIGN_OR_RETURN_UNWRAP(&cipher, args.Holder());
+  if (cipher->pending_)
+    return env->ThrowError("Cipher operation in progress");
+
+  THROW_AND_RETURN_IF_NOT_BUFFER(args[0], "Cipher data");
+  CHECK(args[1]->IsFunction());
+
+  Local<Object> obj = env->NewInternalFieldObject();
+  // The cipher and the input have to outlive the request
+  obj->Set(env->handle_string(), args.Holder());
+  obj->Set(env->buffer_string(), args[0]);
+  obj->Set(env->ondone_string(), args[1]);
+  if (env->in_domain())
+    obj->Set(env->domain_string(), env->domain_array()->Get(0));
+
+  UpdateRequest* req = new UpdateRequest(env,
+                                         obj,
+                                         cipher,
+                                         Buffer::Data(args[0]),
+                                         Buffer::Length(args[0]));
+  uv_queue_work_ex(env->event_loop(),
+                   req->work_req(),
+                   UV_WORK_CRYPTO,
+                   UpdateRequest::Work,
+                   UpdateRequest::After);
+}
+
+
 bool CipherBase::SetAutoPadding(bool auto_padding) {
   if (!initialised_)
     return false;
@@ -3485,8 +3951,11 @@ bool CipherBase::SetAutoPadding(bool auto_padding) {
 
 
 void CipherBase::SetAutoPadding(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
   CipherBase* cipher;
   ASSIGN_OR_RETURN_UNWRAP(&cipher, args.Holder());
+  if (cipher->pending_)
+    return env->ThrowError("Cipher operation in progress");
   cipher->SetAutoPadding(args.Length() < 1 || args[0]->BooleanValue());
 }
 
@@ -3524,6 +3993,8 @@ void CipherBase::Final(const FunctionCallbackInfo<Value>& args) {
 
   CipherBase* cipher;
   ASSIGN_OR_RETURN_UNWRAP(&cipher, args.Holder());
+  if (cipher->pending_)
+    return env->ThrowError("Cipher operation in progress");
 
   unsigned char* out_value = nullptr;
   int out_len = -1;
@@ -3810,6 +4281,252 @@ void Hash::HashDigest(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// One-shot digest, saves allocating a Hash object for small inputs
+void OneShotDigest(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  if (args.Length() == 0 || !args[0]->IsString())
+    return env->ThrowError("Must give hashtype string as argument");
+  THROW_AND_RETURN_IF_NOT_STRING_OR_BUFFER(args[1], "Data");
+
+  const node::Utf8Value hash_type(env->isolate(), args[0]);
+  const EVP_MD* md = EVP_get_digestbyname(*hash_type);
+  if (md == nullptr) {
+    return ThrowCryptoError(env, ERR_get_error(),
+                            "Digest method not supported");
+  }
+
+  const char* data;
+  size_t len;
+  StringBytes::InlineDecoder decoder;
+  if (args[1]->IsString()) {
+    if (!decoder.Decode(env, args[1].As<String>(), args[2], UTF8))
+      return;
+    data = decoder.out();
+    len = decoder.size();
+  } else {
+    data = Buffer::Data(args[1]);
+    len = Buffer::Length(args[1]);
+  }
+
+  enum encoding encoding = BUFFER;
+  if (args.Length() >= 4) {
+    encoding = ParseEncoding(env->isolate(),
+                             args[3]->ToString(env->isolate()),
+                             BUFFER);
+  }
+
+  unsigned char md_value[EVP_MAX_MD_SIZE];
+  unsigned int md_len;
+  if (EVP_Digest(data, len, md_value, &md_len, md, nullptr) <= 0)
+    return ThrowCryptoError(env, ERR_get_error(), "Digest failed");
+
+  Local<Value> rc = StringBytes::Encode(env->isolate(),
+                                        reinterpret_cast<const char*>(md_value),
+                                        md_len,
+                                        encoding);
+  args.GetReturnValue().Set(rc);
+}
+
+
+// Only instantiate within a valid HandleScope.
+class HashBatchRequest : public AsyncWrap {
+ public:
+  HashBatchRequest(Environment* env,
+                   Local<Object> object,
+                   const EVP_MD* md,
+                   size_t count)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_CRYPTO),
+        md_(md),
+        error_(0),
+        inputs_(count),
+        size_(count * EVP_MD_size(md)),
+        data_(static_cast<char*>(node::Malloc(size_))) {
+    if (data() == nullptr && size_ > 0)
+      FatalError("node::HashBatchRequest()", "Out of Memory");
+    Wrap(object, this);
+  }
+
+  ~HashBatchRequest() override {
+    free(data_);
+    ClearWrap(object());
+    persistent().Reset();
+  }
+
+  uv_work_t* work_req() {
+    return &work_req_;
+  }
+
+  inline void set_input(size_t index, const char* data, size_t len) {
+    inputs_[index] = uv_buf_init(const_cast<char*>(data), len);
+  }
+
+  inline char* data() const {
+    return data_;
+  }
+
+  inline void return_memory(char** d, size_t* len) {
+    *d = data_;
+    data_ = nullptr;
+    *len = size_;
+    size_ = 0;
+  }
+
+  inline unsigned long error() const {  // NOLINT(runtime/int)
+    return error_;
+  }
+
+  // Digests all the inputs one after the other into the packed result,
+  // reusing a single context
+  void Run() {
+    EVP_MD_CTX ctx;
+    EVP_MD_CTX_init(&ctx);
+    unsigned char* out = reinterpret_cast<unsigned char*>(data_);
+    for (const uv_buf_t& input : inputs_) {
+      unsigned int md_len;
+      if (EVP_DigestInit_ex(&ctx, md_, nullptr) <= 0 ||
+          EVP_DigestUpdate(&ctx, input.base, input.len) <= 0 ||
+          EVP_DigestFinal_ex(&ctx, out, &md_len) <= 0) {
+        error_ = ERR_get_error();
+        if (error_ == 0)
+          error_ = static_cast<unsigned long>(-1);  // NOLINT(runtime/int)
+        break;
+      }
+      out += md_len;
+    }
+    EVP_MD_CTX_cleanup(&ctx);
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+  uv_work_t work_req_;
+
+ private:
+  const EVP_MD* md_;
+  unsigned long error_;  // NOLINT(runtime/int)
+  std::vector<uv_buf_t> inputs_;
+  size_t size_;
+  char* data_;
+};
+
+
+void HashBatchWork(uv_work_t* work_req) {
+  HashBatchRequest* req = ContainerOf(&HashBatchRequest::work_req_, work_req);
+  req->Run();
+}
+
+
+// don't call this function without a valid HandleScope
+void HashBatchCheck(HashBatchRequest* req, Local<Value> argv[2]) {
+  if (req->error()) {
+    char errmsg[256] = "Digest failed";
+
+    if (req->error() != static_cast<unsigned long>(-1))  // NOLINT(runtime/int)
+      ERR_error_string_n(req->error(), errmsg, sizeof errmsg);
+
+    argv[0] = Exception::Error(OneByteString(req->env()->isolate(), errmsg));
+    argv[1] = Null(req->env()->isolate());
+  } else {
+    char* data = nullptr;
+    size_t size;
+    req->return_memory(&data, &size);
+    argv[0] = Null(req->env()->isolate());
+    argv[1] = Buffer::New(req->env(), data, size).ToLocalChecked();
+  }
+}
+
+
+void HashBatchAfter(uv_work_t* work_req, int status) {
+  CHECK_EQ(status, 0);
+  HashBatchRequest* req = ContainerOf(&HashBatchRequest::work_req_, work_req);
+  Environment* env = req->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+  Local<Value> argv[2];
+  HashBatchCheck(req, argv);
+  req->MakeCallback(env->ondone_string(), arraysize(argv), argv);
+  delete req;
+}
+
+
+// Batches smaller than this are not worth a trip to the threadpool
+static const size_t kHashBatchThreadpoolThreshold = 64 * 1024;
+
+// Hashes an array of Buffers into one Buffer holding the digests back to
+// back. With a callback and enough data, the work is done on the threadpool
+// and the request object is returned, otherwise the result is.
+void HashBatch(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  if (args.Length() == 0 || !args[0]->IsString())
+    return env->ThrowError("Must give hashtype string as argument");
+  if (!args[1]->IsArray())
+    return env->ThrowTypeError("Data must be an array of buffers");
+
+  const node::Utf8Value hash_type(env->isolate(), args[0]);
+  const EVP_MD* md = EVP_get_digestbyname(*hash_type);
+  if (md == nullptr) {
+    return ThrowCryptoError(env, ERR_get_error(),
+                            "Digest method not supported");
+  }
+
+  Local<Array> inputs = args[1].As<Array>();
+  const size_t count = inputs->Length();
+  if (count * EVP_MD_size(md) > Buffer::kMaxLength)
+    return env->ThrowRangeError("Too many inputs");
+
+  Local<Object> obj = env->NewInternalFieldObject();
+  HashBatchRequest* req = new HashBatchRequest(env, obj, md, count);
+
+  // The caller may change its array once we return, the threadpool reads
+  // the Buffers that were validated here.
+  const bool async = args[2]->IsFunction();
+  Local<Array> buffers;
+  if (async)
+    buffers = Array::New(env->isolate(), count);
+
+  size_t total = 0;
+  for (size_t i = 0; i < count; i++) {
+    Local<Value> input = inputs->Get(env->context(), i).ToLocalChecked();
+    if (!Buffer::HasInstance(input)) {
+      delete req;
+      return env->ThrowTypeError("Data must be an array of buffers");
+    }
+    req->set_input(i, Buffer::Data(input), Buffer::Length(input));
+    total += Buffer::Length(input);
+    if (async)
+      buffers->Set(env->context(), i, input).FromJust();
+  }
+
+  if (async && total >= kHashBatchThreadpoolThreshold) {
+    obj->Set(env->ondone_string(), args[2]);
+    // Keeps the inputs alive while the threadpool reads them
+    obj->Set(env->buffer_string(), buffers);
+
+    if (env->in_domain())
+      obj->Set(env->domain_string(), env->domain_array()->Get(0));
+    uv_queue_work_ex(env->event_loop(),
+                     req->work_req(),
+                     UV_WORK_CRYPTO,
+                     HashBatchWork,
+                     HashBatchAfter);
+    args.GetReturnValue().Set(obj);
+  } else {
+    if (!async)
+      env->PrintSyncTrace();
+    Local<Value> argv[2];
+    req->Run();
+    HashBatchCheck(req, argv);
+    delete req;
+
+    if (!argv[0]->IsNull())
+      env->isolate()->ThrowException(argv[0]);
+    else
+      args.GetReturnValue().Set(argv[1]);
+  }
+}
+
+
 void SignBase::CheckThrow(SignBase::Error error) {
   HandleScope scope(env()->isolate());
 
@@ -5334,10 +6051,11 @@ void PBKDF2(const FunctionCallbackInfo<Value>& args) {
 
     if (env->in_domain())
       obj->Set(env->domain_string(), env->domain_array()->Get(0));
-    uv_queue_work(env->event_loop(),
-                  req->work_req(),
-                  EIO_PBKDF2,
-                  EIO_PBKDF2After);
+    uv_queue_work_ex(env->event_loop(),
+                     req->work_req(),
+                     UV_WORK_CRYPTO,
+                     EIO_PBKDF2,
+                     EIO_PBKDF2After);
   } else {
     env->PrintSyncTrace();
     Local<Value> argv[2];
@@ -5360,19 +6078,203 @@ void PBKDF2(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Serves small random requests from blocks of RAND_bytes() output that are
+// generated ahead of time on the threadpool, which saves them the fixed cost
+// of a call into OpenSSL.
+//
+// Bytes leave the pool once and are wiped from it as they do. The pool is
+// discarded when the process forks, as parent and child would otherwise hand
+// out the same bytes, and when the RNG changes with a new engine or FIPS mode,
+// so that all bytes come from the RNG that is current when they are asked for.
+class RandomPool {
+ public:
+  static const size_t kBlockSize = 64 * 1024;
+  static const size_t kMaxRequest = 1024;
+
+  RandomPool() : current_(nullptr),
+                 spare_(nullptr),
+                 offset_(kBlockSize),
+                 refilling_(false),
+                 generation_(0),
+                 pid_(getpid()) {
+  }
+
+  // Copies len bytes of pooled randomness to out. Returns false when the pool
+  // can't serve them, the caller has to get them from OpenSSL itself then.
+  bool Take(Environment* env, char* out, size_t len);
+  void Discard();
+
+ private:
+  struct RefillRequest {
+    uv_work_t work_req;
+    RandomPool* pool;
+    uint64_t generation;
+    unsigned char* data;
+  };
+
+  void DiscardLocked();
+  void StartRefill(Environment* env);
+  static void RefillWork(uv_work_t* work_req);
+  static void RefillAfter(uv_work_t* work_req, int status);
+
+  Mutex mutex_;
+  unsigned char* current_;  // Block being served
+  unsigned char* spare_;  // Next block, nullptr until refilled
+  size_t offset_;  // Unused bytes of current_ start here
+  bool refilling_;
+  uint64_t generation_;  // Bumped to drop the refill in flight
+  int pid_;
+};
+
+static RandomPool random_pool;
+
+
+bool RandomPool::Take(Environment* env, char* out, size_t len) {
+  if (len > kMaxRequest)
+    return false;
+  if (len == 0)
+    return true;
+
+  Mutex::ScopedLock scoped_lock(mutex_);
+
+  if (pid_ != getpid()) {
+    // Also forgets the refill in flight, the child has no threadpool
+    DiscardLocked();
+    pid_ = getpid();
+  }
+
+  if (kBlockSize - offset_ < len) {
+    if (spare_ == nullptr) {
+      StartRefill(env);
+      return false;
+    }
+    if (current_ != nullptr) {
+      OPENSSL_cleanse(current_ + offset_, kBlockSize - offset_);
+      delete[] current_;
+    }
+    current_ = spare_;
+    spare_ = nullptr;
+    offset_ = 0;
+    StartRefill(env);
+  }
+
+  memcpy(out, current_ + offset_, len);
+  OPENSSL_cleanse(current_ + offset_, len);
+  offset_ += len;
+  return true;
+}
+
+
+void RandomPool::Discard() {
+  Mutex::ScopedLock scoped_lock(mutex_);
+  DiscardLocked();
+}
+
+
+void RandomPool::DiscardLocked() {
+  if (current_ != nullptr) {
+    OPENSSL_cleanse(current_, kBlockSize);
+    delete[] current_;
+    current_ = nullptr;
+  }
+  if (spare_ != nullptr) {
+    OPENSSL_cleanse(spare_, kBlockSize);
+    delete[] spare_;
+    spare_ = nullptr;
+  }
+  offset_ = kBlockSize;
+  refilling_ = false;
+  generation_++;
+}
+
+
+void RandomPool::StartRefill(Environment* env) {
+  if (refilling_ || spare_ != nullptr)
+    return;
+  refilling_ = true;
+
+  RefillRequest* req = new RefillRequest();
+  req->pool = this;
+  req->generation = generation_;
+  req->data = new unsigned char[kBlockSize];
+  uv_queue_work_ex(env->event_loop(),
+                   &req->work_req,
+                   UV_WORK_CRYPTO,
+                   RefillWork,
+                   RefillAfter);
+}
+
+
+void RandomPool::RefillWork(uv_work_t* work_req) {
+  RefillRequest* req = ContainerOf(&RefillRequest::work_req, work_req);
+
+  // Ensure that OpenSSL's PRNG is properly seeded.
+  CheckEntropy();
+
+  if (RAND_bytes(req->data, kBlockSize) != 1) {
+    OPENSSL_cleanse(req->data, kBlockSize);
+    delete[] req->data;
+    req->data = nullptr;
+    ERR_clear_error();
+  }
+}
+
+
+void RandomPool::RefillAfter(uv_work_t* work_req, int status) {
+  CHECK_EQ(status, 0);
+  RefillRequest* req = ContainerOf(&RefillRequest::work_req, work_req);
+  RandomPool* pool = req->pool;
+
+  {
+    Mutex::ScopedLock scoped_lock(pool->mutex_);
+    if (req->generation == pool->generation_) {
+      pool->refilling_ = false;
+      // On failure, requests go to OpenSSL which reports the error
+      pool->spare_ = req->data;
+      req->data = nullptr;
+    }
+  }
+
+  if (req->data != nullptr) {
+    OPENSSL_cleanse(req->data, kBlockSize);
+    delete[] req->data;
+  }
+  delete req;
+}
+
+
 // Only instantiate within a valid HandleScope.
 class RandomBytesRequest : public AsyncWrap {
  public:
+  enum FreeMode {
+    FREE_DATA,
+    DONT_FREE_DATA
+  };
+
   RandomBytesRequest(Environment* env, Local<Object> object, size_t size)
       : AsyncWrap(env, object, AsyncWrap::PROVIDER_CRYPTO),
         error_(0),
         size_(size),
-        data_(static_cast<char*>(node::Malloc(size))) {
+        data_(static_cast<char*>(node::Malloc(size))),
+        free_mode_(FREE_DATA) {
     if (data() == nullptr && size > 0)
       FatalError("node::RandomBytesRequest()", "Out of Memory");
     Wrap(object, this);
   }
 
+  // Fills memory owned by someone else, e.g. a Buffer kept alive by object
+  RandomBytesRequest(Environment* env,
+                     Local<Object> object,
+                     char* data,
+                     size_t size)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_CRYPTO),
+        error_(0),
+        size_(size),
+        data_(data),
+        free_mode_(DONT_FREE_DATA) {
+    Wrap(object, this);
+  }
+
   ~RandomBytesRequest() override {
     ClearWrap(object());
     persistent().Reset();
@@ -5390,8 +6292,14 @@ class RandomBytesRequest : public AsyncWrap {
     return data_;
   }
 
+  inline FreeMode free_mode() const {
+    return free_mode_;
+  }
+
   inline void release() {
-    free(data_);
+    if (free_mode_ == FREE_DATA)
+      free(data_);
+    data_ = nullptr;
     size_ = 0;
   }
 
@@ -5418,6 +6326,7 @@ class RandomBytesRequest : public AsyncWrap {
   unsigned long error_;  // NOLINT(runtime/int)
   size_t size_;
   char* data_;
+  const FreeMode free_mode_;
 };
 
 
@@ -5451,6 +6360,9 @@ void RandomBytesCheck(RandomBytesRequest* req, Local<Value> argv[2]) {
     argv[0] = Exception::Error(OneByteString(req->env()->isolate(), errmsg));
     argv[1] = Null(req->env()->isolate());
     req->release();
+  } else if (req->free_mode() == RandomBytesRequest::DONT_FREE_DATA) {
+    argv[0] = Null(req->env()->isolate());
+    argv[1] = req->object()->Get(req->env()->buffer_string());
   } else {
     char* data = nullptr;
     size_t size;
@@ -5488,6 +6400,20 @@ void RandomBytes(const FunctionCallbackInfo<Value>& args) {
   if (size < 0 || size > Buffer::kMaxLength)
     return env->ThrowRangeError("size is not a valid Smi");
 
+  // Small synchronous requests don't need a request object when the pool
+  // can serve them
+  if (!args[1]->IsFunction() &&
+      static_cast<size_t>(size) <= RandomPool::kMaxRequest) {
+    char* data = static_cast<char*>(node::Malloc(size));
+    CHECK(data != nullptr || size == 0);
+    if (random_pool.Take(env, data, size)) {
+      env->PrintSyncTrace();
+      return args.GetReturnValue().Set(
+          Buffer::New(env, data, size).ToLocalChecked());
+    }
+    free(data);
+  }
+
   Local<Object> obj = env->NewInternalFieldObject();
   RandomBytesRequest* req = new RandomBytesRequest(env, obj, size);
 
@@ -5496,10 +6422,11 @@ void RandomBytes(const FunctionCallbackInfo<Value>& args) {
 
     if (env->in_domain())
       obj->Set(env->domain_string(), env->domain_array()->Get(0));
-    uv_queue_work(env->event_loop(),
-                  req->work_req(),
-                  RandomBytesWork,
-                  RandomBytesAfter);
+    uv_queue_work_ex(env->event_loop(),
+                     req->work_req(),
+                     UV_WORK_CRYPTO,
+                     RandomBytesWork,
+                     RandomBytesAfter);
     args.GetReturnValue().Set(obj);
   } else {
     env->PrintSyncTrace();
@@ -5516,6 +6443,55 @@ void RandomBytes(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Fills the size bytes at offset of a Buffer. Returns true when the request
+// was served right away, the callback isn't invoked in that case.
+void RandomFill(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(Buffer::HasInstance(args[0]));
+  CHECK(args[1]->IsUint32());
+  CHECK(args[2]->IsUint32());
+
+  const size_t offset = args[1]->Uint32Value();
+  const size_t size = args[2]->Uint32Value();
+  CHECK_LE(offset + size, Buffer::Length(args[0]));
+  char* data = Buffer::Data(args[0]) + offset;
+
+  if (!args[3]->IsFunction())
+    env->PrintSyncTrace();
+
+  if (random_pool.Take(env, data, size))
+    return args.GetReturnValue().Set(true);
+
+  Local<Object> obj = env->NewInternalFieldObject();
+  obj->Set(env->buffer_string(), args[0]);
+  RandomBytesRequest* req = new RandomBytesRequest(env, obj, data, size);
+
+  if (args[3]->IsFunction()) {
+    obj->Set(env->ondone_string(), args[3]);
+
+    if (env->in_domain())
+      obj->Set(env->domain_string(), env->domain_array()->Get(0));
+    uv_queue_work_ex(env->event_loop(),
+                     req->work_req(),
+                     UV_WORK_CRYPTO,
+                     RandomBytesWork,
+                     RandomBytesAfter);
+    args.GetReturnValue().Set(false);
+  } else {
+    Local<Value> argv[2];
+    RandomBytesWork(req->work_req());
+    RandomBytesCheck(req, argv);
+    delete req;
+
+    if (!argv[0]->IsNull())
+      env->isolate()->ThrowException(argv[0]);
+    else
+      args.GetReturnValue().Set(true);
+  }
+}
+
+
 void GetSSLCiphers(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -5847,6 +6823,10 @@ void SetEngine(const FunctionCallbackInfo<Value>& args) {
   ENGINE_free(engine);
   if (r == 0)
     return ThrowCryptoError(env, ERR_get_error());
+
+  // Pooled bytes come from the previous RNG
+  if (flags & ENGINE_METHOD_RAND)
+    random_pool.Discard();
 }
 #endif  // !OPENSSL_NO_ENGINE
 
@@ -5869,6 +6849,7 @@ void SetFipsCrypto(const FunctionCallbackInfo<Value>& args) {
     unsigned long err = ERR_get_error();  // NOLINT(runtime/int)
     return ThrowCryptoError(env, err);
   }
+  random_pool.Discard();
 #else
   return env->ThrowError("Cannot set FIPS mode in a non-FIPS build.");
 #endif /* NODE_FIPS_MODE */
@@ -5883,6 +6864,7 @@ void InitCrypto(Local<Object> target,
   uv_once(&init_once, InitCryptoOnce);
 
   Environment* env = Environment::GetCurrent(context);
+  SessionCache::Initialize(env, target);
   SecureContext::Initialize(env, target);
   Connection::Initialize(env, target);
   CipherBase::Initialize(env, target);
@@ -5903,6 +6885,9 @@ void InitCrypto(Local<Object> target,
   env->SetMethod(target, "setFipsCrypto", SetFipsCrypto);
   env->SetMethod(target, "PBKDF2", PBKDF2);
   env->SetMethod(target, "randomBytes", RandomBytes);
+  env->SetMethod(target, "randomFill", RandomFill);
+  env->SetMethod(target, "hash", OneShotDigest);
+  env->SetMethod(target, "hashBatch", HashBatch);
   env->SetMethod(target, "getSSLCiphers", GetSSLCiphers);
   env->SetMethod(target, "getCiphers", GetCiphers);
   env->SetMethod(target, "getHashes", GetHashes);
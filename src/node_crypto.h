@@ -32,6 +32,11 @@
 #include <openssl/rand.h>
 #include <openssl/pkcs12.h>
 
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #define EVP_F_EVP_DECRYPTFINAL 101
 
 #if !defined(OPENSSL_NO_TLSEXT) && defined(SSL_CTX_set_tlsext_status_cb)
@@ -68,6 +73,66 @@ extern X509_STORE* root_cert_store;
 // Forward declaration
 class Connection;
 
+// Size-bounded LRU cache of server sessions, keyed by session id. Any number
+// of SecureContexts can share one, OpenSSL consults it directly without going
+// through JS land.
+class SessionCache : public BaseObject {
+ public:
+  ~SessionCache() override {
+    Clear();
+  }
+
+  static void Initialize(Environment* env, v8::Local<v8::Object> target);
+
+  // Takes over the reference to |sess|
+  void Add(SSL_SESSION* sess);
+  // Doesn't add a reference to the session
+  SSL_SESSION* Get(const unsigned char* id, int len);
+  void Clear();
+
+  static const uint32_t kDefaultMaxEntries = 20 * 1024;
+  static const uint32_t kDefaultTimeout = 300;  // Seconds
+
+ protected:
+  struct Entry {
+    std::string id;
+    SSL_SESSION* sess;
+    uint64_t expires;  // uv_now() based
+  };
+
+  typedef std::list<Entry> EntryList;
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetStats(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Clear(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  void Remove(EntryList::iterator it);
+
+  SessionCache(Environment* env,
+               v8::Local<v8::Object> wrap,
+               uint32_t max_entries,
+               uint32_t timeout)
+      : BaseObject(env, wrap),
+        max_entries_(max_entries),
+        timeout_(timeout),
+        hits_(0),
+        misses_(0),
+        evictions_(0),
+        expired_(0) {
+    MakeWeak<SessionCache>(this);
+  }
+
+ private:
+  const uint32_t max_entries_;
+  const uint32_t timeout_;
+  EntryList entries_;  // Most recently used first
+  std::unordered_map<std::string, EntryList::iterator> index_;
+  uint64_t hits_;
+  uint64_t misses_;
+  uint64_t evictions_;
+  uint64_t expired_;
+};
+
 class SecureContext : public BaseObject {
  public:
   ~SecureContext() override {
@@ -80,6 +145,7 @@ class SecureContext : public BaseObject {
   SSL_CTX* ctx_;
   X509* cert_;
   X509* issuer_;
+  SessionCache* session_cache_;
 
   static const int kMaxSessionSize = 10 * 1024;
 
@@ -108,6 +174,7 @@ class SecureContext : public BaseObject {
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetSessionTimeout(
       const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetSessionCache(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Close(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void LoadPKCS12(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetTicketKeys(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -122,19 +189,43 @@ class SecureContext : public BaseObject {
   template <bool primary>
   static void GetCertificate(const v8::FunctionCallbackInfo<v8::Value>& args);
 
+  // Keeps session_cache_ alive
+  v8::Persistent<v8::Object> session_cache_object_;
+
   static int TicketKeyCallback(SSL* ssl,
                                unsigned char* name,
                                unsigned char* iv,
                                EVP_CIPHER_CTX* ectx,
                                HMAC_CTX* hctx,
                                int enc);
+  static int TicketKeyRingCallback(SSL* ssl,
+                                   unsigned char* name,
+                                   unsigned char* iv,
+                                   EVP_CIPHER_CTX* ectx,
+                                   HMAC_CTX* hctx,
+                                   int enc);
+
+  // Same layout as the 48 bytes of SSL_CTX_set_tlsext_ticket_keys()
+  struct TicketKey {
+    unsigned char name[16];
+    unsigned char hmac_key[16];
+    unsigned char aes_key[16];
+  };
+
+  // The first key encrypts new tickets, all of them decrypt
+  std::vector<TicketKey> ticket_keys_;
+  // Set by EnableTicketKeyCallback(), JS land then handles the ticket keys
+  // and ticket_keys_ is not used
+  bool ticket_key_callback_;
 
   SecureContext(Environment* env, v8::Local<v8::Object> wrap)
       : BaseObject(env, wrap),
         ca_store_(nullptr),
         ctx_(nullptr),
         cert_(nullptr),
-        issuer_(nullptr) {
+        issuer_(nullptr),
+        session_cache_(nullptr),
+        ticket_key_callback_(false) {
     MakeWeak<SecureContext>(this);
     env->isolate()->AdjustAmountOfExternalAllocatedMemory(kExternalSize);
   }
@@ -158,6 +249,8 @@ class SecureContext : public BaseObject {
       ca_store_ = nullptr;
       cert_ = nullptr;
       issuer_ = nullptr;
+      session_cache_ = nullptr;
+      session_cache_object_.Reset();
     } else {
       CHECK_EQ(ca_store_, nullptr);
     }
@@ -182,7 +275,9 @@ class SSLWrap {
         new_session_wait_(false),
         cert_cb_(nullptr),
         cert_cb_arg_(nullptr),
-        cert_cb_running_(false) {
+        cert_cb_running_(false),
+        async_key_ops_(false),
+        key_op_(kKeyOpNone) {
     ssl_ = SSL_new(sc->ctx_);
     env_->isolate()->AdjustAmountOfExternalAllocatedMemory(kExternalSize);
     CHECK_NE(ssl_, nullptr);
@@ -210,10 +305,20 @@ class SSLWrap {
   inline bool is_client() const { return kind_ == kClient; }
   inline bool is_waiting_new_session() const { return new_session_wait_; }
   inline bool is_waiting_cert_cb() const { return cert_cb_ != nullptr; }
+  inline void enable_async_key_ops() { async_key_ops_ = true; }
 
  protected:
   typedef void (*CertCb)(void* arg);
 
+  // Server handshakes in the async key operation mode are suspended once the
+  // certificate is settled, the owner of the SSL object then runs the rest of
+  // the handshake step, which signs with the private key, on the threadpool.
+  enum KeyOpState {
+    kKeyOpNone,
+    kKeyOpWanted,  // Suspended, waiting for StartKeyOp()
+    kKeyOpRunning  // Between StartKeyOp() and FinishKeyOp()
+  };
+
   // Size allocated by OpenSSL: one for SSL structure, one for SSL3_STATE and
   // some for buffers.
   // NOTE: Actually it is much more than this
@@ -289,6 +394,9 @@ class SSLWrap {
 
   void DestroySSL();
   void WaitForCertCb(CertCb cb, void* arg);
+  int SuspendForKeyOp();
+  void StartKeyOp();
+  void FinishKeyOp();
   void SetSNIContext(SecureContext* sc);
   int SetCACerts(SecureContext* sc);
 
@@ -308,6 +416,14 @@ class SSLWrap {
   void* cert_cb_arg_;
   bool cert_cb_running_;
 
+  // The callbacks of a handshake step that runs on the threadpool can't touch
+  // JS land, they use copies made by StartKeyOp() instead.
+  bool async_key_ops_;
+  KeyOpState key_op_;
+  std::string key_op_npn_;
+  std::string key_op_alpn_;
+  std::string key_op_ocsp_;
+
   ClientHelloParser hello_parser_;
 
 #ifdef NODE__HAVE_TLSEXT_STATUS_CB
@@ -450,6 +566,7 @@ class CipherBase : public BaseObject {
   static void Init(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void InitIv(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Update(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void UpdateAsync(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Final(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetAutoPadding(const v8::FunctionCallbackInfo<v8::Value>& args);
 
@@ -465,17 +582,21 @@ class CipherBase : public BaseObject {
         initialised_(false),
         kind_(kind),
         auth_tag_(nullptr),
-        auth_tag_len_(0) {
+        auth_tag_len_(0),
+        pending_(false) {
     MakeWeak<CipherBase>(this);
   }
 
  private:
+  class UpdateRequest;
+
   EVP_CIPHER_CTX ctx_; /* coverity[member_decl] */
   const EVP_CIPHER* cipher_; /* coverity[member_decl] */
   bool initialised_;
   CipherKind kind_;
   char* auth_tag_;
   unsigned int auth_tag_len_;
+  bool pending_;  // An UpdateRequest owns the context
 };
 
 class Hmac : public BaseObject {
@@ -48,6 +48,15 @@ void NodeBIO::AssignEnvironment(Environment* env) {
 }
 
 
+void NodeBIO::set_off_thread(bool off_thread) {
+  off_thread_ = off_thread;
+  if (!off_thread_ && external_memory_ != 0) {
+    env_->isolate()->AdjustAmountOfExternalAllocatedMemory(external_memory_);
+    external_memory_ = 0;
+  }
+}
+
+
 int NodeBIO::New(BIO* bio) {
   bio->ptr = new NodeBIO();
 
@@ -297,6 +306,27 @@ void NodeBIO::FreeEmpty() {
 }
 
 
+size_t NodeBIO::Copy(char* out, size_t size) const {
+  size_t copied = 0;
+  size_t max = Length() > size ? size : Length();
+  Buffer* current = read_head_;
+
+  while (copied < max) {
+    CHECK_LE(current->read_pos_, current->write_pos_);
+    size_t avail = current->write_pos_ - current->read_pos_;
+    if (avail > max - copied)
+      avail = max - copied;
+
+    memcpy(out + copied, current->data_ + current->read_pos_, avail);
+    copied += avail;
+
+    current = current->next_;
+  }
+
+  return copied;
+}
+
+
 size_t NodeBIO::IndexOf(char delim, size_t limit) {
   size_t bytes_read = 0;
   size_t max = Length() > limit ? limit : Length();
@@ -421,7 +451,7 @@ void NodeBIO::TryAllocateForWrite(size_t hint) {
                              kThroughputBufferLength;
     if (len < hint)
       len = hint;
-    Buffer* next = new Buffer(env_, len);
+    Buffer* next = new Buffer(this, len);
 
     if (w == nullptr) {
       next->next_ = next;
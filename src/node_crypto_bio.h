@@ -17,6 +17,9 @@ class NodeBIO {
   NodeBIO() : env_(nullptr),
               initial_(kInitialBufferLength),
               length_(0),
+              allocated_(0),
+              off_thread_(false),
+              external_memory_(0),
               read_head_(nullptr),
               write_head_(nullptr) {
   }
@@ -31,6 +34,11 @@ class NodeBIO {
 
   void AssignEnvironment(Environment* env);
 
+  // While set, the BIO may be used from another thread and changes in
+  // memory usage are reported to V8 only once it's cleared again.  Must be
+  // called on the main thread.
+  void set_off_thread(bool off_thread);
+
   // Move read head to next buffer if needed
   void TryMoveReadHead();
 
@@ -52,6 +60,10 @@ class NodeBIO {
   // reading
   size_t PeekMultiple(char** out, size_t* size, size_t* count);
 
+  // Copy up to `size` bytes from the start of the buffer into `out` without
+  // consuming them, return the number of copied bytes
+  size_t Copy(char* out, size_t size) const;
+
   // Find first appearance of `delim` in buffer or `limit` if `delim`
   // wasn't found.
   size_t IndexOf(char delim, size_t limit);
@@ -75,6 +87,11 @@ class NodeBIO {
     return length_;
   }
 
+  // Return the memory held by the buffer in bytes, used or not
+  inline size_t Allocated() const {
+    return allocated_;
+  }
+
   inline void set_initial(size_t initial) {
     initial_ = initial;
   }
@@ -100,26 +117,37 @@ class NodeBIO {
 
   static const BIO_METHOD method;
 
+  inline void AdjustExternalMemory(int64_t change) {
+    if (off_thread_)
+      external_memory_ += change;
+    else
+      env_->isolate()->AdjustAmountOfExternalAllocatedMemory(change);
+  }
+
   class Buffer {
    public:
-    Buffer(Environment* env, size_t len) : env_(env),
-                                           read_pos_(0),
-                                           write_pos_(0),
-                                           len_(len),
-                                           next_(nullptr) {
+    Buffer(NodeBIO* bio, size_t len) : bio_(bio),
+                                       env_(bio->env_),
+                                       read_pos_(0),
+                                       write_pos_(0),
+                                       len_(len),
+                                       next_(nullptr) {
       data_ = new char[len];
+      bio_->allocated_ += len;
       if (env_ != nullptr)
-        env_->isolate()->AdjustAmountOfExternalAllocatedMemory(len);
+        bio_->AdjustExternalMemory(len);
     }
 
     ~Buffer() {
       delete[] data_;
+      bio_->allocated_ -= len_;
       if (env_ != nullptr) {
         const int64_t len = static_cast<int64_t>(len_);
-        env_->isolate()->AdjustAmountOfExternalAllocatedMemory(-len);
+        bio_->AdjustExternalMemory(-len);
       }
     }
 
+    NodeBIO* bio_;
     Environment* env_;
     size_t read_pos_;
     size_t write_pos_;
@@ -131,6 +159,9 @@ class NodeBIO {
   Environment* env_;
   size_t initial_;
   size_t length_;
+  size_t allocated_;
+  bool off_thread_;
+  int64_t external_memory_;
   Buffer* read_head_;
   Buffer* write_head_;
 };
@@ -22,6 +22,8 @@
 # include <io.h>
 #endif
 
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace node {
@@ -34,10 +36,14 @@ using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::HandleScope;
 using v8::Integer;
+using v8::Isolate;
+using v8::JSON;
 using v8::Local;
+using v8::Null;
 using v8::Number;
 using v8::Object;
 using v8::String;
+using v8::TryCatch;
 using v8::Value;
 
 #ifndef MIN
@@ -534,85 +540,418 @@ Local<Value> BuildStatsObject(Environment* env, const uv_stat_t* s) {
   return handle_scope.Escape(stats);
 }
 
-// Used to speed up module loading.  Returns the contents of the file as
-// a string or undefined when the file cannot be opened.  The speedup
-// comes from not creating Error objects on failure.
-static void InternalModuleReadFile(const FunctionCallbackInfo<Value>& args) {
-  Environment* env = Environment::GetCurrent(args);
-  uv_loop_t* loop = env->event_loop();
-
-  CHECK(args[0]->IsString());
-  node::Utf8Value path(env->isolate(), args[0]);
-
+// Reads the file at path for the module loader.  Regular files are read
+// with a single read() sized by fstat().  Returns false when the file can't
+// be opened or read, otherwise *data is malloc'd and owned by the caller.
+static bool ReadModuleFile(uv_loop_t* loop,
+                           const char* path,
+                           char** data,
+                           size_t* size) {
   uv_fs_t open_req;
-  const int fd = uv_fs_open(loop, &open_req, *path, O_RDONLY, 0, nullptr);
+  const int fd = uv_fs_open(loop, &open_req, path, O_RDONLY, 0, nullptr);
   uv_fs_req_cleanup(&open_req);
 
   if (fd < 0) {
-    return;
+    return false;
+  }
+
+  const size_t kBlockSize = 32 << 10;
+  size_t capacity = kBlockSize;
+  bool is_regular_file = false;
+  uv_fs_t stat_req;
+  if (uv_fs_fstat(loop, &stat_req, fd, nullptr) == 0 &&
+      (stat_req.statbuf.st_mode & S_IFMT) == S_IFREG) {
+    // One extra byte so that a file that grew since the fstat() is detected
+    // without having to issue another read() to find EOF.
+    capacity = stat_req.statbuf.st_size + 1;
+    is_regular_file = true;
   }
+  uv_fs_req_cleanup(&stat_req);
 
-  std::vector<char> chars;
+  char* chars = static_cast<char*>(node::Malloc(capacity));
+  CHECK_NE(chars, nullptr);
+  size_t length = 0;
   int64_t offset = 0;
   for (;;) {
-    const size_t kBlockSize = 32 << 10;
-    const size_t start = chars.size();
-    chars.resize(start + kBlockSize);
-
-    uv_buf_t buf;
-    buf.base = &chars[start];
-    buf.len = kBlockSize;
+    uv_buf_t buf = uv_buf_init(chars + length, capacity - length);
 
     uv_fs_t read_req;
     const ssize_t numchars =
         uv_fs_read(loop, &read_req, fd, &buf, 1, offset, nullptr);
     uv_fs_req_cleanup(&read_req);
 
-    CHECK_GE(numchars, 0);
-    if (static_cast<size_t>(numchars) < kBlockSize) {
-      chars.resize(start + numchars);
-    }
-    if (numchars == 0) {
+    if (numchars < 0) {
+      // E.g. EISDIR, let the caller deal with it.
+      free(chars);
+      chars = nullptr;
       break;
     }
+    length += numchars;
     offset += numchars;
+    if (numchars == 0 || (is_regular_file && length < capacity)) {
+      break;
+    }
+    if (length < capacity) {
+      continue;
+    }
+
+    capacity += kBlockSize;
+    chars = static_cast<char*>(node::Realloc(chars, capacity));
+    CHECK_NE(chars, nullptr);
   }
 
   uv_fs_t close_req;
   CHECK_EQ(0, uv_fs_close(loop, &close_req, fd, nullptr));
   uv_fs_req_cleanup(&close_req);
 
+  if (chars == nullptr) {
+    return false;
+  }
+
+  *data = chars;
+  *size = length;
+  return true;
+}
+
+
+// Turns the contents of a file read by ReadModuleFile() into a string and
+// takes ownership of data.  Pure ASCII, which is the norm for JS sources,
+// becomes an external string without further copying.
+static Local<String> ModuleFileToString(Isolate* isolate,
+                                        char* data,
+                                        size_t length) {
   size_t start = 0;
-  if (chars.size() >= 3 && 0 == memcmp(&chars[0], "\xEF\xBB\xBF", 3)) {
+  if (length >= 3 && 0 == memcmp(data, "\xEF\xBB\xBF", 3)) {
     start = 3;  // Skip UTF-8 BOM.
   }
 
-  Local<String> chars_string =
-      String::NewFromUtf8(env->isolate(),
-                          &chars[start],
-                          String::kNormalString,
-                          chars.size() - start);
-  args.GetReturnValue().Set(chars_string);
+  if (!StringBytes::ContainsNonAscii(data + start, length - start)) {
+    if (start > 0)
+      memmove(data, data + start, length - start);
+    return StringBytes::NewExternalOneByte(isolate, data, length - start);
+  }
+
+  Local<String> string = String::NewFromUtf8(isolate,
+                                             data + start,
+                                             String::kNormalString,
+                                             length - start);
+  free(data);
+  return string;
 }
 
-// Used to speed up module loading.  Returns 0 if the path refers to
-// a file, 1 when it's a directory or < 0 on error (usually -ENOENT.)
-// The speedup comes from not creating thousands of Stat and Error objects.
-static void InternalModuleStat(const FunctionCallbackInfo<Value>& args) {
+
+// Used to speed up module loading.  Returns the contents of the file as
+// a string or undefined when the file cannot be opened.  The speedup
+// comes from not creating Error objects on failure.
+static void InternalModuleReadFile(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
   CHECK(args[0]->IsString());
   node::Utf8Value path(env->isolate(), args[0]);
 
+  char* data;
+  size_t length;
+  if (!ReadModuleFile(env->event_loop(), *path, &data, &length)) {
+    return;
+  }
+
+  args.GetReturnValue().Set(ModuleFileToString(env->isolate(), data, length));
+}
+
+
+// Results of ModuleStat(), see InternalModuleStatCache().  nullptr when
+// caching is off.
+static std::unordered_map<std::string, int>* module_stat_cache;
+
+// package.json "main" fields by directory, an empty string when there is no
+// usable one.  Like packageMainCache in lib/module.js this is never flushed.
+static std::unordered_map<std::string, std::string>* package_main_cache;
+
+
+// Returns 0 if the path refers to a file, 1 when it's a directory or < 0 on
+// error (usually -ENOENT.)
+static int ModuleStat(uv_loop_t* loop, const std::string& path) {
+  if (module_stat_cache != nullptr) {
+    auto it = module_stat_cache->find(path);
+    if (it != module_stat_cache->end())
+      return it->second;
+  }
+
   uv_fs_t req;
-  int rc = uv_fs_stat(env->event_loop(), &req, *path, nullptr);
+  int rc = uv_fs_stat(loop, &req, path.c_str(), nullptr);
   if (rc == 0) {
     const uv_stat_t* const s = static_cast<const uv_stat_t*>(req.ptr);
     rc = !!(s->st_mode & S_IFDIR);
   }
   uv_fs_req_cleanup(&req);
 
-  args.GetReturnValue().Set(rc);
+  if (module_stat_cache != nullptr)
+    module_stat_cache->emplace(path, rc);
+  return rc;
+}
+
+
+// Used to speed up module loading.  Returns 0 if the path refers to
+// a file, 1 when it's a directory or < 0 on error (usually -ENOENT.)
+// The speedup comes from not creating thousands of Stat and Error objects.
+static void InternalModuleStat(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsString());
+  node::Utf8Value path(env->isolate(), args[0]);
+
+  args.GetReturnValue().Set(
+      ModuleStat(env->event_loop(), std::string(*path, path.length())));
+}
+
+
+// internalModuleStatCache(enable)
+//
+// Starts caching the results of internalModuleStat() and
+// internalModuleResolve(), dropping whatever was cached before.  The module
+// loader turns the cache on for the duration of a top-level require() so
+// that files added afterwards are still found.
+static void InternalModuleStatCache(const FunctionCallbackInfo<Value>& args) {
+  delete module_stat_cache;
+  module_stat_cache = nullptr;
+  if (args[0]->IsTrue())
+    module_stat_cache = new std::unordered_map<std::string, int>();
+}
+
+
+// Implements the file system part of Module._findPath() in lib/module.js.
+class ModuleResolver {
+ public:
+  ModuleResolver(Environment* env, Local<Array> exts, Local<Function> resolve)
+      : env_(env), resolve_(resolve), fallback_(false) {
+    for (uint32_t i = 0; i < exts->Length(); i++) {
+      node::Utf8Value ext(env->isolate(), exts->Get(i));
+      exts_.emplace_back(*ext, ext.length());
+    }
+  }
+
+  // Set when something came up that lib/module.js has to handle itself,
+  // like a package.json that doesn't parse.
+  bool fallback() const { return fallback_; }
+
+  bool TryFile(const std::string& path, std::string* filename) {
+    if (Stat(path) != 0)
+      return false;
+    *filename = path;
+    return true;
+  }
+
+  bool TryExtensions(const std::string& path, std::string* filename) {
+    for (const std::string& ext : exts_) {
+      if (TryFile(path + ext, filename))
+        return true;
+    }
+    return false;
+  }
+
+  bool TryPackage(const std::string& path, std::string* filename) {
+    std::string main;
+    if (!ReadPackageMain(path, &main) || main.empty())
+      return false;
+
+    // Resolve the same way as lib/module.js does.
+    Isolate* isolate = env_->isolate();
+    Local<Value> argv[] = {
+      String::NewFromUtf8(isolate, path.data(), String::kNormalString,
+                          path.size()),
+      String::NewFromUtf8(isolate, main.data(), String::kNormalString,
+                          main.size())
+    };
+    Local<Value> resolved;
+    if (!resolve_->Call(env_->context(), Null(isolate), arraysize(argv), argv)
+             .ToLocal(&resolved) ||
+        !resolved->IsString()) {
+      fallback_ = true;
+      return false;
+    }
+
+    node::Utf8Value resolved_path(isolate, resolved);
+    const std::string base(*resolved_path, resolved_path.length());
+    return TryFile(base, filename) ||
+           TryExtensions(base, filename) ||
+           TryExtensions(Join(base, "index"), filename);
+  }
+
+  int Stat(const std::string& path) {
+    return ModuleStat(env_->event_loop(), MakeLong(path));
+  }
+
+  static std::string Join(const std::string& dir, const char* name) {
+    if (!dir.empty() && IsPathSeparator(dir.back()))
+      return dir + name;
+    return dir + kPathSeparator + name;
+  }
+
+ private:
+#ifdef _WIN32
+  static const char kPathSeparator = '\\';
+  static bool IsPathSeparator(char c) { return c == '\\' || c == '/'; }
+#else
+  static const char kPathSeparator = '/';
+  static bool IsPathSeparator(char c) { return c == '/'; }
+#endif
+
+  // Counterpart of path._makeLong().
+  static std::string MakeLong(const std::string& path) {
+#ifdef _WIN32
+    if (path.size() >= 3) {
+      if (path[0] == '\\' && path[1] == '\\' &&
+          path[2] != '?' && path[2] != '.') {
+        return "\\\\?\\UNC\\" + path.substr(2);
+      }
+      if (((path[0] >= 'A' && path[0] <= 'Z') ||
+           (path[0] >= 'a' && path[0] <= 'z')) &&
+          path[1] == ':' && path[2] == '\\') {
+        return "\\\\?\\" + path;
+      }
+    }
+#endif
+    return path;
+  }
+
+  // Looks up the "main" field of path/package.json.  Returns false if there
+  // is no package.json; main is empty if it has no usable "main" field.
+  bool ReadPackageMain(const std::string& path, std::string* main) {
+    if (package_main_cache != nullptr) {
+      auto it = package_main_cache->find(path);
+      if (it != package_main_cache->end()) {
+        *main = it->second;
+        return true;
+      }
+    }
+
+    const std::string json_path = MakeLong(Join(path, "package.json"));
+    char* data;
+    size_t length;
+    if (!ReadModuleFile(env_->event_loop(), json_path.c_str(), &data, &length))
+      return false;
+
+    Isolate* isolate = env_->isolate();
+    TryCatch try_catch(isolate);
+    Local<String> json = ModuleFileToString(isolate, data, length);
+    Local<Value> pkg;
+    if (json.IsEmpty() || !JSON::Parse(isolate, json).ToLocal(&pkg) ||
+        pkg->IsNull() || pkg->IsUndefined()) {
+      // Let lib/module.js throw a proper error.
+      fallback_ = true;
+      return false;
+    }
+
+    main->clear();
+    if (pkg->IsObject()) {
+      Local<Value> value;
+      if (!pkg.As<Object>()->Get(env_->context(),
+                                 FIXED_ONE_BYTE_STRING(isolate, "main"))
+               .ToLocal(&value)) {
+        fallback_ = true;
+        return false;
+      }
+      if (value->IsString()) {
+        node::Utf8Value value_string(isolate, value);
+        main->assign(*value_string, value_string.length());
+      } else if (value->BooleanValue()) {
+        // path.resolve() throws for those.
+        fallback_ = true;
+        return false;
+      }
+    }
+
+    if (package_main_cache == nullptr)
+      package_main_cache = new std::unordered_map<std::string, std::string>();
+    package_main_cache->emplace(path, *main);
+    return true;
+  }
+
+  Environment* const env_;
+  Local<Function> resolve_;
+  std::vector<std::string> exts_;
+  bool fallback_;
+};
+
+
+// internalModuleResolve(basePaths, lookupPaths, exts, trailingSlash, resolve)
+//
+// Does the file system work of Module._findPath() in one call: for every
+// lookup path, skipped when it isn't a directory, it tries the resolved
+// base path as a file, as a package and with each extension, and finally
+// base/index with each extension.  resolve is path.resolve() and is used
+// for package.json "main" fields.
+//
+// Returns [index, filename] on success, undefined if there is no match and
+// null when lib/module.js has to redo the lookup itself, e.g. to report a
+// broken package.json.
+static void InternalModuleResolve(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+
+  CHECK(args[0]->IsArray());
+  CHECK(args[1]->IsArray());
+  CHECK(args[2]->IsArray());
+  CHECK(args[4]->IsFunction());
+
+  Local<Array> base_paths = args[0].As<Array>();
+  Local<Array> lookup_paths = args[1].As<Array>();
+  const bool trailing_slash = args[3]->IsTrue();
+  ModuleResolver resolver(env,
+                          args[2].As<Array>(),
+                          args[4].As<Function>());
+
+  const uint32_t count = base_paths->Length();
+  CHECK_EQ(count, lookup_paths->Length());
+
+  std::string filename;
+  for (uint32_t i = 0; i < count; i++) {
+    // Don't search further if the lookup path doesn't exist.
+    Local<Value> lookup_path = lookup_paths->Get(i);
+    if (lookup_path->IsString() && lookup_path.As<String>()->Length() > 0) {
+      node::Utf8Value dir(isolate, lookup_path);
+      if (resolver.Stat(std::string(*dir, dir.length())) < 1)
+        continue;
+    }
+
+    node::Utf8Value base_value(isolate, base_paths->Get(i));
+    const std::string base(*base_value, base_value.length());
+    bool found = false;
+
+    if (!trailing_slash) {
+      const int rc = resolver.Stat(base);
+      if (rc == 0) {
+        filename = base;
+        found = true;
+      } else if (rc == 1) {
+        found = resolver.TryPackage(base, &filename);
+      }
+
+      if (!found && !resolver.fallback())
+        found = resolver.TryExtensions(base, &filename);
+    }
+
+    if (!found && !resolver.fallback())
+      found = resolver.TryPackage(base, &filename);
+
+    if (!found && !resolver.fallback()) {
+      found = resolver.TryExtensions(ModuleResolver::Join(base, "index"),
+                                     &filename);
+    }
+
+    if (resolver.fallback())
+      return args.GetReturnValue().SetNull();
+
+    if (found) {
+      Local<Array> result = Array::New(isolate, 2);
+      result->Set(0, Integer::NewFromUnsigned(isolate, i));
+      result->Set(1, String::NewFromUtf8(isolate,
+                                         filename.data(),
+                                         String::kNormalString,
+                                         filename.size()));
+      return args.GetReturnValue().Set(result);
+    }
+  }
 }
 
 static void Stat(const FunctionCallbackInfo<Value>& args) {
@@ -1507,6 +1846,8 @@ void InitFs(Local<Object> target,
   env->SetMethod(target, "readdir", ReadDir);
   env->SetMethod(target, "internalModuleReadFile", InternalModuleReadFile);
   env->SetMethod(target, "internalModuleStat", InternalModuleStat);
+  env->SetMethod(target, "internalModuleStatCache", InternalModuleStatCache);
+  env->SetMethod(target, "internalModuleResolve", InternalModuleResolve);
   env->SetMethod(target, "stat", Stat);
   env->SetMethod(target, "lstat", LStat);
   env->SetMethod(target, "fstat", FStat);
@@ -39,7 +39,9 @@ using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::HandleScope;
 using v8::Integer;
+using v8::Isolate;
 using v8::Local;
+using v8::NewStringType;
 using v8::Object;
 using v8::String;
 using v8::Uint32;
@@ -69,6 +71,89 @@ const uint32_t kOnExecute = 4;
   int name##_(const char* at, size_t length)
 
 
+// How repeated headers are combined, this must match the rules in
+// IncomingMessage.prototype._addHeaderLine() in lib/_http_incoming.js.
+enum HeaderMerge {
+  kMergeJoin,  // Comma-separated list.
+  kMergeFirst,  // Duplicates are dropped.
+  kMergeArray  // Array of values, only used for set-cookie.
+};
+
+
+struct KnownHeader {
+  const char* name;  // Lowercase.
+  size_t length;
+  HeaderMerge merge;
+};
+
+
+// Header names that are common enough to be worth interning.  Names that
+// aren't listed here are lowercased and merged with kMergeJoin.
+#define KNOWN_HEADERS(V)                                                      \
+  V("accept", kMergeJoin)                                                     \
+  V("accept-charset", kMergeJoin)                                             \
+  V("accept-encoding", kMergeJoin)                                            \
+  V("accept-language", kMergeJoin)                                            \
+  V("accept-ranges", kMergeJoin)                                              \
+  V("age", kMergeFirst)                                                       \
+  V("authorization", kMergeFirst)                                             \
+  V("cache-control", kMergeJoin)                                              \
+  V("connection", kMergeJoin)                                                 \
+  V("content-encoding", kMergeJoin)                                           \
+  V("content-length", kMergeFirst)                                            \
+  V("content-type", kMergeFirst)                                              \
+  V("cookie", kMergeJoin)                                                     \
+  V("date", kMergeJoin)                                                       \
+  V("etag", kMergeFirst)                                                      \
+  V("expect", kMergeJoin)                                                     \
+  V("expires", kMergeFirst)                                                   \
+  V("from", kMergeFirst)                                                      \
+  V("host", kMergeFirst)                                                      \
+  V("if-modified-since", kMergeFirst)                                         \
+  V("if-none-match", kMergeJoin)                                              \
+  V("if-unmodified-since", kMergeFirst)                                       \
+  V("keep-alive", kMergeJoin)                                                 \
+  V("last-modified", kMergeFirst)                                             \
+  V("location", kMergeFirst)                                                  \
+  V("max-forwards", kMergeFirst)                                              \
+  V("origin", kMergeJoin)                                                     \
+  V("pragma", kMergeJoin)                                                     \
+  V("proxy-authorization", kMergeFirst)                                       \
+  V("range", kMergeJoin)                                                      \
+  V("referer", kMergeFirst)                                                   \
+  V("retry-after", kMergeFirst)                                               \
+  V("server", kMergeFirst)                                                    \
+  V("set-cookie", kMergeArray)                                                \
+  V("transfer-encoding", kMergeJoin)                                          \
+  V("upgrade", kMergeJoin)                                                    \
+  V("user-agent", kMergeFirst)                                                \
+  V("vary", kMergeJoin)                                                       \
+  V("via", kMergeJoin)                                                        \
+  V("x-forwarded-for", kMergeJoin)                                            \
+  V("x-forwarded-proto", kMergeJoin)                                          \
+  V("x-requested-with", kMergeJoin)                                           \
+
+static const KnownHeader known_headers[] = {
+#define V(name, merge) { name, sizeof(name) - 1, merge },
+  KNOWN_HEADERS(V)
+#undef V
+};
+
+#undef KNOWN_HEADERS
+
+
+static const KnownHeader* LookupKnownHeader(const char* name, size_t length) {
+  for (size_t i = 0; i < arraysize(known_headers); i++) {
+    const KnownHeader* header = &known_headers[i];
+    if (header->length == length &&
+        StringEqualNoCaseN(header->name, name, length)) {
+      return header;
+    }
+  }
+  return nullptr;
+}
+
+
 // helper class for the Parser
 struct StringPtr {
   StringPtr() {
@@ -135,6 +220,16 @@ struct StringPtr {
   }
 
 
+  Local<String> ToInternalizedString(Environment* env) const {
+    if (str_ == nullptr)
+      return String::Empty(env->isolate());
+    return String::NewFromOneByte(env->isolate(),
+                                  reinterpret_cast<const uint8_t*>(str_),
+                                  NewStringType::kInternalized,
+                                  size_).ToLocalChecked();
+  }
+
+
   const char* str_;
   bool on_heap_;
   size_t size_;
@@ -235,6 +330,7 @@ class Parser : public AsyncWrap {
       A_STATUS_MESSAGE,
       A_UPGRADE,
       A_SHOULD_KEEP_ALIVE,
+      A_HEADERS_OBJECT,
       A_MAX
     };
 
@@ -254,7 +350,15 @@ class Parser : public AsyncWrap {
       Flush();
     } else {
       // Fast case, pass headers and URL to JS land.
-      argv[A_HEADERS] = CreateHeaders();
+      if (native_headers_) {
+        Local<Array> raw;
+        Local<Object> headers;
+        CreateNativeHeaders(&raw, &headers);
+        argv[A_HEADERS] = raw;
+        argv[A_HEADERS_OBJECT] = headers;
+      } else {
+        argv[A_HEADERS] = CreateHeaders();
+      }
       if (parser_.type == HTTP_REQUEST)
         argv[A_URL] = url_.ToString(env());
     }
@@ -458,6 +562,14 @@ class Parser : public AsyncWrap {
   }
 
 
+  // parser.useNativeHeaders(flag)
+  static void UseNativeHeaders(const FunctionCallbackInfo<Value>& args) {
+    Parser* parser;
+    ASSIGN_OR_RETURN_UNWRAP(&parser, args.Holder());
+    parser->native_headers_ = args[0]->IsTrue();
+  }
+
+
   template <bool should_pause>
   static void Pause(const FunctionCallbackInfo<Value>& args) {
     Environment* env = Environment::GetCurrent(args);
@@ -661,6 +773,93 @@ class Parser : public AsyncWrap {
   }
 
 
+  // Builds both the `rawHeaders` array and the lowercased `headers` object
+  // of an IncomingMessage.  Known header names are interned, and repeated
+  // headers are merged with the same rules that JS land applies.
+  void CreateNativeHeaders(Local<Array>* raw_out, Local<Object>* headers_out) {
+    Isolate* isolate = env()->isolate();
+    Local<Array> raw = Array::New(isolate, num_values_ * 2);
+    Local<Object> headers = Object::New(isolate);
+
+    Local<String> keys[arraysize(fields_)];
+    Local<Value> values[arraysize(fields_)];
+    HeaderMerge merges[arraysize(fields_)];
+    size_t num_keys = 0;
+    Local<String> comma;
+
+    for (size_t i = 0; i < num_values_; i++) {
+      const StringPtr& field = fields_[i];
+      const KnownHeader* known = LookupKnownHeader(field.str_, field.size_);
+
+      Local<String> key;
+      Local<String> raw_key;
+      HeaderMerge merge = kMergeJoin;
+      if (known != nullptr) {
+        merge = known->merge;
+        key = String::NewFromOneByte(
+            isolate,
+            reinterpret_cast<const uint8_t*>(known->name),
+            NewStringType::kInternalized,
+            known->length).ToLocalChecked();
+        if (memcmp(known->name, field.str_, field.size_) == 0)
+          raw_key = key;
+        else
+          raw_key = field.ToInternalizedString(env());
+      } else {
+        MaybeStackBuffer<char, 256> lower(field.size_);
+        char* out = lower.out();
+        bool is_lower = true;
+        for (size_t k = 0; k < field.size_; k++) {
+          out[k] = ToLower(field.str_[k]);
+          is_lower = is_lower && out[k] == field.str_[k];
+        }
+        key = String::NewFromOneByte(
+            isolate,
+            reinterpret_cast<const uint8_t*>(out),
+            NewStringType::kInternalized,
+            field.size_).ToLocalChecked();
+        raw_key = is_lower ? key : field.ToString(env());
+      }
+
+      Local<String> value = values_[i].ToString(env());
+      raw->Set(i * 2, raw_key);
+      raw->Set(i * 2 + 1, value);
+
+      // Internalized strings compare by identity, so this is cheap.
+      size_t slot = 0;
+      while (slot < num_keys && !keys[slot]->StrictEquals(key))
+        slot++;
+
+      if (slot == num_keys) {
+        keys[slot] = key;
+        merges[slot] = merge;
+        if (merge == kMergeArray) {
+          Local<Array> list = Array::New(isolate, 1);
+          list->Set(0, value);
+          values[slot] = list;
+        } else {
+          values[slot] = value;
+        }
+        num_keys++;
+      } else if (merges[slot] == kMergeArray) {
+        Local<Array> list = values[slot].As<Array>();
+        list->Set(list->Length(), value);
+      } else if (merges[slot] == kMergeJoin) {
+        if (comma.IsEmpty())
+          comma = FIXED_ONE_BYTE_STRING(isolate, ", ");
+        values[slot] = String::Concat(
+            String::Concat(values[slot].As<String>(), comma), value);
+      }
+    }
+
+    for (size_t i = 0; i < num_keys; i++)
+      headers->Set(keys[i], values[i]);
+
+    *raw_out = raw;
+    *headers_out = headers;
+  }
+
+
   // spill headers and request path to JS land
   void Flush() {
     HandleScope scope(env()->isolate());
@@ -706,6 +905,7 @@ class Parser : public AsyncWrap {
   size_t num_values_;
   bool have_flushed_;
   bool got_exception_;
+  bool native_headers_ = false;
   Local<Object> current_buffer_;
   size_t current_buffer_len_;
   char* current_buffer_data_;
@@ -772,6 +972,7 @@ void InitHttpParser(Local<Object> target,
   env->SetProtoMethod(t, "consume", Parser::Consume);
   env->SetProtoMethod(t, "unconsume", Parser::Unconsume);
   env->SetProtoMethod(t, "getCurrentBuffer", Parser::GetCurrentBuffer);
+  env->SetProtoMethod(t, "useNativeHeaders", Parser::UseNativeHeaders);
 
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "HTTPParser"),
               t->GetFunction());
@@ -0,0 +1,395 @@
+#include "node.h"
+#include "node_internals.h"
+
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <math.h>  // floor()
+#include <string>
+#include <stdlib.h>  // free()
+#include <string.h>  // memcpy()
+
+// Serializes the header block of an outgoing HTTP message.  This is the
+// native counterpart of OutgoingMessage#_storeHeader() in
+// lib/_http_outgoing.js: it validates the header fields and values, tracks
+// the headers that influence the connection state (Connection,
+// Content-Length, Transfer-Encoding, ...) and appends the automatic headers,
+// all in a single pass and without building intermediate strings.
+//
+// The Date, Connection, Content-Length and Transfer-Encoding lines that are
+// added automatically come from preformatted byte sequences, the Date and
+// Content-Length ones from the Environment's HttpHeaderCache.
+
+namespace node {
+
+using v8::Array;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::Object;
+using v8::String;
+using v8::Uint32Array;
+using v8::Value;
+
+// Keep in sync with lib/_http_outgoing.js.
+enum SerializerFlags {
+  // Input.
+  kSendDate = 1 << 0,
+  kUseChunkedEncodingByDefault = 1 << 1,
+  kHasAgent = 1 << 2,
+  kRemovedConnection = 1 << 3,
+  kRemovedContentLength = 1 << 4,
+  kRemovedTransferEncoding = 1 << 5,
+  kHasBody = 1 << 6,
+  kNoContent = 1 << 7,  // 204 or 304 response.
+  // Input and output.
+  kShouldKeepAlive = 1 << 8,
+  kChunkedEncoding = 1 << 9,
+  // Output.
+  kLast = 1 << 10,
+  kUpgrading = 1 << 11,
+  kSentExpect = 1 << 12
+};
+
+// Number.MAX_SAFE_INTEGER.
+static const double kMaxSafeInteger = 9007199254740991.0;
+
+
+// Growable byte buffer that starts out on the stack; almost every header
+// block fits.
+class HeaderBuffer {
+ public:
+  HeaderBuffer() : data_(stack_), length_(0), capacity_(sizeof(stack_)) {}
+
+  ~HeaderBuffer() {
+    if (data_ != stack_)
+      free(data_);
+  }
+
+  char* Reserve(size_t size) {
+    if (length_ + size > capacity_) {
+      size_t capacity = capacity_ * 2;
+      while (capacity < length_ + size)
+        capacity *= 2;
+      char* data = static_cast<char*>(node::Malloc(capacity));
+      CHECK_NE(data, nullptr);
+      memcpy(data, data_, length_);
+      if (data_ != stack_)
+        free(data_);
+      data_ = data;
+      capacity_ = capacity;
+    }
+    return data_ + length_;
+  }
+
+  void Commit(size_t size) {
+    CHECK_LE(length_ + size, capacity_);
+    length_ += size;
+  }
+
+  void Append(const char* data, size_t size) {
+    memcpy(Reserve(size), data, size);
+    Commit(size);
+  }
+
+  template <size_t N>
+  void Append(const char (&data)[N]) {
+    Append(data, N - 1);
+  }
+
+  const char* data() const { return data_; }
+  size_t length() const { return length_; }
+
+ private:
+  char stack_[4096];
+  char* data_;
+  size_t length_;
+  size_t capacity_;
+
+  DISALLOW_COPY_AND_ASSIGN(HeaderBuffer);
+};
+
+
+// token = 1*tchar, see checkIsHttpToken() in lib/_http_common.js.
+static inline bool IsTokenChar(uint16_t c) {
+  return (c >= 94 && c <= 122) ||
+         (c >= 65 && c <= 90) ||
+         c == 45 ||
+         (c >= 48 && c <= 57) ||
+         (c >= 33 && c <= 46 && c != 34 && c != 40 && c != 41 && c != 44) ||
+         c == 124 ||
+         c == 126;
+}
+
+
+// See checkInvalidHeaderChar() in lib/_http_common.js.
+static inline bool IsFieldValueChar(uint16_t c) {
+  return (c > 31 || c == 9) && c != 127 && c <= 255;
+}
+
+
+// Appends `string` as latin1.  Returns false if it contains a character
+// that is rejected by `IsValid`.
+template <bool (*IsValid)(uint16_t)>
+static bool AppendChecked(HeaderBuffer* buf, Local<String> string) {
+  const int length = string->Length();
+  char* out = buf->Reserve(length);
+
+  if (string->IsOneByte()) {
+    string->WriteOneByte(reinterpret_cast<uint8_t*>(out),
+                         0,
+                         length,
+                         String::NO_NULL_TERMINATION);
+    for (int i = 0; i < length; i++) {
+      if (!IsValid(static_cast<uint8_t>(out[i])))
+        return false;
+    }
+  } else {
+    String::Value value(string);
+    for (int i = 0; i < length; i++) {
+      const uint16_t c = (*value)[i];
+      if (!IsValid(c))
+        return false;
+      out[i] = static_cast<char>(c);
+    }
+  }
+
+  buf->Commit(length);
+  return true;
+}
+
+
+static inline bool IsWordChar(char c) {
+  return (c >= 'a' && c <= 'z') ||
+         (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') ||
+         c == '_';
+}
+
+
+// Case-insensitive substring search.  With `whole_word` the match must be
+// delimited like /(^|\W)word(\W|$)/i.
+static bool ContainsNoCase(const char* data,
+                           size_t length,
+                           const char* word,
+                           size_t word_length,
+                           bool whole_word) {
+  for (size_t i = 0; i + word_length <= length; i++) {
+    if (!StringEqualNoCaseN(data + i, word, word_length))
+      continue;
+    if (!whole_word)
+      return true;
+    if ((i == 0 || !IsWordChar(data[i - 1])) &&
+        (i + word_length == length || !IsWordChar(data[i + word_length]))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+#define FIELD_IS(name)                                                        \
+  (field_length == sizeof(name) - 1 &&                                        \
+      StringEqualNoCaseN(field, name, sizeof(name) - 1))
+
+#define VALUE_CONTAINS(word, whole_word)                                      \
+  ContainsNoCase(value, value_length, word, sizeof(word) - 1, whole_word)
+
+
+// serializeHeader(list, flags, contentLength, state)
+//
+// `list` is a flat [field, value, field, value, ...] array, `flags` is a
+// combination of the input SerializerFlags and `contentLength` is a
+// non-negative safe integer, or -1 if unknown.  Returns the header block
+// minus the first line; the output flags are stored in state[0].
+static void SerializeHeader(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+  Local<Context> context = env->context();
+
+  CHECK(args[0]->IsArray());
+  CHECK(args[1]->IsUint32());
+  CHECK(args[2]->IsNumber());
+  CHECK(args[3]->IsUint32Array());
+
+  Local<Array> list = args[0].As<Array>();
+  uint32_t flags = args[1]->Uint32Value();
+  // Validated by _storeHeader(), a double outside the int64_t range can't
+  // be converted.
+  const double content_length_value = args[2].As<v8::Number>()->Value();
+  CHECK(content_length_value == -1 ||
+        (content_length_value >= 0 &&
+         content_length_value <= kMaxSafeInteger &&
+         content_length_value == floor(content_length_value)));
+  const int64_t content_length = static_cast<int64_t>(content_length_value);
+
+  bool sent_connection = false;
+  bool sent_connection_upgrade = false;
+  bool sent_content_length = false;
+  bool sent_transfer_encoding = false;
+  bool sent_date = false;
+  bool sent_trailer = false;
+  bool sent_upgrade = false;
+
+  HeaderBuffer buf;
+
+  const uint32_t length = list->Length();
+  for (uint32_t i = 0; i + 1 < length; i += 2) {
+    Local<Value> field_value = list->Get(context, i).ToLocalChecked();
+    const size_t field_start = buf.length();
+    if (!field_value->IsString() ||
+        field_value.As<String>()->Length() == 0 ||
+        !AppendChecked<IsTokenChar>(&buf, field_value.As<String>())) {
+      node::Utf8Value field(isolate, field_value);
+      std::string message = "Header name must be a valid HTTP Token [\"";
+      message += *field;
+      message += "\"]";
+      return env->ThrowTypeError(message.c_str());
+    }
+    const size_t field_length = buf.length() - field_start;
+
+    buf.Append(": ");
+
+    Local<String> value_string;
+    if (!list->Get(context, i + 1).ToLocalChecked()
+            ->ToString(context).ToLocal(&value_string)) {
+      return;  // Exception pending.
+    }
+    const size_t value_start = buf.length();
+    if (!AppendChecked<IsFieldValueChar>(&buf, value_string))
+      return env->ThrowTypeError(
+          "The header content contains invalid characters");
+    const size_t value_length = buf.length() - value_start;
+
+    buf.Append("\r\n");
+
+    const char* field = buf.data() + field_start;
+    const char* value = buf.data() + value_start;
+    if (FIELD_IS("connection")) {
+      sent_connection = true;
+      if (VALUE_CONTAINS("close", true))
+        flags |= kLast;
+      else
+        flags |= kShouldKeepAlive;
+      if (VALUE_CONTAINS("upgrade", true))
+        sent_connection_upgrade = true;
+    } else if (FIELD_IS("transfer-encoding")) {
+      sent_transfer_encoding = true;
+      if (VALUE_CONTAINS("chunk", false))
+        flags |= kChunkedEncoding;
+    } else if (FIELD_IS("content-length")) {
+      sent_content_length = true;
+    } else if (FIELD_IS("date")) {
+      sent_date = true;
+    } else if (FIELD_IS("expect")) {
+      flags |= kSentExpect;
+    } else if (FIELD_IS("trailer")) {
+      sent_trailer = true;
+    } else if (FIELD_IS("upgrade")) {
+      sent_upgrade = true;
+    }
+  }
+
+  // Are we upgrading the connection?
+  if (sent_connection_upgrade && sent_upgrade)
+    flags |= kUpgrading;
+
+  HttpHeaderCache* cache = env->http_header_cache();
+  size_t line_length;
+
+  if ((flags & kSendDate) && !sent_date) {
+    const char* line = cache->DateLine(&line_length);
+    buf.Append(line, line_length);
+  }
+
+  // 204 and 304 responses must not have a body, don't send a zero chunk
+  // but close the connection instead.
+  if ((flags & kNoContent) && (flags & kChunkedEncoding)) {
+    flags &= ~(kChunkedEncoding | kShouldKeepAlive);
+  }
+
+  // keep-alive logic
+  if (flags & kRemovedConnection) {
+    flags |= kLast;
+    flags &= ~kShouldKeepAlive;
+  } else if (!sent_connection) {
+    const bool send_keep_alive =
+        (flags & kShouldKeepAlive) &&
+        (sent_content_length ||
+         (flags & (kUseChunkedEncodingByDefault | kHasAgent)));
+    if (send_keep_alive) {
+      buf.Append("Connection: keep-alive\r\n");
+    } else {
+      flags |= kLast;
+      buf.Append("Connection: close\r\n");
+    }
+  }
+
+  if (!sent_content_length && !sent_transfer_encoding) {
+    if (!(flags & kHasBody)) {
+      flags &= ~kChunkedEncoding;
+    } else if (!(flags & kUseChunkedEncodingByDefault)) {
+      flags |= kLast;
+    } else if (!sent_trailer &&
+               !(flags & kRemovedContentLength) &&
+               content_length >= 0) {
+      const char* line = cache->ContentLengthLine(content_length,
+                                                  &line_length);
+      buf.Append(line, line_length);
+    } else if (!(flags & kRemovedTransferEncoding)) {
+      buf.Append("Transfer-Encoding: chunked\r\n");
+      flags |= kChunkedEncoding;
+    }
+  }
+
+  buf.Append("\r\n");
+
+  Local<Uint32Array> state = args[3].As<Uint32Array>();
+  CHECK_GE(state->Length(), 1);
+  uint32_t* state_data = reinterpret_cast<uint32_t*>(
+      static_cast<char*>(state->Buffer()->GetContents().Data()) +
+      state->ByteOffset());
+  state_data[0] = flags;
+
+  args.GetReturnValue().Set(OneByteString(isolate, buf.data(), buf.length()));
+}
+
+#undef FIELD_IS
+#undef VALUE_CONTAINS
+
+
+void InitHttpSerializer(Local<Object> target,
+                        Local<Value> unused,
+                        Local<Context> context,
+                        void* priv) {
+  Environment* env = Environment::GetCurrent(context);
+
+  env->SetMethod(target, "serializeHeader", SerializeHeader);
+
+#define V(name)                                                               \
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), #name),                   \
+              Integer::NewFromUnsigned(env->isolate(), name));
+  V(kSendDate)
+  V(kUseChunkedEncodingByDefault)
+  V(kHasAgent)
+  V(kRemovedConnection)
+  V(kRemovedContentLength)
+  V(kRemovedTransferEncoding)
+  V(kHasBody)
+  V(kNoContent)
+  V(kShouldKeepAlive)
+  V(kChunkedEncoding)
+  V(kLast)
+  V(kUpgrading)
+  V(kSentExpect)
+#undef V
+}
+
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(http_serializer, node::InitHttpSerializer)
@@ -0,0 +1,474 @@
+#include "node.h"
+#include "node_buffer.h"
+
+#include "base-object.h"
+#include "base-object-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "string_search.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <string.h>  // memcmp()
+#include <string>
+
+// Incremental parser for multipart bodies (RFC 2046), multipart/form-data
+// uploads in particular.  A Buffer is passed to parser.execute() and the
+// parser calls back into JS with the headers of each part and with the
+// ranges of the Buffer that hold part bodies, so body data is never copied
+// or looked at from JS:
+//     parser[kOnPart](rawHeaders)
+//     parser[kOnBody](buffer, start, length)
+//     parser[kOnPartEnd]()
+// The only copies are of the few bytes at the end of a chunk that may be the
+// start of a delimiter, which are held back until the next chunk tells.
+
+namespace node {
+
+using v8::Array;
+using v8::Context;
+using v8::Exception;
+using v8::Function;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::HandleScope;
+using v8::Integer;
+using v8::Local;
+using v8::NewStringType;
+using v8::Object;
+using v8::String;
+using v8::Value;
+
+const uint32_t kOnPart = 0;
+const uint32_t kOnBody = 1;
+const uint32_t kOnPartEnd = 2;
+
+
+class MultipartParser : public BaseObject {
+ public:
+  MultipartParser(Environment* env,
+                  Local<Object> wrap,
+                  const char* boundary,
+                  size_t boundary_length,
+                  size_t max_header_size)
+      : BaseObject(env, wrap),
+        state_(kPreamble),
+        delimiter_("\r\n--"),
+        // The first delimiter doesn't need a line break in front of it when
+        // there is no preamble, pretend that there is one.
+        lookbehind_("\r\n"),
+        max_header_size_(max_header_size),
+        error_(nullptr),
+        current_buffer_data_(nullptr) {
+    MakeWeak<MultipartParser>(this);
+    delimiter_.append(boundary, boundary_length);
+  }
+
+
+  // new MultipartParser(boundary, maxHeaderSize)
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    CHECK(args.IsConstructCall());
+    CHECK(Buffer::HasInstance(args[0]));
+    CHECK(args[1]->IsUint32());
+    const size_t boundary_length = Buffer::Length(args[0]);
+    CHECK_GT(boundary_length, 0);
+    CHECK_LE(boundary_length, 70);
+    new MultipartParser(env,
+                        args.This(),
+                        Buffer::Data(args[0]),
+                        boundary_length,
+                        args[1]->Uint32Value());
+  }
+
+
+  // var err = parser.execute(buffer);
+  static void Execute(const FunctionCallbackInfo<Value>& args) {
+    MultipartParser* parser;
+    ASSIGN_OR_RETURN_UNWRAP(&parser, args.Holder());
+    CHECK(parser->current_buffer_.IsEmpty());
+    CHECK(Buffer::HasInstance(args[0]));
+
+    Local<Object> buffer_obj = args[0].As<Object>();
+    const char* data = Buffer::Data(buffer_obj);
+    const size_t length = Buffer::Length(buffer_obj);
+
+    // The callbacks for this chunk slice the Buffer it came in.
+    parser->current_buffer_ = buffer_obj;
+    parser->current_buffer_data_ = data;
+    const bool ok = parser->Execute(data, length);
+    parser->current_buffer_.Clear();
+    parser->current_buffer_data_ = nullptr;
+
+    // An exception thrown by a callback is left to propagate.
+    if (ok && parser->error_ != nullptr)
+      args.GetReturnValue().Set(parser->Error());
+  }
+
+
+  // var err = parser.finish();
+  static void Finish(const FunctionCallbackInfo<Value>& args) {
+    MultipartParser* parser;
+    ASSIGN_OR_RETURN_UNWRAP(&parser, args.Holder());
+    CHECK(parser->current_buffer_.IsEmpty());
+
+    if (parser->state_ != kEpilogue && parser->error_ == nullptr)
+      parser->SetError("Unexpected end of multipart data");
+    if (parser->error_ != nullptr)
+      args.GetReturnValue().Set(parser->Error());
+  }
+
+ private:
+  enum State {
+    kPreamble,
+    kDelimiter,  // Right after a delimiter.
+    kPadding,  // Whitespace after a delimiter.
+    kDelimiterEnd,  // The CR that ends the delimiter line was seen.
+    kClose,  // The first hyphen of the close delimiter was seen.
+    kHeaders,
+    kBody,
+    kEpilogue,
+    kError
+  };
+
+
+  // Returns false if a callback threw.
+  bool Execute(const char* data, size_t length) {
+    size_t i = 0;
+    while (i < length && state_ != kError) {
+      switch (state_) {
+        case kPreamble:
+        case kBody: {
+          size_t consumed;
+          if (!ScanBody(data + i, length - i, &consumed))
+            return false;
+          i += consumed;
+          break;
+        }
+
+        case kDelimiter:
+          if (data[i] == '-') {
+            state_ = kClose;
+          } else if (data[i] == ' ' || data[i] == '\t') {
+            state_ = kPadding;
+          } else if (data[i] == '\r') {
+            state_ = kDelimiterEnd;
+          } else {
+            SetError("Malformed multipart delimiter");
+            break;
+          }
+          i++;
+          break;
+
+        case kPadding:
+          if (data[i] == '\r') {
+            state_ = kDelimiterEnd;
+          } else if (data[i] != ' ' && data[i] != '\t') {
+            SetError("Malformed multipart delimiter");
+            break;
+          }
+          i++;
+          break;
+
+        case kDelimiterEnd:
+          if (data[i] != '\n') {
+            SetError("Malformed multipart delimiter");
+            break;
+          }
+          // Keep the line break so that a header block without any headers
+          // also ends in an empty line.
+          header_.assign("\r\n");
+          state_ = kHeaders;
+          i++;
+          break;
+
+        case kClose:
+          if (data[i] != '-') {
+            SetError("Malformed multipart delimiter");
+            break;
+          }
+          state_ = kEpilogue;
+          i++;
+          break;
+
+        case kHeaders:
+          // Header blocks are small, byte at a time is fine.
+          while (i < length) {
+            header_.push_back(data[i++]);
+            if (header_.size() > max_header_size_) {
+              SetError("Part header too large");
+              break;
+            }
+            if (header_.size() >= 4 &&
+                header_.compare(header_.size() - 4, 4, "\r\n\r\n") == 0) {
+              state_ = kBody;
+              if (!OnPart())
+                return false;
+              break;
+            }
+          }
+          break;
+
+        case kEpilogue:
+          // Everything after the close delimiter is ignored.
+          i = length;
+          break;
+
+        case kError:
+          UNREACHABLE();
+      }
+    }
+    return true;
+  }
+
+
+  // Looks for the next delimiter in preamble or body data and passes the
+  // body data in front of it on to kOnBody.  Sets *consumed to the number of
+  // bytes used up, including the delimiter if one was found.  Returns false
+  // if a callback threw.
+  bool ScanBody(const char* data, size_t length, size_t* consumed) {
+    const size_t delimiter_length = delimiter_.size();
+
+    // Bytes held back from the previous chunk come first.  Find the first
+    // of them that the delimiter can start at; the ones before it are data.
+    if (!lookbehind_.empty()) {
+      const size_t held = lookbehind_.size();
+      for (size_t start = 0; start < held; start++) {
+        const size_t tail = held - start;
+        const size_t rest = delimiter_length - tail;
+        const size_t available = rest < length ? rest : length;
+        if (memcmp(lookbehind_.data() + start, delimiter_.data(), tail) != 0 ||
+            memcmp(data, delimiter_.data() + tail, available) != 0) {
+          continue;
+        }
+        if (!OnBodyCopy(lookbehind_.data(), start))
+          return false;
+        if (available < rest) {
+          // Still undecided, hold on to the whole chunk as well.
+          lookbehind_.erase(0, start);
+          lookbehind_.append(data, length);
+          *consumed = length;
+          return true;
+        }
+        lookbehind_.clear();
+        *consumed = rest;
+        return OnDelimiter();
+      }
+      if (!OnBodyCopy(lookbehind_.data(), held))
+        return false;
+      lookbehind_.clear();
+    }
+
+    if (length >= delimiter_length) {
+      const size_t position = SearchString(
+          reinterpret_cast<const uint8_t*>(data),
+          length,
+          reinterpret_cast<const uint8_t*>(delimiter_.data()),
+          delimiter_length,
+          0,
+          true);
+      if (position != length) {
+        if (!OnBody(data, position))
+          return false;
+        *consumed = position + delimiter_length;
+        return OnDelimiter();
+      }
+    }
+
+    // Hold back the longest tail that is a prefix of the delimiter.
+    size_t held = delimiter_length - 1 < length ? delimiter_length - 1 : length;
+    for (; held > 0; held--) {
+      if (data[length - held] == '\r' &&
+          memcmp(data + length - held, delimiter_.data(), held) == 0) {
+        break;
+      }
+    }
+    if (!OnBody(data, length - held))
+      return false;
+    lookbehind_.assign(data + length - held, held);
+    *consumed = length;
+    return true;
+  }
+
+
+  bool OnDelimiter() {
+    const bool in_part = state_ == kBody;
+    state_ = kDelimiter;
+    if (!in_part)
+      return true;
+
+    HandleScope scope(env()->isolate());
+    Local<Object> obj = object();
+    Local<Value> cb = obj->Get(kOnPartEnd);
+    if (!cb->IsFunction())
+      return true;
+    return !cb.As<Function>()->Call(obj, 0, nullptr).IsEmpty();
+  }
+
+
+  // Body data inside the current chunk, passed as a range of its Buffer.
+  bool OnBody(const char* data, size_t length) {
+    if (state_ != kBody || length == 0)
+      return true;
+
+    HandleScope scope(env()->isolate());
+    Local<Object> obj = object();
+    Local<Value> cb = obj->Get(kOnBody);
+    if (!cb->IsFunction())
+      return true;
+
+    Local<Value> argv[3] = {
+      current_buffer_,
+      Integer::NewFromUnsigned(env()->isolate(), data - current_buffer_data_),
+      Integer::NewFromUnsigned(env()->isolate(), length)
+    };
+    return !cb.As<Function>()->Call(obj, arraysize(argv), argv).IsEmpty();
+  }
+
+
+  // Body data that was held back from an earlier chunk.
+  bool OnBodyCopy(const char* data, size_t length) {
+    if (state_ != kBody || length == 0)
+      return true;
+
+    HandleScope scope(env()->isolate());
+    Local<Object> obj = object();
+    Local<Value> cb = obj->Get(kOnBody);
+    if (!cb->IsFunction())
+      return true;
+
+    Local<Value> argv[3] = {
+      Buffer::Copy(env(), data, length).ToLocalChecked(),
+      Integer::NewFromUnsigned(env()->isolate(), 0),
+      Integer::NewFromUnsigned(env()->isolate(), length)
+    };
+    return !cb.As<Function>()->Call(obj, arraysize(argv), argv).IsEmpty();
+  }
+
+
+  // Splits the header block into [name, value, ...] for kOnPart.  Names and
+  // values are decoded as UTF-8, which is what browsers send file names in.
+  bool OnPart() {
+    HandleScope scope(env()->isolate());
+    Local<Array> headers = Array::New(env()->isolate());
+    uint32_t count = 0;
+    std::string value;
+
+    // Skip the line break in front of the block and the empty line after it.
+    size_t line = 2;
+    const size_t end = header_.size() - 2;
+    while (line < end) {
+      const size_t line_end = header_.find("\r\n", line);
+      const char* p = header_.data() + line;
+      const char* q = header_.data() + line_end;
+
+      if (*p == ' ' || *p == '\t') {
+        // Obsolete line folding, the line continues the previous value.
+        if (count == 0) {
+          SetError("Malformed part header");
+          return true;
+        }
+        const char* start = TrimWhitespace(p, &q);
+        value.push_back(' ');
+        value.append(start, q - start);
+      } else {
+        const char* colon =
+            static_cast<const char*>(memchr(p, ':', q - p));
+        if (colon == nullptr || colon == p) {
+          SetError("Malformed part header");
+          return true;
+        }
+        if (count > 0)
+          headers->Set(count++, Utf8String(value));
+        const char* name_end = colon;
+        while (name_end > p && (name_end[-1] == ' ' || name_end[-1] == '\t'))
+          name_end--;
+        headers->Set(count++, Utf8String(std::string(p, name_end - p)));
+        const char* start = TrimWhitespace(colon + 1, &q);
+        value.assign(start, q - start);
+      }
+      line = line_end + 2;
+    }
+    if (count > 0)
+      headers->Set(count++, Utf8String(value));
+    header_.clear();
+
+    Local<Object> obj = object();
+    Local<Value> cb = obj->Get(kOnPart);
+    if (!cb->IsFunction())
+      return true;
+    Local<Value> argv[1] = { headers };
+    return !cb.As<Function>()->Call(obj, arraysize(argv), argv).IsEmpty();
+  }
+
+
+  // Returns the start of [p, *q) without leading whitespace and moves *q in
+  // past trailing whitespace.
+  static const char* TrimWhitespace(const char* p, const char** q) {
+    while (p < *q && (*p == ' ' || *p == '\t'))
+      p++;
+    while (*q > p && ((*q)[-1] == ' ' || (*q)[-1] == '\t'))
+      (*q)--;
+    return p;
+  }
+
+
+  Local<String> Utf8String(const std::string& s) {
+    return String::NewFromUtf8(env()->isolate(),
+                               s.data(),
+                               NewStringType::kNormal,
+                               s.size()).ToLocalChecked();
+  }
+
+
+  void SetError(const char* message) {
+    state_ = kError;
+    error_ = message;
+  }
+
+
+  Local<Value> Error() {
+    return Exception::Error(OneByteString(env()->isolate(), error_));
+  }
+
+
+  State state_;
+  // CRLF, two hyphens and the boundary.
+  std::string delimiter_;
+  // The tail of the previous chunk that may start a delimiter.
+  std::string lookbehind_;
+  std::string header_;
+  size_t max_header_size_;
+  const char* error_;
+  Local<Object> current_buffer_;
+  const char* current_buffer_data_;
+};
+
+
+void InitMultipartParser(Local<Object> target,
+                         Local<Value> unused,
+                         Local<Context> context,
+                         void* priv) {
+  Environment* env = Environment::GetCurrent(context);
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(MultipartParser::New);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+  t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "MultipartParser"));
+
+  t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kOnPart"),
+         Integer::NewFromUnsigned(env->isolate(), kOnPart));
+  t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kOnBody"),
+         Integer::NewFromUnsigned(env->isolate(), kOnBody));
+  t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kOnPartEnd"),
+         Integer::NewFromUnsigned(env->isolate(), kOnPartEnd));
+
+  env->SetProtoMethod(t, "execute", MultipartParser::Execute);
+  env->SetProtoMethod(t, "finish", MultipartParser::Finish);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "MultipartParser"),
+              t->GetFunction());
+}
+
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(multipart_parser, node::InitMultipartParser)
@@ -7,6 +7,7 @@
 #include "env-inl.h"
 #include "util.h"
 #include "util-inl.h"
+#include "zlib_stream_pool.h"
 
 #include "v8.h"
 #include "zlib.h"
@@ -25,6 +26,7 @@ using v8::FunctionTemplate;
 using v8::HandleScope;
 using v8::Integer;
 using v8::Local;
+using v8::Null;
 using v8::Number;
 using v8::Object;
 using v8::Value;
@@ -43,6 +45,9 @@ enum node_zlib_mode {
 #define GZIP_HEADER_ID1 0x1f
 #define GZIP_HEADER_ID2 0x8b
 
+// Smallest output buffer zlibSync() starts with.
+static const size_t kMinOneShotOutput = 1024;
+
 void InitZlib(v8::Local<v8::Object> target);
 
 
@@ -62,6 +67,7 @@ class ZCtx : public AsyncWrap {
         memLevel_(0),
         mode_(mode),
         strategy_(0),
+        strm_(nullptr),
         windowBits_(0),
         write_in_progress_(false),
         pending_close_(false),
@@ -85,18 +91,15 @@ class ZCtx : public AsyncWrap {
     pending_close_ = false;
     CHECK(init_done_ && "close before init");
     CHECK_LE(mode_, UNZIP);
+    mode_ = NONE;
 
-    if (mode_ == DEFLATE || mode_ == GZIP || mode_ == DEFLATERAW) {
-      (void)deflateEnd(&strm_);
-      int64_t change_in_bytes = -static_cast<int64_t>(kDeflateContextSize);
-      env()->isolate()->AdjustAmountOfExternalAllocatedMemory(change_in_bytes);
-    } else if (mode_ == INFLATE || mode_ == GUNZIP || mode_ == INFLATERAW ||
-               mode_ == UNZIP) {
-      (void)inflateEnd(&strm_);
-      int64_t change_in_bytes = -static_cast<int64_t>(kInflateContextSize);
-      env()->isolate()->AdjustAmountOfExternalAllocatedMemory(change_in_bytes);
+    // The stream goes back to the pool instead of being torn down, the next
+    // context with the same parameters only has to reset it.  The pool
+    // accounts for its memory.
+    if (strm_ != nullptr) {
+      env()->zlib_stream_pool()->Release(strm_);
+      strm_ = nullptr;
     }
-    mode_ = NONE;
 
     if (dictionary_ != nullptr) {
       delete[] dictionary_;
@@ -171,10 +174,10 @@ class ZCtx : public AsyncWrap {
     // build up the work request
     uv_work_t* work_req = &(ctx->work_req_);
 
-    ctx->strm_.avail_in = in_len;
-    ctx->strm_.next_in = in;
-    ctx->strm_.avail_out = out_len;
-    ctx->strm_.next_out = out;
+    ctx->strm_->avail_in = in_len;
+    ctx->strm_->next_in = in;
+    ctx->strm_->avail_out = out_len;
+    ctx->strm_->next_out = out;
     ctx->flush_ = flush;
 
     if (!async) {
@@ -187,10 +190,11 @@ class ZCtx : public AsyncWrap {
     }
 
     // async version
-    uv_queue_work(ctx->env()->event_loop(),
-                  work_req,
-                  ZCtx::Process,
-                  ZCtx::After);
+    uv_queue_work_ex(ctx->env()->event_loop(),
+                     work_req,
+                     UV_WORK_COMPRESSION,
+                     ZCtx::Process,
+                     ZCtx::After);
 
     args.GetReturnValue().Set(ctx->object());
   }
@@ -199,9 +203,9 @@ class ZCtx : public AsyncWrap {
   static void AfterSync(ZCtx* ctx, const FunctionCallbackInfo<Value>& args) {
     Environment* env = ctx->env();
     Local<Integer> avail_out = Integer::New(env->isolate(),
-                                            ctx->strm_.avail_out);
+                                            ctx->strm_->avail_out);
     Local<Integer> avail_in = Integer::New(env->isolate(),
-                                           ctx->strm_.avail_in);
+                                           ctx->strm_->avail_in);
 
     ctx->write_in_progress_ = false;
 
@@ -230,11 +234,11 @@ class ZCtx : public AsyncWrap {
       case DEFLATE:
       case GZIP:
       case DEFLATERAW:
-        ctx->err_ = deflate(&ctx->strm_, ctx->flush_);
+        ctx->err_ = deflate(ctx->strm_, ctx->flush_);
         break;
       case UNZIP:
-        if (ctx->strm_.avail_in > 0) {
-          next_expected_header_byte = ctx->strm_.next_in;
+        if (ctx->strm_->avail_in > 0) {
+          next_expected_header_byte = ctx->strm_->next_in;
         }
 
         switch (ctx->gzip_id_bytes_read_) {
@@ -247,7 +251,7 @@ class ZCtx : public AsyncWrap {
               ctx->gzip_id_bytes_read_ = 1;
               next_expected_header_byte++;
 
-              if (ctx->strm_.avail_in == 1) {
+              if (ctx->strm_->avail_in == 1) {
                 // The only available byte was already read.
                 break;
               }
@@ -280,17 +284,17 @@ class ZCtx : public AsyncWrap {
       case INFLATE:
       case GUNZIP:
       case INFLATERAW:
-        ctx->err_ = inflate(&ctx->strm_, ctx->flush_);
+        ctx->err_ = inflate(ctx->strm_, ctx->flush_);
 
         // If data was encoded with dictionary
         if (ctx->err_ == Z_NEED_DICT && ctx->dictionary_ != nullptr) {
           // Load it
-          ctx->err_ = inflateSetDictionary(&ctx->strm_,
+          ctx->err_ = inflateSetDictionary(ctx->strm_,
                                            ctx->dictionary_,
                                            ctx->dictionary_len_);
           if (ctx->err_ == Z_OK) {
             // And try to decode again
-            ctx->err_ = inflate(&ctx->strm_, ctx->flush_);
+            ctx->err_ = inflate(ctx->strm_, ctx->flush_);
           } else if (ctx->err_ == Z_DATA_ERROR) {
             // Both inflateSetDictionary() and inflate() return Z_DATA_ERROR.
             // Make it possible for After() to tell a bad dictionary from bad
@@ -299,17 +303,17 @@ class ZCtx : public AsyncWrap {
           }
         }
 
-        while (ctx->strm_.avail_in > 0 &&
+        while (ctx->strm_->avail_in > 0 &&
                ctx->mode_ == GUNZIP &&
                ctx->err_ == Z_STREAM_END &&
-               ctx->strm_.next_in[0] != 0x00) {
+               ctx->strm_->next_in[0] != 0x00) {
           // Bytes remain in input buffer. Perhaps this is another compressed
           // member in the same archive, or just trailing garbage.
           // Trailing zero bytes are okay, though, since they are frequently
           // used for padding.
 
           Reset(ctx);
-          ctx->err_ = inflate(&ctx->strm_, ctx->flush_);
+          ctx->err_ = inflate(ctx->strm_, ctx->flush_);
         }
         break;
       default:
@@ -329,7 +333,7 @@ class ZCtx : public AsyncWrap {
     switch (ctx->err_) {
     case Z_OK:
     case Z_BUF_ERROR:
-      if (ctx->strm_.avail_out != 0 && ctx->flush_ == Z_FINISH) {
+      if (ctx->strm_->avail_out != 0 && ctx->flush_ == Z_FINISH) {
         ZCtx::Error(ctx, "unexpected end of file");
         return false;
       }
@@ -366,9 +370,9 @@ class ZCtx : public AsyncWrap {
       return;
 
     Local<Integer> avail_out = Integer::New(env->isolate(),
-                                            ctx->strm_.avail_out);
+                                            ctx->strm_->avail_out);
     Local<Integer> avail_in = Integer::New(env->isolate(),
-                                           ctx->strm_.avail_in);
+                                           ctx->strm_->avail_in);
 
     ctx->write_in_progress_ = false;
 
@@ -387,8 +391,8 @@ class ZCtx : public AsyncWrap {
     // If you hit this assertion, you forgot to enter the v8::Context first.
     CHECK_EQ(env->context(), env->isolate()->GetCurrentContext());
 
-    if (ctx->strm_.msg != nullptr) {
-      message = ctx->strm_.msg;
+    if (ctx->strm_ != nullptr && ctx->strm_->msg != nullptr) {
+      message = ctx->strm_->msg;
     }
 
     HandleScope scope(env->isolate());
@@ -482,10 +486,6 @@ class ZCtx : public AsyncWrap {
     ctx->memLevel_ = memLevel;
     ctx->strategy_ = strategy;
 
-    ctx->strm_.zalloc = Z_NULL;
-    ctx->strm_.zfree = Z_NULL;
-    ctx->strm_.opaque = Z_NULL;
-
     ctx->flush_ = Z_NO_FLUSH;
 
     ctx->err_ = Z_OK;
@@ -502,26 +502,28 @@ class ZCtx : public AsyncWrap {
       ctx->windowBits_ *= -1;
     }
 
+    ZlibStreamPool* pool = ctx->env()->zlib_stream_pool();
     switch (ctx->mode_) {
       case DEFLATE:
       case GZIP:
       case DEFLATERAW:
-        ctx->err_ = deflateInit2(&ctx->strm_,
-                                 ctx->level_,
-                                 Z_DEFLATED,
-                                 ctx->windowBits_,
-                                 ctx->memLevel_,
-                                 ctx->strategy_);
-        ctx->env()->isolate()
-            ->AdjustAmountOfExternalAllocatedMemory(kDeflateContextSize);
+        ctx->strm_ = pool->Acquire(ZlibStreamPool::kDeflate,
+                                   ctx->windowBits_,
+                                   ctx->level_,
+                                   ctx->memLevel_,
+                                   ctx->strategy_,
+                                   &ctx->err_);
         break;
       case INFLATE:
       case GUNZIP:
       case INFLATERAW:
       case UNZIP:
-        ctx->err_ = inflateInit2(&ctx->strm_, ctx->windowBits_);
-        ctx->env()->isolate()
-            ->AdjustAmountOfExternalAllocatedMemory(kInflateContextSize);
+        ctx->strm_ = pool->Acquire(ZlibStreamPool::kInflate,
+                                   ctx->windowBits_,
+                                   ctx->level_,
+                                   ctx->memLevel_,
+                                   ctx->strategy_,
+                                   &ctx->err_);
         break;
       default:
         CHECK(0 && "wtf?");
@@ -548,7 +550,7 @@ class ZCtx : public AsyncWrap {
     switch (ctx->mode_) {
       case DEFLATE:
       case DEFLATERAW:
-        ctx->err_ = deflateSetDictionary(&ctx->strm_,
+        ctx->err_ = deflateSetDictionary(ctx->strm_,
                                          ctx->dictionary_,
                                          ctx->dictionary_len_);
         break;
@@ -567,7 +569,9 @@ class ZCtx : public AsyncWrap {
     switch (ctx->mode_) {
       case DEFLATE:
       case DEFLATERAW:
-        ctx->err_ = deflateParams(&ctx->strm_, level, strategy);
+        ctx->err_ = ctx->env()->zlib_stream_pool()->Params(ctx->strm_,
+                                                           level,
+                                                           strategy);
         break;
       default:
         break;
@@ -585,12 +589,12 @@ class ZCtx : public AsyncWrap {
       case DEFLATE:
       case DEFLATERAW:
       case GZIP:
-        ctx->err_ = deflateReset(&ctx->strm_);
+        ctx->err_ = deflateReset(ctx->strm_);
         break;
       case INFLATE:
       case INFLATERAW:
       case GUNZIP:
-        ctx->err_ = inflateReset(&ctx->strm_);
+        ctx->err_ = inflateReset(ctx->strm_);
         break;
       default:
         break;
@@ -617,9 +621,6 @@ class ZCtx : public AsyncWrap {
     }
   }
 
-  static const int kDeflateContextSize = 16384;  // approximate
-  static const int kInflateContextSize = 10240;  // approximate
-
   Bytef* dictionary_;
   size_t dictionary_len_;
   int err_;
@@ -629,7 +630,7 @@ class ZCtx : public AsyncWrap {
   int memLevel_;
   node_zlib_mode mode_;
   int strategy_;
-  z_stream strm_;
+  z_stream* strm_;
   int windowBits_;
   uv_work_t work_req_;
   bool write_in_progress_;
@@ -639,6 +640,384 @@ class ZCtx : public AsyncWrap {
 };
 
 
+// Compresses one block of a parallel gzip stream on the threadpool. Each
+// block becomes a raw deflate stream primed with the end of the previous
+// block, ending on a byte boundary (or with the final block) so that the
+// blocks can be concatenated into a single deflate stream.
+class DeflateBlockRequest : public AsyncWrap {
+ public:
+  DeflateBlockRequest(Environment* env,
+                      Local<Object> object,
+                      const char* in,
+                      size_t in_len,
+                      const char* dictionary,
+                      size_t dictionary_len,
+                      bool last,
+                      int level,
+                      int mem_level,
+                      int strategy)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_ZLIB),
+        in_(reinterpret_cast<const Bytef*>(in)),
+        in_len_(in_len),
+        dictionary_(reinterpret_cast<const Bytef*>(dictionary)),
+        dictionary_len_(dictionary_len),
+        last_(last),
+        level_(level),
+        mem_level_(mem_level),
+        strategy_(strategy),
+        err_(Z_OK),
+        out_(nullptr),
+        out_len_(0),
+        crc_(0) {
+    Wrap(object, this);
+  }
+
+  ~DeflateBlockRequest() override {
+    free(out_);
+    ClearWrap(object());
+    persistent().Reset();
+  }
+
+  uv_work_t* work_req() {
+    return &work_req_;
+  }
+
+  static void Work(uv_work_t* work_req) {
+    DeflateBlockRequest* req =
+        ContainerOf(&DeflateBlockRequest::work_req_, work_req);
+    req->Deflate();
+    req->crc_ = crc32(crc32(0, Z_NULL, 0), req->in_, req->in_len_);
+  }
+
+  static void After(uv_work_t* work_req, int status) {
+    CHECK_EQ(status, 0);
+    DeflateBlockRequest* req =
+        ContainerOf(&DeflateBlockRequest::work_req_, work_req);
+    Environment* env = req->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+
+    Local<Value> argv[3];
+    if (req->err_ == Z_OK) {
+      argv[0] = Null(env->isolate());
+      argv[1] = Buffer::New(env,
+                            reinterpret_cast<char*>(req->out_),
+                            req->out_len_).ToLocalChecked();
+      req->out_ = nullptr;
+      argv[2] = Integer::NewFromUnsigned(env->isolate(), req->crc_);
+    } else {
+      argv[0] = Integer::New(env->isolate(), req->err_);
+      argv[1] = Null(env->isolate());
+      argv[2] = Null(env->isolate());
+    }
+    req->MakeCallback(env->ondone_string(), arraysize(argv), argv);
+    delete req;
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+  uv_work_t work_req_;
+
+ private:
+  void Deflate() {
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    err_ = deflateInit2(&strm, level_, Z_DEFLATED, -15, mem_level_, strategy_);
+    if (err_ != Z_OK)
+      return;
+
+    if (dictionary_ != nullptr)
+      err_ = deflateSetDictionary(&strm, dictionary_, dictionary_len_);
+
+    // Room for the whole block, the output buffer grows if it isn't enough
+    size_t size = deflateBound(&strm, in_len_) + 16;
+    out_ = static_cast<Bytef*>(node::Malloc(size));
+    CHECK_NE(out_, nullptr);
+
+    strm.next_in = const_cast<Bytef*>(in_);
+    strm.avail_in = in_len_;
+    strm.next_out = out_;
+    strm.avail_out = size;
+
+    const int flush = last_ ? Z_FINISH : Z_SYNC_FLUSH;
+    while (err_ == Z_OK) {
+      err_ = deflate(&strm, flush);
+      if (strm.avail_out != 0 || err_ == Z_STREAM_END)
+        break;
+      const size_t used = size;
+      size *= 2;
+      out_ = static_cast<Bytef*>(node::Realloc(out_, size));
+      CHECK_NE(out_, nullptr);
+      strm.next_out = out_ + used;
+      strm.avail_out = size - used;
+    }
+    out_len_ = size - strm.avail_out;
+
+    if (err_ == Z_STREAM_END || (err_ == Z_BUF_ERROR && !last_))
+      err_ = Z_OK;
+    (void)deflateEnd(&strm);
+  }
+
+  const Bytef* const in_;
+  const size_t in_len_;
+  const Bytef* const dictionary_;
+  const size_t dictionary_len_;
+  const bool last_;
+  const int level_;
+  const int mem_level_;
+  const int strategy_;
+  int err_;
+  Bytef* out_;
+  size_t out_len_;
+  uLong crc_;
+};
+
+
+// deflateBlock(in, dictionary, last, level, memLevel, strategy, ondone)
+static void DeflateBlock(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK_EQ(args.Length(), 7);
+
+  CHECK(Buffer::HasInstance(args[0]));
+  const char* dictionary = nullptr;
+  size_t dictionary_len = 0;
+  if (!args[1]->IsNull()) {
+    CHECK(Buffer::HasInstance(args[1]));
+    dictionary = Buffer::Data(args[1]);
+    dictionary_len = Buffer::Length(args[1]);
+  }
+
+  const int level = args[3]->Int32Value();
+  CHECK((level >= -1 && level <= 9) && "invalid compression level");
+  const int mem_level = args[4]->Int32Value();
+  CHECK((mem_level >= 1 && mem_level <= 9) && "invalid memlevel");
+  CHECK(args[6]->IsFunction());
+
+  Local<Object> obj = env->NewInternalFieldObject();
+  // The input and the dictionary have to outlive the request
+  obj->Set(env->buffer_string(), args[0]);
+  obj->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "dictionary"), args[1]);
+  obj->Set(env->ondone_string(), args[6]);
+
+  DeflateBlockRequest* req =
+      new DeflateBlockRequest(env,
+                              obj,
+                              Buffer::Data(args[0]),
+                              Buffer::Length(args[0]),
+                              dictionary,
+                              dictionary_len,
+                              args[2]->IsTrue(),
+                              level,
+                              mem_level,
+                              args[5]->Int32Value());
+  uv_queue_work_ex(env->event_loop(),
+                   req->work_req(),
+                   UV_WORK_COMPRESSION,
+                   DeflateBlockRequest::Work,
+                   DeflateBlockRequest::After);
+}
+
+
+// crc32Combine(crc1, crc2, len2), the CRC-32 of two pieces of data given the
+// CRC-32 of each and the length of the second one
+static void Crc32Combine(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsUint32());
+  CHECK(args[1]->IsUint32());
+  CHECK(args[2]->IsNumber());
+  const uLong crc = crc32_combine(args[0]->Uint32Value(),
+                                  args[1]->Uint32Value(),
+                                  args[2]->IntegerValue());
+  args.GetReturnValue().Set(static_cast<uint32_t>(crc));
+}
+
+
+// zlibSync(mode, input, flush, windowBits, level, memLevel, strategy,
+//          dictionary), compresses or decompresses a whole buffer in a single
+// call using a stream from the environment's pool.  Returns the output, an
+// array of [message, errno] when zlib fails or null when the output would
+// exceed kMaxLength.
+static void ZlibSync(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK_EQ(args.Length(), 8);
+
+  CHECK(args[0]->IsInt32());
+  const node_zlib_mode mode =
+      static_cast<node_zlib_mode>(args[0]->Int32Value());
+  CHECK(mode >= DEFLATE && mode <= UNZIP);
+  CHECK(Buffer::HasInstance(args[1]));
+  const int flush = args[2]->Int32Value();
+  int window_bits = args[3]->Int32Value();
+  CHECK((window_bits >= 8 && window_bits <= 15) && "invalid windowBits");
+  const int level = args[4]->Int32Value();
+  CHECK((level >= -1 && level <= 9) && "invalid compression level");
+  const int mem_level = args[5]->Int32Value();
+  CHECK((mem_level >= 1 && mem_level <= 9) && "invalid memlevel");
+  const int strategy = args[6]->Int32Value();
+
+  const Bytef* dictionary = nullptr;
+  size_t dictionary_len = 0;
+  if (Buffer::HasInstance(args[7])) {
+    dictionary = reinterpret_cast<const Bytef*>(Buffer::Data(args[7]));
+    dictionary_len = Buffer::Length(args[7]);
+  }
+
+  const Bytef* in = reinterpret_cast<const Bytef*>(Buffer::Data(args[1]));
+  const size_t in_len = Buffer::Length(args[1]);
+
+  const bool deflating = mode == DEFLATE || mode == GZIP || mode == DEFLATERAW;
+  if (mode == GZIP || mode == GUNZIP)
+    window_bits += 16;
+  else if (mode == UNZIP)
+    window_bits += 32;
+  else if (mode == DEFLATERAW || mode == INFLATERAW)
+    window_bits *= -1;
+
+  // Concatenated gzip members are decompressed one after the other, the way
+  // ZCtx::Process() does it.
+  const bool gzip = mode == GUNZIP ||
+                    (mode == UNZIP && in_len >= 2 &&
+                     in[0] == GZIP_HEADER_ID1 && in[1] == GZIP_HEADER_ID2);
+
+  env->PrintSyncTrace();
+
+  ZlibStreamPool* pool = env->zlib_stream_pool();
+  int err;
+  z_stream* strm = pool->Acquire(deflating ? ZlibStreamPool::kDeflate :
+                                             ZlibStreamPool::kInflate,
+                                 window_bits,
+                                 level,
+                                 mem_level,
+                                 strategy,
+                                 &err);
+
+  const char* message = "Init error";
+  if (err == Z_OK && dictionary != nullptr &&
+      (mode == DEFLATE || mode == DEFLATERAW)) {
+    err = deflateSetDictionary(strm, dictionary, dictionary_len);
+    message = "Failed to set dictionary";
+  }
+
+  Bytef* out = nullptr;
+  size_t size = 0;
+  bool too_large = false;
+  if (err == Z_OK) {
+    message = nullptr;
+
+    // Start with room for the whole output when compressing, and a guess
+    // when decompressing; the buffer doubles whenever it fills up.
+    size = deflating ? deflateBound(strm, in_len) : in_len * 4;
+    if (size < kMinOneShotOutput)
+      size = kMinOneShotOutput;
+    if (size > Buffer::kMaxLength)
+      size = Buffer::kMaxLength;
+    out = static_cast<Bytef*>(node::Malloc(size));
+    CHECK_NE(out, nullptr);
+
+    strm->next_in = const_cast<Bytef*>(in);
+    strm->avail_in = in_len;
+    strm->next_out = out;
+    strm->avail_out = size;
+
+    for (;;) {
+      if (deflating) {
+        err = deflate(strm, flush);
+      } else {
+        err = inflate(strm, flush);
+        if (err == Z_NEED_DICT && dictionary != nullptr) {
+          err = inflateSetDictionary(strm, dictionary, dictionary_len);
+          if (err == Z_OK)
+            err = inflate(strm, flush);
+          else if (err == Z_DATA_ERROR)
+            err = Z_NEED_DICT;
+        }
+
+        // Trailing zero bytes are padding, anything else should be another
+        // member or it is an error.
+        while (gzip &&
+               err == Z_STREAM_END &&
+               strm->avail_in > 0 &&
+               strm->next_in[0] != 0x00) {
+          err = inflateReset(strm);
+          if (err == Z_OK)
+            err = inflate(strm, flush);
+        }
+      }
+
+      if ((err != Z_OK && err != Z_BUF_ERROR) || strm->avail_out != 0)
+        break;
+
+      if (size == Buffer::kMaxLength) {
+        too_large = true;
+        break;
+      }
+      const size_t used = size;
+      size = size > Buffer::kMaxLength / 2 ? Buffer::kMaxLength : size * 2;
+      out = static_cast<Bytef*>(node::Realloc(out, size));
+      CHECK_NE(out, nullptr);
+      strm->next_out = out + used;
+      strm->avail_out = size - used;
+    }
+
+    // Same rules as ZCtx::CheckError().
+    switch (err) {
+      case Z_OK:
+      case Z_BUF_ERROR:
+        if (strm->avail_out != 0 && flush == Z_FINISH)
+          message = "unexpected end of file";
+        break;
+      case Z_STREAM_END:
+        break;
+      case Z_NEED_DICT:
+        message = dictionary == nullptr ? "Missing dictionary" :
+                                          "Bad dictionary";
+        break;
+      default:
+        message = "Zlib error";
+    }
+  }
+
+  if (too_large) {
+    free(out);
+    pool->Release(strm);
+    return args.GetReturnValue().SetNull();
+  }
+
+  if (message != nullptr) {
+    if (strm->msg != nullptr)
+      message = strm->msg;
+    Local<Array> result = Array::New(env->isolate(), 2);
+    result->Set(0, OneByteString(env->isolate(), message));
+    result->Set(1, Integer::New(env->isolate(), err));
+    free(out);
+    pool->Release(strm);
+    return args.GetReturnValue().Set(result);
+  }
+
+  const size_t length = size - strm->avail_out;
+  pool->Release(strm);
+  out = static_cast<Bytef*>(node::Realloc(out, length));
+  Local<Object> buf =
+      Buffer::New(env, reinterpret_cast<char*>(out), length).ToLocalChecked();
+  args.GetReturnValue().Set(buf);
+}
+
+
+static void GetStreamPoolStatistics(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  ZlibStreamPool::Statistics stats;
+  env->zlib_stream_pool()->GetStatistics(&stats);
+
+  Local<Object> result = Object::New(env->isolate());
+  result->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "created"),
+              Number::New(env->isolate(), stats.created));
+  result->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "reused"),
+              Number::New(env->isolate(), stats.reused));
+  result->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "idle"),
+              Number::New(env->isolate(), stats.idle));
+  args.GetReturnValue().Set(result);
+}
+
+
 void InitZlib(Local<Object> target,
               Local<Value> unused,
               Local<Context> context,
@@ -658,6 +1037,11 @@ void InitZlib(Local<Object> target,
   z->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "Zlib"));
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "Zlib"), z->GetFunction());
 
+  env->SetMethod(target, "deflateBlock", DeflateBlock);
+  env->SetMethod(target, "crc32Combine", Crc32Combine);
+  env->SetMethod(target, "zlibSync", ZlibSync);
+  env->SetMethod(target, "getStreamPoolStatistics", GetStreamPoolStatistics);
+
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "ZLIB_VERSION"),
               FIXED_ONE_BYTE_STRING(env->isolate(), ZLIB_VERSION));
 }
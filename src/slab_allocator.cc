@@ -0,0 +1,218 @@
+#include "slab_allocator.h"
+
+#include "env.h"
+#include "env-inl.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+#include "util.h"
+#include "util-inl.h"
+
+#include <new>  // placement new
+
+namespace node {
+
+using v8::Isolate;
+using v8::Local;
+using v8::MaybeLocal;
+using v8::Object;
+
+// Every slice is preceded by a pointer to its slab, or nullptr for slices
+// that are too big for a slab and were malloc'd on their own.  Keeping the
+// header at 16 bytes keeps the slices suitably aligned for any use.
+static const size_t kSliceHeaderSize = 16;
+
+static inline size_t AlignUp(size_t n) {
+  return (n + kSliceHeaderSize - 1) & ~(kSliceHeaderSize - 1);
+}
+
+
+template <typename T>
+static inline char* SlabData(T* slab) {
+  return reinterpret_cast<char*>(slab) + AlignUp(sizeof(*slab));
+}
+
+
+template <typename T>
+static inline T* SliceOwner(char* base) {
+  return *reinterpret_cast<T**>(base - kSliceHeaderSize);
+}
+
+
+SlabAllocator::SlabAllocator(Isolate* isolate)
+    : isolate_(isolate),
+      current_(nullptr),
+      spare_(nullptr),
+      allocations_(0),
+      hits_(0),
+      slabs_created_(0),
+      live_slabs_(0),
+      retained_bytes_(0),
+      committed_bytes_(0) {
+}
+
+
+SlabAllocator::~SlabAllocator() {
+  if (current_ != nullptr) {
+    current_->refs -= 1;
+    current_ = nullptr;
+  }
+
+  // Slabs that are still referenced by Buffers are orphaned; FreeCallback()
+  // deletes them once their last Buffer is collected.  Don't touch the
+  // isolate here, it may already be on its way out.
+  while (Slab* slab = slabs_.PopFront()) {
+    if (slab->refs == 0) {
+      slab->~Slab();
+      free(slab);
+    } else {
+      slab->allocator = nullptr;
+    }
+  }
+}
+
+
+SlabAllocator::Slab* SlabAllocator::NewSlab() {
+  const size_t size = AlignUp(sizeof(Slab)) + kSlabSize;
+  void* mem = node::Malloc(size);
+  if (mem == nullptr)
+    FatalError("node::SlabAllocator::NewSlab()", "Out Of Memory");
+
+  Slab* slab = new(mem) Slab();
+  slab->allocator = this;
+  slab->refs = 0;
+  slab->offset = 0;
+  slabs_.PushBack(slab);
+
+  slabs_created_ += 1;
+  live_slabs_ += 1;
+  retained_bytes_ += size;
+  // Let the GC know that collecting Buffers frees up real memory.
+  isolate_->AdjustAmountOfExternalAllocatedMemory(size);
+  return slab;
+}
+
+
+void SlabAllocator::DeleteSlab(Slab* slab) {
+  const size_t size = AlignUp(sizeof(Slab)) + kSlabSize;
+  live_slabs_ -= 1;
+  retained_bytes_ -= size;
+  isolate_->AdjustAmountOfExternalAllocatedMemory(-static_cast<int64_t>(size));
+  slab->~Slab();  // Unlinks it from slabs_.
+  free(slab);
+}
+
+
+void SlabAllocator::Unref(Slab* slab) {
+  CHECK_GT(slab->refs, 0);
+  if (--slab->refs > 0)
+    return;
+
+  // The current slab holds a reference to itself, so this one is retired.
+  if (spare_ == nullptr) {
+    slab->offset = 0;
+    spare_ = slab;
+  } else {
+    DeleteSlab(slab);
+  }
+}
+
+
+uv_buf_t SlabAllocator::Allocate(size_t size) {
+  allocations_ += 1;
+
+  const size_t needed = kSliceHeaderSize + AlignUp(size);
+  if (needed > kSlabSize) {
+    char* base = static_cast<char*>(node::Malloc(kSliceHeaderSize + size));
+    if (base == nullptr)
+      FatalError("node::SlabAllocator::Allocate()", "Out Of Memory");
+    *reinterpret_cast<Slab**>(base) = nullptr;
+    return uv_buf_init(base + kSliceHeaderSize, size);
+  }
+
+  if (current_ != nullptr && kSlabSize - current_->offset >= needed) {
+    hits_ += 1;
+  } else {
+    Slab* retired = current_;
+    if (spare_ != nullptr) {
+      hits_ += 1;
+      current_ = spare_;
+      spare_ = nullptr;
+    } else {
+      current_ = NewSlab();
+    }
+    current_->refs += 1;
+    if (retired != nullptr)
+      Unref(retired);
+  }
+
+  char* base = SlabData(current_) + current_->offset;
+  *reinterpret_cast<Slab**>(base) = current_;
+  current_->offset += needed;
+  current_->refs += 1;
+  return uv_buf_init(base + kSliceHeaderSize, size);
+}
+
+
+MaybeLocal<Object> SlabAllocator::Commit(Environment* env,
+                                         const uv_buf_t* buf,
+                                         size_t nread) {
+  CHECK_LE(nread, buf->len);
+  Slab* slab = SliceOwner<Slab>(buf->base);
+  char* data = buf->base;
+
+  if (slab == nullptr) {
+    char* base = static_cast<char*>(
+        node::Realloc(buf->base - kSliceHeaderSize, kSliceHeaderSize + nread));
+    data = base + kSliceHeaderSize;
+  } else if (SlabData(slab) + slab->offset ==
+             buf->base + AlignUp(buf->len)) {
+    // Most recent slice, give the unused tail back.
+    slab->offset = (buf->base - SlabData(slab)) + AlignUp(nread);
+  }
+
+  committed_bytes_ += nread;
+
+  // The slice's reference moves over to the Buffer.
+  MaybeLocal<Object> ret = Buffer::New(env, data, nread, FreeCallback, slab);
+  if (ret.IsEmpty())
+    FreeCallback(data, slab);
+  return ret;
+}
+
+
+void SlabAllocator::Release(const uv_buf_t* buf) {
+  Slab* slab = SliceOwner<Slab>(buf->base);
+  if (slab == nullptr) {
+    free(buf->base - kSliceHeaderSize);
+    return;
+  }
+
+  if (SlabData(slab) + slab->offset == buf->base + AlignUp(buf->len))
+    slab->offset = buf->base - kSliceHeaderSize - SlabData(slab);
+  Unref(slab);
+}
+
+
+void SlabAllocator::FreeCallback(char* data, void* hint) {
+  Slab* slab = static_cast<Slab*>(hint);
+  if (slab == nullptr) {
+    free(data - kSliceHeaderSize);
+  } else if (slab->allocator != nullptr) {
+    slab->allocator->Unref(slab);
+  } else if (--slab->refs == 0) {
+    slab->~Slab();
+    free(slab);
+  }
+}
+
+
+void SlabAllocator::GetStatistics(Statistics* stats) const {
+  stats->allocations = allocations_;
+  stats->hits = hits_;
+  stats->slabs_created = slabs_created_;
+  stats->live_slabs = live_slabs_;
+  stats->retained_bytes = retained_bytes_;
+  stats->committed_bytes = committed_bytes_;
+}
+
+}  // namespace node
@@ -0,0 +1,87 @@
+#ifndef SRC_SLAB_ALLOCATOR_H_
+#define SRC_SLAB_ALLOCATOR_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "util.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <stddef.h>  // size_t
+#include <stdint.h>  // uint64_t
+
+namespace node {
+
+class Environment;
+
+// Hands out read buffers for stream handles from large, reference counted
+// slabs instead of doing a malloc() and realloc() for every read.  This is
+// the native counterpart of the allocation pool in lib/buffer.js.
+//
+// Usage: Allocate() a slice in the alloc callback, then either Commit() it
+// in the read callback, which turns the first nread bytes into a Buffer
+// that keeps the slab alive, or Release() it when nothing was read.  The
+// unused tail of the most recent slice goes back to the slab, so many small
+// reads share one slab.
+//
+// A retained Buffer pins its whole slab, exactly like a pooled Buffer in
+// JS land does.  Slabs are freed when their last Buffer is collected; one
+// empty slab is kept around as a spare.
+class SlabAllocator {
+ public:
+  static const size_t kSlabSize = 256 * 1024;
+
+  // Snapshot of the counters, see GetStatistics().
+  struct Statistics {
+    uint64_t allocations;     // Slices handed out.
+    uint64_t hits;            // Slices that did not need a fresh slab.
+    uint64_t slabs_created;   // Slabs malloc'd over the allocator's lifetime.
+    uint64_t live_slabs;      // Slabs currently alive, including the spare.
+    uint64_t retained_bytes;  // Memory held by those slabs.
+    uint64_t committed_bytes;  // Bytes turned into Buffers.
+  };
+
+  explicit SlabAllocator(v8::Isolate* isolate);
+  ~SlabAllocator();
+
+  uv_buf_t Allocate(size_t size);
+  v8::MaybeLocal<v8::Object> Commit(Environment* env,
+                                    const uv_buf_t* buf,
+                                    size_t nread);
+  void Release(const uv_buf_t* buf);
+
+  void GetStatistics(Statistics* stats) const;
+
+ private:
+  // Header of a slab, the slab's memory follows it in the same allocation.
+  struct Slab {
+    SlabAllocator* allocator;  // nullptr once the allocator is gone.
+    size_t refs;  // Outstanding slices and Buffers, plus one while current.
+    size_t offset;  // Start of the free tail.
+    ListNode<Slab> node_;
+  };
+
+  Slab* NewSlab();
+  void DeleteSlab(Slab* slab);
+  void Unref(Slab* slab);
+  static void FreeCallback(char* data, void* hint);
+
+  v8::Isolate* const isolate_;
+  Slab* current_;
+  Slab* spare_;
+  ListHead<Slab, &Slab::node_> slabs_;
+  uint64_t allocations_;
+  uint64_t hits_;
+  uint64_t slabs_created_;
+  uint64_t live_slabs_;
+  uint64_t retained_bytes_;
+  uint64_t committed_bytes_;
+
+  DISALLOW_COPY_AND_ASSIGN(SlabAllocator);
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_SLAB_ALLOCATOR_H_
@@ -16,7 +16,9 @@ using v8::External;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::HandleScope;
+using v8::Isolate;
 using v8::Local;
+using v8::Number;
 using v8::Object;
 using v8::PropertyAttribute;
 using v8::PropertyCallbackInfo;
@@ -52,6 +54,7 @@ void StreamBase::AddMethods(Environment* env,
                                      v8::DEFAULT,
                                      attributes);
 
+  env->SetProtoMethod(t, "getWriteStatistics", GetWriteStatistics<Base>);
   env->SetProtoMethod(t, "readStart", JSMethod<Base, &StreamBase::ReadStart>);
   env->SetProtoMethod(t, "readStop", JSMethod<Base, &StreamBase::ReadStop>);
   if ((flags & kFlagNoShutdown) == 0)
@@ -110,11 +113,31 @@ void StreamBase::GetBytesRead(Local<String> key,
 }
 
 
+template <class Base>
+void StreamBase::GetWriteStatistics(const FunctionCallbackInfo<Value>& args) {
+  Base* handle;
+  ASSIGN_OR_RETURN_UNWRAP(&handle, args.Holder());
+
+  StreamBase* wrap = static_cast<StreamBase*>(handle);
+  const WriteStatistics& stats = wrap->write_stats_;
+  Isolate* isolate = args.GetIsolate();
+  Local<Object> obj = Object::New(isolate);
+#define V(name, field)                                                        \
+  obj->Set(FIXED_ONE_BYTE_STRING(isolate, name),                              \
+           Number::New(isolate, static_cast<double>(stats.field)));
+  V("writes", writes)
+  V("writeAttempts", write_attempts)
+  V("bytesCopied", bytes_copied)
+  V("bytesByReference", bytes_by_reference)
+#undef V
+  args.GetReturnValue().Set(obj);
+}
+
+
 template <class Base>
 void StreamBase::GetExternal(Local<String> key,
                              const PropertyCallbackInfo<Value>& args) {
-  Base* handle = Unwrap<Base>(args.Holder());
-
+  Base* handle;
   ASSIGN_OR_RETURN_UNWRAP(&handle, args.Holder());
 
   StreamBase* wrap = static_cast<StreamBase*>(handle);
@@ -126,8 +149,7 @@ void StreamBase::GetExternal(Local<String> key,
 template <class Base,
           int (StreamBase::*Method)(const FunctionCallbackInfo<Value>& args)>
 void StreamBase::JSMethod(const FunctionCallbackInfo<Value>& args) {
-  Base* handle = Unwrap<Base>(args.Holder());
-
+  Base* handle;
   ASSIGN_OR_RETURN_UNWRAP(&handle, args.Holder());
 
   StreamBase* wrap = static_cast<StreamBase*>(handle);
@@ -4,6 +4,7 @@
 
 #include "node.h"
 #include "node_buffer.h"
+#include "node_internals.h"
 #include "env.h"
 #include "env-inl.h"
 #include "js_stream.h"
@@ -13,6 +14,7 @@
 #include "v8.h"
 
 #include <limits.h>  // INT_MAX
+#include <stdlib.h>  // free()
 
 namespace node {
 
@@ -135,11 +137,21 @@ int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
   if (arraysize(bufs_) < count)
     bufs = new uv_buf_t[count];
 
-  WriteWrap* req_wrap = WriteWrap::New(env,
-                                       req_wrap_obj,
-                                       this,
-                                       AfterWrite,
-                                       storage_size);
+  // Strings go into the write arena when it's available, so that a write
+  // that completes synchronously doesn't allocate at all.  Otherwise they
+  // are stored behind the WriteWrap like before.
+  WriteWrap* req_wrap = nullptr;
+  char* storage;
+  if (storage_size <= kWriteArenaMaxSize && write_arena_owner_ == nullptr) {
+    storage = GetWriteArena(storage_size);
+  } else {
+    req_wrap = WriteWrap::New(env,
+                              req_wrap_obj,
+                              this,
+                              AfterWrite,
+                              storage_size);
+    storage = req_wrap->Extra();
+  }
 
   uint32_t bytes = 0;
   size_t offset = 0;
@@ -151,13 +163,14 @@ int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
       bufs[i].base = Buffer::Data(chunk);
       bufs[i].len = Buffer::Length(chunk);
       bytes += bufs[i].len;
+      write_stats_.bytes_by_reference += bufs[i].len;
       continue;
     }
 
     // Write string
     offset = ROUND_UP(offset, WriteWrap::kAlignSize);
     CHECK_LE(offset, storage_size);
-    char* str_storage = req_wrap->Extra(offset);
+    char* str_storage = storage + offset;
     size_t str_size = storage_size - offset;
 
     Local<String> string = chunk->ToString(env->isolate());
@@ -172,30 +185,70 @@ int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
     bufs[i].len = str_size;
     offset += str_size;
     bytes += str_size;
+    write_stats_.bytes_copied += str_size;
+  }
+
+  write_stats_.writes++;
+
+  int err = 0;
+  uv_buf_t* vbufs = bufs;
+  size_t vcount = count;
+  if (req_wrap == nullptr) {
+    // Try writing immediately, Buffers and the arena are still valid.
+    write_stats_.write_attempts++;
+    err = DoTryWrite(&vbufs, &vcount);
+    if (err != 0 || vcount == 0)
+      goto done;
+
+    req_wrap = WriteWrap::New(env, req_wrap_obj, this, AfterWrite);
+    if (storage_size > 0)
+      write_arena_owner_ = req_wrap;
   }
 
-  int err = DoWrite(req_wrap, bufs, count, nullptr);
+  write_stats_.write_attempts++;
+  err = DoWrite(req_wrap, vbufs, vcount, nullptr);
+  req_wrap->object()->Set(env->async(), True(env->isolate()));
+
+  if (err) {
+    if (write_arena_owner_ == req_wrap)
+      write_arena_owner_ = nullptr;
+    req_wrap->Dispose();
+  }
 
+ done:
   // Deallocate space
   if (bufs != bufs_)
     delete[] bufs;
 
-  req_wrap->object()->Set(env->async(), True(env->isolate()));
-  req_wrap->object()->Set(env->bytes_string(),
-                          Number::New(env->isolate(), bytes));
+  req_wrap_obj->Set(env->bytes_string(), Number::New(env->isolate(), bytes));
   const char* msg = Error();
   if (msg != nullptr) {
     req_wrap_obj->Set(env->error_string(), OneByteString(env->isolate(), msg));
     ClearError();
   }
 
-  if (err)
-    req_wrap->Dispose();
-
   return err;
 }
 
 
+char* StreamBase::GetWriteArena(size_t size) {
+  CHECK_EQ(write_arena_owner_, nullptr);
+  if (size > write_arena_size_) {
+    // Grow in pages, the arena is kept for the lifetime of the stream.
+    size_t new_size = ROUND_UP(size, 4096);
+    char* arena = static_cast<char*>(node::Realloc(write_arena_, new_size));
+    if (arena == nullptr)
+      FatalError("node::StreamBase::GetWriteArena()", "Out Of Memory");
+    write_arena_ = arena;
+    write_arena_size_ = new_size;
+  }
+  return write_arena_;
+}
+
+
+StreamBase::~StreamBase() {
+  free(write_arena_);
+}
 
 
 int StreamBase::WriteBuffer(const FunctionCallbackInfo<Value>& args) {
@@ -212,9 +265,13 @@ int StreamBase::WriteBuffer(const FunctionCallbackInfo<Value>& args) {
   buf.base = const_cast<char*>(data);
   buf.len = length;
 
+  write_stats_.writes++;
+  write_stats_.bytes_by_reference += length;
+
   // Try writing immediately without allocation
   uv_buf_t* bufs = &buf;
   size_t count = 1;
+  write_stats_.write_attempts++;
   int err = DoTryWrite(&bufs, &count);
   if (err != 0)
     goto done;
@@ -225,6 +282,7 @@ int StreamBase::WriteBuffer(const FunctionCallbackInfo<Value>& args) {
   // Allocate, or write rest
   req_wrap = WriteWrap::New(env, req_wrap_obj, this, AfterWrite);
 
+  write_stats_.write_attempts++;
   err = DoWrite(req_wrap, bufs, count, nullptr);
   req_wrap_obj->Set(env->async(), True(env->isolate()));
   req_wrap_obj->Set(env->buffer_string(), args[1]);
@@ -277,6 +335,8 @@ int StreamBase::WriteString(const FunctionCallbackInfo<Value>& args) {
   size_t data_size;
   uv_buf_t buf;
 
+  write_stats_.writes++;
+
   bool try_write = storage_size <= sizeof(stack_storage) &&
                    (!IsIPCPipe() || send_handle_obj.IsEmpty());
   if (try_write) {
@@ -286,9 +346,11 @@ int StreamBase::WriteString(const FunctionCallbackInfo<Value>& args) {
                                    string,
                                    enc);
     buf = uv_buf_init(stack_storage, data_size);
+    write_stats_.bytes_copied += data_size;
 
     uv_buf_t* bufs = &buf;
     size_t count = 1;
+    write_stats_.write_attempts++;
     err = DoTryWrite(&bufs, &count);
 
     // Failure
@@ -318,7 +380,9 @@ int StreamBase::WriteString(const FunctionCallbackInfo<Value>& args) {
                                    storage_size,
                                    string,
                                    enc);
+    write_stats_.bytes_copied += data_size;
   }
+  write_stats_.write_attempts++;
 
   CHECK_LE(data_size, storage_size);
 
@@ -373,6 +437,10 @@ void StreamBase::AfterWrite(WriteWrap* req_wrap, int status) {
   // The wrap and request objects should still be there.
   CHECK_EQ(req_wrap->persistent().IsEmpty(), false);
 
+  // The arena may be reused by the next write.
+  if (wrap->write_arena_owner_ == req_wrap)
+    wrap->write_arena_owner_ = nullptr;
+
   // Unref handle property
   Local<Object> req_wrap_obj = req_wrap->object();
   req_wrap_obj->Delete(env->context(), env->handle_string()).FromJust();
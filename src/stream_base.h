@@ -225,11 +225,29 @@ class StreamBase : public StreamResource {
                 v8::Local<v8::Object> buf,
                 v8::Local<v8::Object> handle);
 
+  // Counters for the write path, see getWriteStatistics().
+  struct WriteStatistics {
+    uint64_t writes;  // Write requests from JS land.
+    uint64_t write_attempts;  // Calls into DoTryWrite() and DoWrite().
+    uint64_t bytes_copied;  // String bytes encoded in native land.
+    uint64_t bytes_by_reference;  // Buffer bytes handed down as-is.
+  };
+
+  // Strings of a writev() up to this size are encoded into a per-stream
+  // arena rather than into a fresh WriteWrap allocation.
+  static const size_t kWriteArenaMaxSize = 64 * 1024;
+
  protected:
-  explicit StreamBase(Environment* env) : env_(env), consumed_(false) {
+  explicit StreamBase(Environment* env)
+      : env_(env),
+        consumed_(false),
+        write_arena_(nullptr),
+        write_arena_size_(0),
+        write_arena_owner_(nullptr),
+        write_stats_() {
   }
 
-  virtual ~StreamBase() = default;
+  virtual ~StreamBase();
 
   // One of these must be implemented
   virtual AsyncWrap* GetAsyncWrap();
@@ -260,14 +278,27 @@ class StreamBase : public StreamResource {
   static void GetBytesRead(v8::Local<v8::String> key,
                            const v8::PropertyCallbackInfo<v8::Value>& args);
 
+  template <class Base>
+  static void GetWriteStatistics(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+
   template <class Base,
             int (StreamBase::*Method)(
       const v8::FunctionCallbackInfo<v8::Value>& args)>
   static void JSMethod(const v8::FunctionCallbackInfo<v8::Value>& args);
 
  private:
+  char* GetWriteArena(size_t size);
+
   Environment* env_;
   bool consumed_;
+
+  // The arena is lent to the WriteWrap of a write that couldn't complete
+  // synchronously and is reused once that write is done.
+  char* write_arena_;
+  size_t write_arena_size_;
+  WriteWrap* write_arena_owner_;
+  WriteStatistics write_stats_;
 };
 
 }  // namespace node
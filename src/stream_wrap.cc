@@ -18,6 +18,9 @@
 #include <stdlib.h>  // abort()
 #include <string.h>  // memcpy()
 #include <limits.h>  // INT_MAX
+#if !defined(_WIN32)
+#include <unistd.h>  // dup(), close()
+#endif
 
 
 namespace node {
@@ -29,7 +32,9 @@ using v8::FunctionTemplate;
 using v8::HandleScope;
 using v8::Integer;
 using v8::Local;
+using v8::Number;
 using v8::Object;
+using v8::Undefined;
 using v8::Value;
 
 
@@ -52,6 +57,29 @@ void StreamWrap::Initialize(Local<Object> target,
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "WriteWrap"),
               ww->GetFunction());
   env->set_write_wrap_constructor_function(ww->GetFunction());
+
+  env->SetMethod(target, "getReadSlabStatistics", GetReadSlabStatistics);
+}
+
+
+void StreamWrap::GetReadSlabStatistics(
+    const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  SlabAllocator::Statistics stats;
+  env->read_slab_allocator()->GetStatistics(&stats);
+
+  Local<Object> obj = Object::New(env->isolate());
+#define V(name, field)                                                        \
+  obj->Set(FIXED_ONE_BYTE_STRING(env->isolate(), name),                       \
+           Number::New(env->isolate(), static_cast<double>(stats.field)));
+  V("allocations", allocations)
+  V("hits", hits)
+  V("slabsCreated", slabs_created)
+  V("liveSlabs", live_slabs)
+  V("retainedBytes", retained_bytes)
+  V("committedBytes", committed_bytes)
+#undef V
+  args.GetReturnValue().Set(obj);
 }
 
 
@@ -77,6 +105,7 @@ void StreamWrap::AddMethods(Environment* env,
                             v8::Local<v8::FunctionTemplate> target,
                             int flags) {
   env->SetProtoMethod(target, "setBlocking", SetBlocking);
+  env->SetProtoMethod(target, "sendFile", SendFile);
   StreamBase::AddMethods<StreamWrap>(env, target, flags);
 }
 
@@ -148,14 +177,8 @@ void StreamWrap::OnAlloc(uv_handle_t* handle,
 
 
 void StreamWrap::OnAllocImpl(size_t size, uv_buf_t* buf, void* ctx) {
-  buf->base = static_cast<char*>(node::Malloc(size));
-  buf->len = size;
-
-  if (buf->base == nullptr && size > 0) {
-    FatalError(
-        "node::StreamWrap::DoAlloc(size_t, uv_buf_t*, void*)",
-        "Out Of Memory");
-  }
+  StreamWrap* wrap = static_cast<StreamWrap*>(ctx);
+  *buf = wrap->env()->read_slab_allocator()->Allocate(size);
 }
 
 
@@ -189,23 +212,25 @@ void StreamWrap::OnReadImpl(ssize_t nread,
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
 
+  SlabAllocator* allocator = env->read_slab_allocator();
   Local<Object> pending_obj;
 
   if (nread < 0)  {
     if (buf->base != nullptr)
-      free(buf->base);
+      allocator->Release(buf);
     wrap->EmitData(nread, Local<Object>(), pending_obj);
     return;
   }
 
   if (nread == 0) {
     if (buf->base != nullptr)
-      free(buf->base);
+      allocator->Release(buf);
     return;
   }
 
-  char* base = static_cast<char*>(node::Realloc(buf->base, nread));
-  CHECK_LE(static_cast<size_t>(nread), buf->len);
+  // Turn the slice into a Buffer first, accepting a handle below may
+  // allocate again.
+  Local<Object> obj = allocator->Commit(env, buf, nread).ToLocalChecked();
 
   if (pending == UV_TCP) {
     pending_obj = AcceptHandle<TCPWrap, uv_tcp_t>(env, wrap);
@@ -217,7 +242,6 @@ void StreamWrap::OnReadImpl(ssize_t nread,
     CHECK_EQ(pending, UV_UNKNOWN_HANDLE);
   }
 
-  Local<Object> obj = Buffer::New(env, base, nread).ToLocalChecked();
   wrap->EmitData(nread, obj, pending_obj);
 }
 
@@ -274,6 +298,258 @@ void StreamWrap::SetBlocking(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+SendFileWrap::SendFileWrap(Environment* env,
+                           Local<Object> req_wrap_obj,
+                           uv_file in_fd,
+                           uv_file out_fd,
+                           int64_t offset,
+                           int64_t length)
+    : ReqWrap(env, req_wrap_obj, AsyncWrap::PROVIDER_WRITEWRAP),
+      in_fd_(in_fd),
+      out_fd_(out_fd),
+      offset_(offset),
+      remaining_(length),
+      bytes_(0),
+      fallback_data_(nullptr) {
+  Wrap(req_wrap_obj, this);
+}
+
+
+SendFileWrap::~SendFileWrap() {
+  free(fallback_data_);
+#if !defined(_WIN32)
+  close(out_fd_);
+#endif
+}
+
+
+int SendFileWrap::Send() {
+  size_t chunk_size = kMaxChunkSize;
+  if (remaining_ >= 0 && static_cast<uint64_t>(remaining_) < chunk_size)
+    chunk_size = static_cast<size_t>(remaining_);
+
+  int err = uv_fs_sendfile(env()->event_loop(),
+                           &req_,
+                           out_fd_,
+                           in_fd_,
+                           offset_,
+                           chunk_size,
+                           SendFileWrap::AfterSendFile);
+  Dispatched();
+  return err;
+}
+
+
+int SendFileWrap::ReadFallbackChunk() {
+  size_t chunk_size = kFallbackChunkSize;
+  if (remaining_ >= 0 && static_cast<uint64_t>(remaining_) < chunk_size)
+    chunk_size = static_cast<size_t>(remaining_);
+
+  if (fallback_data_ == nullptr) {
+    fallback_data_ = static_cast<char*>(node::Malloc(kFallbackChunkSize));
+    if (fallback_data_ == nullptr)
+      return UV_ENOMEM;
+  }
+
+  uv_buf_t buf = uv_buf_init(fallback_data_, chunk_size);
+  int err = uv_fs_read(env()->event_loop(),
+                       &req_,
+                       in_fd_,
+                       &buf,
+                       1,
+                       offset_,
+                       SendFileWrap::AfterFallbackRead);
+  Dispatched();
+  return err;
+}
+
+
+StreamWrap* SendFileWrap::stream_wrap() {
+  HandleScope scope(env()->isolate());
+  Context::Scope context_scope(env()->context());
+  Local<Value> handle_obj = object()->Get(env()->handle_string());
+  if (!handle_obj->IsObject())
+    return nullptr;
+  StreamWrap* wrap = Unwrap<StreamWrap>(handle_obj.As<Object>());
+  if (wrap == nullptr || !wrap->IsAlive() || wrap->IsClosing())
+    return nullptr;
+  return wrap;
+}
+
+
+void SendFileWrap::Advance(ssize_t nbytes) {
+  offset_ += nbytes;
+  bytes_ += nbytes;
+  if (remaining_ > 0)
+    remaining_ -= nbytes;
+  NODE_COUNT_NET_BYTES_SENT(nbytes);
+}
+
+
+void StreamWrap::SendFile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  StreamWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+
+  CHECK(args[0]->IsObject());
+  CHECK(args[1]->IsInt32());
+  CHECK(args[2]->IsNumber());
+  CHECK(args[3]->IsNumber());
+
+  if (!wrap->IsAlive() || wrap->IsClosing())
+    return args.GetReturnValue().Set(UV_EINVAL);
+
+#if defined(_WIN32)
+  // uv_fs_sendfile() on Windows only knows about CRT file descriptors,
+  // sockets have to go through the regular write path.
+  return args.GetReturnValue().Set(UV_ENOSYS);
+#else
+  // Bytes that are still queued in libuv would be overtaken by the data
+  // that sendfile() pushes straight into the socket.
+  if (wrap->stream()->write_queue_size != 0)
+    return args.GetReturnValue().Set(UV_EBUSY);
+
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+  int in_fd = args[1]->Int32Value();
+  int64_t offset = args[2]->IntegerValue();
+  int64_t length = args[3]->IntegerValue();
+
+  int fd;
+  int err = uv_fileno(reinterpret_cast<uv_handle_t*>(wrap->stream()), &fd);
+  if (err != 0)
+    return args.GetReturnValue().Set(err);
+
+  // The threadpool keeps using the socket while the event loop is free to
+  // close the handle, so give the request its own reference to the socket.
+  int out_fd = dup(fd);
+  if (out_fd == -1)
+    return args.GetReturnValue().Set(-errno);
+
+  SendFileWrap* req_wrap = new SendFileWrap(env,
+                                            req_wrap_obj,
+                                            in_fd,
+                                            out_fd,
+                                            offset,
+                                            length);
+  req_wrap_obj->Set(env->handle_string(), wrap->object());
+
+  err = req_wrap->Send();
+  if (err)
+    delete req_wrap;
+
+  args.GetReturnValue().Set(err);
+#endif
+}
+
+
+void SendFileWrap::AfterSendFile(uv_fs_t* req) {
+  SendFileWrap* req_wrap = ContainerOf(&SendFileWrap::req_, req);
+  ssize_t result = req->result;
+  uv_fs_req_cleanup(req);
+
+  if (result == UV_EAGAIN) {
+    // The socket's send buffer is full.  Push one chunk through the stream
+    // so libuv polls for writability, then resume with sendfile().
+    int err = req_wrap->ReadFallbackChunk();
+    if (err)
+      req_wrap->Done(err);
+    return;
+  }
+
+  if (result < 0)
+    return req_wrap->Done(result);
+
+  if (result == 0)  // EOF
+    return req_wrap->Done(0);
+
+  req_wrap->Advance(result);
+
+  if (req_wrap->remaining_ == 0)
+    return req_wrap->Done(0);
+
+  // Don't keep feeding a socket that JS land has closed in the meantime,
+  // our dup()'ed descriptor would otherwise keep the connection open.
+  if (req_wrap->stream_wrap() == nullptr)
+    return req_wrap->Done(UV_ECANCELED);
+
+  int err = req_wrap->Send();
+  if (err)
+    req_wrap->Done(err);
+}
+
+
+void SendFileWrap::AfterFallbackRead(uv_fs_t* req) {
+  SendFileWrap* req_wrap = ContainerOf(&SendFileWrap::req_, req);
+  ssize_t result = req->result;
+  uv_fs_req_cleanup(req);
+
+  if (result <= 0)
+    return req_wrap->Done(result);
+
+  StreamWrap* wrap = req_wrap->stream_wrap();
+  if (wrap == nullptr)
+    return req_wrap->Done(UV_ECANCELED);
+
+  uv_buf_t buf = uv_buf_init(req_wrap->fallback_data_, result);
+  req_wrap->write_req_.data = req_wrap;
+  int err = uv_write(&req_wrap->write_req_,
+                     wrap->stream(),
+                     &buf,
+                     1,
+                     AfterFallbackWrite);
+  if (err)
+    return req_wrap->Done(err);
+
+  req_wrap->Advance(result);
+}
+
+
+void SendFileWrap::AfterFallbackWrite(uv_write_t* req, int status) {
+  SendFileWrap* req_wrap = static_cast<SendFileWrap*>(req->data);
+
+  if (status < 0 || req_wrap->remaining_ == 0)
+    return req_wrap->Done(status);
+
+  if (req_wrap->stream_wrap() == nullptr)
+    return req_wrap->Done(UV_ECANCELED);
+
+  int err = req_wrap->Send();
+  if (err)
+    req_wrap->Done(err);
+}
+
+
+void SendFileWrap::Done(int status) {
+  Environment* env = this->env();
+  HandleScope scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  // The wrap and request objects should still be there.
+  CHECK_EQ(persistent().IsEmpty(), false);
+
+  Local<Object> req_wrap_obj = object();
+  Local<Value> handle_obj = req_wrap_obj->Get(env->handle_string());
+  req_wrap_obj->Delete(env->context(), env->handle_string()).FromJust();
+  req_wrap_obj->Set(env->bytes_string(),
+                    Number::New(env->isolate(), static_cast<double>(bytes_)));
+
+  Local<Value> argv[] = {
+    Integer::New(env->isolate(), status),
+    handle_obj,
+    req_wrap_obj,
+    Undefined(env->isolate())
+  };
+
+  if (req_wrap_obj->Has(env->context(),
+                        env->oncomplete_string()).FromJust()) {
+    MakeCallback(env->oncomplete_string(), arraysize(argv), argv);
+  }
+
+  delete this;
+}
+
+
 int StreamWrap::DoShutdown(ShutdownWrap* req_wrap) {
   int err;
   err = uv_shutdown(&req_wrap->req_, stream(), AfterShutdown);
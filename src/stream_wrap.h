@@ -15,6 +15,52 @@ namespace node {
 // Forward declaration
 class StreamWrap;
 
+// Copies a byte range of a file to a stream without moving the data through
+// JS land.  The bulk of the work is done by uv_fs_sendfile() on the
+// threadpool; when the socket's send buffer is full the request falls back
+// to a single read + uv_write() so that libuv waits for the socket to become
+// writable before the next sendfile() round.
+class SendFileWrap : public ReqWrap<uv_fs_t> {
+ public:
+  SendFileWrap(Environment* env,
+               v8::Local<v8::Object> req_wrap_obj,
+               uv_file in_fd,
+               uv_file out_fd,
+               int64_t offset,
+               int64_t length);
+  ~SendFileWrap();
+
+  int Send();
+  int ReadFallbackChunk();
+
+  inline int64_t bytes() const { return bytes_; }
+  size_t self_size() const override { return sizeof(*this); }
+
+  // Upper bound for a single sendfile() round.  Linux caps transfers at
+  // 0x7ffff000 bytes anyway, keeping the chunks smaller lets us notice a
+  // closed stream sooner.
+  static const size_t kMaxChunkSize = 1 << 30;
+  static const size_t kFallbackChunkSize = 64 * 1024;
+
+ private:
+  static void AfterSendFile(uv_fs_t* req);
+  static void AfterFallbackRead(uv_fs_t* req);
+  static void AfterFallbackWrite(uv_write_t* req, int status);
+
+  // Returns nullptr once the target stream has been closed.
+  StreamWrap* stream_wrap();
+  void Done(int status);
+  void Advance(ssize_t nbytes);
+
+  const uv_file in_fd_;
+  const uv_file out_fd_;
+  int64_t offset_;
+  int64_t remaining_;  // -1 means "until EOF".
+  int64_t bytes_;
+  char* fallback_data_;
+  uv_write_t write_req_;
+};
+
 class StreamWrap : public HandleWrap, public StreamBase {
  public:
   static void Initialize(v8::Local<v8::Object> target,
@@ -75,6 +121,9 @@ class StreamWrap : public HandleWrap, public StreamBase {
 
  private:
   static void SetBlocking(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendFile(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetReadSlabStatistics(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
 
   // Callbacks for libuv
   static void OnAlloc(uv_handle_t* handle,
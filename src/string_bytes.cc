@@ -3,10 +3,14 @@
 #include "base64.h"
 #include "node.h"
 #include "node_buffer.h"
+#include "string_simd.h"
+#include "util.h"
+#include "util-inl.h"
 #include "v8.h"
 
 #include <limits.h>
 #include <string.h>  // memcpy
+#include <algorithm>
 #include <vector>
 
 // When creating strings >= this length v8's gc spins up and consumes
@@ -17,6 +21,8 @@
 namespace node {
 
 using v8::EscapableHandleScope;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
 using v8::HandleScope;
 using v8::Isolate;
 using v8::Local;
@@ -170,13 +176,33 @@ static const int8_t unhex_table[256] =
   static_cast<unsigned>(unhex_table[static_cast<uint8_t>(x)])
 
 
+// The vector decoder only takes one-byte strings.
+template <typename TypeName>
+size_t hex_decode_blocks(char* buf,
+                         size_t len,
+                         const TypeName* src,
+                         const size_t srcLen) {
+  return 0;
+}
+
+
+size_t hex_decode_blocks(char* buf,
+                         size_t len,
+                         const char* src,
+                         const size_t srcLen) {
+  return simd::HexDecodeBlocks(src, srcLen, buf, len);
+}
+
+
 template <typename TypeName>
 size_t hex_decode(char* buf,
                   size_t len,
                   const TypeName* src,
                   const size_t srcLen) {
   size_t i;
-  for (i = 0; i < len && i * 2 + 1 < srcLen; ++i) {
+  for (i = hex_decode_blocks(buf, len, src, srcLen);
+       i < len && i * 2 + 1 < srcLen;
+       ++i) {
     unsigned a = unhex(src[i * 2 + 0]);
     unsigned b = unhex(src[i * 2 + 1]);
     if (!~a || !~b)
@@ -262,6 +288,62 @@ size_t StringBytes::WriteUCS2(char* buf,
 }
 
 
+// Characters are read from the string in chunks of this many.
+static const size_t kUtf8WriteChunkSize = 4096;
+
+size_t StringBytes::WriteUtf8(char* buf,
+                              size_t buflen,
+                              Local<String> str,
+                              int flags,
+                              int* chars_written) {
+  const size_t length = str->Length();
+  size_t nchars = 0;
+  size_t nbytes = 0;
+
+  if (str->IsOneByte()) {
+    // Latin1ToUtf8() copies runs of ASCII as they are.  The characters go
+    // through a chunk on the stack rather than straight into buf, bytes past
+    // the ones that are reported as written must be left alone.
+    uint8_t chunk[kUtf8WriteChunkSize];
+    while (nchars < length && nbytes < buflen) {
+      const size_t n = std::min(length - nchars, kUtf8WriteChunkSize);
+      str->WriteOneByte(chunk, nchars, n, flags);
+      size_t consumed;
+      nbytes += simd::Latin1ToUtf8(chunk,
+                                   n,
+                                   buf + nbytes,
+                                   buflen - nbytes,
+                                   &consumed);
+      nchars += consumed;
+      if (consumed < n)
+        break;
+    }
+  } else {
+    uint16_t chunk[kUtf8WriteChunkSize];
+    while (nchars < length && nbytes < buflen) {
+      size_t n = std::min(length - nchars, kUtf8WriteChunkSize);
+      str->Write(chunk, nchars, n, flags);
+      // Don't split a surrogate pair between two chunks.
+      if (nchars + n < length && (chunk[n - 1] & 0xFC00) == 0xD800)
+        n--;
+      size_t consumed;
+      nbytes += simd::Utf16ToUtf8(chunk,
+                                  n,
+                                  buf + nbytes,
+                                  buflen - nbytes,
+                                  &consumed);
+      nchars += consumed;
+      if (consumed < n)
+        break;
+    }
+  }
+
+  if (chars_written != nullptr)
+    *chars_written = nchars;
+  return nbytes;
+}
+
+
 size_t StringBytes::Write(Isolate* isolate,
                           char* buf,
                           size_t buflen,
@@ -299,7 +381,7 @@ size_t StringBytes::Write(Isolate* isolate,
 
     case BUFFER:
     case UTF8:
-      nbytes = str->WriteUtf8(buf, buflen, chars_written, flags);
+      nbytes = WriteUtf8(buf, buflen, str, flags, chars_written);
       break;
 
     case UCS2: {
@@ -341,6 +423,11 @@ size_t StringBytes::Write(Isolate* isolate,
     case BASE64:
       if (is_extern) {
         nbytes = base64_decode(buf, buflen, data, external_nbytes);
+      } else if (str->IsOneByte()) {
+        // The decoders are vectorized for one-byte input only.
+        MaybeStackBuffer<char> value(str->Length());
+        str->WriteOneByte(reinterpret_cast<uint8_t*>(*value), 0, -1, flags);
+        nbytes = base64_decode(buf, buflen, *value, value.length());
       } else {
         String::Value value(str);
         nbytes = base64_decode(buf, buflen, *value, value.length());
@@ -353,6 +440,13 @@ size_t StringBytes::Write(Isolate* isolate,
     case HEX:
       if (is_extern) {
         nbytes = hex_decode(buf, buflen, data, external_nbytes);
+      } else if (str->IsOneByte()) {
+        // The decoders are vectorized for one-byte input only.
+        // Only the first 2 * buflen digits are read.
+        const size_t length = std::min<size_t>(str->Length(), 2 * buflen);
+        MaybeStackBuffer<char> value(length);
+        str->WriteOneByte(reinterpret_cast<uint8_t*>(*value), 0, length, flags);
+        nbytes = hex_decode(buf, buflen, *value, value.length());
       } else {
         String::Value value(str);
         nbytes = hex_decode(buf, buflen, *value, value.length());
@@ -485,106 +579,19 @@ size_t StringBytes::Size(Isolate* isolate,
 
 
 
-static bool contains_non_ascii_slow(const char* buf, size_t len) {
-  for (size_t i = 0; i < len; ++i) {
-    if (buf[i] & 0x80)
-      return true;
-  }
-  return false;
-}
-
-
-static bool contains_non_ascii(const char* src, size_t len) {
-  if (len < 16) {
-    return contains_non_ascii_slow(src, len);
-  }
-
-  const unsigned bytes_per_word = sizeof(uintptr_t);
-  const unsigned align_mask = bytes_per_word - 1;
-  const unsigned unaligned = reinterpret_cast<uintptr_t>(src) & align_mask;
-
-  if (unaligned > 0) {
-    const unsigned n = bytes_per_word - unaligned;
-    if (contains_non_ascii_slow(src, n))
-      return true;
-    src += n;
-    len -= n;
-  }
-
-
-#if defined(_WIN64) || defined(_LP64)
-  const uintptr_t mask = 0x8080808080808080ll;
-#else
-  const uintptr_t mask = 0x80808080l;
-#endif
-
-  const uintptr_t* srcw = reinterpret_cast<const uintptr_t*>(src);
-
-  for (size_t i = 0, n = len / bytes_per_word; i < n; ++i) {
-    if (srcw[i] & mask)
-      return true;
-  }
-
-  const unsigned remainder = len & align_mask;
-  if (remainder > 0) {
-    const size_t offset = len - remainder;
-    if (contains_non_ascii_slow(src + offset, remainder))
-      return true;
-  }
-
-  return false;
+bool StringBytes::ContainsNonAscii(const char* buf, size_t buflen) {
+  return !simd::IsAscii(buf, buflen);
 }
 
 
-static void force_ascii_slow(const char* src, char* dst, size_t len) {
-  for (size_t i = 0; i < len; ++i) {
-    dst[i] = src[i] & 0x7f;
-  }
-}
-
-
-static void force_ascii(const char* src, char* dst, size_t len) {
-  if (len < 16) {
-    force_ascii_slow(src, dst, len);
-    return;
-  }
-
-  const unsigned bytes_per_word = sizeof(uintptr_t);
-  const unsigned align_mask = bytes_per_word - 1;
-  const unsigned src_unalign = reinterpret_cast<uintptr_t>(src) & align_mask;
-  const unsigned dst_unalign = reinterpret_cast<uintptr_t>(dst) & align_mask;
-
-  if (src_unalign > 0) {
-    if (src_unalign == dst_unalign) {
-      const unsigned unalign = bytes_per_word - src_unalign;
-      force_ascii_slow(src, dst, unalign);
-      src += unalign;
-      dst += unalign;
-      len -= src_unalign;
-    } else {
-      force_ascii_slow(src, dst, len);
-      return;
-    }
-  }
-
-#if defined(_WIN64) || defined(_LP64)
-  const uintptr_t mask = ~0x8080808080808080ll;
-#else
-  const uintptr_t mask = ~0x80808080l;
-#endif
-
-  const uintptr_t* srcw = reinterpret_cast<const uintptr_t*>(src);
-  uintptr_t* dstw = reinterpret_cast<uintptr_t*>(dst);
-
-  for (size_t i = 0, n = len / bytes_per_word; i < n; ++i) {
-    dstw[i] = srcw[i] & mask;
-  }
-
-  const unsigned remainder = len & align_mask;
-  if (remainder > 0) {
-    const size_t offset = len - remainder;
-    force_ascii_slow(src + offset, dst + offset, remainder);
+Local<String> StringBytes::NewExternalOneByte(Isolate* isolate,
+                                              char* buf,
+                                              size_t buflen) {
+  if (buflen == 0) {
+    free(buf);
+    return String::Empty(isolate);
   }
+  return ExternOneByteString::New(isolate, buf, buflen);
 }
 
 
@@ -594,7 +601,8 @@ static size_t hex_encode(const char* src, size_t slen, char* dst, size_t dlen) {
       "not enough space provided for hex encode");
 
   dlen = slen * 2;
-  for (uint32_t i = 0, k = 0; k < dlen; i += 1, k += 2) {
+  const size_t start = simd::HexEncodeBlocks(src, slen, dst);
+  for (size_t i = start, k = start * 2; k < dlen; i += 1, k += 2) {
     static const char hex[] = "0123456789abcdef";
     uint8_t val = static_cast<uint8_t>(src[i]);
     dst[k + 0] = hex[val >> 4];
@@ -606,6 +614,71 @@ static size_t hex_encode(const char* src, size_t slen, char* dst, size_t dlen) {
 
 
 
+// Decodes UTF-8 with the kernels from string_simd.h.  ASCII and Latin-1
+// text becomes a one-byte string.  Malformed input is left to V8, which
+// takes care of replacing the bad sequences.
+static Local<String> DecodeUtf8(Isolate* isolate,
+                                const char* buf,
+                                size_t buflen) {
+  const size_t ascii = simd::AsciiPrefixLength(buf, buflen);
+  if (ascii == buflen) {
+    if (buflen < EXTERN_APEX)
+      return OneByteString(isolate, buf, buflen);
+    return ExternOneByteString::NewFromCopy(isolate, buf, buflen);
+  }
+
+  size_t length;
+  bool latin1;
+  if (!simd::ValidateUtf8(buf + ascii, buflen - ascii, &length, &latin1)) {
+    return String::NewFromUtf8(isolate,
+                               buf,
+                               String::kNormalString,
+                               buflen);
+  }
+  length += ascii;
+
+  if (latin1) {
+    MaybeStackBuffer<uint8_t> stack_dst;
+    uint8_t* dst;
+    if (length < EXTERN_APEX) {
+      stack_dst.AllocateSufficientStorage(length);
+      dst = *stack_dst;
+    } else {
+      dst = static_cast<uint8_t*>(node::Malloc(length));
+      if (dst == nullptr)
+        return Local<String>();
+    }
+    memcpy(dst, buf, ascii);
+    simd::Utf8ToLatin1(buf + ascii, buflen - ascii, dst + ascii);
+    if (length < EXTERN_APEX)
+      return OneByteString(isolate, dst, length);
+    return ExternOneByteString::New(isolate,
+                                    reinterpret_cast<char*>(dst),
+                                    length);
+  }
+
+  MaybeStackBuffer<uint16_t> stack_dst;
+  uint16_t* dst;
+  if (length < EXTERN_APEX) {
+    stack_dst.AllocateSufficientStorage(length);
+    dst = *stack_dst;
+  } else {
+    dst = static_cast<uint16_t*>(node::Malloc(length * sizeof(*dst)));
+    if (dst == nullptr)
+      return Local<String>();
+  }
+  simd::Latin1ToUtf16(reinterpret_cast<const uint8_t*>(buf), ascii, dst);
+  simd::Utf8ToUtf16(buf + ascii, buflen - ascii, dst + ascii);
+  if (length < EXTERN_APEX) {
+    return String::NewFromTwoByte(isolate,
+                                  dst,
+                                  String::kNormalString,
+                                  length);
+  }
+  return ExternTwoByteString::New(isolate, dst, length);
+}
+
+
 Local<Value> StringBytes::Encode(Isolate* isolate,
                                  const char* buf,
                                  size_t buflen,
@@ -627,12 +700,12 @@ Local<Value> StringBytes::Encode(Isolate* isolate,
       }
 
     case ASCII:
-      if (contains_non_ascii(buf, buflen)) {
+      if (!simd::IsAscii(buf, buflen)) {
         char* out = static_cast<char*>(node::Malloc(buflen));
         if (out == nullptr) {
           return Local<String>();
         }
-        force_ascii(buf, out, buflen);
+        simd::ClearHighBits(buf, out, buflen);
         if (buflen < EXTERN_APEX) {
           val = OneByteString(isolate, out, buflen);
           free(out);
@@ -648,10 +721,7 @@ Local<Value> StringBytes::Encode(Isolate* isolate,
       break;
 
     case UTF8:
-      val = String::NewFromUtf8(isolate,
-                                buf,
-                                String::kNormalString,
-                                buflen);
+      val = DecodeUtf8(isolate, buf, buflen);
       break;
 
     case LATIN1:
@@ -763,4 +833,254 @@ Local<Value> StringBytes::Encode(Isolate* isolate,
   return ret;
 }
 
+
+StringCodec::StringCodec(Environment* env,
+                         Local<Object> wrap,
+                         enum encoding encoding)
+    : BaseObject(env, wrap),
+      encoding_(encoding) {
+  MakeWeak<StringCodec>(this);
+  Reset();
+}
+
+
+void StringCodec::Initialize(Environment* env, Local<Object> target) {
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+
+  env->SetProtoMethod(t, "encode", Encode);
+  env->SetProtoMethod(t, "decode", Decode);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "StringCodec"),
+              t->GetFunction());
+}
+
+
+void StringCodec::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args.IsConstructCall());
+  const enum encoding encoding = ParseEncoding(env->isolate(), args[0], UTF8);
+  CHECK(encoding == BASE64 || encoding == HEX);
+  new StringCodec(env, args.This(), encoding);
+}
+
+
+void StringCodec::Reset() {
+  pending_length_ = 0;
+  finished_ = false;
+  odd_length_ = false;
+}
+
+
+// encode(buffer, flush)
+void StringCodec::Encode(const FunctionCallbackInfo<Value>& args) {
+  StringCodec* codec;
+  ASSIGN_OR_RETURN_UNWRAP(&codec, args.Holder());
+  CHECK(args[0]->IsUint8Array());
+  const char* data = Buffer::Data(args[0]);
+  const size_t length = Buffer::Length(args[0]);
+  const bool flush = args[1]->IsTrue();
+
+  if (codec->encoding_ == HEX) {
+    args.GetReturnValue().Set(
+        StringBytes::Encode(args.GetIsolate(), data, length, HEX));
+    return;
+  }
+  args.GetReturnValue().Set(codec->EncodeBase64(data, length, flush));
+}
+
+
+Local<Value> StringCodec::EncodeBase64(const char* data,
+                                       size_t length,
+                                       bool flush) {
+  Isolate* isolate = env()->isolate();
+  const size_t held = pending_length_;
+  const size_t total = held + length;
+  const size_t count = flush ? total : total - total % 3;
+
+  if (count == 0) {
+    memcpy(pending_ + held, data, length);
+    pending_length_ = total;
+    return String::Empty(isolate);
+  }
+
+  // The group started by the held back bytes is finished first, then the
+  // rest is encoded in one go.
+  Local<String> head;
+  size_t used = 0;
+  if (held > 0) {
+    char group[3];
+    memcpy(group, pending_, held);
+    used = std::min(3 - held, length);
+    memcpy(group + held, data, used);
+    char chars[4];
+    base64_encode(group, held + used, chars, sizeof(chars));
+    head = OneByteString(isolate, chars, sizeof(chars));
+  }
+
+  const size_t rest = count - held - used;
+  memcpy(pending_, data + used + rest, length - used - rest);
+  pending_length_ = length - used - rest;
+
+  if (rest == 0)
+    return head;
+  Local<Value> body = StringBytes::Encode(isolate, data + used, rest, BASE64);
+  if (head.IsEmpty() || body.IsEmpty())
+    return body;
+  return String::Concat(head, body.As<String>());
+}
+
+
+// Writes the bytes of the sextets held back, all of them for a whole group
+// and those that are complete otherwise, like base64_decode_slow() does.
+size_t StringCodec::WriteBase64Group(char* dst) {
+  const uint8_t* const v = pending_;
+  const size_t n = pending_length_;
+  pending_length_ = 0;
+  if (n < 2)
+    return 0;
+  dst[0] = (v[0] << 2) | (v[1] >> 4);
+  if (n < 3)
+    return 1;
+  dst[1] = (v[1] << 4) | (v[2] >> 2);
+  if (n < 4)
+    return 2;
+  dst[2] = (v[2] << 6) | v[3];
+  return 3;
+}
+
+
+template <typename TypeName>
+size_t StringCodec::DecodeBase64(char* dst,
+                                 size_t dstlen,
+                                 const TypeName* src,
+                                 size_t srclen,
+                                 bool flush) {
+  size_t i = 0;
+  size_t k = 0;
+  while (i < srclen && !finished_) {
+    if (pending_length_ == 0) {
+      size_t consumed;
+      k += base64_decode_groups(dst + k, dstlen - k, src + i, srclen - i,
+                                &consumed);
+      i += consumed;
+      if (i >= srclen)
+        break;
+    }
+    // Padding, whitespace or the start of an incomplete group.
+    const uint8_t c = src[i];
+    const uint8_t lo = unbase64(c);
+    i += 1;
+    if (lo < 64) {
+      pending_[pending_length_++] = lo;
+      if (pending_length_ == 4)
+        k += WriteBase64Group(dst + k);
+    } else if (c == '=') {
+      k += WriteBase64Group(dst + k);
+      finished_ = true;
+    }
+  }
+  if (flush) {
+    k += WriteBase64Group(dst + k);
+    Reset();
+  }
+  return k;
+}
+
+
+template <typename TypeName>
+size_t StringCodec::DecodeHex(char* dst, const TypeName* src, size_t srclen) {
+  odd_length_ = odd_length_ != (srclen % 2 == 1);
+  if (finished_ || srclen == 0)
+    return 0;
+
+  size_t i = 0;
+  size_t k = 0;
+  if (pending_length_ == 1) {
+    const unsigned a = unhex(pending_[0]);
+    const unsigned b = unhex(src[0]);
+    pending_length_ = 0;
+    i = 1;
+    if (!~a || !~b) {
+      finished_ = true;
+      return 0;
+    }
+    dst[k++] = (a << 4) | b;
+  }
+
+  const size_t n = hex_decode(dst + k, (srclen - i) / 2, src + i, srclen - i);
+  k += n;
+  i += 2 * n;
+  if (i + 1 < srclen) {
+    finished_ = true;
+  } else if (i < srclen) {
+    pending_[0] = static_cast<uint8_t>(src[i]);
+    pending_length_ = 1;
+  }
+  return k;
+}
+
+
+// decode(string, flush)
+void StringCodec::Decode(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  StringCodec* codec;
+  ASSIGN_OR_RETURN_UNWRAP(&codec, args.Holder());
+  CHECK(args[0]->IsString());
+  Local<String> str = args[0].As<String>();
+  const bool flush = args[1]->IsTrue();
+  const size_t length = str->Length();
+
+  const size_t storage = codec->encoding_ == BASE64 ?
+      (codec->pending_length_ + length) / 4 * 3 + 3 :
+      (length + 1) / 2;
+  // An empty hex string needs no storage, and Malloc(0) returns nullptr.
+  char* dst = nullptr;
+  if (storage > 0) {
+    dst = static_cast<char*>(node::Malloc(storage));
+    CHECK_NE(dst, nullptr);
+  }
+
+  // The vector decoders want one-byte input, like StringBytes::Write().
+  size_t written;
+  if (str->IsExternalOneByte()) {
+    const char* data = str->GetExternalOneByteStringResource()->data();
+    written = codec->encoding_ == BASE64 ?
+        codec->DecodeBase64(dst, storage, data, length, flush) :
+        codec->DecodeHex(dst, data, length);
+  } else if (str->IsOneByte()) {
+    MaybeStackBuffer<char> value(length);
+    str->WriteOneByte(reinterpret_cast<uint8_t*>(*value), 0, length,
+                      String::NO_NULL_TERMINATION);
+    written = codec->encoding_ == BASE64 ?
+        codec->DecodeBase64(dst, storage, *value, length, flush) :
+        codec->DecodeHex(dst, *value, length);
+  } else {
+    String::Value value(str);
+    written = codec->encoding_ == BASE64 ?
+        codec->DecodeBase64(dst, storage, *value, length, flush) :
+        codec->DecodeHex(dst, *value, length);
+  }
+
+  if (codec->encoding_ == HEX && flush) {
+    const bool odd_length = codec->odd_length_;
+    codec->Reset();
+    if (odd_length) {
+      free(dst);
+      return env->ThrowTypeError("Invalid hex string");
+    }
+  }
+
+  if (written == 0) {
+    free(dst);
+    dst = nullptr;
+  } else if (written < storage) {
+    dst = static_cast<char*>(node::Realloc(dst, written));
+  }
+  Local<Object> buffer;
+  if (Buffer::New(env, dst, written).ToLocal(&buffer))
+    args.GetReturnValue().Set(buffer);
+}
+
 }  // namespace node
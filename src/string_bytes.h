@@ -7,6 +7,8 @@
 
 #include "v8.h"
 #include "node.h"
+#include "base-object.h"
+#include "base-object-inl.h"
 #include "env.h"
 #include "env-inl.h"
 #include "util.h"
@@ -98,7 +100,23 @@ class StringBytes {
                                      const char* buf,
                                      enum encoding encoding);
 
+  // Returns true if buf contains bytes outside of the ASCII range.
+  static bool ContainsNonAscii(const char* buf, size_t buflen);
+
+  // Turns the malloc'd buf into an external one-byte string without copying
+  // it.  The string takes ownership of buf; it is freed when the string is
+  // collected, or right away if the string can't be created.
+  static v8::Local<v8::String> NewExternalOneByte(v8::Isolate* isolate,
+                                                  char* buf,
+                                                  size_t buflen);
+
  private:
+  static size_t WriteUtf8(char* buf,
+                          size_t buflen,
+                          v8::Local<v8::String> str,
+                          int flags,
+                          int* chars_written);
+
   static size_t WriteUCS2(char* buf,
                           size_t buflen,
                           size_t nbytes,
@@ -108,6 +126,49 @@ class StringBytes {
                           size_t* chars_written);
 };
 
+// Converts between bytes and base64 or hex text a piece at a time, holding
+// back what doesn't make up a whole group yet, so that the pieces of output
+// add up to what converting all of the input at once gives.  An instance is
+// used in one direction only: StringDecoder encodes with it and
+// StringEncoder decodes.
+class StringCodec : public BaseObject {
+ public:
+  static void Initialize(Environment* env, v8::Local<v8::Object> target);
+
+ private:
+  StringCodec(Environment* env,
+              v8::Local<v8::Object> wrap,
+              enum encoding encoding);
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Encode(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Decode(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  v8::Local<v8::Value> EncodeBase64(const char* data,
+                                    size_t length,
+                                    bool flush);
+  template <typename TypeName>
+  size_t DecodeBase64(char* dst,
+                      size_t dstlen,
+                      const TypeName* src,
+                      size_t srclen,
+                      bool flush);
+  template <typename TypeName>
+  size_t DecodeHex(char* dst, const TypeName* src, size_t srclen);
+  size_t WriteBase64Group(char* dst);
+  void Reset();
+
+  const enum encoding encoding_;
+  // Bytes when encoding base64, sextets when decoding it, and a digit when
+  // decoding hex.
+  uint8_t pending_[4];
+  size_t pending_length_;
+  // Decoding stopped at base64 padding or an invalid pair of hex digits, like
+  // it does for whole strings.  The rest of the input is ignored.
+  bool finished_;
+  bool odd_length_;
+};
+
 }  // namespace node
 
 #endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
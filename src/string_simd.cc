@@ -0,0 +1,857 @@
+#include "string_simd.h"
+
+#include <string.h>  // memcpy
+
+#if defined(__x86_64__) || defined(_M_X64) ||                                \
+    ((defined(__i386__) || defined(_M_IX86)) &&                               \
+     (defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#define NODE_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// AVX2 code is compiled for the function only, through the target attribute,
+// and only runs after checking the CPU.  MSVC needs no special flags.
+#if defined(NODE_HAVE_SSE2)
+#if defined(_MSC_VER) && !defined(__clang__)
+#define NODE_HAVE_AVX2 1
+#define NODE_TARGET_AVX2
+#include <immintrin.h>
+#include <intrin.h>
+#elif defined(__clang__) ||                                                   \
+    (defined(__GNUC__) && (__GNUC__ > 4 ||                                    \
+                           (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#define NODE_HAVE_AVX2 1
+#define NODE_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+#endif
+
+namespace node {
+namespace simd {
+
+enum Level {
+  kScalar,
+  kSSE2,
+  kAVX2
+};
+
+
+static Level DetectLevel() {
+#if defined(NODE_HAVE_AVX2) && defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  const int max_leaf = info[0];
+  __cpuid(info, 1);
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  const bool avx = (info[2] & (1 << 28)) != 0;
+  if (max_leaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6) {
+    __cpuidex(info, 7, 0);
+    if (info[1] & (1 << 5))
+      return kAVX2;
+  }
+  return kSSE2;
+#elif defined(NODE_HAVE_AVX2)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return kAVX2;
+  return kSSE2;
+#elif defined(NODE_HAVE_SSE2)
+  return kSSE2;
+#else
+  return kScalar;
+#endif
+}
+
+static const Level level = DetectLevel();
+
+
+static inline unsigned CountTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index;  // NOLINT(runtime/int)
+  _BitScanForward(&index, mask);
+  return index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+
+static inline bool IsHighSurrogate(uint16_t unit) {
+  return (unit & 0xFC00) == 0xD800;
+}
+
+
+static inline bool IsLowSurrogate(uint16_t unit) {
+  return (unit & 0xFC00) == 0xDC00;
+}
+
+
+// Decodes the multi-byte sequence at s, returns its length or 0 if it is
+// malformed.  See table 3-7 in chapter 3 of the Unicode standard.
+static inline size_t DecodeSequence(const uint8_t* s,
+                                    size_t available,
+                                    uint32_t* code_point) {
+  const uint8_t c = s[0];
+  if (c < 0xC2) {
+    // Continuation byte or overlong two byte form.
+    return 0;
+  }
+
+  if (c < 0xE0) {
+    if (available < 2 || (s[1] & 0xC0) != 0x80)
+      return 0;
+    *code_point = ((c & 0x1F) << 6) | (s[1] & 0x3F);
+    return 2;
+  }
+
+  if (c < 0xF0) {
+    const uint8_t lower = c == 0xE0 ? 0xA0 : 0x80;  // Overlong.
+    const uint8_t upper = c == 0xED ? 0x9F : 0xBF;  // Surrogates.
+    if (available < 3 ||
+        s[1] < lower || s[1] > upper ||
+        (s[2] & 0xC0) != 0x80) {
+      return 0;
+    }
+    *code_point = ((c & 0x0F) << 12) | ((s[1] & 0x3F) << 6) | (s[2] & 0x3F);
+    return 3;
+  }
+
+  if (c < 0xF5) {
+    const uint8_t lower = c == 0xF0 ? 0x90 : 0x80;  // Overlong.
+    const uint8_t upper = c == 0xF4 ? 0x8F : 0xBF;  // Past U+10FFFF.
+    if (available < 4 ||
+        s[1] < lower || s[1] > upper ||
+        (s[2] & 0xC0) != 0x80 ||
+        (s[3] & 0xC0) != 0x80) {
+      return 0;
+    }
+    *code_point = ((c & 0x07) << 18) |
+                  ((s[1] & 0x3F) << 12) |
+                  ((s[2] & 0x3F) << 6) |
+                  (s[3] & 0x3F);
+    return 4;
+  }
+
+  return 0;
+}
+
+
+static size_t AsciiPrefixLengthScalar(const char* data,
+                                      size_t start,
+                                      size_t length) {
+  size_t i = start;
+  for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(word));
+    if (word & 0x8080808080808080ull)
+      break;
+  }
+  for (; i < length; i++) {
+    if (data[i] & 0x80)
+      return i;
+  }
+  return length;
+}
+
+
+static void ClearHighBitsScalar(const char* src,
+                                char* dst,
+                                size_t start,
+                                size_t length) {
+  for (size_t i = start; i < length; i++)
+    dst[i] = src[i] & 0x7f;
+}
+
+
+static void Latin1ToUtf16Scalar(const uint8_t* src,
+                                size_t start,
+                                size_t length,
+                                uint16_t* dst) {
+  for (size_t i = start; i < length; i++)
+    dst[i] = src[i];
+}
+
+
+// Narrows the leading ASCII units of src to dst, returns how many there were.
+static size_t NarrowAsciiPrefixScalar(const uint16_t* src,
+                                      size_t start,
+                                      size_t length,
+                                      char* dst) {
+  size_t i = start;
+  for (; i < length && src[i] < 0x80; i++)
+    dst[i] = static_cast<char>(src[i]);
+  return i;
+}
+
+
+#if defined(NODE_HAVE_SSE2)
+static inline __m128i Load128(const void* p) {
+  return _mm_loadu_si128(static_cast<const __m128i*>(p));
+}
+
+
+static inline void Store128(void* p, __m128i v) {
+  _mm_storeu_si128(static_cast<__m128i*>(p), v);
+}
+
+
+static size_t AsciiPrefixLengthSSE2(const char* data, size_t length) {
+  size_t i = 0;
+  for (; i + 64 <= length; i += 64) {
+    const __m128i a = Load128(data + i);
+    const __m128i b = Load128(data + i + 16);
+    const __m128i c = Load128(data + i + 32);
+    const __m128i d = Load128(data + i + 48);
+    const __m128i all = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+    if (_mm_movemask_epi8(all) != 0)
+      break;
+  }
+  for (; i + 16 <= length; i += 16) {
+    const __m128i v = Load128(data + i);
+    const uint32_t mask = _mm_movemask_epi8(v);
+    if (mask != 0)
+      return i + CountTrailingZeros(mask);
+  }
+  return AsciiPrefixLengthScalar(data, i, length);
+}
+
+
+static void ClearHighBitsSSE2(const char* src, char* dst, size_t length) {
+  const __m128i mask = _mm_set1_epi8(0x7f);
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    const __m128i v = Load128(src + i);
+    Store128(dst + i, _mm_and_si128(v, mask));
+  }
+  ClearHighBitsScalar(src, dst, i, length);
+}
+
+
+static void Latin1ToUtf16SSE2(const uint8_t* src,
+                              size_t length,
+                              uint16_t* dst) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    const __m128i v = Load128(src + i);
+    Store128(dst + i, _mm_unpacklo_epi8(v, zero));
+    Store128(dst + i + 8, _mm_unpackhi_epi8(v, zero));
+  }
+  Latin1ToUtf16Scalar(src, i, length, dst);
+}
+
+
+static size_t NarrowAsciiPrefixSSE2(const uint16_t* src,
+                                    size_t length,
+                                    char* dst) {
+  const __m128i non_ascii = _mm_set1_epi16(static_cast<int16_t>(0xFF80));
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    const __m128i a = Load128(src + i);
+    const __m128i b = Load128(src + i + 8);
+    const __m128i high = _mm_and_si128(_mm_or_si128(a, b), non_ascii);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xFFFF)
+      break;
+    Store128(dst + i, _mm_packus_epi16(a, b));
+  }
+  return NarrowAsciiPrefixScalar(src, i, length, dst);
+}
+
+// Nibbles to lowercase hex digits.
+static inline __m128i HexDigitsSSE2(__m128i nibbles) {
+  const __m128i letters = _mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9));
+  const __m128i offset = _mm_and_si128(letters, _mm_set1_epi8('a' - '0' - 10));
+  return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), offset);
+}
+
+
+static size_t HexEncodeSSE2(const char* src, size_t length, char* dst) {
+  const __m128i low_nibble = _mm_set1_epi8(0x0f);
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    const __m128i v = Load128(src + i);
+    const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), low_nibble);
+    const __m128i lo = _mm_and_si128(v, low_nibble);
+    Store128(dst + 2 * i, HexDigitsSSE2(_mm_unpacklo_epi8(hi, lo)));
+    Store128(dst + 2 * i + 16, HexDigitsSSE2(_mm_unpackhi_epi8(hi, lo)));
+  }
+  return i;
+}
+
+
+// Mask of the bytes in [lo, hi].  The bounds are ASCII, so bytes with the high
+// bit set, which compare as negative, are never in range.
+static inline __m128i InRangeSSE2(__m128i v, char lo, char hi) {
+  return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)),
+                       _mm_cmpgt_epi8(_mm_set1_epi8(hi + 1), v));
+}
+
+
+// Hex digits to nibbles.  *valid is cleared unless all of them are digits.
+static inline __m128i HexNibblesSSE2(__m128i v, bool* valid) {
+  const __m128i digit = InRangeSSE2(v, '0', '9');
+  const __m128i lower = InRangeSSE2(v, 'a', 'f');
+  const __m128i upper = InRangeSSE2(v, 'A', 'F');
+  const __m128i all = _mm_or_si128(digit, _mm_or_si128(lower, upper));
+  *valid = *valid && _mm_movemask_epi8(all) == 0xFFFF;
+  const __m128i offset =
+      _mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8('0')),
+                   _mm_or_si128(_mm_and_si128(lower, _mm_set1_epi8('a' - 10)),
+                                _mm_and_si128(upper, _mm_set1_epi8('A' - 10))));
+  return _mm_sub_epi8(v, offset);
+}
+
+
+// Joins the nibble pairs in each 16-bit lane into a byte, left in the low half.
+static inline __m128i JoinNibblesSSE2(__m128i nibbles) {
+  const __m128i joined = _mm_or_si128(_mm_slli_epi16(nibbles, 4),
+                                      _mm_srli_epi16(nibbles, 8));
+  return _mm_and_si128(joined, _mm_set1_epi16(0xff));
+}
+
+
+static size_t HexDecodeSSE2(const char* src,
+                            size_t length,
+                            char* dst,
+                            size_t dst_length) {
+  size_t k = 0;
+  for (; 2 * k + 32 <= length && k + 16 <= dst_length; k += 16) {
+    bool valid = true;
+    const __m128i a = HexNibblesSSE2(Load128(src + 2 * k), &valid);
+    const __m128i b = HexNibblesSSE2(Load128(src + 2 * k + 16), &valid);
+    if (!valid)
+      break;
+    Store128(dst + k, _mm_packus_epi16(JoinNibblesSSE2(a), JoinNibblesSSE2(b)));
+  }
+  return k;
+}
+#endif  // defined(NODE_HAVE_SSE2)
+
+
+#if defined(NODE_HAVE_AVX2)
+NODE_TARGET_AVX2
+static inline __m256i Load256(const void* p) {
+  return _mm256_loadu_si256(static_cast<const __m256i*>(p));
+}
+
+
+NODE_TARGET_AVX2
+static inline void Store256(void* p, __m256i v) {
+  _mm256_storeu_si256(static_cast<__m256i*>(p), v);
+}
+
+
+NODE_TARGET_AVX2
+static size_t AsciiPrefixLengthAVX2(const char* data, size_t length) {
+  size_t i = 0;
+  for (; i + 64 <= length; i += 64) {
+    const __m256i a = Load256(data + i);
+    const __m256i b = Load256(data + i + 32);
+    if (_mm256_movemask_epi8(_mm256_or_si256(a, b)) != 0)
+      break;
+  }
+  for (; i + 32 <= length; i += 32) {
+    const __m256i v = Load256(data + i);
+    const uint32_t mask = _mm256_movemask_epi8(v);
+    if (mask != 0)
+      return i + CountTrailingZeros(mask);
+  }
+  return AsciiPrefixLengthScalar(data, i, length);
+}
+
+
+NODE_TARGET_AVX2
+static void ClearHighBitsAVX2(const char* src, char* dst, size_t length) {
+  const __m256i mask = _mm256_set1_epi8(0x7f);
+  size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    const __m256i v = Load256(src + i);
+    Store256(dst + i, _mm256_and_si256(v, mask));
+  }
+  ClearHighBitsScalar(src, dst, i, length);
+}
+
+
+NODE_TARGET_AVX2
+static void Latin1ToUtf16AVX2(const uint8_t* src,
+                              size_t length,
+                              uint16_t* dst) {
+  size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    const __m128i a = Load128(src + i);
+    const __m128i b = Load128(src + i + 16);
+    Store256(dst + i, _mm256_cvtepu8_epi16(a));
+    Store256(dst + i + 16, _mm256_cvtepu8_epi16(b));
+  }
+  Latin1ToUtf16Scalar(src, i, length, dst);
+}
+
+
+NODE_TARGET_AVX2
+static size_t NarrowAsciiPrefixAVX2(const uint16_t* src,
+                                    size_t length,
+                                    char* dst) {
+  const __m256i non_ascii = _mm256_set1_epi16(static_cast<int16_t>(0xFF80));
+  size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    const __m256i a = Load256(src + i);
+    const __m256i b = Load256(src + i + 16);
+    if (!_mm256_testz_si256(_mm256_or_si256(a, b), non_ascii))
+      break;
+    // packus works within 128-bit lanes, put the quadwords back in order.
+    const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b),
+                                                    0xD8);
+    Store256(dst + i, packed);
+  }
+  return NarrowAsciiPrefixScalar(src, i, length, dst);
+}
+
+
+NODE_TARGET_AVX2
+static inline __m256i HexDigitsAVX2(__m256i nibbles) {
+  const __m256i letters = _mm256_cmpgt_epi8(nibbles, _mm256_set1_epi8(9));
+  const __m256i offset =
+      _mm256_and_si256(letters, _mm256_set1_epi8('a' - '0' - 10));
+  return _mm256_add_epi8(_mm256_add_epi8(nibbles, _mm256_set1_epi8('0')),
+                         offset);
+}
+
+
+NODE_TARGET_AVX2
+static size_t HexEncodeAVX2(const char* src, size_t length, char* dst) {
+  const __m256i low_nibble = _mm256_set1_epi16(0x0f);
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    // Widening keeps the bytes in order, which unpacking within the 128-bit
+    // lanes would not.
+    const __m256i v = _mm256_cvtepu8_epi16(Load128(src + i));
+    const __m256i hi = _mm256_srli_epi16(v, 4);
+    const __m256i lo = _mm256_slli_epi16(_mm256_and_si256(v, low_nibble), 8);
+    Store256(dst + 2 * i, HexDigitsAVX2(_mm256_or_si256(hi, lo)));
+  }
+  return i;
+}
+
+
+NODE_TARGET_AVX2
+static inline __m256i InRangeAVX2(__m256i v, char lo, char hi) {
+  return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(lo - 1)),
+                          _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), v));
+}
+
+
+NODE_TARGET_AVX2
+static inline __m256i HexNibblesAVX2(__m256i v, bool* valid) {
+  const __m256i digit = InRangeAVX2(v, '0', '9');
+  const __m256i lower = InRangeAVX2(v, 'a', 'f');
+  const __m256i upper = InRangeAVX2(v, 'A', 'F');
+  const __m256i all = _mm256_or_si256(digit, _mm256_or_si256(lower, upper));
+  *valid = *valid && _mm256_movemask_epi8(all) == -1;
+  const __m256i offset = _mm256_or_si256(
+      _mm256_and_si256(digit, _mm256_set1_epi8('0')),
+      _mm256_or_si256(_mm256_and_si256(lower, _mm256_set1_epi8('a' - 10)),
+                      _mm256_and_si256(upper, _mm256_set1_epi8('A' - 10))));
+  return _mm256_sub_epi8(v, offset);
+}
+
+
+NODE_TARGET_AVX2
+static inline __m256i JoinNibblesAVX2(__m256i nibbles) {
+  const __m256i joined = _mm256_or_si256(_mm256_slli_epi16(nibbles, 4),
+                                         _mm256_srli_epi16(nibbles, 8));
+  return _mm256_and_si256(joined, _mm256_set1_epi16(0xff));
+}
+
+
+NODE_TARGET_AVX2
+static size_t HexDecodeAVX2(const char* src,
+                            size_t length,
+                            char* dst,
+                            size_t dst_length) {
+  size_t k = 0;
+  for (; 2 * k + 64 <= length && k + 32 <= dst_length; k += 32) {
+    bool valid = true;
+    const __m256i a = HexNibblesAVX2(Load256(src + 2 * k), &valid);
+    const __m256i b = HexNibblesAVX2(Load256(src + 2 * k + 32), &valid);
+    if (!valid)
+      break;
+    const __m256i packed =
+        _mm256_packus_epi16(JoinNibblesAVX2(a), JoinNibblesAVX2(b));
+    Store256(dst + k, _mm256_permute4x64_epi64(packed, 0xD8));
+  }
+  return k;
+}
+
+
+// Base64 after Wojciech Mula and Daniel Lemire, "Faster Base64 Encoding and
+// Decoding Using AVX2 Instructions".
+NODE_TARGET_AVX2
+static size_t Base64EncodeAVX2(const char* src, size_t length, char* dst) {
+  // Lays out each group of three bytes as the 32-bit word [b1 b0 b2 b1],
+  // which puts every sextet within reach of a 16-bit multiply.
+  const __m256i spread = _mm256_setr_epi8(
+      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+  // Offsets from a sextet to its character, picked by the range it is in.
+  const __m256i offsets = _mm256_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+      '/' - 63, 'A', 0, 0,
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+      '/' - 63, 'A', 0, 0);
+  size_t i = 0;
+  size_t k = 0;
+  // Each 128-bit lane takes 12 bytes, loaded 16 at a time, so 28 bytes must
+  // be readable for the 24 that are encoded.
+  for (; i + 28 <= length; i += 24, k += 32) {
+    const __m256i in = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(Load128(src + i)), Load128(src + i + 12), 1);
+    const __m256i words = _mm256_shuffle_epi8(in, spread);
+    const __m256i t0 =
+        _mm256_and_si256(words, _mm256_set1_epi32(0x0fc0fc00));
+    const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+    const __m256i t2 =
+        _mm256_and_si256(words, _mm256_set1_epi32(0x003f03f0));
+    const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+    const __m256i sextets = _mm256_or_si256(t1, t3);
+
+    // 0-25 map to 13, 26-51 to 0, and 52-63 to 1-12.
+    __m256i range = _mm256_subs_epu8(sextets, _mm256_set1_epi8(51));
+    const __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), sextets);
+    range = _mm256_or_si256(range,
+                            _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+    const __m256i chars =
+        _mm256_add_epi8(sextets, _mm256_shuffle_epi8(offsets, range));
+    Store256(dst + k, chars);
+  }
+  return i;
+}
+
+
+// Characters of either alphabet to sextets.  *valid is cleared unless all of
+// them are in one.
+NODE_TARGET_AVX2
+static inline __m256i Base64SextetsAVX2(__m256i v, bool* valid) {
+  const __m256i upper = InRangeAVX2(v, 'A', 'Z');
+  const __m256i lower = InRangeAVX2(v, 'a', 'z');
+  const __m256i digit = InRangeAVX2(v, '0', '9');
+  const __m256i plus = _mm256_or_si256(
+      _mm256_cmpeq_epi8(v, _mm256_set1_epi8('+')),
+      _mm256_cmpeq_epi8(v, _mm256_set1_epi8('-')));
+  const __m256i slash = _mm256_or_si256(
+      _mm256_cmpeq_epi8(v, _mm256_set1_epi8('/')),
+      _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+  const __m256i all = _mm256_or_si256(
+      _mm256_or_si256(upper, lower),
+      _mm256_or_si256(digit, _mm256_or_si256(plus, slash)));
+  *valid = _mm256_movemask_epi8(all) == -1;
+  const __m256i letters = _mm256_or_si256(
+      _mm256_and_si256(upper, _mm256_sub_epi8(v, _mm256_set1_epi8('A'))),
+      _mm256_and_si256(lower, _mm256_sub_epi8(v, _mm256_set1_epi8('a' - 26))));
+  const __m256i others = _mm256_or_si256(
+      _mm256_and_si256(digit, _mm256_add_epi8(v, _mm256_set1_epi8(52 - '0'))),
+      _mm256_or_si256(_mm256_and_si256(plus, _mm256_set1_epi8(62)),
+                      _mm256_and_si256(slash, _mm256_set1_epi8(63))));
+  return _mm256_or_si256(letters, others);
+}
+
+
+NODE_TARGET_AVX2
+static size_t Base64DecodeAVX2(const char* src,
+                               size_t length,
+                               char* dst,
+                               size_t dst_length) {
+  // Packs the 24 bits of each 32-bit word into three bytes, most significant
+  // first, and then the 12 bytes of each lane next to each other.
+  const __m256i pack = _mm256_setr_epi8(
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+  const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+  size_t i = 0;
+  size_t k = 0;
+  // A full 32 bytes are stored for the 24 that are decoded.
+  for (; i + 32 <= length && k + 32 <= dst_length; i += 32, k += 24) {
+    bool valid;
+    const __m256i sextets = Base64SextetsAVX2(Load256(src + i), &valid);
+    if (!valid)
+      break;
+    const __m256i pairs =
+        _mm256_maddubs_epi16(sextets, _mm256_set1_epi32(0x01400140));
+    const __m256i words =
+        _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+    const __m256i bytes = _mm256_permutevar8x32_epi32(
+        _mm256_shuffle_epi8(words, pack), lanes);
+    Store256(dst + k, bytes);
+  }
+  return k;
+}
+#endif  // defined(NODE_HAVE_AVX2)
+
+
+size_t AsciiPrefixLength(const char* data, size_t length) {
+#if defined(NODE_HAVE_AVX2)
+  if (level == kAVX2)
+    return AsciiPrefixLengthAVX2(data, length);
+#endif
+#if defined(NODE_HAVE_SSE2)
+  return AsciiPrefixLengthSSE2(data, length);
+#else
+  return AsciiPrefixLengthScalar(data, 0, length);
+#endif
+}
+
+
+void ClearHighBits(const char* src, char* dst, size_t length) {
+#if defined(NODE_HAVE_AVX2)
+  if (level == kAVX2) {
+    ClearHighBitsAVX2(src, dst, length);
+    return;
+  }
+#endif
+#if defined(NODE_HAVE_SSE2)
+  ClearHighBitsSSE2(src, dst, length);
+#else
+  ClearHighBitsScalar(src, dst, 0, length);
+#endif
+}
+
+
+void Latin1ToUtf16(const uint8_t* src, size_t length, uint16_t* dst) {
+#if defined(NODE_HAVE_AVX2)
+  if (level == kAVX2) {
+    Latin1ToUtf16AVX2(src, length, dst);
+    return;
+  }
+#endif
+#if defined(NODE_HAVE_SSE2)
+  Latin1ToUtf16SSE2(src, length, dst);
+#else
+  Latin1ToUtf16Scalar(src, 0, length, dst);
+#endif
+}
+
+
+static size_t NarrowAsciiPrefix(const uint16_t* src,
+                                size_t length,
+                                char* dst) {
+#if defined(NODE_HAVE_AVX2)
+  if (level == kAVX2)
+    return NarrowAsciiPrefixAVX2(src, length, dst);
+#endif
+#if defined(NODE_HAVE_SSE2)
+  return NarrowAsciiPrefixSSE2(src, length, dst);
+#else
+  return NarrowAsciiPrefixScalar(src, 0, length, dst);
+#endif
+}
+
+
+bool ValidateUtf8(const char* data,
+                  size_t length,
+                  size_t* utf16_length,
+                  bool* latin1) {
+  const uint8_t* const s = reinterpret_cast<const uint8_t*>(data);
+  size_t units = 0;
+  bool below_0x100 = true;
+  size_t i = 0;
+  while (i < length) {
+    const size_t ascii = AsciiPrefixLength(data + i, length - i);
+    i += ascii;
+    units += ascii;
+    while (i < length && s[i] >= 0x80) {
+      uint32_t code_point;
+      const size_t n = DecodeSequence(s + i, length - i, &code_point);
+      if (n == 0)
+        return false;
+      i += n;
+      units += code_point >= 0x10000 ? 2 : 1;
+      below_0x100 = below_0x100 && code_point < 0x100;
+    }
+  }
+  *utf16_length = units;
+  *latin1 = below_0x100;
+  return true;
+}
+
+
+void Utf8ToLatin1(const char* src, size_t length, uint8_t* dst) {
+  const uint8_t* const s = reinterpret_cast<const uint8_t*>(src);
+  size_t i = 0;
+  while (i < length) {
+    const size_t ascii = AsciiPrefixLength(src + i, length - i);
+    memcpy(dst, s + i, ascii);
+    dst += ascii;
+    i += ascii;
+    // Only two byte sequences decode to U+0080 to U+00FF.
+    while (i < length && s[i] >= 0x80) {
+      *dst++ = static_cast<uint8_t>(((s[i] & 0x1F) << 6) | (s[i + 1] & 0x3F));
+      i += 2;
+    }
+  }
+}
+
+
+void Utf8ToUtf16(const char* src, size_t length, uint16_t* dst) {
+  const uint8_t* const s = reinterpret_cast<const uint8_t*>(src);
+  size_t i = 0;
+  while (i < length) {
+    const size_t ascii = AsciiPrefixLength(src + i, length - i);
+    Latin1ToUtf16(s + i, ascii, dst);
+    dst += ascii;
+    i += ascii;
+    while (i < length && s[i] >= 0x80) {
+      uint32_t code_point = 0;
+      i += DecodeSequence(s + i, length - i, &code_point);
+      if (code_point >= 0x10000) {
+        code_point -= 0x10000;
+        *dst++ = static_cast<uint16_t>(0xD800 + (code_point >> 10));
+        *dst++ = static_cast<uint16_t>(0xDC00 + (code_point & 0x3FF));
+      } else {
+        *dst++ = static_cast<uint16_t>(code_point);
+      }
+    }
+  }
+}
+
+
+size_t Latin1ToUtf8(const uint8_t* src,
+                    size_t length,
+                    char* dst,
+                    size_t dst_length,
+                    size_t* consumed) {
+  size_t i = 0;
+  size_t written = 0;
+  while (i < length && written < dst_length) {
+    size_t run = length - i;
+    if (run > dst_length - written)
+      run = dst_length - written;
+    const size_t ascii =
+        AsciiPrefixLength(reinterpret_cast<const char*>(src + i), run);
+    memcpy(dst + written, src + i, ascii);
+    written += ascii;
+    i += ascii;
+    while (i < length && src[i] >= 0x80) {
+      if (dst_length - written < 2) {
+        *consumed = i;
+        return written;
+      }
+      dst[written++] = static_cast<char>(0xC0 | (src[i] >> 6));
+      dst[written++] = static_cast<char>(0x80 | (src[i] & 0x3F));
+      i++;
+    }
+  }
+  *consumed = i;
+  return written;
+}
+
+
+size_t Utf16ToUtf8(const uint16_t* src,
+                   size_t length,
+                   char* dst,
+                   size_t dst_length,
+                   size_t* consumed) {
+  size_t i = 0;
+  size_t written = 0;
+  while (i < length && written < dst_length) {
+    size_t run = length - i;
+    if (run > dst_length - written)
+      run = dst_length - written;
+    const size_t ascii = NarrowAsciiPrefix(src + i, run, dst + written);
+    written += ascii;
+    i += ascii;
+    while (i < length && src[i] >= 0x80) {
+      uint32_t code_point = src[i];
+      size_t units = 1;
+      if (IsHighSurrogate(src[i]) &&
+          i + 1 < length &&
+          IsLowSurrogate(src[i + 1])) {
+        code_point = 0x10000 + ((code_point - 0xD800) << 10) +
+                     (src[i + 1] - 0xDC00);
+        units = 2;
+      } else if (IsHighSurrogate(src[i]) || IsLowSurrogate(src[i])) {
+        code_point = 0xFFFD;
+      }
+
+      const size_t bytes =
+          code_point < 0x800 ? 2 : code_point < 0x10000 ? 3 : 4;
+      if (dst_length - written < bytes) {
+        *consumed = i;
+        return written;
+      }
+
+      char* out = dst + written;
+      if (bytes == 2) {
+        out[0] = static_cast<char>(0xC0 | (code_point >> 6));
+        out[1] = static_cast<char>(0x80 | (code_point & 0x3F));
+      } else if (bytes == 3) {
+        out[0] = static_cast<char>(0xE0 | (code_point >> 12));
+        out[1] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (code_point & 0x3F));
+      } else {
+        out[0] = static_cast<char>(0xF0 | (code_point >> 18));
+        out[1] = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        out[2] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out[3] = static_cast<char>(0x80 | (code_point & 0x3F));
+      }
+      written += bytes;
+      i += units;
+    }
+  }
+  *consumed = i;
+  return written;
+}
+
+
+size_t Base64EncodeBlocks(const char* src, size_t length, char* dst) {
+#if defined(NODE_HAVE_AVX2)
+  if (level == kAVX2)
+    return Base64EncodeAVX2(src, length, dst);
+#endif
+  return 0;
+}
+
+
+size_t Base64DecodeBlocks(const char* src,
+                          size_t length,
+                          char* dst,
+                          size_t dst_length) {
+#if defined(NODE_HAVE_AVX2)
+  if (level == kAVX2)
+    return Base64DecodeAVX2(src, length, dst, dst_length);
+#endif
+  return 0;
+}
+
+
+size_t HexEncodeBlocks(const char* src, size_t length, char* dst) {
+#if defined(NODE_HAVE_AVX2)
+  if (level == kAVX2)
+    return HexEncodeAVX2(src, length, dst);
+#endif
+#if defined(NODE_HAVE_SSE2)
+  return HexEncodeSSE2(src, length, dst);
+#else
+  return 0;
+#endif
+}
+
+
+size_t HexDecodeBlocks(const char* src,
+                       size_t length,
+                       char* dst,
+                       size_t dst_length) {
+#if defined(NODE_HAVE_AVX2)
+  if (level == kAVX2)
+    return HexDecodeAVX2(src, length, dst, dst_length);
+#endif
+#if defined(NODE_HAVE_SSE2)
+  return HexDecodeSSE2(src, length, dst, dst_length);
+#else
+  return 0;
+#endif
+}
+
+}  // namespace simd
+}  // namespace node
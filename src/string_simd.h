@@ -0,0 +1,93 @@
+#ifndef SRC_STRING_SIMD_H_
+#define SRC_STRING_SIMD_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <stddef.h>  // size_t
+#include <stdint.h>  // uint8_t, uint16_t
+
+namespace node {
+namespace simd {
+
+// Character set kernels for StringBytes.  On x86 they use AVX2 when the CPU
+// and OS support it and SSE2 otherwise; other platforms get portable scalar
+// code.  The vector code works on runs of ASCII, which dominate real-world
+// text; multi-byte UTF-8 sequences are handled one at a time.
+
+// Index of the first byte with the high bit set, or |length| if there is none.
+size_t AsciiPrefixLength(const char* data, size_t length);
+
+inline bool IsAscii(const char* data, size_t length) {
+  return AsciiPrefixLength(data, length) == length;
+}
+
+// Copies |length| bytes from |src| to |dst| with the high bit of each one
+// cleared.  The buffers may be the same but must not overlap otherwise.
+void ClearHighBits(const char* src, char* dst, size_t length);
+
+// Checks that |data| is well-formed UTF-8: no overlong forms, surrogates or
+// code points past U+10FFFF.  On success, *utf16_length is set to the number
+// of UTF-16 code units it decodes to and *latin1 to whether all of them are
+// below U+0100.
+bool ValidateUtf8(const char* data,
+                  size_t length,
+                  size_t* utf16_length,
+                  bool* latin1);
+
+// Decoders for input that passed ValidateUtf8(), |dst| must have room for
+// utf16_length units.
+void Utf8ToLatin1(const char* src, size_t length, uint8_t* dst);
+void Utf8ToUtf16(const char* src, size_t length, uint16_t* dst);
+
+// Widens Latin-1 to UTF-16.
+void Latin1ToUtf16(const uint8_t* src, size_t length, uint16_t* dst);
+
+// Encoders that stop when the next character doesn't fit in |dst_length|
+// bytes.  They return the number of bytes written and set *consumed to the
+// number of input characters (UTF-16 code units) that went in.  Lone
+// surrogates are written as U+FFFD.
+size_t Latin1ToUtf8(const uint8_t* src,
+                    size_t length,
+                    char* dst,
+                    size_t dst_length,
+                    size_t* consumed);
+size_t Utf16ToUtf8(const uint16_t* src,
+                   size_t length,
+                   char* dst,
+                   size_t dst_length,
+                   size_t* consumed);
+
+// Vector parts of the base64 and hex codecs in base64.h and string_bytes.cc.
+// They only take whole blocks of clean input, no whitespace or padding, and
+// leave the rest to the scalar code, as they do everything on CPUs without
+// the instructions they need.
+
+// Encodes leading groups of three bytes, four characters each, and returns
+// the number of bytes consumed.
+size_t Base64EncodeBlocks(const char* src, size_t length, char* dst);
+
+// Decodes leading groups of four characters from either alphabet and returns
+// the number of bytes written; four characters were consumed for every three.
+// Blocks are stored whole, so it stops short of the end of |dst|.
+size_t Base64DecodeBlocks(const char* src,
+                          size_t length,
+                          char* dst,
+                          size_t dst_length);
+
+// Encodes leading bytes as two lowercase digits each and returns the number
+// of bytes consumed.
+size_t HexEncodeBlocks(const char* src, size_t length, char* dst);
+
+// Decodes leading pairs of digits of either case and returns the number of
+// bytes written.
+size_t HexDecodeBlocks(const char* src,
+                       size_t length,
+                       char* dst,
+                       size_t dst_length);
+
+}  // namespace simd
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_STRING_SIMD_H_
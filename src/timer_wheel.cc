@@ -0,0 +1,234 @@
+#include "timer_wheel.h"
+
+#include <string.h>  // memset()
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace node {
+
+static inline unsigned CountTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index;  // NOLINT(runtime/int)
+  _BitScanForward(&index, mask);
+  return index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+
+TimerWheel::TimerWheel(uint64_t now) : tick_(now) {
+  for (uint32_t i = 0; i <= kBuckets; i++)
+    heads_[i] = tails_[i] = kNone;
+  memset(occupied_, 0, sizeof(occupied_));
+}
+
+
+void TimerWheel::Schedule(uint32_t id, uint64_t expiry) {
+  if (id >= entries_.size()) {
+    Entry entry = { 0, kNone, kNone, kNone };
+    entries_.resize(id + 1, entry);
+  } else if (entries_[id].bucket != kNone) {
+    Unlink(id);
+  }
+  Insert(id, expiry);
+}
+
+
+void TimerWheel::Cancel(uint32_t id) {
+  if (IsScheduled(id))
+    Unlink(id);
+}
+
+
+void TimerWheel::Advance(uint64_t now) {
+  while (tick_ <= now) {
+    if (IsEmpty()) {
+      tick_ = now + 1;
+      break;
+    }
+
+    // At the end of a turn of the first level, bring down the timers of the
+    // next bucket of the second level, and so on up.
+    if ((tick_ & (kFirstLevelSize - 1)) == 0) {
+      for (unsigned level = 1; level < kLevels; level++) {
+        Cascade(Bucket(level, tick_));
+        if (((tick_ >> Shift(level)) & (kLevelSize - 1)) != 0)
+          break;
+      }
+    }
+
+    // All timers in the first level bucket of a tick expire on that tick.
+    const uint32_t bucket = Bucket(0, tick_);
+    while (heads_[bucket] != kNone) {
+      const uint32_t id = heads_[bucket];
+      Unlink(id);
+      Append(kExpired, id);
+    }
+    tick_++;
+
+    // Skip ahead to the next occupied bucket or the end of the turn.
+    const uint32_t index = Bucket(0, tick_);
+    if (index != 0) {
+      const uint32_t next = FindOccupied(index, kFirstLevelSize);
+      uint64_t target = tick_ - index +
+          (next == kNone ? kFirstLevelSize : next);
+      if (target > now + 1)
+        target = now + 1;
+      tick_ = target;
+    }
+  }
+}
+
+
+uint32_t TimerWheel::NextExpired() {
+  const uint32_t id = heads_[kExpired];
+  if (id != kNone)
+    Unlink(id);
+  return id;
+}
+
+
+uint64_t TimerWheel::NextWakeup() const {
+  if (HasExpired())
+    return tick_;
+
+  // A timer in the rest of this turn of the first level is the next one,
+  // unless the current tick is on the boundary of a turn.  The cascade for
+  // that boundary has not run yet and may bring down earlier timers.
+  const uint32_t index = Bucket(0, tick_);
+  uint64_t wakeup = UINT64_MAX;
+  uint32_t next = FindOccupied(index, kFirstLevelSize);
+  if (next != kNone) {
+    wakeup = tick_ + (next - index);
+    if (index != 0)
+      return wakeup;
+  } else {
+    next = FindOccupied(0, index);
+    if (next != kNone)
+      wakeup = tick_ - index + kFirstLevelSize + next;
+  }
+
+  // Otherwise wake up for the next cascade that brings timers down.  The
+  // current bucket of a level is cascaded on this tick if it is on the
+  // boundary, a full turn later if not.
+  for (unsigned level = 1; level < kLevels; level++) {
+    const unsigned shift = Shift(level);
+    const uint32_t base = Bucket(level, 0);
+    const uint32_t current = Bucket(level, tick_) - base;
+    const bool on_boundary = (tick_ & ((uint64_t(1) << shift) - 1)) == 0;
+    const uint32_t first = on_boundary ? current : current + 1;
+    uint64_t turns;
+    next = FindOccupied(base + first, base + kLevelSize);
+    if (next != kNone) {
+      turns = next - base - current;
+    } else {
+      next = FindOccupied(base, base + first);
+      if (next == kNone)
+        continue;
+      turns = next - base + kLevelSize - current;
+    }
+    const uint64_t cascade = ((tick_ >> shift) + turns) << shift;
+    if (cascade < wakeup)
+      wakeup = cascade;
+  }
+  return wakeup;
+}
+
+
+bool TimerWheel::IsEmpty() const {
+  for (uint32_t i = 0; i < kBuckets / 32; i++) {
+    if (occupied_[i] != 0)
+      return false;
+  }
+  return true;
+}
+
+
+void TimerWheel::Skip(uint64_t now) {
+  if (now > tick_ && IsEmpty())
+    tick_ = now;
+}
+
+
+void TimerWheel::Insert(uint32_t id, uint64_t expiry) {
+  static const uint64_t kMaxDelta = (uint64_t(1) << Shift(kLevels)) - 1;
+
+  if (expiry < tick_)
+    expiry = tick_;
+  uint64_t delta = expiry - tick_;
+  if (delta > kMaxDelta) {
+    delta = kMaxDelta;
+    expiry = tick_ + delta;
+  }
+  entries_[id].expiry = expiry;
+
+  unsigned level = 0;
+  while (level < kLevels - 1 &&
+         delta >= (uint64_t(1) << Shift(level + 1))) {
+    level++;
+  }
+  Append(Bucket(level, expiry), id);
+}
+
+
+void TimerWheel::Append(uint32_t bucket, uint32_t id) {
+  Entry* entry = &entries_[id];
+  entry->bucket = bucket;
+  entry->next = kNone;
+  entry->prev = tails_[bucket];
+  if (tails_[bucket] == kNone)
+    heads_[bucket] = id;
+  else
+    entries_[tails_[bucket]].next = id;
+  tails_[bucket] = id;
+  if (bucket != kExpired)
+    occupied_[bucket / 32] |= 1u << (bucket % 32);
+}
+
+
+void TimerWheel::Unlink(uint32_t id) {
+  Entry* entry = &entries_[id];
+  const uint32_t bucket = entry->bucket;
+  if (entry->prev == kNone)
+    heads_[bucket] = entry->next;
+  else
+    entries_[entry->prev].next = entry->next;
+  if (entry->next == kNone)
+    tails_[bucket] = entry->prev;
+  else
+    entries_[entry->next].prev = entry->prev;
+  entry->bucket = kNone;
+  if (bucket != kExpired && heads_[bucket] == kNone)
+    occupied_[bucket / 32] &= ~(1u << (bucket % 32));
+}
+
+
+void TimerWheel::Cascade(uint32_t bucket) {
+  uint32_t id = heads_[bucket];
+  heads_[bucket] = tails_[bucket] = kNone;
+  occupied_[bucket / 32] &= ~(1u << (bucket % 32));
+  while (id != kNone) {
+    const uint32_t next = entries_[id].next;
+    Insert(id, entries_[id].expiry);
+    id = next;
+  }
+}
+
+
+uint32_t TimerWheel::FindOccupied(uint32_t first, uint32_t last) const {
+  uint32_t i = first;
+  while (i < last) {
+    const uint32_t word = occupied_[i / 32] >> (i % 32);
+    if (word != 0) {
+      i += CountTrailingZeros(word);
+      return i < last ? i : kNone;
+    }
+    i = (i / 32 + 1) * 32;
+  }
+  return kNone;
+}
+
+}  // namespace node
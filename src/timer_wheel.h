@@ -0,0 +1,115 @@
+#ifndef SRC_TIMER_WHEEL_H_
+#define SRC_TIMER_WHEEL_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "util.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace node {
+
+// Hierarchical timing wheel (Varghese & Lauck) for large numbers of timers
+// that are mostly re-armed or cancelled before they expire, like the idle
+// timeouts of sockets.  Time is counted in ticks of one millisecond.  The
+// first level has a bucket for each of the next 256 ticks; four more levels
+// of 64 buckets each, every one of them 64 times coarser than the last, reach
+// 2^32 ticks ahead.  Buckets of the coarser levels are redistributed to the
+// finer ones when the wheel gets to them, so timers expire on the exact tick.
+//
+// Timers are identified by small integers chosen by the caller and live in
+// intrusive doubly linked lists, which makes scheduling and cancelling O(1).
+class TimerWheel {
+ public:
+  static const uint32_t kNone = 0xffffffff;
+
+  // |now| is the first tick that timers can expire on.
+  explicit TimerWheel(uint64_t now);
+
+  // Schedules timer |id| to expire on tick |expiry|, or on the next tick if
+  // that has passed.  A timer that is scheduled already is moved.
+  void Schedule(uint32_t id, uint64_t expiry);
+
+  // Unschedules a timer, whether or not it has expired.
+  void Cancel(uint32_t id);
+
+  inline bool IsScheduled(uint32_t id) const {
+    return id < entries_.size() && entries_[id].bucket != kNone;
+  }
+
+  // Moves the timers that expire on or before tick |now| to the expired
+  // list, in the order of their expiry.
+  void Advance(uint64_t now);
+
+  // Takes the first timer off the expired list, or returns kNone.
+  uint32_t NextExpired();
+
+  inline bool HasExpired() const { return heads_[kExpired] != kNone; }
+
+  // True if no timers are scheduled, expired ones aside.
+  bool IsEmpty() const;
+
+  // Moves the current tick forward to |now| if no timers are scheduled, so
+  // that Advance() doesn't have to catch up on the time the wheel was idle.
+  void Skip(uint64_t now);
+
+  // The first tick on which Advance() can find expired timers, or UINT64_MAX
+  // if nothing is scheduled.  It may be early, but never late.
+  uint64_t NextWakeup() const;
+
+ private:
+  static const unsigned kLevels = 5;
+  static const unsigned kFirstLevelBits = 8;
+  static const unsigned kLevelBits = 6;
+  static const uint32_t kFirstLevelSize = 1 << kFirstLevelBits;
+  static const uint32_t kLevelSize = 1 << kLevelBits;
+  static const uint32_t kBuckets =
+      kFirstLevelSize + (kLevels - 1) * kLevelSize;
+  // Extra list of the timers that expired and were not taken yet.
+  static const uint32_t kExpired = kBuckets;
+
+  struct Entry {
+    uint64_t expiry;
+    uint32_t prev;
+    uint32_t next;
+    uint32_t bucket;
+  };
+
+  // Bit shift of the tick count that gives the bucket in a coarser level.
+  static inline unsigned Shift(unsigned level) {
+    return kFirstLevelBits + (level - 1) * kLevelBits;
+  }
+
+  static inline uint32_t Bucket(unsigned level, uint64_t tick) {
+    if (level == 0)
+      return static_cast<uint32_t>(tick & (kFirstLevelSize - 1));
+    return kFirstLevelSize + (level - 1) * kLevelSize +
+        static_cast<uint32_t>((tick >> Shift(level)) & (kLevelSize - 1));
+  }
+
+  void Insert(uint32_t id, uint64_t expiry);
+  void Append(uint32_t bucket, uint32_t id);
+  void Unlink(uint32_t id);
+  // Schedules the timers in |bucket| anew, relative to the current tick.
+  void Cascade(uint32_t bucket);
+  // The first occupied bucket in [first, last), or kNone.
+  uint32_t FindOccupied(uint32_t first, uint32_t last) const;
+
+  std::vector<Entry> entries_;
+  uint32_t heads_[kBuckets + 1];
+  uint32_t tails_[kBuckets + 1];
+  // One bit per bucket that has timers in it.
+  uint32_t occupied_[kBuckets / 32];
+  // The next tick to process, all timers before it have been expired.
+  uint64_t tick_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimerWheel);
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_TIMER_WHEEL_H_
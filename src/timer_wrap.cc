@@ -3,6 +3,7 @@
 #include "env.h"
 #include "env-inl.h"
 #include "handle_wrap.h"
+#include "timer_wheel.h"
 #include "util.h"
 #include "util-inl.h"
 
@@ -16,11 +17,175 @@ using v8::FunctionTemplate;
 using v8::HandleScope;
 using v8::Integer;
 using v8::Local;
+using v8::Number;
 using v8::Object;
+using v8::Persistent;
+using v8::Uint32Array;
 using v8::Value;
 
 const uint32_t kOnTimeout = 0;
 
+
+// Milliseconds since the loop started, after updating the loop time.
+static uint64_t GetLoopTime(Environment* env) {
+  uv_update_time(env->event_loop());
+  uint64_t now = uv_now(env->event_loop());
+  CHECK(now >= env->timer_base());
+  return now - env->timer_base();
+}
+
+
+static Local<Value> LoopTimeToValue(Environment* env, uint64_t now) {
+  if (now <= 0xfffffff)
+    return Integer::NewFromUnsigned(env->isolate(), static_cast<uint32_t>(now));
+  return Number::New(env->isolate(), static_cast<double>(now));
+}
+
+
+// A TimerWheel on a single libuv timer, for timers._unrefActive().  Timers
+// are numbered by JS.  The ones that expire together are reported to JS in
+// batches: their numbers are written to a Uint32Array that JS passes to the
+// constructor and the kOnTimeout callback is called with their count.
+class TimerWheelWrap : public HandleWrap {
+ public:
+  static void Initialize(Environment* env, Local<Object> target) {
+    Local<FunctionTemplate> constructor = env->NewFunctionTemplate(New);
+    constructor->InstanceTemplate()->SetInternalFieldCount(1);
+    constructor->SetClassName(
+        FIXED_ONE_BYTE_STRING(env->isolate(), "TimerWheel"));
+    constructor->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kOnTimeout"),
+                     Integer::New(env->isolate(), kOnTimeout));
+
+    env->SetProtoMethod(constructor, "close", HandleWrap::Close);
+    env->SetProtoMethod(constructor, "ref", HandleWrap::Ref);
+    env->SetProtoMethod(constructor, "unref", HandleWrap::Unref);
+    env->SetProtoMethod(constructor, "hasRef", HandleWrap::HasRef);
+
+    env->SetProtoMethod(constructor, "start", Start);
+    env->SetProtoMethod(constructor, "stop", Stop);
+
+    target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "TimerWheel"),
+                constructor->GetFunction());
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    CHECK(args.IsConstructCall());
+    CHECK(args[0]->IsUint32Array());
+    Environment* env = Environment::GetCurrent(args);
+    new TimerWheelWrap(env, args.This(), args[0].As<Uint32Array>());
+  }
+
+  TimerWheelWrap(Environment* env,
+                 Local<Object> object,
+                 Local<Uint32Array> expired)
+      : HandleWrap(env,
+                   object,
+                   reinterpret_cast<uv_handle_t*>(&handle_),
+                   AsyncWrap::PROVIDER_TIMERWRAP),
+        wheel_(GetLoopTime(env)),
+        wakeup_(UINT64_MAX),
+        in_callback_(false),
+        expired_object_(env->isolate(), expired),
+        expired_(reinterpret_cast<uint32_t*>(
+            static_cast<char*>(expired->Buffer()->GetContents().Data()) +
+            expired->ByteOffset())),
+        expired_length_(expired->Length()) {
+    CHECK_GT(expired_length_, 0);
+    int r = uv_timer_init(env->event_loop(), &handle_);
+    CHECK_EQ(r, 0);
+  }
+
+  ~TimerWheelWrap() override {
+    expired_object_.Reset();
+  }
+
+  // var start = wheel.start(id, msecs);
+  static void Start(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    TimerWheelWrap* wrap = Unwrap<TimerWheelWrap>(args.Holder());
+
+    CHECK(HandleWrap::IsAlive(wrap));
+    CHECK(args[0]->IsUint32());
+
+    const uint32_t id = args[0]->Uint32Value();
+    const int64_t timeout = args[1]->IntegerValue();
+    const uint64_t now = GetLoopTime(env);
+    const uint64_t expiry = now + (timeout > 0 ? timeout : 0);
+    wrap->wheel_.Skip(now);
+    wrap->wheel_.Schedule(id, expiry);
+    // Re-arming a timer for later, the common case for idle timeouts, never
+    // touches the libuv timer.  Waking up earlier than needed is harmless.
+    if (expiry < wrap->wakeup_ && !wrap->in_callback_)
+      wrap->Arm();
+
+    args.GetReturnValue().Set(LoopTimeToValue(env, now));
+  }
+
+  // wheel.stop(id);
+  static void Stop(const FunctionCallbackInfo<Value>& args) {
+    TimerWheelWrap* wrap = Unwrap<TimerWheelWrap>(args.Holder());
+
+    CHECK(HandleWrap::IsAlive(wrap));
+    CHECK(args[0]->IsUint32());
+
+    wrap->wheel_.Cancel(args[0]->Uint32Value());
+  }
+
+  static void OnTimeout(uv_timer_t* handle) {
+    TimerWheelWrap* wrap = static_cast<TimerWheelWrap*>(handle->data);
+    Environment* env = wrap->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+
+    wrap->wakeup_ = UINT64_MAX;
+    wrap->wheel_.Advance(GetLoopTime(env));
+
+    wrap->in_callback_ = true;
+    while (wrap->wheel_.HasExpired()) {
+      uint32_t count = 0;
+      while (count < wrap->expired_length_) {
+        const uint32_t id = wrap->wheel_.NextExpired();
+        if (id == TimerWheel::kNone)
+          break;
+        wrap->expired_[count++] = id;
+      }
+      Local<Value> argv[] = { Integer::NewFromUnsigned(env->isolate(), count) };
+      Local<Value> ret = wrap->MakeCallback(kOnTimeout, arraysize(argv), argv);
+      // The rest is picked up on the next turn of the loop after an
+      // exception.
+      if (ret.IsEmpty() || !HandleWrap::IsAlive(wrap))
+        break;
+    }
+    wrap->in_callback_ = false;
+
+    if (HandleWrap::IsAlive(wrap))
+      wrap->Arm();
+  }
+
+  // Sets the libuv timer for the next tick that the wheel has work on.
+  void Arm() {
+    wakeup_ = wheel_.NextWakeup();
+    if (wakeup_ == UINT64_MAX) {
+      uv_timer_stop(&handle_);
+      return;
+    }
+    const uint64_t now = uv_now(env()->event_loop()) - env()->timer_base();
+    uv_timer_start(&handle_, OnTimeout, wakeup_ > now ? wakeup_ - now : 0, 0);
+  }
+
+  uv_timer_t handle_;
+  TimerWheel wheel_;
+  // The tick the libuv timer is set for, or UINT64_MAX.
+  uint64_t wakeup_;
+  bool in_callback_;
+  Persistent<Uint32Array> expired_object_;
+  uint32_t* expired_;
+  const size_t expired_length_;
+};
+
 class TimerWrap : public HandleWrap {
  public:
   static void Initialize(Local<Object> target,
@@ -45,6 +210,8 @@ class TimerWrap : public HandleWrap {
 
     target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "Timer"),
                 constructor->GetFunction());
+
+    TimerWheelWrap::Initialize(env, target);
   }
 
   size_t self_size() const override { return sizeof(*this); }
@@ -97,14 +264,7 @@ class TimerWrap : public HandleWrap {
 
   static void Now(const FunctionCallbackInfo<Value>& args) {
     Environment* env = Environment::GetCurrent(args);
-    uv_update_time(env->event_loop());
-    uint64_t now = uv_now(env->event_loop());
-    CHECK(now >= env->timer_base());
-    now -= env->timer_base();
-    if (now <= 0xfffffff)
-      args.GetReturnValue().Set(static_cast<uint32_t>(now));
-    else
-      args.GetReturnValue().Set(static_cast<double>(now));
+    args.GetReturnValue().Set(LoopTimeToValue(env, GetLoopTime(env)));
   }
 
   uv_timer_t handle_;
@@ -23,7 +23,9 @@ using v8::Exception;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
+using v8::HandleScope;
 using v8::Local;
+using v8::Number;
 using v8::Object;
 using v8::String;
 using v8::Value;
@@ -49,6 +51,8 @@ TLSWrap::TLSWrap(Environment* env,
       shutdown_(false),
       error_(nullptr),
       cycle_depth_(0),
+      offload_(nullptr),
+      offload_threshold_(0),
       eof_(false) {
   node::Wrap(object(), this);
   MakeWeak(this);
@@ -78,6 +82,12 @@ TLSWrap::~TLSWrap() {
   delete clear_in_;
   clear_in_ = nullptr;
 
+  // The object is kept alive while a job is queued
+  if (offload_ != nullptr)
+    CHECK_EQ(offload_->queued_, false);
+  delete offload_;
+  offload_ = nullptr;
+
   sc_ = nullptr;
 
 #ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
@@ -88,6 +98,57 @@ TLSWrap::~TLSWrap() {
 }
 
 
+TLSWrap::OffloadJob::OffloadJob(Environment* env)
+    : queued_(false),
+      running_(false),
+      pending_(false),
+      handshake_(false),
+      enc_out_written_(0),
+      read_error_(0),
+      info_where_(0),
+      write_failed_(false),
+      error_(nullptr) {
+  CHECK_EQ(uv_mutex_init(&mutex_), 0);
+  CHECK_EQ(uv_cond_init(&cond_), 0);
+  clear_out_.AssignEnvironment(env);
+  staged_enc_in_.AssignEnvironment(env);
+  staged_clear_in_.AssignEnvironment(env);
+}
+
+
+TLSWrap::OffloadJob::~OffloadJob() {
+  delete[] error_;
+  uv_cond_destroy(&cond_);
+  uv_mutex_destroy(&mutex_);
+}
+
+
+void TLSWrap::OffloadJob::Reset() {
+  pending_ = false;
+  handshake_ = false;
+  clear_out_.Reset();
+  staged_enc_in_.Reset();
+  staged_clear_in_.Reset();
+  enc_out_written_ = 0;
+  read_error_ = 0;
+  info_where_ = 0;
+  write_failed_ = false;
+  delete[] error_;
+  error_ = nullptr;
+}
+
+
+// Appends the contents of `from` to `to`, leaving `from` empty.
+static void MoveBIO(NodeBIO* from, NodeBIO* to) {
+  while (from->Length() > 0) {
+    size_t avail = 0;
+    char* data = from->Peek(&avail);
+    to->Write(data, avail);
+    from->Read(nullptr, avail);
+  }
+}
+
+
 void TLSWrap::MakePending() {
   write_item_queue_.MoveBack(&pending_write_items_);
 }
@@ -238,6 +299,13 @@ void TLSWrap::SSLInfoCallback(const SSL* ssl_, int where, int ret) {
   // a non-const SSL* in OpenSSL <= 0.9.7e.
   SSL* ssl = const_cast<SSL*>(ssl_);
   TLSWrap* c = static_cast<TLSWrap*>(SSL_get_app_data(ssl));
+
+  // Called on a threadpool thread, replayed by FinishOffload()
+  if (c->offload_ != nullptr && c->offload_->running_) {
+    c->offload_->info_where_ |= where;
+    return;
+  }
+
   Environment* env = c->env();
   Local<Object> object = c->object();
 
@@ -263,6 +331,10 @@ void TLSWrap::EncOut() {
   if (!hello_parser_.IsEnded())
     return;
 
+  // enc_out_ belongs to the offloaded job
+  if (offloading())
+    return;
+
   // Write in progress
   if (write_size_ != 0)
     return;
@@ -333,6 +405,13 @@ void TLSWrap::EncOutCb(WriteWrap* req_wrap, int status) {
     return;
   }
 
+  // enc_out_ belongs to the offloaded job, commit once it's done
+  if (wrap->offloading()) {
+    wrap->offload_->enc_out_written_ += wrap->write_size_;
+    wrap->write_size_ = 0;
+    return;
+  }
+
   // Commit
   NodeBIO::FromBIO(wrap->enc_out_)->Read(nullptr, wrap->write_size_);
 
@@ -401,33 +480,25 @@ void TLSWrap::ClearOut() {
   if (eof_)
     return;
 
-  if (ssl_ == nullptr)
+  if (ssl_ == nullptr || offloading())
     return;
 
   crypto::MarkPopErrorOnReturn mark_pop_error_on_return;
 
-  char out[kClearOutChunkSize];
   int read;
   for (;;) {
-    read = SSL_read(ssl_, out, sizeof(out));
-
-    if (read <= 0)
+    // Decrypt straight into the consumer's memory, an empty read hands it
+    // back
+    uv_buf_t buf;
+    OnAlloc(kClearOutChunkSize, &buf);
+    read = SSL_read(ssl_, buf.base, buf.len);
+
+    if (read <= 0) {
+      OnRead(0, &buf);
       break;
-
-    char* current = out;
-    while (read > 0) {
-      int avail = read;
-
-      uv_buf_t buf;
-      OnAlloc(avail, &buf);
-      if (static_cast<int>(buf.len) < avail)
-        avail = buf.len;
-      memcpy(buf.base, current, avail);
-      OnRead(avail, &buf);
-
-      read -= avail;
-      current += avail;
     }
+
+    OnRead(read, &buf);
   }
 
   int flags = SSL_get_shutdown(ssl_);
@@ -464,7 +535,7 @@ bool TLSWrap::ClearIn() {
   if (!hello_parser_.IsEnded())
     return false;
 
-  if (ssl_ == nullptr)
+  if (ssl_ == nullptr || offloading())
     return false;
 
   crypto::MarkPopErrorOnReturn mark_pop_error_on_return;
@@ -501,6 +572,300 @@ bool TLSWrap::ClearIn() {
 }
 
 
+// Bulk data is encrypted and decrypted on the threadpool once the handshake
+// is done. Returns true while a job is pending, the event loop must not touch
+// the SSL object then.
+bool TLSWrap::Offload() {
+  if (offload_ == nullptr)
+    return false;
+
+  if (offload_->pending_)
+    return true;
+
+  if (offload_->queued_)
+    return false;
+
+  // A server handshake suspended by SSLCertCallback() goes on with the
+  // private key operation, see StartKeyOp()
+  const bool handshake = key_op_ == kKeyOpWanted;
+  if (handshake)
+    StartKeyOp();
+  else if (!HasBulkWork())
+    return false;
+
+  // Flush what's already encrypted, the socket write proceeds meanwhile
+  if (write_size_ == 0 && BIO_pending(enc_out_) != 0) {
+    EncOut();
+    if (ssl_ == nullptr)
+      return false;
+  }
+
+  offload_->queued_ = true;
+  offload_->running_ = true;
+  offload_->pending_ = true;
+  offload_->handshake_ = handshake;
+  NodeBIO::FromBIO(enc_in_)->set_off_thread(true);
+  NodeBIO::FromBIO(enc_out_)->set_off_thread(true);
+  clear_in_->set_off_thread(true);
+  offload_->clear_out_.set_off_thread(true);
+
+  // Keep the object alive until OffloadDone()
+  ClearWeak();
+  offload_->req_.data = this;
+  CHECK_EQ(0, uv_queue_work_ex(env()->event_loop(),
+                               &offload_->req_,
+                               UV_WORK_CRYPTO,
+                               OffloadWork,
+                               OffloadDone));
+  return true;
+}
+
+
+// Returns true if there is enough bulk data to encrypt and decrypt.
+bool TLSWrap::HasBulkWork() {
+  if (offload_threshold_ == 0)
+    return false;
+
+  // Handshakes, renegotiations and alerts stay on the event loop
+  if (ssl_ == nullptr ||
+      !established_ ||
+      eof_ ||
+      shutdown_ ||
+      !hello_parser_.IsEnded() ||
+      is_waiting_new_session() ||
+      !SSL_is_init_finished(ssl_) ||
+      SSL_renegotiate_pending(ssl_)) {
+    return false;
+  }
+
+  size_t work = clear_in_->Length() + SSL_pending(ssl_);
+  if (HasApplicationRecord())
+    work += BIO_pending(enc_in_);
+  return work != 0 && work >= offload_threshold_;
+}
+
+
+// Returns true if OpenSSL holds no partially read record and enc_in_ starts
+// with a complete application data record, which can be decrypted without
+// running into the handshake or an alert.
+bool TLSWrap::HasApplicationRecord() {
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+  // This looks into the record layer state of the SSL struct, which is only
+  // public up to OpenSSL 1.0.2
+  if (ssl_->rstate != SSL_ST_READ_HEADER ||
+      ssl_->packet_length != 0 ||
+      ssl_->s3->rbuf.left != 0) {
+    return false;
+  }
+
+  NodeBIO* enc_in = NodeBIO::FromBIO(enc_in_);
+  unsigned char header[SSL3_RT_HEADER_LENGTH];
+  if (enc_in->Copy(reinterpret_cast<char*>(header), sizeof(header)) !=
+      sizeof(header)) {
+    return false;
+  }
+
+  const size_t length = (header[3] << 8) | header[4];
+  return header[0] == SSL3_RT_APPLICATION_DATA &&
+         enc_in->Length() >= sizeof(header) + length;
+#else
+  // The SSL struct is opaque, so only records that OpenSSL has read already
+  // are decrypted off the event loop, see SSL_pending()
+  return false;
+#endif  // OPENSSL_VERSION_NUMBER < 0x10100000L
+}
+
+
+// Runs on the threadpool.
+void TLSWrap::OffloadedCycle() {
+  OffloadJob* job = offload_;
+  int status = 1;
+
+  ERR_clear_error();
+
+  if (job->handshake_) {
+    // Sends the first flight of the server, up to where the client's
+    // response is needed
+    status = SSL_do_handshake(ssl_);
+  } else {
+    // Encrypt
+    size_t budget = kOffloadChunkSize;
+    while (clear_in_->Length() > 0 && budget > 0) {
+      size_t avail = 0;
+      char* data = clear_in_->Peek(&avail);
+      if (avail > budget)
+        avail = budget;
+      status = SSL_write(ssl_, data, avail);
+      CHECK(status == -1 || status == static_cast<int>(avail));
+      if (status == -1) {
+        job->write_failed_ = true;
+        break;
+      }
+      clear_in_->Read(nullptr, avail);
+      budget -= avail;
+    }
+
+    // Decrypt, stopping at anything that isn't application data
+    budget = kOffloadChunkSize;
+    while (!job->write_failed_ &&
+           budget > 0 &&
+           (SSL_pending(ssl_) > 0 || HasApplicationRecord())) {
+      size_t avail = kClearOutChunkSize;
+      char* out = job->clear_out_.PeekWritable(&avail);
+      status = SSL_read(ssl_, out, avail);
+      if (status <= 0)
+        break;
+      job->clear_out_.Commit(status);
+      budget -= budget > static_cast<size_t>(status) ? status : budget;
+    }
+  }
+
+  if (status <= 0) {
+    const int err = SSL_get_error(ssl_, status);
+    if (err == SSL_ERROR_SSL || err == SSL_ERROR_SYSCALL) {
+      BIO* bio = BIO_new(BIO_s_mem());
+      ERR_print_errors(bio);
+
+      BUF_MEM* mem;
+      BIO_get_mem_ptr(bio, &mem);
+      job->error_ = new char[mem->length + 1];
+      memcpy(job->error_, mem->data, mem->length);
+      job->error_[mem->length] = '\0';
+      BIO_free_all(bio);
+    } else {
+      job->write_failed_ = false;
+    }
+  }
+
+  ERR_clear_error();
+}
+
+
+void TLSWrap::OffloadWork(uv_work_t* req) {
+  TLSWrap* wrap = static_cast<TLSWrap*>(req->data);
+  OffloadJob* job = wrap->offload_;
+
+  wrap->OffloadedCycle();
+
+  uv_mutex_lock(&job->mutex_);
+  job->running_ = false;
+  uv_cond_signal(&job->cond_);
+  uv_mutex_unlock(&job->mutex_);
+}
+
+
+// Waits until the thread lets go of the SSL object and the BIOs.
+void TLSWrap::WaitForOffload() {
+  if (!offloading())
+    return;
+
+  uv_mutex_lock(&offload_->mutex_);
+  while (offload_->running_)
+    uv_cond_wait(&offload_->cond_, &offload_->mutex_);
+  uv_mutex_unlock(&offload_->mutex_);
+
+  if (ssl_ != nullptr) {
+    NodeBIO::FromBIO(enc_in_)->set_off_thread(false);
+    NodeBIO::FromBIO(enc_out_)->set_off_thread(false);
+    clear_in_->set_off_thread(false);
+  }
+  offload_->clear_out_.set_off_thread(false);
+}
+
+
+// Hands the results of the job to JS land and queues up what came in
+// meanwhile, in order.
+void TLSWrap::FinishOffload() {
+  if (!offloading())
+    return;
+
+  WaitForOffload();
+
+  OffloadJob* job = offload_;
+  job->pending_ = false;
+
+  if (job->handshake_) {
+    job->handshake_ = false;
+    FinishKeyOp();
+  }
+
+  if (ssl_ == nullptr) {
+    job->Reset();
+    return;
+  }
+
+  if (job->enc_out_written_ != 0) {
+    NodeBIO::FromBIO(enc_out_)->Read(nullptr, job->enc_out_written_);
+    job->enc_out_written_ = 0;
+  }
+
+  MoveBIO(&job->staged_clear_in_, clear_in_);
+  MoveBIO(&job->staged_enc_in_, NodeBIO::FromBIO(enc_in_));
+
+  const int info_where = job->info_where_;
+  job->info_where_ = 0;
+  if (info_where != 0)
+    SSLInfoCallback(ssl_, info_where, 1);
+
+  while (job->clear_out_.Length() > 0 && ssl_ != nullptr && !eof_) {
+    size_t avail = 0;
+    char* data = job->clear_out_.Peek(&avail);
+
+    uv_buf_t buf;
+    OnAlloc(avail, &buf);
+    if (buf.len < avail)
+      avail = buf.len;
+    memcpy(buf.base, data, avail);
+    job->clear_out_.Read(nullptr, avail);
+    OnRead(avail, &buf);
+  }
+  job->clear_out_.Reset();
+
+  char* const error_str = job->error_;
+  const bool write_failed = job->write_failed_;
+  job->error_ = nullptr;
+  job->write_failed_ = false;
+  if (error_str != nullptr && ssl_ != nullptr) {
+    // The SSL object is unusable now
+    offload_threshold_ = 0;
+
+    if (write_failed) {
+      MakePending();
+      InvokeQueued(UV_EPROTO, error_str);
+      clear_in_->Reset();
+    } else {
+      Local<Value> arg =
+          Exception::Error(OneByteString(env()->isolate(), error_str));
+      if (BIO_pending(enc_out_) != 0)
+        EncOut();
+      MakeCallback(env()->onerror_string(), 1, &arg);
+    }
+  }
+  delete[] error_str;
+
+  // EOF or error after the data that came with it
+  const ssize_t read_error = job->read_error_;
+  job->read_error_ = 0;
+  if (read_error != 0 && ssl_ != nullptr)
+    DoRead(read_error, nullptr, UV_UNKNOWN_HANDLE);
+}
+
+
+void TLSWrap::OffloadDone(uv_work_t* req, int status) {
+  CHECK_EQ(status, 0);
+  TLSWrap* wrap = static_cast<TLSWrap*>(req->data);
+
+  HandleScope handle_scope(wrap->env()->isolate());
+  Context::Scope context_scope(wrap->env()->context());
+
+  // No new job until the results of this one are handled
+  wrap->FinishOffload();
+  wrap->offload_->queued_ = false;
+  wrap->MakeWeak(wrap);
+  wrap->Cycle();
+}
+
+
 void* TLSWrap::Cast() {
   return reinterpret_cast<void*>(this);
 }
@@ -559,15 +924,22 @@ int TLSWrap::DoWrite(WriteWrap* w,
   CHECK_EQ(send_handle, nullptr);
   CHECK_NE(ssl_, nullptr);
 
-  bool empty = true;
+  size_t i;
+
+  // The SSL object is busy on the threadpool, queue up behind the job
+  if (offloading()) {
+    write_item_queue_.PushBack(new WriteItem(w));
+    w->Dispatched();
+    for (i = 0; i < count; i++)
+      offload_->staged_clear_in_.Write(bufs[i].base, bufs[i].len);
+    return 0;
+  }
 
   // Empty writes should not go through encryption process
-  size_t i;
+  size_t length = 0;
   for (i = 0; i < count; i++)
-    if (bufs[i].len > 0) {
-      empty = false;
-      break;
-    }
+    length += bufs[i].len;
+  bool empty = length == 0;
   if (empty) {
     ClearOut();
     // However, if there is any data that should be written to the socket,
@@ -586,6 +958,14 @@ int TLSWrap::DoWrite(WriteWrap* w,
     return 0;
   }
 
+  // Leave bulk data to the threadpool
+  if (offload_threshold_ != 0 && length >= offload_threshold_) {
+    for (i = 0; i < count; i++)
+      clear_in_->Write(bufs[i].base, bufs[i].len);
+    Cycle();
+    return 0;
+  }
+
   // Process enqueued data first
   if (!ClearIn()) {
     // If there're still data to process - enqueue current one
@@ -645,8 +1025,12 @@ void TLSWrap::OnAllocImpl(size_t suggested_size, uv_buf_t* buf, void* ctx) {
     return;
   }
 
+  NodeBIO* enc_in = NodeBIO::FromBIO(wrap->enc_in_);
+  if (wrap->offloading())
+    enc_in = &wrap->offload_->staged_enc_in_;
+
   size_t size = 0;
-  buf->base = NodeBIO::FromBIO(wrap->enc_in_)->PeekWritable(&size);
+  buf->base = enc_in->PeekWritable(&size);
   buf->len = size;
 }
 
@@ -661,9 +1045,8 @@ void TLSWrap::OnReadImpl(ssize_t nread,
 
 
 void TLSWrap::OnAllocSelf(size_t suggested_size, uv_buf_t* buf, void* ctx) {
-  buf->base = static_cast<char*>(node::Malloc(suggested_size));
-  CHECK_NE(buf->base, nullptr);
-  buf->len = suggested_size;
+  TLSWrap* wrap = static_cast<TLSWrap*>(ctx);
+  *buf = wrap->env()->read_slab_allocator()->Allocate(suggested_size);
 }
 
 
@@ -672,9 +1055,18 @@ void TLSWrap::OnReadSelf(ssize_t nread,
                          uv_handle_type pending,
                          void* ctx) {
   TLSWrap* wrap = static_cast<TLSWrap*>(ctx);
-  Local<Object> buf_obj;
-  if (buf != nullptr)
-    buf_obj = Buffer::New(wrap->env(), buf->base, buf->len).ToLocalChecked();
+  SlabAllocator* allocator = wrap->env()->read_slab_allocator();
+
+  if (nread <= 0) {
+    if (buf != nullptr && buf->base != nullptr)
+      allocator->Release(buf);
+    if (nread < 0)
+      wrap->EmitData(nread, Local<Object>(), Local<Object>());
+    return;
+  }
+
+  Local<Object> buf_obj =
+      allocator->Commit(wrap->env(), buf, nread).ToLocalChecked();
   wrap->EmitData(nread, buf_obj, Local<Object>());
 }
 
@@ -682,6 +1074,15 @@ void TLSWrap::OnReadSelf(ssize_t nread,
 void TLSWrap::DoRead(ssize_t nread,
                      const uv_buf_t* buf,
                      uv_handle_type pending) {
+  // Stage the data until the offloaded job is done
+  if (offloading()) {
+    if (nread > 0)
+      offload_->staged_enc_in_.Commit(nread);
+    else if (nread < 0 && offload_->read_error_ == 0)
+      offload_->read_error_ = nread;
+    return;
+  }
+
   if (nread < 0)  {
     // Error should be emitted only after all data was read
     ClearOut();
@@ -721,6 +1122,9 @@ void TLSWrap::DoRead(ssize_t nread,
 
 
 int TLSWrap::DoShutdown(ShutdownWrap* req_wrap) {
+  // Everything encrypted so far goes out before the close_notify
+  FinishOffload();
+
   crypto::MarkPopErrorOnReturn mark_pop_error_on_return;
 
   if (ssl_ != nullptr && SSL_shutdown(ssl_) == 0)
@@ -786,6 +1190,11 @@ void TLSWrap::DestroySSL(const FunctionCallbackInfo<Value>& args) {
   TLSWrap* wrap;
   ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
 
+  // Drop the results of an offloaded job
+  wrap->WaitForOffload();
+  if (wrap->offload_ != nullptr)
+    wrap->offload_->Reset();
+
   // Move all writes to pending
   wrap->MakePending();
 
@@ -800,6 +1209,84 @@ void TLSWrap::DestroySSL(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void TLSWrap::EnableOffload(const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+
+  if (!args[0]->IsUint32())
+    return wrap->env()->ThrowTypeError("Threshold must be a uint32");
+  if (wrap->ssl_ == nullptr)
+    return wrap->env()->ThrowTypeError("EnableOffload after destroySSL");
+
+  if (wrap->offload_ == nullptr)
+    wrap->offload_ = new OffloadJob(wrap->env());
+  wrap->offload_threshold_ = args[0]->Uint32Value();
+}
+
+
+void TLSWrap::EnableAsyncKeyOps(const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+
+  if (wrap->ssl_ == nullptr)
+    return wrap->env()->ThrowTypeError("EnableAsyncKeyOps after destroySSL");
+  CHECK(wrap->is_server());
+
+  if (wrap->offload_ == nullptr)
+    wrap->offload_ = new OffloadJob(wrap->env());
+  wrap->enable_async_key_ops();
+}
+
+
+// Memory held by the connection's buffers, whether or not it is in use
+void TLSWrap::GetMemoryUsage(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  TLSWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+
+  if (wrap->ssl_ == nullptr)
+    return;
+
+  // The worker owns the BIOs while a job runs
+  wrap->WaitForOffload();
+
+  const size_t enc_in = NodeBIO::FromBIO(wrap->enc_in_)->Allocated();
+  const size_t enc_out = NodeBIO::FromBIO(wrap->enc_out_)->Allocated();
+  const size_t clear_in = wrap->clear_in_->Allocated();
+  size_t offload = 0;
+  if (wrap->offload_ != nullptr) {
+    offload = wrap->offload_->clear_out_.Allocated() +
+              wrap->offload_->staged_enc_in_.Allocated() +
+              wrap->offload_->staged_clear_in_.Allocated();
+  }
+  const size_t ssl = kExternalSize;
+
+  Local<Object> obj = Object::New(env->isolate());
+#define V(name, key)                                                          \
+  obj->Set(env->context(),                                                    \
+           FIXED_ONE_BYTE_STRING(env->isolate(), key),                        \
+           Number::New(env->isolate(), static_cast<double>(name))).FromJust();
+  V(enc_in, "encryptedIn")
+  V(enc_out, "encryptedOut")
+  V(clear_in, "cleartextIn")
+  V(offload, "offload")
+  V(ssl, "ssl")
+  V(enc_in + enc_out + clear_in + offload + ssl, "total")
+#undef V
+  args.GetReturnValue().Set(obj);
+}
+
+
+template <void (*Method)(const FunctionCallbackInfo<Value>&)>
+void TLSWrap::AfterOffload(const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+  wrap->WaitForOffload();
+  Method(args);
+}
+
+
 void TLSWrap::EnableCertCb(const FunctionCallbackInfo<Value>& args) {
   TLSWrap* wrap;
   ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
@@ -821,6 +1308,7 @@ void TLSWrap::GetServername(const FunctionCallbackInfo<Value>& args) {
   ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
 
   CHECK_NE(wrap->ssl_, nullptr);
+  wrap->WaitForOffload();
 
   const char* servername = SSL_get_servername(wrap->ssl_,
                                               TLSEXT_NAMETYPE_host_name);
@@ -916,6 +1404,34 @@ void TLSWrap::Initialize(Local<Object> target,
   StreamBase::AddMethods<TLSWrap>(env, t, StreamBase::kFlagHasWritev);
   SSLWrap<TLSWrap>::AddMethods(env, t);
 
+  env->SetProtoMethod(t, "enableOffload", EnableOffload);
+  env->SetProtoMethod(t, "enableAsyncKeyOps", EnableAsyncKeyOps);
+  env->SetProtoMethod(t, "getMemoryUsage", GetMemoryUsage);
+
+  // The threadpool may own the SSL object while a job runs, so SSLWrap
+  // methods that use it wait for the job first
+#define V(name, method)                                                       \
+  env->SetProtoMethod(t, name, AfterOffload<SSLWrap<TLSWrap>::method>);
+  V("getPeerCertificate", GetPeerCertificate)
+  V("getSession", GetSession)
+  V("isSessionReused", IsSessionReused)
+  V("isInitFinished", IsInitFinished)
+  V("verifyError", VerifyError)
+  V("getCurrentCipher", GetCurrentCipher)
+  V("renegotiate", Renegotiate)
+  V("shutdownSSL", Shutdown)
+  V("getTLSTicket", GetTLSTicket)
+  V("getEphemeralKeyInfo", GetEphemeralKeyInfo)
+  V("getProtocol", GetProtocol)
+  V("getALPNNegotiatedProtocol", GetALPNNegotiatedProto)
+#ifdef SSL_set_max_send_fragment
+  V("setMaxSendFragment", SetMaxSendFragment)
+#endif  // SSL_set_max_send_fragment
+#ifdef OPENSSL_NPN_NEGOTIATED
+  V("getNegotiatedProtocol", GetNegotiatedProto)
+#endif  // OPENSSL_NPN_NEGOTIATED
+#undef V
+
 #ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
   env->SetProtoMethod(t, "getServername", GetServername);
   env->SetProtoMethod(t, "setServername", SetServername);
@@ -5,6 +5,7 @@
 
 #include "node.h"
 #include "node_crypto.h"  // SSLWrap
+#include "node_crypto_bio.h"  // NodeBIO
 
 #include "async-wrap.h"
 #include "env.h"
@@ -17,7 +18,6 @@
 namespace node {
 
 // Forward-declarations
-class NodeBIO;
 class WriteWrap;
 namespace crypto {
 class SecureContext;
@@ -66,6 +66,10 @@ class TLSWrap : public AsyncWrap,
   // Maximum number of buffers passed to uv_write()
   static const int kSimultaneousBufferCount = 10;
 
+  // Maximum number of cleartext bytes that an offloaded job encrypts, and
+  // decrypts, before handing the results back to the event loop
+  static const size_t kOffloadChunkSize = 256 * 1024;
+
   // Write callback queue's item
   class WriteItem {
    public:
@@ -79,6 +83,35 @@ class TLSWrap : public AsyncWrap,
     ListNode<WriteItem> member_;
   };
 
+  // Encryption and decryption of bulk data, or a step of a server handshake,
+  // on the threadpool, see Offload().
+  // While the job is pending the event loop leaves the SSL object and its
+  // BIOs alone and stages everything that comes in meanwhile.
+  class OffloadJob {
+   public:
+    explicit OffloadJob(Environment* env);
+    ~OffloadJob();
+
+    // Drops the results and the staged data
+    void Reset();
+
+    uv_work_t req_;
+    uv_mutex_t mutex_;
+    uv_cond_t cond_;
+    bool queued_;  // req_ is in use
+    bool running_;  // A thread owns the SSL object, protected by mutex_
+    bool pending_;  // The results haven't been processed yet
+    bool handshake_;  // The job runs a handshake step instead, see Offload()
+    NodeBIO clear_out_;  // Decrypted data
+    NodeBIO staged_enc_in_;  // Data read from the socket meanwhile
+    NodeBIO staged_clear_in_;  // Data written by JS land meanwhile
+    size_t enc_out_written_;  // Bytes of enc_out_ flushed meanwhile
+    ssize_t read_error_;  // EOF or error reported by the socket meanwhile
+    int info_where_;  // SSLInfoCallback() events that happened on the thread
+    bool write_failed_;
+    char* error_;  // OpenSSL error message, if any
+  };
+
   TLSWrap(Environment* env,
           Kind kind,
           StreamBase* stream,
@@ -93,14 +126,32 @@ class TLSWrap : public AsyncWrap,
   void MakePending();
   bool InvokeQueued(int status, const char* error_str = nullptr);
 
+  inline bool offloading() const {
+    return offload_ != nullptr && offload_->pending_;
+  }
+
+  bool Offload();
+  bool HasBulkWork();
+  bool HasApplicationRecord();
+  void OffloadedCycle();
+  void WaitForOffload();
+  void FinishOffload();
+  static void OffloadWork(uv_work_t* req);
+  static void OffloadDone(uv_work_t* req, int status);
+
   inline void Cycle() {
     // Prevent recursion
     if (++cycle_depth_ > 1)
       return;
 
     for (; cycle_depth_ > 0; cycle_depth_--) {
+      if (Offload())
+        continue;
       ClearIn();
       ClearOut();
+      // The handshake may have been suspended for the private key operation
+      if (key_op_ == kKeyOpWanted && Offload())
+        continue;
       EncOut();
     }
   }
@@ -137,6 +188,15 @@ class TLSWrap : public AsyncWrap,
   static void EnableCertCb(
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void DestroySSL(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void EnableOffload(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void EnableAsyncKeyOps(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetMemoryUsage(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  // Calls an SSLWrap method that reads or changes the SSL state once an
+  // offloaded job has let go of it
+  template <void (*Method)(const v8::FunctionCallbackInfo<v8::Value>&)>
+  static void AfterOffload(const v8::FunctionCallbackInfo<v8::Value>& args);
 
 #ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
   static void GetServername(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -158,6 +218,8 @@ class TLSWrap : public AsyncWrap,
   bool shutdown_;
   const char* error_;
   int cycle_depth_;
+  OffloadJob* offload_;
+  size_t offload_threshold_;
 
   // If true - delivered EOF to the js-land, either after `close_notify`, or
   // after the `UV_EOF` on socket.
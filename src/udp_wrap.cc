@@ -9,11 +9,15 @@
 #include "util-inl.h"
 
 #include <stdlib.h>
+#include <string.h>  // memcpy()
+
+#include <vector>
 
 
 namespace node {
 
 using v8::Array;
+using v8::Boolean;
 using v8::Context;
 using v8::EscapableHandleScope;
 using v8::External;
@@ -55,6 +59,52 @@ inline bool SendWrap::have_callback() const {
 }
 
 
+// One request object for a group of datagrams passed to sendBatch().  What
+// uv_udp_try_send2() can't push out right away is queued as one
+// uv_udp_send_t per datagram; the JS callback fires when the last one is done.
+class BatchSendWrap : public ReqWrap<uv_udp_send_t> {
+ public:
+  BatchSendWrap(Environment* env,
+                Local<Object> req_wrap_obj,
+                bool have_callback,
+                size_t queued);
+  ~BatchSendWrap() override;
+  inline bool have_callback() const { return have_callback_; }
+  size_t self_size() const override {
+    return sizeof(*this) + queued_ * sizeof(*reqs);
+  }
+
+  uv_udp_send_t* const reqs;
+  size_t pending;
+  size_t msg_size;
+  int status;
+
+ private:
+  const bool have_callback_;
+  const size_t queued_;
+};
+
+
+BatchSendWrap::BatchSendWrap(Environment* env,
+                             Local<Object> req_wrap_obj,
+                             bool have_callback,
+                             size_t queued)
+    : ReqWrap(env, req_wrap_obj, AsyncWrap::PROVIDER_UDPSENDWRAP),
+      reqs(queued > 0 ? new uv_udp_send_t[queued] : nullptr),
+      pending(queued),
+      msg_size(0),
+      status(0),
+      have_callback_(have_callback),
+      queued_(queued) {
+  Wrap(req_wrap_obj, this);
+}
+
+
+BatchSendWrap::~BatchSendWrap() {
+  delete[] reqs;
+}
+
+
 static void NewSendWrap(const FunctionCallbackInfo<Value>& args) {
   CHECK(args.IsConstructCall());
 }
@@ -64,12 +114,22 @@ UDPWrap::UDPWrap(Environment* env, Local<Object> object, AsyncWrap* parent)
     : HandleWrap(env,
                  object,
                  reinterpret_cast<uv_handle_t*>(&handle_),
-                 AsyncWrap::PROVIDER_UDPWRAP) {
-  int r = uv_udp_init(env->event_loop(), &handle_);
+                 AsyncWrap::PROVIDER_UDPWRAP),
+      recv_batch_(nullptr) {
+  // UV_UDP_RECVMMSG only kicks in when OnAlloc() hands out a buffer that is
+  // big enough for several datagrams, i.e. in batched receive mode.
+  int r = uv_udp_init_ex(env->event_loop(),
+                         &handle_,
+                         AF_UNSPEC | UV_UDP_RECVMMSG);
   CHECK_EQ(r, 0);  // can't fail anyway
 }
 
 
+UDPWrap::~UDPWrap() {
+  delete recv_batch_;
+}
+
+
 void UDPWrap::Initialize(Local<Object> target,
                          Local<Value> unused,
                          Local<Context> context) {
@@ -92,6 +152,8 @@ void UDPWrap::Initialize(Local<Object> target,
   env->SetProtoMethod(t, "send", Send);
   env->SetProtoMethod(t, "bind6", Bind6);
   env->SetProtoMethod(t, "send6", Send6);
+  env->SetProtoMethod(t, "sendBatch", SendBatch);
+  env->SetProtoMethod(t, "sendBatch6", SendBatch6);
   env->SetProtoMethod(t, "close", Close);
   env->SetProtoMethod(t, "recvStart", RecvStart);
   env->SetProtoMethod(t, "recvStop", RecvStop);
@@ -341,11 +403,142 @@ void UDPWrap::Send6(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void UDPWrap::DoSendBatch(const FunctionCallbackInfo<Value>& args,
+                          int family) {
+  Environment* env = Environment::GetCurrent(args);
+
+  UDPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap,
+                          args.Holder(),
+                          args.GetReturnValue().Set(UV_EBADF));
+
+  // sendBatch(req, list, count, port, address, hasCallback)
+  CHECK(args[0]->IsObject());
+  CHECK(args[1]->IsArray());
+  CHECK(args[2]->IsUint32());
+  CHECK(args[3]->IsUint32());
+  CHECK(args[4]->IsString());
+  CHECK(args[5]->IsBoolean());
+
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+  Local<Array> chunks = args[1].As<Array>();
+  size_t count = args[2]->Uint32Value();
+  const unsigned short port = args[3]->Uint32Value();
+  node::Utf8Value address(env->isolate(), args[4]);
+  const bool have_callback = args[5]->IsTrue();
+
+  CHECK_GT(count, 0);
+
+  char addr[sizeof(sockaddr_in6)];
+  int err;
+
+  switch (family) {
+  case AF_INET:
+    err = uv_ip4_addr(*address, port, reinterpret_cast<sockaddr_in*>(&addr));
+    break;
+  case AF_INET6:
+    err = uv_ip6_addr(*address, port, reinterpret_cast<sockaddr_in6*>(&addr));
+    break;
+  default:
+    CHECK(0 && "unexpected address family");
+    ABORT();
+  }
+
+  if (err)
+    return args.GetReturnValue().Set(err);
+
+  // Every element of the list is a datagram of its own.
+  std::vector<uv_buf_t> bufs(count);
+  std::vector<uv_buf_t*> bufs_ptrs(count);
+  std::vector<unsigned int> nbufs(count, 1);
+  std::vector<sockaddr*> addrs(count, reinterpret_cast<sockaddr*>(&addr));
+  size_t msg_size = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    Local<Value> chunk = chunks->Get(i);
+    size_t length = Buffer::Length(chunk);
+    bufs[i] = uv_buf_init(Buffer::Data(chunk), length);
+    bufs_ptrs[i] = &bufs[i];
+    msg_size += length;
+  }
+
+  // Push out as much as possible with one sendmmsg() call.  This fails with
+  // UV_EAGAIN when earlier datagrams are still queued on the handle.
+  size_t sent = 0;
+  err = uv_udp_try_send2(&wrap->handle_,
+                         count,
+                         bufs_ptrs.data(),
+                         nbufs.data(),
+                         addrs.data(),
+                         0);
+  if (err > 0)
+    sent = err;
+  else if (err != UV_EAGAIN && err != UV_ENOSYS)
+    return args.GetReturnValue().Set(err);
+
+  BatchSendWrap* req_wrap =
+      new BatchSendWrap(env, req_wrap_obj, have_callback, count - sent);
+  req_wrap->msg_size = msg_size;
+
+  err = 0;
+  for (size_t i = sent; i < count; i++) {
+    uv_udp_send_t* req = &req_wrap->reqs[i - sent];
+    req->data = req_wrap;
+    err = uv_udp_send(req,
+                      &wrap->handle_,
+                      &bufs[i],
+                      1,
+                      reinterpret_cast<const sockaddr*>(&addr),
+                      OnBatchSend);
+    if (err) {
+      req_wrap->pending -= count - i;
+      break;
+    }
+  }
+
+  req_wrap->Dispatched();
+
+  if (err) {
+    if (req_wrap->pending == 0) {
+      delete req_wrap;
+      return args.GetReturnValue().Set(err);
+    }
+    // Reported by OnBatchSend() once the queued datagrams are done.
+    req_wrap->status = err;
+  }
+
+  // Everything went out synchronously, JS land completes the request.
+  bool async = req_wrap->pending > 0;
+  req_wrap_obj->Set(env->async(), Boolean::New(env->isolate(), async));
+  if (!async)
+    delete req_wrap;
+
+  args.GetReturnValue().Set(0);
+}
+
+
+void UDPWrap::SendBatch(const FunctionCallbackInfo<Value>& args) {
+  DoSendBatch(args, AF_INET);
+}
+
+
+void UDPWrap::SendBatch6(const FunctionCallbackInfo<Value>& args) {
+  DoSendBatch(args, AF_INET6);
+}
+
+
 void UDPWrap::RecvStart(const FunctionCallbackInfo<Value>& args) {
   UDPWrap* wrap;
   ASSIGN_OR_RETURN_UNWRAP(&wrap,
                           args.Holder(),
                           args.GetReturnValue().Set(UV_EBADF));
+
+  // recvStart(batch)
+  if (args[0]->IsTrue() && wrap->recv_batch_ == nullptr) {
+    wrap->recv_batch_ = new RecvBatch;
+    wrap->recv_batch_->count = 0;
+  }
+
   int err = uv_udp_recv_start(&wrap->handle_, OnAlloc, OnRecv);
   // UV_EALREADY means that the socket is already bound but that's okay
   if (err == UV_EALREADY)
@@ -381,9 +574,38 @@ void UDPWrap::OnSend(uv_udp_send_t* req, int status) {
 }
 
 
+void UDPWrap::OnBatchSend(uv_udp_send_t* req, int status) {
+  BatchSendWrap* req_wrap = static_cast<BatchSendWrap*>(req->data);
+  if (status < 0 && req_wrap->status == 0)
+    req_wrap->status = status;
+
+  if (--req_wrap->pending > 0)
+    return;
+
+  if (req_wrap->have_callback()) {
+    Environment* env = req_wrap->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    Local<Value> arg[] = {
+      Integer::New(env->isolate(), req_wrap->status),
+      Integer::New(env->isolate(), req_wrap->msg_size),
+    };
+    req_wrap->MakeCallback(env->oncomplete_string(), arraysize(arg), arg);
+  }
+  delete req_wrap;
+}
+
+
 void UDPWrap::OnAlloc(uv_handle_t* handle,
                       size_t suggested_size,
                       uv_buf_t* buf) {
+  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
+  if (wrap->recv_batch_ != nullptr) {
+    *buf = uv_buf_init(wrap->recv_batch_->data,
+                       sizeof(wrap->recv_batch_->data));
+    return;
+  }
+
   buf->base = static_cast<char*>(node::Malloc(suggested_size));
   buf->len = suggested_size;
 
@@ -399,13 +621,42 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
                      const uv_buf_t* buf,
                      const struct sockaddr* addr,
                      unsigned int flags) {
+  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
+  RecvBatch* batch = wrap->recv_batch_;
+  const bool batched = batch != nullptr &&
+                       buf->base >= batch->data &&
+                       buf->base < batch->data + sizeof(batch->data);
+
   if (nread == 0 && addr == nullptr) {
-    if (buf->base != nullptr)
+    // Either nothing was read or recvmmsg() is handing back the buffer
+    // after the last datagram of a batch.
+    if (batched)
+      wrap->FlushRecvBatch();
+    else if (buf->base != nullptr)
       free(buf->base);
     return;
   }
 
-  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
+  if (batched && nread >= 0) {
+    RecvBatch::Message* message = &batch->messages[batch->count++];
+    message->base = buf->base;
+    message->len = nread;
+    if (addr != nullptr) {
+      memcpy(&message->addr,
+             addr,
+             addr->sa_family == AF_INET6 ? sizeof(sockaddr_in6) :
+                                           sizeof(sockaddr_in));
+    } else {
+      memset(&message->addr, 0, sizeof(message->addr));
+    }
+
+    // Without UV_UDP_MMSG_CHUNK the datagram came from plain recvmsg() and
+    // the buffer is reused by the next read.
+    if (!(flags & UV_UDP_MMSG_CHUNK) || batch->count == RecvBatch::kMaxBatch)
+      wrap->FlushRecvBatch();
+    return;
+  }
+
   Environment* env = wrap->env();
 
   HandleScope handle_scope(env->isolate());
@@ -420,7 +671,9 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
   };
 
   if (nread < 0) {
-    if (buf->base != nullptr)
+    if (batched)
+      wrap->FlushRecvBatch();
+    else if (buf->base != nullptr)
       free(buf->base);
     wrap->MakeCallback(env->onmessage_string(), arraysize(argv), argv);
     return;
@@ -433,6 +686,52 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
 }
 
 
+void UDPWrap::FlushRecvBatch() {
+  RecvBatch* batch = recv_batch_;
+  const size_t count = batch->count;
+  if (count == 0)
+    return;
+
+  // Reset first, the callback may re-enter libuv.
+  batch->count = 0;
+
+  Environment* env = this->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  size_t total = 0;
+  for (size_t i = 0; i < count; i++)
+    total += batch->messages[i].len;
+
+  // Pack the datagrams back to back into a single slab, JS land slices it.
+  char* data = static_cast<char*>(node::Malloc(total));
+  if (data == nullptr && total > 0) {
+    FatalError("node::UDPWrap::FlushRecvBatch()", "Out Of Memory");
+  }
+
+  Local<Array> lengths = Array::New(env->isolate(), count);
+  Local<Array> rinfos = Array::New(env->isolate(), count);
+  size_t offset = 0;
+  for (size_t i = 0; i < count; i++) {
+    const RecvBatch::Message& message = batch->messages[i];
+    if (message.len > 0)
+      memcpy(data + offset, message.base, message.len);
+    offset += message.len;
+    lengths->Set(i, Integer::NewFromUnsigned(env->isolate(), message.len));
+    const sockaddr* addr = reinterpret_cast<const sockaddr*>(&message.addr);
+    rinfos->Set(i, AddressToJS(env, addr));
+  }
+
+  Local<Value> argv[] = {
+    object(),
+    Buffer::New(env, data, total).ToLocalChecked(),
+    lengths,
+    rinfos
+  };
+  MakeCallback(env->onmessagebatch_string(), arraysize(argv), argv);
+}
+
+
 Local<Object> UDPWrap::Instantiate(Environment* env, AsyncWrap* parent) {
   EscapableHandleScope scope(env->isolate());
   // If this assert fires then Initialize hasn't been called yet.
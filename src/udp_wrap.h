@@ -25,6 +25,8 @@ class UDPWrap: public HandleWrap {
   static void Send(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Bind6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Send6(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendBatch(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendBatch6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void RecvStart(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void RecvStop(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetSockName(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -48,12 +50,34 @@ class UDPWrap: public HandleWrap {
             int (*F)(const typename T::HandleType*, sockaddr*, int*)>
   friend void GetSockOrPeerName(const v8::FunctionCallbackInfo<v8::Value>&);
 
+  // Receive state for batched mode.  libuv carves |data| up into slots of
+  // 64 KB and hands us one datagram per slot, recvmmsg() fills up to
+  // kMaxBatch of them with a single system call.  The datagrams are
+  // collected here and delivered to JS land with one callback.
+  struct RecvBatch {
+    static const size_t kMaxBatch = 16;
+    static const size_t kSlotSize = 64 * 1024;
+
+    struct Message {
+      const char* base;
+      size_t len;
+      sockaddr_storage addr;
+    };
+
+    char data[kMaxBatch * kSlotSize];
+    Message messages[kMaxBatch];
+    size_t count;
+  };
+
   UDPWrap(Environment* env, v8::Local<v8::Object> object, AsyncWrap* parent);
+  ~UDPWrap();
 
   static void DoBind(const v8::FunctionCallbackInfo<v8::Value>& args,
                      int family);
   static void DoSend(const v8::FunctionCallbackInfo<v8::Value>& args,
                      int family);
+  static void DoSendBatch(const v8::FunctionCallbackInfo<v8::Value>& args,
+                          int family);
   static void SetMembership(const v8::FunctionCallbackInfo<v8::Value>& args,
                             uv_membership membership);
 
@@ -61,13 +85,16 @@ class UDPWrap: public HandleWrap {
                       size_t suggested_size,
                       uv_buf_t* buf);
   static void OnSend(uv_udp_send_t* req, int status);
+  static void OnBatchSend(uv_udp_send_t* req, int status);
   static void OnRecv(uv_udp_t* handle,
                      ssize_t nread,
                      const uv_buf_t* buf,
                      const struct sockaddr* addr,
                      unsigned int flags);
+  void FlushRecvBatch();
 
   uv_udp_t handle_;
+  RecvBatch* recv_batch_;
 };
 
 }  // namespace node
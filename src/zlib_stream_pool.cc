@@ -0,0 +1,164 @@
+#include "zlib_stream_pool.h"
+
+#include "util.h"
+#include "util-inl.h"
+
+#include "zlib.h"
+
+#include <string.h>
+
+namespace node {
+
+struct ZlibStreamPool::Stream {
+  z_stream strm;
+  Kind kind;
+  int window_bits;
+  int level;
+  int mem_level;
+  int strategy;
+  // False when deflateParams() failed and the level and strategy that are
+  // in effect are unknown.
+  bool reusable;
+};
+
+
+ZlibStreamPool::ZlibStreamPool(v8::Isolate* isolate)
+    : isolate_(isolate), created_(0), reused_(0) {
+}
+
+
+ZlibStreamPool::~ZlibStreamPool() {
+  for (Stream* stream : idle_)
+    Free(stream);
+}
+
+
+z_stream* ZlibStreamPool::Acquire(Kind kind,
+                                  int window_bits,
+                                  int level,
+                                  int mem_level,
+                                  int strategy,
+                                  int* err) {
+  // Most recently released first, its memory is the most likely to be warm.
+  for (size_t i = idle_.size(); i-- > 0;) {
+    Stream* stream = idle_[i];
+    if (stream->kind != kind)
+      continue;
+    if (kind == kDeflate &&
+        (stream->window_bits != window_bits ||
+         stream->level != level ||
+         stream->mem_level != mem_level ||
+         stream->strategy != strategy))
+      continue;
+
+    idle_.erase(idle_.begin() + i);
+    reused_++;
+    if (kind == kDeflate) {
+      // The stream was reset when it was released.
+      *err = Z_OK;
+    } else {
+      *err = inflateReset2(&stream->strm, window_bits);
+      stream->window_bits = window_bits;
+    }
+    return &stream->strm;
+  }
+
+  Stream* stream = new Stream;
+  memset(&stream->strm, 0, sizeof(stream->strm));
+  stream->kind = kind;
+  stream->window_bits = window_bits;
+  stream->level = level;
+  stream->mem_level = mem_level;
+  stream->strategy = strategy;
+  stream->reusable = true;
+  created_++;
+  isolate_->AdjustAmountOfExternalAllocatedMemory(
+      kind == kDeflate ? kDeflateContextSize : kInflateContextSize);
+
+  if (kind == kDeflate) {
+    *err = deflateInit2(&stream->strm,
+                        level,
+                        Z_DEFLATED,
+                        window_bits,
+                        mem_level,
+                        strategy);
+  } else {
+    *err = inflateInit2(&stream->strm, window_bits);
+  }
+  return &stream->strm;
+}
+
+
+void ZlibStreamPool::Release(z_stream* strm) {
+  Stream* stream = ContainerOf(&Stream::strm, strm);
+
+  // Streams that failed to initialize have no state to reuse.
+  if (strm->state == Z_NULL || !stream->reusable) {
+    Free(stream);
+    return;
+  }
+
+  size_t idle = 0;
+  for (Stream* other : idle_) {
+    if (other->kind == stream->kind)
+      idle++;
+  }
+  if (idle >= kMaxIdleStreams) {
+    Free(stream);
+    return;
+  }
+
+  int err;
+  if (stream->kind == kDeflate)
+    err = deflateReset(strm);
+  else
+    err = inflateReset(strm);
+  if (err != Z_OK) {
+    Free(stream);
+    return;
+  }
+
+  // Don't keep references to the owner's buffers.
+  strm->next_in = Z_NULL;
+  strm->avail_in = 0;
+  strm->next_out = Z_NULL;
+  strm->avail_out = 0;
+  idle_.push_back(stream);
+}
+
+
+int ZlibStreamPool::Params(z_stream* strm, int level, int strategy) {
+  Stream* stream = ContainerOf(&Stream::strm, strm);
+  CHECK_EQ(stream->kind, kDeflate);
+
+  const int err = deflateParams(strm, level, strategy);
+  if (err == Z_OK) {
+    stream->level = level;
+    stream->strategy = strategy;
+  } else {
+    stream->reusable = false;
+  }
+  return err;
+}
+
+
+void ZlibStreamPool::GetStatistics(Statistics* stats) const {
+  stats->created = created_;
+  stats->reused = reused_;
+  stats->idle = idle_.size();
+}
+
+
+void ZlibStreamPool::Free(Stream* stream) {
+  isolate_->AdjustAmountOfExternalAllocatedMemory(
+      -(stream->kind == kDeflate ? kDeflateContextSize : kInflateContextSize));
+  if (stream->strm.state != Z_NULL) {
+    if (stream->kind == kDeflate)
+      (void)deflateEnd(&stream->strm);
+    else
+      (void)inflateEnd(&stream->strm);
+  }
+  delete stream;
+}
+
+}  // namespace node
@@ -0,0 +1,93 @@
+#ifndef SRC_ZLIB_STREAM_POOL_H_
+#define SRC_ZLIB_STREAM_POOL_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "util.h"
+#include "v8.h"
+
+#include <stddef.h>  // size_t
+#include <stdint.h>  // uint64_t
+#include <vector>
+
+struct z_stream_s;
+
+namespace node {
+
+// Keeps initialized zlib streams around after their owner is done with them
+// so that the next deflate or inflate context can be reset instead of going
+// through deflateInit2() or inflateInit2() again, which allocates and clears
+// the window and hash tables every time.  Most of the cost of compressing or
+// decompressing a small buffer is in that setup.
+//
+// Deflate streams are only handed out again for the same windowBits,
+// memLevel, compression level and strategy.  deflateParams() can't change
+// the last two on a reset stream without an output buffer on all zlib
+// versions.  Inflate streams can be reused for any windowBits through
+// inflateReset2().
+//
+// The memory of every stream, in use or idle, is reported to V8 as external
+// memory until the stream is freed.
+//
+// Not thread-safe.  Streams are acquired and released on the loop thread,
+// they may be used on the threadpool in between.
+class ZlibStreamPool {
+ public:
+  // Idle streams kept per kind, the rest are freed when released.
+  static const size_t kMaxIdleStreams = 8;
+
+  enum Kind { kDeflate, kInflate };
+
+  // Snapshot of the counters, see GetStatistics().
+  struct Statistics {
+    uint64_t created;  // Streams initialized from scratch.
+    uint64_t reused;   // Streams handed out again from the pool.
+    uint64_t idle;     // Streams currently waiting in the pool.
+  };
+
+  explicit ZlibStreamPool(v8::Isolate* isolate);
+  ~ZlibStreamPool();
+
+  // Returns a stream ready for use with the given parameters.  |windowBits|
+  // includes the gzip (+16), auto-detect (+32) and raw (negative) encodings.
+  // On failure *err is set to the zlib error code and the returned stream
+  // is still owned by the caller, who must Release() it.
+  z_stream_s* Acquire(Kind kind,
+                      int window_bits,
+                      int level,
+                      int mem_level,
+                      int strategy,
+                      int* err);
+
+  // Takes back a stream obtained from Acquire(), in whatever state it is.
+  void Release(z_stream_s* strm);
+
+  // deflateParams() for a deflate stream obtained from Acquire(), so that it
+  // is only handed out again for its current level and strategy.
+  int Params(z_stream_s* strm, int level, int strategy);
+
+  void GetStatistics(Statistics* stats) const;
+
+ private:
+  // A z_stream along with the parameters it was initialized with.
+  struct Stream;
+
+  // Approximate sizes of the zlib state.
+  static const int kDeflateContextSize = 16384;
+  static const int kInflateContextSize = 10240;
+
+  void Free(Stream* stream);
+
+  v8::Isolate* const isolate_;
+  std::vector<Stream*> idle_;
+  uint64_t created_;
+  uint64_t reused_;
+
+  DISALLOW_COPY_AND_ASSIGN(ZlibStreamPool);
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_ZLIB_STREAM_POOL_H_
@@ -513,3 +513,14 @@ exports.isAlive = function isAlive(pid) {
     return false;
   }
 };
+
+// Returns a pseudo-random integer in [0, n). The generator is a xorshift32
+// with a fixed seed, so tests that use it see the same inputs on every run
+// and a failure can be reproduced.
+var randomState = 0x9e3779b9;
+exports.random = function random(n) {
+  randomState ^= randomState << 13;
+  randomState ^= randomState >>> 17;
+  randomState ^= randomState << 5;
+  return (randomState >>> 0) % n;
+};
@@ -0,0 +1,109 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const MultiMatcher = require('buffer').MultiMatcher;
+
+function randomBuffer(length, alphabet) {
+  const buf = Buffer.allocUnsafe(length);
+  for (let i = 0; i < length; i++)
+    buf[i] = alphabet[common.random(alphabet.length)];
+  return buf;
+}
+
+// All matches by brute force, in the order MultiMatcher reports them.
+function bruteForce(patterns, buf) {
+  const matches = [];
+  patterns.forEach((pattern, index) => {
+    for (let i = 0; i + pattern.length <= buf.length; i++) {
+      if (buf.slice(i, i + pattern.length).equals(pattern))
+        matches.push({ index: i, pattern: index });
+    }
+  });
+  return matches.sort((a, b) => {
+    const aEnd = a.index + patterns[a.pattern].length;
+    const bEnd = b.index + patterns[b.pattern].length;
+    return aEnd - bEnd || a.index - b.index || a.pattern - b.pattern;
+  });
+}
+
+const alphabets = [[0x61], [0x61, 0x62], [0x61, 0x62, 0x63, 0x0a],
+                   Array.from({ length: 256 }, (v, i) => i)];
+for (let iteration = 0; iteration < 200; iteration++) {
+  const alphabet = alphabets[iteration % alphabets.length];
+  const patterns = [];
+  for (let i = 1 + common.random(8); i > 0; i--)
+    patterns.push(randomBuffer(1 + common.random(5), alphabet));
+  if (iteration % 10 === 0)
+    patterns.push(patterns[0]);
+  const buf = randomBuffer(common.random(1000), alphabet);
+  const expected = bruteForce(patterns, buf);
+
+  const matcher = new MultiMatcher(patterns);
+  assert.deepStrictEqual(matcher.search(buf), expected);
+
+  // The same matches when the input arrives in pieces.
+  let matches = [];
+  for (let i = 0; i < buf.length;) {
+    const n = common.random(20);
+    matches = matches.concat(matcher.write(buf.slice(i, i + n)));
+    i += n;
+  }
+  assert.deepStrictEqual(matches, expected);
+
+  matcher.reset();
+  assert.deepStrictEqual(matcher.write(buf), expected);
+}
+
+// Strings, offsets and streams.
+const matcher = new MultiMatcher(['he', 'she', 'hers', '€']);
+assert.deepStrictEqual(matcher.search(Buffer.from('ushers')), [
+  { index: 1, pattern: 1 },
+  { index: 2, pattern: 0 },
+  { index: 2, pattern: 2 }
+]);
+assert.deepStrictEqual(matcher.search(Buffer.from('ushers'), 2), [
+  { index: 2, pattern: 0 },
+  { index: 2, pattern: 2 }
+]);
+assert.deepStrictEqual(matcher.search(Buffer.from('ushers'), -3), []);
+assert.deepStrictEqual(matcher.search(Buffer.from('ushers'), 100), []);
+assert.deepStrictEqual(matcher.search(Buffer.from('5 €')),
+                       [{ index: 2, pattern: 3 }]);
+assert.deepStrictEqual(matcher.search(new Uint8Array([0x68, 0x65])),
+                       [{ index: 0, pattern: 0 }]);
+
+const boundary = new MultiMatcher(['\r\n--boundary']);
+assert.deepStrictEqual(boundary.write(Buffer.from('first part\r\n--bou')), []);
+assert.deepStrictEqual(boundary.write(Buffer.from('ndary\r\nsecond part')),
+                       [{ index: 10, pattern: 0 }]);
+assert.deepStrictEqual(boundary.write(Buffer.from('\r\n--boundary')),
+                       [{ index: 30, pattern: 0 }]);
+
+const latin1 = new MultiMatcher(['é'], 'latin1');
+assert.deepStrictEqual(latin1.search(Buffer.from([0x41, 0xe9])),
+                       [{ index: 1, pattern: 0 }]);
+
+// A large input with a few patterns that share their first byte.
+const large = Buffer.alloc(4 * 1024 * 1024, 'x');
+large.write('--end', large.length - 5);
+large.write('--start', 1000);
+assert.deepStrictEqual(new MultiMatcher(['--start', '--end']).search(large), [
+  { index: 1000, pattern: 0 },
+  { index: large.length - 5, pattern: 1 }
+]);
+
+assert.throws(() => new MultiMatcher([]),
+              /^TypeError: "patterns" argument must be a non-empty array$/);
+assert.throws(() => new MultiMatcher(['']),
+              /^TypeError: Patterns must not be empty$/);
+assert.throws(() => new MultiMatcher([1]),
+              /^TypeError: Patterns must be strings, Buffers or Uint8Arrays$/);
+assert.throws(() => matcher.search('ushers'),
+              /^TypeError: "buffer" argument must be a Buffer or Uint8Array$/);
+assert.throws(() => matcher.write('ushers'),
+              /^TypeError: "chunk" argument must be a Buffer or Uint8Array$/);
+const huge = Buffer.alloc(100000);
+for (let i = 0; i < huge.length; i++)
+  huge[i] = i;
+assert.throws(() => new MultiMatcher([huge]),
+              /^RangeError: Too many or too long patterns$/);
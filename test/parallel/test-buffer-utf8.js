@@ -0,0 +1,103 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+// Strings that exercise the ASCII, Latin-1, BMP and astral paths, at
+// lengths and offsets around the vector widths.
+const pieces = ['a', 'hello world ', 'é', 'ÿ', '€', '日本語', '😀', '\u0080',
+                '߿', 'ࠀ', '￿', '\u{10ffff}'];
+
+function randomString(length, pool) {
+  let s = '';
+  while (s.length < length)
+    s += pool[common.random(pool.length)];
+  return s;
+}
+
+const pools = [pieces.slice(0, 2), pieces.slice(0, 4), pieces];
+for (const pool of pools) {
+  for (let length = 0; length < 200; length += 7) {
+    const s = randomString(length, pool);
+    const buf = Buffer.from(s);
+    assert.strictEqual(buf.toString(), s);
+    assert.strictEqual(buf.length, Buffer.byteLength(s));
+    for (let offset = 1; offset < 4 && offset < buf.length; offset++) {
+      assert.strictEqual(buf.toString('utf8', offset),
+                         Buffer.from(buf.slice(offset)).toString());
+    }
+  }
+}
+
+// Large strings, past the size at which they become external.
+const large = randomString(2 * 1024 * 1024, pieces.slice(0, 4));
+assert.strictEqual(Buffer.from(large).toString(), large);
+const largeAscii = 'x'.repeat(2 * 1024 * 1024);
+assert.strictEqual(Buffer.from(largeAscii).toString(), largeAscii);
+const largeWide = randomString(2 * 1024 * 1024, pieces);
+assert.strictEqual(Buffer.from(largeWide).toString(), largeWide);
+
+// Malformed input is replaced with U+FFFD.
+[
+  [0xc0, 0x80],  // Overlong.
+  [0xe0, 0x80, 0x80],  // Overlong.
+  [0xed, 0xa0, 0x80],  // Surrogate.
+  [0xf4, 0x90, 0x80, 0x80],  // Past U+10FFFF.
+  [0x80],  // Stray continuation byte.
+  [0xe2, 0x82]  // Truncated.
+].forEach((bytes) => {
+  const s = Buffer.from([0x61].concat(bytes, [0x62])).toString();
+  assert.strictEqual(s[0], 'a');
+  assert.strictEqual(s[s.length - 1], 'b');
+  assert.ok(/^a\ufffd+b$/.test(s), JSON.stringify(s));
+});
+
+// Writing stops before a character that doesn't fit.
+const mixed = 'abcé€😀' + 'x'.repeat(40) + 'é';
+const encoded = Buffer.from(mixed);
+for (let size = 0; size <= encoded.length; size++) {
+  const buf = Buffer.alloc(size);
+  const written = buf.write(mixed);
+  const expected = Buffer.from(buf.slice(0, written).toString());
+  assert.ok(written <= size);
+  assert.ok(encoded.slice(0, written).equals(expected));
+  assert.ok(size - written < 4);
+}
+
+// Same for one-byte strings, and bytes past the ones written are left alone.
+const oneByte = ['a\u00e9', '\u00e9', 'abc\u00ff', 'x'.repeat(40) + '\u00e9x'];
+for (const s of oneByte) {
+  const bytes = Buffer.from(s);
+  for (let size = 0; size <= bytes.length; size++) {
+    const buf = Buffer.alloc(size, '*');
+    const written = buf.write(s);
+    assert.ok(bytes.slice(0, written).equals(buf.slice(0, written)));
+    assert.ok(size - written < 2);
+    assert.ok(buf.slice(written).equals(Buffer.alloc(size - written, '*')));
+  }
+}
+{
+  const buf = Buffer.alloc(2);
+  assert.strictEqual(buf.write('a\u00e9'), 1);
+  assert.deepStrictEqual(buf, Buffer.from([0x61, 0x00]));
+}
+
+// One-byte strings with characters above U+007F.
+const latin1 = 'abc' + 'ÿ'.repeat(10000) + 'def';
+assert.strictEqual(Buffer.from(latin1).toString(), latin1);
+assert.strictEqual(Buffer.byteLength(latin1), 3 + 20000 + 3);
+
+// Surrogate pairs that straddle the chunks strings are read in.
+for (let i = 4090; i < 4100; i++) {
+  const s = '€' + 'x'.repeat(i) + '😀' + 'x'.repeat(10);
+  assert.strictEqual(Buffer.from(s).toString(), s);
+}
+
+// Lone surrogates are written as U+FFFD.
+assert.deepStrictEqual(Buffer.from('a\ud800b\udc00'),
+                       Buffer.from([0x61, 0xef, 0xbf, 0xbd,
+                                    0x62, 0xef, 0xbf, 0xbd]));
+assert.strictEqual(Buffer.from('😀').toString(), '😀');
+
+// The ASCII encoding only keeps the low seven bits.
+const high = Buffer.alloc(100, 0xe9);
+assert.strictEqual(high.toString('ascii'), 'i'.repeat(100));
@@ -0,0 +1,65 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+const crypto = require('crypto');
+
+const key = crypto.randomBytes(32);
+const iv = crypto.randomBytes(12);
+
+// Mixes chunks above and below the threshold, they have to come out in order.
+const chunks = [];
+for (let size = 1; size <= 4 * 1024 * 1024; size *= 4)
+  chunks.push(crypto.randomBytes(size));
+const plaintext = Buffer.concat(chunks);
+
+function collect(stream, cb) {
+  const out = [];
+  stream.on('data', (chunk) => out.push(chunk));
+  stream.on('end', common.mustCall(() => cb(Buffer.concat(out))));
+}
+
+const cipher = crypto.createCipheriv('aes-256-gcm', key, iv, { offload: true });
+collect(cipher, (ciphertext) => {
+  // Same result as the synchronous API.
+  const sync = crypto.createCipheriv('aes-256-gcm', key, iv);
+  const expected = Buffer.concat([sync.update(plaintext), sync.final()]);
+  assert.ok(ciphertext.equals(expected));
+  assert.ok(cipher.getAuthTag().equals(sync.getAuthTag()));
+
+  const decipher =
+      crypto.createDecipheriv('aes-256-gcm', key, iv, { offload: 1 });
+  decipher.setAuthTag(cipher.getAuthTag());
+  collect(decipher, (decrypted) => {
+    assert.ok(decrypted.equals(plaintext));
+  });
+  decipher.end(ciphertext);
+});
+for (const chunk of chunks)
+  cipher.write(chunk);
+cipher.end();
+
+// The cipher is off limits while a chunk is on the threadpool.
+const busy = crypto.createCipheriv('aes-256-cbc', key, crypto.randomBytes(16),
+                                   { offload: 1 });
+busy.write(Buffer.alloc(1024));
+assert.throws(() => busy.update('x'),
+              /^Error: Cipher operation in progress$/);
+assert.throws(() => busy.final(),
+              /^Error: Cipher operation in progress$/);
+busy.resume();
+busy.on('end', common.mustCall());
+busy.end();
+
+// Authentication failures are reported through the stream.
+const bad = crypto.createDecipheriv('aes-256-gcm', key, iv, { offload: 1 });
+bad.setAuthTag(Buffer.alloc(16));
+bad.on('error', common.mustCall((err) => {
+  assert.ok(/unable to authenticate data/.test(err.message));
+}));
+bad.resume();
+bad.end(crypto.randomBytes(1024));
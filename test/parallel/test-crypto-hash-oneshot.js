@@ -0,0 +1,80 @@
+// Flags: --expose-gc
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+const crypto = require('crypto');
+
+function digest(algorithm, data, encoding) {
+  return crypto.createHash(algorithm).update(data).digest(encoding);
+}
+
+// One-shot digests match the streaming ones.
+for (const algorithm of ['md5', 'sha1', 'sha256', 'sha512']) {
+  for (const data of ['', 'abc', 'résumé', Buffer.alloc(100000, 'x')]) {
+    assert.deepStrictEqual(crypto.hash(algorithm, data),
+                           digest(algorithm, data));
+    assert.strictEqual(crypto.hash(algorithm, data, 'hex'),
+                       digest(algorithm, data, 'hex'));
+  }
+}
+
+assert.throws(() => crypto.hash('nope', 'abc'),
+              /^Error: Digest method not supported$/);
+assert.throws(() => crypto.hash('sha1', 42),
+              /^TypeError: Data must be a string or a buffer$/);
+
+// Batches pack the digests back to back.
+const buffers = [];
+for (let i = 0; i < 100; i++)
+  buffers.push(crypto.randomBytes(i * 7));
+const expected = Buffer.concat(buffers.map((b) => digest('sha256', b)));
+
+assert.deepStrictEqual(crypto.hashBatch('sha256', buffers), expected);
+assert.deepStrictEqual(crypto.hashBatch('sha256', []), Buffer.alloc(0));
+
+assert.throws(() => crypto.hashBatch('sha256', 'abc'),
+              /^TypeError: "buffers" argument must be an array of Buffers$/);
+assert.throws(() => crypto.hashBatch('sha256', ['abc']),
+              /^TypeError: Data must be an array of buffers$/);
+assert.throws(() => crypto.hashBatch('nope', buffers),
+              /^Error: Digest method not supported$/);
+assert.throws(() => crypto.hashBatch('sha256', buffers, 'abc'),
+              /^TypeError: "callback" argument must be a function$/);
+
+// Small batches complete inline but still call back asynchronously.
+let sync = true;
+crypto.hashBatch('sha256', buffers, common.mustCall((err, result) => {
+  assert.ifError(err);
+  assert.strictEqual(sync, false);
+  assert.deepStrictEqual(result, expected);
+}));
+sync = false;
+
+// Large ones go to the threadpool.
+const large = [];
+for (let i = 0; i < 64; i++)
+  large.push(crypto.randomBytes(4096));
+crypto.hashBatch('sha1', large, common.mustCall((err, result) => {
+  assert.ifError(err);
+  assert.deepStrictEqual(result,
+                         Buffer.concat(large.map((b) => digest('sha1', b))));
+}));
+
+// The Buffers are kept alive by the request, not by the caller's array.
+{
+  const inputs = [];
+  for (let i = 0; i < 64; i++)
+    inputs.push(Buffer.alloc(4096, i));
+  const expected = Buffer.concat(inputs.map((b) => digest('sha256', b)));
+  crypto.hashBatch('sha256', inputs, common.mustCall((err, result) => {
+    assert.ifError(err);
+    assert.deepStrictEqual(result, expected);
+  }));
+  inputs.length = 0;
+  global.gc();
+}
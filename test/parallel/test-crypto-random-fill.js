@@ -0,0 +1,59 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+const crypto = require('crypto');
+
+// Only the requested range is written.
+for (const size of [0, 1, 16, 1024, 1025, 100000]) {
+  const buf = Buffer.alloc(size + 20);
+  assert.strictEqual(crypto.randomFillSync(buf, 10, size), buf);
+  assert.ok(buf.slice(0, 10).equals(Buffer.alloc(10)));
+  assert.ok(buf.slice(10 + size).equals(Buffer.alloc(10)));
+  if (size >= 16)
+    assert.ok(!buf.slice(10, 10 + size).equals(Buffer.alloc(size)));
+}
+
+const u8 = new Uint8Array(32);
+crypto.randomFillSync(u8);
+assert.ok(u8.some((byte) => byte !== 0));
+
+// Pooled bytes are never handed out twice.
+const seen = new Set();
+for (let i = 0; i < 20000; i++) {
+  const id = (i % 2 ? crypto.randomBytes(16) :
+                      crypto.randomFillSync(Buffer.alloc(16))).toString('hex');
+  assert.ok(!seen.has(id));
+  seen.add(id);
+}
+
+assert.throws(() => crypto.randomFillSync('abc'),
+              /^TypeError: "buf" argument must be a Buffer or Uint8Array$/);
+assert.throws(() => crypto.randomFillSync(Buffer.alloc(10), 11),
+              /^RangeError: "offset" is out of range$/);
+assert.throws(() => crypto.randomFillSync(Buffer.alloc(10), -1),
+              /^RangeError: "offset" is out of range$/);
+assert.throws(() => crypto.randomFillSync(Buffer.alloc(10), 5, 6),
+              /^RangeError: "size" is out of range$/);
+assert.throws(() => crypto.randomFillSync(Buffer.alloc(10), 0, 1.5),
+              /^RangeError: "size" is out of range$/);
+assert.throws(() => crypto.randomFill(Buffer.alloc(10)),
+              /^TypeError: "callback" argument must be a function$/);
+
+// Small and large asynchronous fills, always called back asynchronously.
+for (const size of [16, 100000]) {
+  const buf = Buffer.alloc(size + 1);
+  let sync = true;
+  crypto.randomFill(buf, 1, common.mustCall((err, result) => {
+    assert.ifError(err);
+    assert.strictEqual(sync, false);
+    assert.strictEqual(result, buf);
+    assert.strictEqual(buf[0], 0);
+    assert.ok(!buf.slice(1).equals(Buffer.alloc(size)));
+  }));
+  sync = false;
+}
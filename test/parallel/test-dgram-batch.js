@@ -0,0 +1,56 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const dgram = require('dgram');
+
+const N = 50;
+const messages = [];
+for (let i = 0; i < N; i++)
+  messages.push(Buffer.alloc(i * 13 % 1400, String.fromCharCode(65 + i % 26)));
+// Strings are accepted as well, and empty datagrams survive batching.
+messages.push('last');
+messages.push(Buffer.alloc(0));
+
+const receiver = dgram.createSocket({ type: 'udp4', recvBatch: true });
+const sender = dgram.createSocket('udp4');
+
+const received = [];
+
+receiver.on('message', function(buf, rinfo) {
+  assert.strictEqual(rinfo.size, buf.length);
+  assert.strictEqual(rinfo.address, common.localhostIPv4);
+  assert.strictEqual(rinfo.port, sender.address().port);
+  received.push(buf);
+  if (received.length < messages.length)
+    return;
+
+  // UDP on loopback preserves ordering in practice; compare as sets anyway.
+  const sorted = (list) => list.map((b) => Buffer.from(b).toString('latin1'))
+                               .sort();
+  assert.deepStrictEqual(sorted(received), sorted(messages));
+  receiver.close();
+  sender.close();
+});
+
+receiver.bind(0, common.localhostIPv4, common.mustCall(function() {
+  const port = receiver.address().port;
+  const total = messages.reduce((n, m) => n + Buffer.byteLength(m), 0);
+  sender.sendBatch(messages, port, common.localhostIPv4,
+                   common.mustCall(function(err, bytes) {
+                     assert.ifError(err);
+                     assert.strictEqual(bytes, total);
+                   }));
+}));
+
+// An empty batch completes without sending anything.
+const idle = dgram.createSocket('udp4');
+idle.sendBatch([], 1234, common.mustCall(function(err, bytes) {
+  assert.ifError(err);
+  assert.strictEqual(bytes, 0);
+  idle.close();
+}));
+
+assert.throws(() => sender.sendBatch('nope', 1234), TypeError);
+assert.throws(() => sender.sendBatch([{}], 1234), TypeError);
+assert.throws(() => sender.sendBatch([], 0), RangeError);
@@ -0,0 +1,158 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const MultipartParser = require('http').MultipartParser;
+
+const boundary = '----formdata-abc123';
+const file = Buffer.alloc(256 * 1024);
+for (let i = 0; i < file.length; i++)
+  file[i] = i * 7;
+// Looks like a delimiter but is part of the data.
+file.write('\r\n--' + boundary.slice(0, -1), 1000, 'latin1');
+
+const body = Buffer.concat([
+  Buffer.from('preamble\r\n' +
+              `--${boundary}\r\n` +
+              'Content-Disposition: form-data; name="field"\r\n' +
+              '\r\n' +
+              'value\r\n' +
+              `--${boundary}  \r\n` +
+              'Content-Disposition: form-data; name="file"; ' +
+              'filename="naïve.bin"\r\n' +
+              'Content-Type: application/octet-stream\r\n' +
+              'X-Folded: a\r\n' +
+              '  b\r\n' +
+              '\r\n'),
+  file,
+  Buffer.from(`\r\n--${boundary}\r\n` +
+              '\r\n' +
+              `\r\n--${boundary}--\r\n` +
+              'epilogue')
+]);
+
+function parse(chunks, callback) {
+  const parser = new MultipartParser(boundary);
+  const parts = [];
+  let current = null;
+  parser.on('part', (headers, rawHeaders) => {
+    assert.strictEqual(current, null);
+    current = { headers, rawHeaders, data: [] };
+  });
+  parser.on('data', (data) => current.data.push(data));
+  parser.on('partEnd', () => {
+    current.data = Buffer.concat(current.data);
+    parts.push(current);
+    current = null;
+  });
+  parser.on('finish', common.mustCall(() => callback(parts)));
+  for (const chunk of chunks)
+    parser.write(chunk);
+  parser.end();
+}
+
+function check(parts) {
+  assert.strictEqual(parts.length, 3);
+  assert.deepStrictEqual(parts[0].headers, {
+    'content-disposition': 'form-data; name="field"'
+  });
+  assert.strictEqual(parts[0].data.toString(), 'value');
+  assert.deepStrictEqual(parts[1].rawHeaders, [
+    'Content-Disposition', 'form-data; name="file"; filename="naïve.bin"',
+    'Content-Type', 'application/octet-stream',
+    'X-Folded', 'a b'
+  ]);
+  assert.strictEqual(parts[1].headers['x-folded'], 'a b');
+  assert.ok(parts[1].data.equals(file));
+  assert.deepStrictEqual(parts[2].headers, {});
+  assert.strictEqual(parts[2].data.length, 0);
+}
+
+// In one piece, the body data is sliced out of the input.
+const parser = new MultipartParser(boundary);
+parser.on('data', common.mustCall((data) => {
+  assert.strictEqual(data.buffer, body.buffer);
+}, 2));
+parser.end(body);
+
+parse([body], check);
+
+// Split at every position around the delimiters and at random ones.
+const delimiter = body.indexOf(`\r\n--${boundary}`, 2000);
+for (let i = delimiter - 2; i < delimiter + boundary.length + 8; i++)
+  parse([body.slice(0, i), body.slice(i)], check);
+
+const chunks = [];
+for (let i = 0; i < body.length;) {
+  const n = 1 + common.random(100);
+  chunks.push(body.slice(i, i + n));
+  i += n;
+}
+parse(chunks, check);
+
+// One byte at a time.
+const bytes = [];
+for (let i = 0; i < 5000; i++)
+  bytes.push(body.slice(i, i + 1));
+bytes.push(body.slice(5000));
+parse(bytes, check);
+
+// No preamble, and piped.
+const stream = require('stream');
+const source = new stream.PassThrough();
+const piped = new MultipartParser('x');
+piped.on('part', common.mustCall((headers) => {
+  assert.deepStrictEqual(headers, { 'a': '1, 2' });
+}));
+piped.on('data', common.mustCall((data) => {
+  assert.strictEqual(data.toString(), 'hello');
+}));
+piped.on('finish', common.mustCall());
+source.pipe(piped);
+source.end('--x\r\nA: 1\r\na: 2\r\n\r\nhello\r\n--x--');
+
+// Strings are decoded whatever the Writable options say.
+for (const options of [{ decodeStrings: false }, { objectMode: true }]) {
+  const parser = new MultipartParser('x', options);
+  parser.on('data', common.mustCall((data) => {
+    assert.strictEqual(data.toString(), 'hello');
+  }));
+  parser.on('finish', common.mustCall());
+  parser.write('--x\r\n\r\nhello');
+  parser.end('\r\n--x--');
+}
+
+// Errors.
+function error(input, message, options) {
+  const parser = new MultipartParser(boundary, options);
+  parser.on('error', common.mustCall((err) => {
+    assert.strictEqual(err.message, message);
+  }));
+  parser.end(input);
+}
+
+error(`--${boundary}\r\n\r\nunterminated`,
+      'Unexpected end of multipart data');
+error('', 'Unexpected end of multipart data');
+error(`--${boundary}\r\nno colon\r\n\r\n`, 'Malformed part header');
+error(`--${boundary}\r\n folded\r\n\r\n`, 'Malformed part header');
+error(`--${boundary}x\r\n`, 'Malformed multipart delimiter');
+error(`--${boundary}\n\n`, 'Malformed multipart delimiter');
+error(`--${boundary}\r\nName: ${'x'.repeat(100)}\r\n\r\n`,
+      'Part header too large', { maxHeaderSize: 64 });
+
+assert.throws(() => new MultipartParser(''),
+              /^TypeError: "boundary" argument must be a valid boundary$/);
+assert.throws(() => new MultipartParser('x'.repeat(71)),
+              /^TypeError: "boundary" argument must be a valid boundary$/);
+assert.throws(() => new MultipartParser('ends in space '),
+              /^TypeError: "boundary" argument must be a valid boundary$/);
+assert.throws(() => new MultipartParser('x', { maxHeaderSize: -1 }),
+              /^TypeError: "maxHeaderSize" must be a non-negative integer$/);
+
+{
+  const parser = new MultipartParser('x', { objectMode: true });
+  parser.on('error', common.mustCall((err) => {
+    assert.strictEqual(err.message, 'Invalid non-string/buffer chunk');
+  }));
+  parser.write({});
+}
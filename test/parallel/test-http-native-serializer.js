@@ -0,0 +1,115 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+const http = require('http');
+
+const binding = process.binding('http_serializer');
+const state = new Uint32Array(1);
+
+function serialize(list, flags, contentLength) {
+  const header = binding.serializeHeader(list, flags, contentLength, state);
+  return { header, flags: state[0] };
+}
+
+const keepAlive = binding.kShouldKeepAlive | binding.kHasBody |
+                  binding.kUseChunkedEncodingByDefault;
+
+// Content-Length comes from the cache, repeated lookups give the same bytes.
+for (let i = 0; i < 3; i++) {
+  const r = serialize(['Content-Type', 'text/plain'], keepAlive, 1234);
+  assert.strictEqual(r.header,
+                     'Content-Type: text/plain\r\n' +
+                     'Connection: keep-alive\r\n' +
+                     'Content-Length: 1234\r\n\r\n');
+  assert.strictEqual(r.flags & binding.kLast, 0);
+  assert.strictEqual(r.flags & binding.kChunkedEncoding, 0);
+}
+
+// No length known, fall back to chunked encoding.
+{
+  const r = serialize([], keepAlive, -1);
+  assert.strictEqual(r.header,
+                     'Connection: keep-alive\r\n' +
+                     'Transfer-Encoding: chunked\r\n\r\n');
+  assert.ok(r.flags & binding.kChunkedEncoding);
+}
+
+// Connection: close is honored and words are matched as in the regexp.
+{
+  let r = serialize(['connection', 'Close'], keepAlive, 0);
+  assert.strictEqual(r.header,
+                     'connection: Close\r\nContent-Length: 0\r\n\r\n');
+  assert.ok(r.flags & binding.kLast);
+
+  r = serialize(['Connection', 'closed'], keepAlive, 0);
+  assert.strictEqual(r.flags & binding.kLast, 0);
+
+  r = serialize(['Connection', 'keep-alive, Upgrade', 'Upgrade', 'ws'],
+                keepAlive, 0);
+  assert.ok(r.flags & binding.kUpgrading);
+}
+
+// 204/304 responses never use chunked encoding.
+{
+  const r = serialize(['Transfer-Encoding', 'chunked'],
+                      keepAlive | binding.kNoContent, -1);
+  assert.strictEqual(r.flags & binding.kChunkedEncoding, 0);
+  assert.strictEqual(r.flags & binding.kShouldKeepAlive, 0);
+}
+
+// Date line in RFC 1123 format, unless the user set one.
+{
+  let r = serialize([], keepAlive | binding.kSendDate, 0);
+  const dateLine = /^Date: \w{3}, \d\d \w{3} \d{4} \d\d:\d\d:\d\d GMT\r\n/;
+  assert.ok(dateLine.test(r.header));
+  const date = r.header.slice(6, r.header.indexOf('\r\n'));
+  assert.ok(Math.abs(Date.parse(date) - Date.now()) < 5000);
+
+  r = serialize(['date', 'x'], keepAlive | binding.kSendDate, 0);
+  assert.strictEqual(r.header.indexOf('Date:'), -1);
+}
+
+// Expect is reported back.
+assert.ok(serialize(['Expect', '100-continue'], keepAlive, 0).flags &
+          binding.kSentExpect);
+
+// Values are stringified, latin1 is passed through.
+assert.strictEqual(serialize(['X-Num', 42, 'X-Latin1', 'caf\u00e9'],
+                             binding.kHasBody, -1).header,
+                   'X-Num: 42\r\nX-Latin1: caf\u00e9\r\nConnection: close\r\n' +
+                   '\r\n');
+
+// Same errors as the JS implementation.
+assert.throws(() => serialize(['bad header', 'x'], 0, -1),
+              /^TypeError: Header name must be a valid HTTP Token \["bad/);
+assert.throws(() => serialize(['', 'x'], 0, -1), TypeError);
+assert.throws(() => serialize(['X-Foo', 'a\r\nb'], 0, -1),
+              /^TypeError: The header content contains invalid characters$/);
+assert.throws(() => serialize(['X-Foo', '\u0100'], 0, -1),
+              /^TypeError: The header content contains invalid characters$/);
+
+// Through OutgoingMessage.
+{
+  const res = new http.ServerResponse({ method: 'GET', httpVersionMajor: 1,
+                                        httpVersionMinor: 1 });
+  res.sendDate = false;
+  res._contentLength = 5;
+  res.writeHead(200, { 'X-Multi': ['a', 'b'] });
+  assert.strictEqual(res._header,
+                     'HTTP/1.1 200 OK\r\n' +
+                     'X-Multi: a\r\nX-Multi: b\r\n' +
+                     'Connection: keep-alive\r\n' +
+                     'Content-Length: 5\r\n\r\n');
+  assert.strictEqual(res.shouldKeepAlive, true);
+  assert.strictEqual(res.chunkedEncoding, false);
+}
+
+// The length is checked before it gets to the serializer.
+[NaN, Infinity, -Infinity, -1, 1.5, Number.MAX_SAFE_INTEGER + 1].forEach(
+  (contentLength) => {
+    const res = new http.ServerResponse({ method: 'GET', httpVersionMajor: 1,
+                                          httpVersionMinor: 1 });
+    res._contentLength = contentLength;
+    assert.throws(() => res.writeHead(200),
+                  /^RangeError: Content-Length must be a non-negative safe/);
+  });
@@ -0,0 +1,95 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+const net = require('net');
+const IncomingMessage = require('_http_incoming').IncomingMessage;
+
+const binding = process.binding('http_parser');
+const HTTPParser = binding.HTTPParser;
+const kOnHeadersComplete = HTTPParser.kOnHeadersComplete | 0;
+
+const CRLF = '\r\n';
+
+const rawHeaders = [
+  'Host', 'example.com',
+  'content-type', 'text/plain',
+  'Content-Type', 'text/html',  // dropped, first one wins
+  'Set-Cookie', 'a=1',
+  'set-cookie', 'b=2',
+  'Accept', 'text/html',
+  'ACCEPT', 'application/json',  // joined
+  'X-Custom-Header', 'one',
+  'x-custom-header', 'two',
+  'x-lower', 'three',
+  'X-Forwarded-For', '10.0.0.1',
+  'Content-Length', '0'
+];
+
+function toRequest(headers) {
+  let req = 'GET /native HTTP/1.1' + CRLF;
+  for (let i = 0; i < headers.length; i += 2)
+    req += headers[i] + ': ' + headers[i + 1] + CRLF;
+  return Buffer.from(req + CRLF);
+}
+
+// What JS land would have built from the flat array.
+function expectedHeaders(headers) {
+  const message = new IncomingMessage(null);
+  message._addHeaderLines(headers, headers.length);
+  return message.headers;
+}
+
+// Binding level: the native object matches the JS implementation and the
+// flat array keeps the original casing.
+{
+  const parser = new HTTPParser(HTTPParser.REQUEST);
+  parser.useNativeHeaders(true);
+  parser[kOnHeadersComplete] = common.mustCall(function(versionMajor,
+                                                        versionMinor,
+                                                        headers,
+                                                        method,
+                                                        url,
+                                                        statusCode,
+                                                        statusMessage,
+                                                        upgrade,
+                                                        shouldKeepAlive,
+                                                        headersObject) {
+    assert.strictEqual(url, '/native');
+    assert.deepStrictEqual(headers, rawHeaders);
+    assert.deepStrictEqual(headersObject, expectedHeaders(rawHeaders));
+    assert.deepStrictEqual(headersObject['set-cookie'], ['a=1', 'b=2']);
+    assert.strictEqual(headersObject['content-type'], 'text/plain');
+    assert.strictEqual(headersObject.accept, 'text/html, application/json');
+    assert.strictEqual(headersObject['x-custom-header'], 'one, two');
+  });
+  const request = toRequest(rawHeaders);
+  assert.strictEqual(parser.execute(request), request.length);
+}
+
+// Without the flag the parser keeps handing out the flat array only.
+{
+  const parser = new HTTPParser(HTTPParser.REQUEST);
+  parser[kOnHeadersComplete] = common.mustCall(function() {
+    assert.deepStrictEqual(arguments[2], rawHeaders);
+    assert.strictEqual(arguments[9], undefined);
+  });
+  const request = toRequest(rawHeaders);
+  parser.execute(request);
+}
+
+// End to end through the http server.
+const server = http.createServer(common.mustCall(function(req, res) {
+  const sent = rawHeaders.concat('Connection', 'close');
+  assert.deepStrictEqual(req.rawHeaders, sent);
+  assert.deepStrictEqual(req.headers, expectedHeaders(sent));
+  res.end();
+  server.close();
+}));
+
+server.listen(0, common.mustCall(function() {
+  const socket = net.connect(this.address().port, function() {
+    socket.end(toRequest(rawHeaders.concat('Connection', 'close')));
+  });
+  socket.resume();
+}));
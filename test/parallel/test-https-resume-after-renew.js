@@ -5,6 +5,7 @@ if (!common.hasCrypto) {
   return;
 }
 
+var assert = require('assert');
 var fs = require('fs');
 var https = require('https');
 var crypto = require('crypto');
@@ -23,12 +24,16 @@ var aes = Buffer.alloc(16, 'S');
 var hmac = Buffer.alloc(16, 'H');
 
 server._sharedCreds.context.enableTicketKeyCallback();
+// Keys set afterwards don't take over from the callback.
+server.setTicketKeys(crypto.randomBytes(48));
+var decrypted = 0;
 server._sharedCreds.context.onticketkeycallback = function(name, iv, enc) {
   if (enc) {
     var newName = Buffer.alloc(16, 'A');
     var newIV = crypto.randomBytes(16);
   } else {
     // Renew
+    decrypted++;
     return [ 2, hmac, aes ];
   }
 
@@ -52,6 +57,7 @@ server.listen(0, function() {
 
   doReq(function() {
     doReq(function() {
+      assert.strictEqual(decrypted, 1);
       server.close();
     });
   });
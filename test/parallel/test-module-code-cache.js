@@ -0,0 +1,77 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const execFileSync = require('child_process').execFileSync;
+const fs = require('fs');
+const path = require('path');
+
+common.refreshTmpDir();
+
+const cacheDir = path.join(common.tmpDir, 'code-cache');
+const modulePath = path.join(common.tmpDir, 'cached-module.js');
+fs.writeFileSync(modulePath, 'module.exports = function() { return 42; };');
+
+const script = `
+  const v8 = require('v8');
+  const before = v8.getCodeCacheStatistics();
+  if (require(${JSON.stringify(modulePath)})() !== 42)
+    throw new Error('wrong result');
+  const after = v8.getCodeCacheStatistics();
+  console.log(JSON.stringify({
+    enabled: after.enabled,
+    hits: after.hits - before.hits,
+    misses: after.misses - before.misses,
+    stored: after.stored - before.stored
+  }));
+`;
+
+function run(args, env) {
+  const out = execFileSync(process.execPath, args.concat(['-e', script]), {
+    env: Object.assign({}, process.env, env)
+  });
+  return JSON.parse(out.toString());
+}
+
+// Disabled by default.
+assert.strictEqual(run([], { NODE_CODE_CACHE_DIR: '' }).enabled, false);
+
+// First run populates the cache, the second one consumes it.
+let stats = run([`--code-cache-dir=${cacheDir}`], {});
+assert.deepStrictEqual(stats, { enabled: true, hits: 0, misses: 1, stored: 1 });
+assert.strictEqual(fs.readdirSync(cacheDir).length, 1);
+
+stats = run([], { NODE_CODE_CACHE_DIR: cacheDir });
+assert.deepStrictEqual(stats, { enabled: true, hits: 1, misses: 0, stored: 0 });
+
+// A modified module invalidates its entry.
+fs.writeFileSync(modulePath,
+                 'module.exports = function() { return 40 + 2; };');
+const future = new Date(Date.now() + 10000);
+fs.utimesSync(modulePath, future, future);
+stats = run([`--code-cache-dir=${cacheDir}`], {});
+assert.deepStrictEqual(stats, { enabled: true, hits: 0, misses: 1, stored: 1 });
+
+stats = run([`--code-cache-dir=${cacheDir}`], {});
+assert.deepStrictEqual(stats, { enabled: true, hits: 1, misses: 0, stored: 0 });
+
+// Missing parent directories are created, and only the user can get in.
+const nestedDir = path.join(common.tmpDir, 'nested', 'code-cache');
+stats = run([`--code-cache-dir=${nestedDir}`], {});
+assert.deepStrictEqual(stats, { enabled: true, hits: 0, misses: 1, stored: 1 });
+if (!common.isWindows)
+  assert.strictEqual(fs.statSync(nestedDir).mode & 0o777, 0o700);
+
+// The cache is not a vm option.
+const vmScript = `
+  const v8 = require('v8');
+  const before = v8.getCodeCacheStatistics();
+  require('vm').runInThisContext('42', {
+    filename: ${JSON.stringify(modulePath)},
+    useCodeCache: true
+  });
+  const after = v8.getCodeCacheStatistics();
+  console.log(after.misses - before.misses + after.hits - before.hits);
+`;
+const out = execFileSync(process.execPath,
+                         [`--code-cache-dir=${cacheDir}`, '-e', vmScript]);
+assert.strictEqual(out.toString().trim(), '0');
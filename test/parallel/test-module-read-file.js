@@ -0,0 +1,53 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+const internalModuleReadFile =
+    process.binding('fs').internalModuleReadFile;
+
+common.refreshTmpDir();
+
+function check(name, contents, expected) {
+  const filename = path.join(common.tmpDir, name);
+  fs.writeFileSync(filename, contents);
+  assert.strictEqual(internalModuleReadFile(filename), expected);
+}
+
+const ascii = 'module.exports = 42;\n';
+const large = 'x'.repeat(100 * 1024);
+
+check('empty.js', '', '');
+check('ascii.js', ascii, ascii);
+check('ascii-bom.js', '﻿' + ascii, ascii);
+check('utf8.js', 'module.exports = "résumé ☃";\n',
+      'module.exports = "résumé ☃";\n');
+check('utf8-bom.js', '﻿é', 'é');
+check('large.js', large, large);
+
+assert.strictEqual(internalModuleReadFile(path.join(common.tmpDir, 'nope')),
+                   undefined);
+assert.strictEqual(internalModuleReadFile(common.tmpDir), undefined);
+
+// The module loader reads sources through it.
+assert.strictEqual(require(path.join(common.tmpDir, 'ascii-bom.js')), 42);
+assert.throws(() => require(path.join(common.tmpDir, 'large.js')),
+              /ReferenceError: x+ is not defined/);
+
+// Unless fs.readFileSync() has been replaced, then it is used instead.
+{
+  const filename = path.join(common.tmpDir, 'patched.js');
+  fs.writeFileSync(filename, 'module.exports = "disk";\n');
+  const readFileSync = fs.readFileSync;
+  fs.readFileSync = function(file, options) {
+    if (file === filename)
+      return '\ufeffmodule.exports = "patched";\n';
+    return readFileSync.apply(this, arguments);
+  };
+  try {
+    assert.strictEqual(require(filename), 'patched');
+  } finally {
+    fs.readFileSync = readFileSync;
+  }
+}
@@ -0,0 +1,67 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+const binding = process.binding('fs');
+const exts = ['.js', '.json', '.node'];
+
+common.refreshTmpDir();
+const root = common.tmpDir;
+
+function mkdir(name) {
+  fs.mkdirSync(path.join(root, name));
+}
+
+function write(name, contents) {
+  fs.writeFileSync(path.join(root, name), contents || '');
+}
+
+function resolve(request, paths, trailingSlash) {
+  const basePaths = paths.map((p) => path.resolve(p, request));
+  return binding.internalModuleResolve(basePaths, paths, exts,
+                                       !!trailingSlash, path.resolve);
+}
+
+mkdir('node_modules');
+mkdir('node_modules/pkg');
+mkdir('node_modules/pkg/lib');
+mkdir('node_modules/index-only');
+mkdir('node_modules/broken');
+write('node_modules/plain.js');
+write('node_modules/pkg/package.json', '{"main": "./lib/main"}');
+write('node_modules/pkg/lib/main.js');
+write('node_modules/index-only/index.json', '{}');
+write('node_modules/broken/package.json', '{ nope');
+
+const nm = path.join(root, 'node_modules');
+const missing = path.join(root, 'missing', 'node_modules');
+
+// Extensions, package.json "main" and index files.
+assert.deepStrictEqual(resolve('plain', [missing, nm]),
+                       [1, path.join(nm, 'plain.js')]);
+assert.deepStrictEqual(resolve('pkg', [nm]),
+                       [0, path.join(nm, 'pkg', 'lib', 'main.js')]);
+assert.deepStrictEqual(resolve('index-only', [nm]),
+                       [0, path.join(nm, 'index-only', 'index.json')]);
+assert.deepStrictEqual(resolve('index-only/', [nm], true),
+                       [0, path.join(nm, 'index-only', 'index.json')]);
+assert.strictEqual(resolve('nope', [missing, nm]), undefined);
+
+// Broken package.json files are left to lib/module.js.
+assert.strictEqual(resolve('broken', [nm]), null);
+assert.throws(() => require(path.join(nm, 'broken')),
+              /^SyntaxError: Error parsing .*package\.json/);
+
+// Cached results stick until the cache is turned off.
+const late = path.join(root, 'late.js');
+binding.internalModuleStatCache(true);
+assert.ok(binding.internalModuleStat(late) < 0);
+write('late.js');
+assert.ok(binding.internalModuleStat(late) < 0);
+binding.internalModuleStatCache(false);
+assert.strictEqual(binding.internalModuleStat(late), 0);
+
+// End to end.
+assert.deepStrictEqual(require(path.join(nm, 'pkg')), {});
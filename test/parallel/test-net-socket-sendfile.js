@@ -0,0 +1,86 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const net = require('net');
+const path = require('path');
+
+common.refreshTmpDir();
+
+// Large enough to fill the socket's send buffer so the request has to wait
+// for the peer to drain it at least once.
+const file = path.join(common.tmpDir, 'sendfile.bin');
+const data = Buffer.allocUnsafe(4 * 1024 * 1024);
+for (let i = 0; i < data.length; i++)
+  data[i] = i % 251;
+fs.writeFileSync(file, data);
+
+const fd = fs.openSync(file, 'r');
+const offset = 17;
+const length = data.length - 1024;
+
+assert.throws(() => new net.Socket().sendFile(-1), TypeError);
+assert.throws(() => new net.Socket().sendFile(fd, { offset: -1 }), TypeError);
+assert.throws(() => new net.Socket().sendFile(fd, { length: 1.5 }), TypeError);
+assert.throws(() => new net.Socket().sendFile(fd, { length: -2 }),
+              /^TypeError: "length" must be a non-negative integer or -1$/);
+
+const server = net.createServer(common.mustCall(function(socket) {
+  // Corked so that the request ends up in the middle of a writev() batch.
+  socket.cork();
+  socket.write('head');
+  socket.sendFile(fd, { offset, length }, common.mustCall(function() {
+    socket.sendFile(fd, { offset: data.length - 3 }, common.mustCall());
+    socket.end('tail');
+  }));
+  socket.write('middle');
+  process.nextTick(() => socket.uncork());
+}));
+
+server.listen(0, common.mustCall(function() {
+  const chunks = [];
+  const conn = net.connect(this.address().port);
+  conn.on('data', (chunk) => chunks.push(chunk));
+  conn.on('end', common.mustCall(function() {
+    const expected = Buffer.concat([
+      Buffer.from('head'),
+      data.slice(offset, offset + length),
+      Buffer.from('middle'),
+      data.slice(data.length - 3),
+      Buffer.from('tail')
+    ]);
+    const actual = Buffer.concat(chunks);
+    assert.strictEqual(actual.length, expected.length);
+    assert(actual.equals(expected));
+    fs.closeSync(fd);
+    server.close();
+  }));
+}));
+
+// Data that was written to the handle directly and is still queued in libuv
+// goes out before the file.
+const WriteWrap = process.binding('stream_wrap').WriteWrap;
+const queued = Buffer.alloc(16 * 1024 * 1024, 'q');
+const busyFd = fs.openSync(file, 'r');
+const busyServer = net.createServer(common.mustCall(function(socket) {
+  const req = new WriteWrap();
+  req.handle = socket._handle;
+  req.oncomplete = common.mustCall(() => {});
+  req.async = false;
+  assert.strictEqual(socket._handle.writeBuffer(req, queued), 0);
+  assert.notStrictEqual(socket._handle.writeQueueSize, 0);
+  socket.sendFile(busyFd, { length: 1024 }, common.mustCall());
+  socket.end();
+}));
+
+busyServer.listen(0, common.mustCall(function() {
+  const chunks = [];
+  const conn = net.connect(this.address().port);
+  conn.on('data', (chunk) => chunks.push(chunk));
+  conn.on('end', common.mustCall(function() {
+    const expected = Buffer.concat([queued, data.slice(0, 1024)]);
+    assert(Buffer.concat(chunks).equals(expected));
+    fs.closeSync(busyFd);
+    busyServer.close();
+  }));
+}));
@@ -0,0 +1,58 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+// Corked writes that mix strings and Buffers end up in a single writev()
+// call. Strings are encoded into a per-stream arena, which must not be
+// reused while a previous write is still pending.
+
+const ROUNDS = 200;
+const body = Buffer.alloc(32 * 1024, 'b');
+const expected = [];
+
+const server = net.createServer(common.mustCall(function(socket) {
+  // Don't read until everything was written so that writes queue up.
+  socket.pause();
+  const received = [];
+  socket.on('data', (data) => received.push(data));
+  socket.on('end', common.mustCall(function() {
+    const actual = Buffer.concat(received);
+    assert.ok(actual.equals(Buffer.concat(expected)),
+              'data must not be corrupted');
+    server.close();
+  }));
+  setTimeout(() => socket.resume(), common.platformTimeout(50));
+}));
+
+server.listen(0, common.mustCall(function() {
+  const client = net.connect(this.address().port, common.mustCall(function() {
+    for (let i = 0; i < ROUNDS; i++) {
+      const head = `HTTP/1.1 200 OK\r\nX-Round: ${i}\r\n`;
+      const utf8 = `X-Unicode: ${'é中'.repeat(i % 7)}\r\n\r\n`;
+      client.cork();
+      client.write(head, 'latin1');
+      client.write(utf8, 'utf8');
+      client.write(body);
+      client.write('trailer' + i, 'ascii');
+      client.uncork();
+      expected.push(Buffer.from(head, 'latin1'),
+                    Buffer.from(utf8, 'utf8'),
+                    body,
+                    Buffer.from('trailer' + i, 'ascii'));
+    }
+
+    client.end();
+    client.on('finish', common.mustCall(function() {
+      const stats = client._handle.getWriteStatistics();
+      // Batches that queue up behind a pending write are merged.
+      assert.ok(stats.writes >= 1 && stats.writes <= ROUNDS);
+      assert.ok(stats.writeAttempts >= stats.writes);
+      assert.strictEqual(stats.bytesByReference, ROUNDS * body.length);
+      const copied = expected.filter((b) => b !== body)
+                             .reduce((n, b) => n + b.length, 0);
+      assert.strictEqual(stats.bytesCopied, copied);
+    }));
+  }));
+}));
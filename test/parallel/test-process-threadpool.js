@@ -0,0 +1,51 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const crypto = require('crypto');
+const zlib = require('zlib');
+
+const classes = ['default', 'fs', 'dns', 'crypto', 'compression'];
+
+const before = process.threadpoolUsage();
+assert.deepStrictEqual(Object.keys(before.queues), classes);
+for (const name of classes) {
+  assert.deepStrictEqual(Object.keys(before.queues[name]),
+                         ['queued', 'running', 'dispatched', 'waitTime',
+                          'maxWaitTime']);
+}
+
+process.setThreadpoolSize(2, 8);
+let usage = process.threadpoolUsage();
+assert.strictEqual(usage.minThreads, 2);
+assert.strictEqual(usage.maxThreads, 8);
+assert.ok(usage.threads >= 2 && usage.threads <= 8);
+
+process.setThreadpoolSize(3);
+usage = process.threadpoolUsage();
+assert.strictEqual(usage.minThreads, 3);
+assert.strictEqual(usage.maxThreads, 3);
+
+assert.throws(() => process.setThreadpoolSize(0), RangeError);
+assert.throws(() => process.setThreadpoolSize(4, 2), RangeError);
+assert.throws(() => process.setThreadpoolSize(1, 1024), RangeError);
+assert.throws(() => process.setThreadpoolSize('4'), TypeError);
+assert.throws(() => process.setThreadpoolSize(1, -1), TypeError);
+
+process.setThreadpoolSize(1, 4);
+
+crypto.pbkdf2('password', 'salt', 1, 32, 'sha1', common.mustCall((err) => {
+  assert.ifError(err);
+  zlib.deflate('hello', common.mustCall((err) => {
+    assert.ifError(err);
+    const after = process.threadpoolUsage();
+    assert.strictEqual(after.queues.crypto.dispatched,
+                       before.queues.crypto.dispatched + 1);
+    assert.ok(after.queues.compression.dispatched >
+              before.queues.compression.dispatched);
+    for (const name of classes) {
+      const queue = after.queues[name];
+      assert.strictEqual(queue.queued, 0);
+      assert.ok(queue.maxWaitTime <= queue.waitTime);
+    }
+  }));
+}));
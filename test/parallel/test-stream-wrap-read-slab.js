@@ -0,0 +1,58 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+const binding = process.binding('stream_wrap');
+const before = binding.getReadSlabStatistics();
+
+const chunks = [];
+for (let i = 0; i < 200; i++) {
+  const fill = String.fromCharCode(97 + i % 26);
+  chunks.push(Buffer.alloc(1 + i * 37 % 3000, fill));
+}
+// A large write spanning several reads.
+chunks.push(Buffer.alloc(1024 * 1024, 'z'));
+const expected = Buffer.concat(chunks);
+
+const server = net.createServer(common.mustCall(function(socket) {
+  const received = [];
+  socket.on('data', function(data) {
+    received.push(data);
+  });
+  socket.on('end', common.mustCall(function() {
+    const actual = Buffer.concat(received);
+    assert.strictEqual(actual.length, expected.length);
+    assert.ok(actual.equals(expected), 'data must not be corrupted');
+
+    // Buffers carved from the same slab must not overlap.
+    for (let i = 1; i < received.length; i++)
+      received[i - 1].fill(0);
+    const last = received[received.length - 1];
+    assert.ok(last.equals(expected.slice(expected.length - last.length)));
+
+    const after = binding.getReadSlabStatistics();
+    assert.ok(after.allocations > before.allocations);
+    assert.ok(after.hits > before.hits);
+    assert.ok(after.hits <= after.allocations);
+    assert.ok(after.slabsCreated >= 1);
+    assert.ok(after.liveSlabs >= 1);
+    assert.ok(after.retainedBytes > 0);
+    assert.ok(after.committedBytes - before.committedBytes >= expected.length);
+    socket.end();
+    server.close();
+  }));
+}));
+
+server.listen(0, common.mustCall(function() {
+  const client = net.connect(this.address().port, common.mustCall(function() {
+    let i = 0;
+    (function next() {
+      if (i === chunks.length)
+        return client.end();
+      client.write(chunks[i++], next);
+    })();
+  }));
+  client.resume();
+}));
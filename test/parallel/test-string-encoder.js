@@ -0,0 +1,125 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const StringDecoder = require('string_decoder').StringDecoder;
+const StringEncoder = require('string_decoder').StringEncoder;
+
+function randomBytes(length) {
+  const buf = Buffer.allocUnsafe(length);
+  for (let i = 0; i < length; i++)
+    buf[i] = common.random(256);
+  return buf;
+}
+
+// Splits str into pieces of random length, some of them empty.
+function split(str, max) {
+  const pieces = [];
+  let i = 0;
+  while (i < str.length) {
+    const n = common.random(max);
+    pieces.push(str.slice(i, i + n));
+    i += n;
+  }
+  return pieces;
+}
+
+function encodeInPieces(encoding, str, max) {
+  const encoder = new StringEncoder(encoding);
+  const pieces = split(str, max).map((piece) => encoder.write(piece));
+  pieces.push(encoder.end());
+  return Buffer.concat(pieces);
+}
+
+function wrap(str) {
+  return str.replace(/.{76}/g, '$&\r\n');
+}
+
+// Lengths around the vector block sizes, and large enough to be external.
+const lengths = [0, 1, 2, 3, 23, 24, 25, 31, 32, 33, 47, 48, 63, 64, 65, 100,
+                 1000, 2 * 1024 * 1024];
+lengths.forEach((length) => {
+  const bytes = randomBytes(length);
+  const base64 = bytes.toString('base64');
+  const hex = bytes.toString('hex');
+
+  assert.ok(Buffer.from(base64, 'base64').equals(bytes));
+  assert.ok(Buffer.from(wrap(base64), 'base64').equals(bytes));
+  assert.ok(Buffer.from(hex, 'hex').equals(bytes));
+  assert.ok(Buffer.from(hex.toUpperCase(), 'hex').equals(bytes));
+  if (length <= 1000) {
+    let expected = '';
+    for (const byte of bytes)
+      expected += (byte < 16 ? '0' : '') + byte.toString(16);
+    assert.strictEqual(hex, expected);
+  }
+
+  const max = length > 1000 ? 100000 : 10;
+  assert.ok(encodeInPieces('base64', base64, max).equals(bytes));
+  assert.ok(encodeInPieces('base64', wrap(base64), max).equals(bytes));
+  assert.ok(encodeInPieces('hex', hex, max).equals(bytes));
+
+  // StringDecoder holds back bytes natively for base64.
+  const decoder = new StringDecoder('base64');
+  const chunks = [];
+  for (let i = 0; i < length;) {
+    const n = common.random(max);
+    chunks.push(decoder.write(bytes.slice(i, i + n)));
+    i += n;
+  }
+  chunks.push(decoder.end());
+  assert.strictEqual(chunks.join(''), base64);
+});
+
+// Same as decoding the joined strings with Buffer.from().
+[
+  'aGVsbG8gd29ybGQ=',
+  'aGVsbG8gd29ybGQ',
+  'aGVsbG8-d29y_GQ',
+  'aGVs bG8\ngd2 9yb\tGQ=',
+  'aGVsbG8=d29ybGQ=',
+  'aGVsbG8gd29ybGQ==extra',
+  'a',
+  '==',
+  'aGVsbG8☃gd29ybGQ='
+].forEach((str) => {
+  const expected = Buffer.from(str, 'base64');
+  for (let i = 0; i < 5; i++)
+    assert.ok(encodeInPieces('base64', str, 4).equals(expected));
+});
+
+[
+  'deadbeef',
+  'DEADbeef',
+  'deadbXef',
+  'dead  beef'
+].forEach((str) => {
+  const expected = Buffer.from(str, 'hex');
+  for (let i = 0; i < 5; i++)
+    assert.ok(encodeInPieces('hex', str, 4).equals(expected));
+});
+
+// Incomplete groups and odd numbers of hex digits.
+const encoder = new StringEncoder('base64');
+assert.deepStrictEqual(encoder.write('aGVsbG8gd2'),
+                       Buffer.from('hello '));
+assert.deepStrictEqual(encoder.end('9ybGQ='), Buffer.from('world'));
+assert.deepStrictEqual(encoder.end('aGk'), Buffer.from('hi'));
+
+const hexEncoder = new StringEncoder('hex');
+assert.deepStrictEqual(hexEncoder.write(''), Buffer.alloc(0));
+assert.deepStrictEqual(hexEncoder.end(), Buffer.alloc(0));
+assert.deepStrictEqual(hexEncoder.end(''), Buffer.alloc(0));
+assert.deepStrictEqual(hexEncoder.write('abc'), Buffer.from([0xab]));
+assert.deepStrictEqual(hexEncoder.write('d'), Buffer.from([0xcd]));
+hexEncoder.write('e');
+assert.throws(() => hexEncoder.end(), /^TypeError: Invalid hex string$/);
+assert.deepStrictEqual(hexEncoder.end('ff'), Buffer.from([0xff]));
+
+assert.throws(() => new StringEncoder('utf8'),
+              /^Error: Unsupported encoding: utf8$/);
+assert.throws(() => new StringEncoder('nope'),
+              /^Error: Unknown encoding: nope$/);
+assert.throws(() => encoder.write(Buffer.alloc(1)),
+              /^TypeError: "str" argument must be a string$/);
+assert.throws(() => new StringDecoder('base64').write('abc'),
+              /^TypeError: "buf" argument must be a Buffer$/);
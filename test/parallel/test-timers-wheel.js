@@ -0,0 +1,143 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const timers = require('timers');
+const Timer = process.binding('timer_wrap').Timer;
+
+// Timers scheduled with _unrefActive() live in a native timing wheel that
+// reports the ones expiring together in batches.
+
+// Enough timers to need several batches, with a spread of timeouts across the
+// levels of the wheel. Every third one is cancelled and every other third
+// re-armed.
+const count = 5000;
+const items = [];
+const fired = [];
+for (let i = 0; i < count; i++) {
+  const item = {
+    _onTimeout() {
+      fired.push(i);
+      assert.strictEqual(this, item);
+    }
+  };
+  timers.enroll(item, 1 + i % 300);
+  timers._unrefActive(item);
+  items.push(item);
+}
+for (let i = 0; i < count; i += 3)
+  timers.unenroll(items[i]);
+for (let i = 1; i < count; i += 3)
+  timers._unrefActive(items[i]);
+
+// Timers that cancel each other in the same batch: only one fires.
+let cancelled = 0;
+const first = {
+  _onTimeout() {
+    cancelled++;
+    timers.unenroll(second);
+  }
+};
+const second = {
+  _onTimeout() {
+    cancelled++;
+    timers.unenroll(first);
+  }
+};
+timers.enroll(first, 5);
+timers._unrefActive(first);
+timers.enroll(second, 5);
+timers._unrefActive(second);
+
+// A timer moved to active() leaves the wheel, and back.
+const moved = { _onTimeout: common.mustCall() };
+timers.enroll(moved, 1000);
+timers._unrefActive(moved);
+timers.active(moved);
+timers.enroll(moved, 10);
+timers._unrefActive(moved);
+
+// Re-arming from the callback, and a timer far in the future.
+let rearmed = 0;
+const repeating = {
+  _onTimeout() {
+    if (++rearmed < 5)
+      timers._unrefActive(repeating);
+  }
+};
+timers.enroll(repeating, 1);
+timers._unrefActive(repeating);
+
+const far = { _onTimeout: common.fail };
+timers.enroll(far, 1e9);
+timers._unrefActive(far);
+
+// An exception doesn't keep the rest of the batch from running.
+const thrower = {
+  _onTimeout() {
+    throw new Error('thrown from a timer');
+  }
+};
+const afterThrower = { _onTimeout: common.mustCall() };
+timers.enroll(thrower, 50);
+timers._unrefActive(thrower);
+timers.enroll(afterThrower, 50);
+timers._unrefActive(afterThrower);
+process.once('uncaughtException', common.mustCall((err) => {
+  assert.strictEqual(err.message, 'thrown from a timer');
+}));
+
+// The wheel doesn't keep the process open by itself, this does.
+setTimeout(common.mustCall(() => {
+  const expected = count - Math.ceil(count / 3);
+  assert.strictEqual(fired.length, expected);
+  assert.strictEqual(new Set(fired).size, expected);
+  assert.ok(fired.every((i) => i % 3 !== 0));
+  assert.strictEqual(cancelled, 1);
+  assert.strictEqual(rearmed, 5);
+  assert.strictEqual(items[1]._idleNext, null);
+  timers.unenroll(far);
+  checkTurnBoundary(10);
+}), common.platformTimeout(1000));
+
+// A timer that the wheel still has to bring down from the second level when
+// it reaches the end of a 256 ms turn fires on time, even if a timer later
+// in the next turn is scheduled in between. `early` expires just after the
+// turn ends and `late` towards the end of the next one, and `marker` fires on
+// the last millisecond of the turn to schedule `late`. If the marker is late
+// the wheel has already passed the boundary, so try again with a later turn.
+let turnBoundaryChecked = false;
+process.on('exit', () => assert.ok(turnBoundaryChecked));
+function checkTurnBoundary(attempts) {
+  const keepAlive = setInterval(() => {}, 1000);
+  const start = Timer.now();
+  const boundary = (Math.floor((start + 300) / 256) + 1) * 256;
+
+  const late = { _onTimeout: common.fail };
+  const early = {
+    _onTimeout() {
+      assert.ok(Timer.now() < boundary + 200);
+      timers.unenroll(late);
+      clearInterval(keepAlive);
+      turnBoundaryChecked = true;
+    }
+  };
+  timers.enroll(early, boundary + 10 - start);
+  timers._unrefActive(early);
+
+  const marker = {
+    _onTimeout() {
+      const now = Timer.now();
+      if (now !== boundary - 1) {
+        assert.ok(attempts > 1, 'the marker timer never fired on time');
+        timers.unenroll(early);
+        clearInterval(keepAlive);
+        checkTurnBoundary(attempts - 1);
+        return;
+      }
+      timers.enroll(late, boundary + 240 - now);
+      timers._unrefActive(late);
+    }
+  };
+  timers.enroll(marker, boundary - 1 - start);
+  timers._unrefActive(marker);
+}
@@ -0,0 +1,65 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+const tls = require('tls');
+const fs = require('fs');
+const path = require('path');
+
+const options = {
+  key: fs.readFileSync(path.join(common.fixturesDir, 'test_key.pem')),
+  cert: fs.readFileSync(path.join(common.fixturesDir, 'test_cert.pem')),
+  ciphers: 'ECDHE-RSA-AES128-GCM-SHA256',
+  ALPNProtocols: ['b', 'a'],
+  asyncKeyOps: true
+};
+
+const server = tls.createServer(options, common.mustCall((socket) => {
+  socket.end(socket.alpnProtocol);
+}, 6));
+
+function connect(session, callback) {
+  const client = tls.connect({
+    port: server.address().port,
+    rejectUnauthorized: false,
+    ALPNProtocols: ['a'],
+    session: session
+  }, common.mustCall(() => {
+    assert.strictEqual(client.alpnProtocol, 'a');
+    assert.strictEqual(client.getCipher().name, options.ciphers);
+  }));
+
+  let data = '';
+  client.setEncoding('utf8');
+  client.on('data', (chunk) => data += chunk);
+  client.on('end', common.mustCall(() => {
+    assert.strictEqual(data, 'a');
+    callback(client);
+  }));
+}
+
+server.listen(0, common.mustCall(() => {
+  const before = process.threadpoolUsage().queues.crypto.dispatched;
+
+  // Concurrent full handshakes, then a resumed one.
+  let pending = 5;
+  let session;
+  for (let i = 0; i < 5; i++) {
+    connect(null, common.mustCall((client) => {
+      session = client.getSession();
+      if (--pending > 0)
+        return;
+
+      assert.ok(process.threadpoolUsage().queues.crypto.dispatched >=
+                before + 5);
+      connect(session, common.mustCall((client) => {
+        assert.strictEqual(client.isSessionReused(), true);
+        server.close();
+      }));
+    }));
+  }
+}));
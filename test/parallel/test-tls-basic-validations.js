@@ -34,7 +34,7 @@ assert.throws(() => tls.createServer({ticketKeys: 'abcd'}),
               /TypeError: Ticket keys must be a buffer/);
 
 assert.throws(() => tls.createServer({ticketKeys: new Buffer(0)}),
-              /TypeError: Ticket keys length must be 48 bytes/);
+              /TypeError: Ticket keys length must be a multiple of 48 bytes/);
 
 assert.throws(() => tls.createSecurePair({}),
               /Error: First argument must be a tls module SecureContext/);
@@ -0,0 +1,62 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+const crypto = require('crypto');
+const tls = require('tls');
+const fs = require('fs');
+const path = require('path');
+
+const options = {
+  key: fs.readFileSync(path.join(common.fixturesDir, 'test_key.pem')),
+  cert: fs.readFileSync(path.join(common.fixturesDir, 'test_cert.pem'))
+};
+
+const keys = ['encryptedIn', 'encryptedOut', 'cleartextIn', 'offload', 'ssl',
+              'total'];
+
+function check(usage) {
+  assert.deepStrictEqual(Object.keys(usage), keys);
+  let sum = 0;
+  for (const key of keys.slice(0, -1)) {
+    assert.strictEqual(typeof usage[key], 'number');
+    assert.ok(usage[key] >= 0);
+    sum += usage[key];
+  }
+  assert.strictEqual(usage.total, sum);
+  assert.ok(usage.ssl > 0);
+}
+
+// Decrypted data is handed out in slices of shared memory, large payloads
+// have to arrive intact.
+const payload = crypto.randomBytes(1024 * 1024);
+
+const server = tls.createServer(options, common.mustCall((socket) => {
+  check(socket.getMemoryUsage());
+  socket.end(payload);
+}));
+
+server.listen(0, common.mustCall(() => {
+  const client = tls.connect({
+    port: server.address().port,
+    rejectUnauthorized: false
+  }, common.mustCall(() => {
+    const usage = client.getMemoryUsage();
+    check(usage);
+    assert.strictEqual(usage.offload, 0);
+  }));
+
+  const received = [];
+  client.on('data', (chunk) => received.push(chunk));
+  client.on('end', common.mustCall(() => {
+    assert.ok(Buffer.concat(received).equals(payload));
+    assert.ok(client.getMemoryUsage().encryptedIn > 0);
+    client.destroy();
+    assert.strictEqual(client.getMemoryUsage(), null);
+    server.close();
+  }));
+}));
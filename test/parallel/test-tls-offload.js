@@ -0,0 +1,52 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+const crypto = require('crypto');
+const tls = require('tls');
+const fs = require('fs');
+const path = require('path');
+
+const options = {
+  key: fs.readFileSync(path.join(common.fixturesDir, 'test_key.pem')),
+  cert: fs.readFileSync(path.join(common.fixturesDir, 'test_cert.pem')),
+  offload: true
+};
+
+// Mixes writes above and below the threshold, all of it has to come back in
+// order.
+const chunks = [];
+for (let size = 1; size <= 4 * 1024 * 1024; size *= 4)
+  chunks.push(crypto.randomBytes(size));
+const expected = Buffer.concat(chunks);
+
+const server = tls.createServer(options, common.mustCall((socket) => {
+  socket.pipe(socket);
+}));
+
+server.listen(0, common.mustCall(() => {
+  const client = tls.connect({
+    port: server.address().port,
+    rejectUnauthorized: false,
+    offload: 1
+  }, common.mustCall(() => {
+    for (const chunk of chunks)
+      client.write(chunk);
+    client.end();
+  }));
+
+  const received = [];
+  client.on('data', (chunk) => received.push(chunk));
+  client.on('end', common.mustCall(() => {
+    assert.ok(Buffer.concat(received).equals(expected));
+    assert.ok(process.threadpoolUsage().queues.crypto.dispatched > 0);
+    server.close();
+  }));
+}));
+
+assert.throws(() => new tls.TLSSocket(null, { offload: -1 }),
+              /^TypeError: Threshold must be a uint32$/);
@@ -0,0 +1,74 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+const tls = require('tls');
+const fs = require('fs');
+const path = require('path');
+
+const cache = tls.createSessionCache({ maxEntries: 2 });
+const options = {
+  key: fs.readFileSync(path.join(common.fixturesDir, 'test_key.pem')),
+  cert: fs.readFileSync(path.join(common.fixturesDir, 'test_cert.pem')),
+  secureOptions: require('constants').SSL_OP_NO_TICKET,
+  sessionIdContext: 'shared',
+  sessionCache: cache
+};
+
+const a = tls.createServer(options, (socket) => socket.end());
+const b = tls.createServer(options, (socket) => socket.end());
+
+function connect(server, session, callback) {
+  const client = tls.connect({
+    port: server.address().port,
+    rejectUnauthorized: false,
+    session: session
+  }, common.mustCall(() => {
+    const reused = client.isSessionReused();
+    const newSession = client.getSession();
+    client.on('close', common.mustCall(() => callback(reused, newSession)));
+    client.resume();
+  }));
+}
+
+a.listen(0, common.mustCall(() => b.listen(0, common.mustCall(() => {
+  connect(a, null, common.mustCall((reused, session) => {
+    assert.strictEqual(reused, false);
+    assert.strictEqual(cache.getStats().size, 1);
+
+    // Resumed by the other server, without any JS session events.
+    connect(b, session, common.mustCall((reused) => {
+      assert.strictEqual(reused, true);
+
+      // Two more sessions push the first one out.
+      connect(a, null, common.mustCall(() => {
+        connect(b, null, common.mustCall(() => {
+          connect(a, session, common.mustCall((reused) => {
+            assert.strictEqual(reused, false);
+            assert.deepStrictEqual(cache.getStats(), {
+              size: 2,
+              hits: 1,
+              misses: 1,
+              evictions: 2,
+              expired: 0
+            });
+
+            cache.clear();
+            assert.strictEqual(cache.getStats().size, 0);
+            a.close();
+            b.close();
+          }));
+        }));
+      }));
+    }));
+  }));
+}))));
+
+assert.throws(() => tls.createSessionCache({ maxEntries: 0 }),
+              /^TypeError: Maximum number of entries must be > 0$/);
+assert.throws(() => tls.createSecureContext({ sessionCache: {} }),
+              /^TypeError: sessionCache must be created by/);
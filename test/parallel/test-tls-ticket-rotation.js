@@ -0,0 +1,65 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+const tls = require('tls');
+const fs = require('fs');
+const path = require('path');
+const crypto = require('crypto');
+
+const first = crypto.randomBytes(48);
+const server = tls.createServer({
+  key: fs.readFileSync(path.join(common.fixturesDir, 'test_key.pem')),
+  cert: fs.readFileSync(path.join(common.fixturesDir, 'test_cert.pem')),
+  ticketKeys: first
+}, (socket) => socket.end());
+
+function connect(session, callback) {
+  const client = tls.connect({
+    port: server.address().port,
+    rejectUnauthorized: false,
+    session: session
+  }, common.mustCall(() => {
+    const reused = client.isSessionReused();
+    const ticket = client.getTLSTicket();
+    client.on('close', common.mustCall(() => callback(reused, ticket)));
+    client.resume();
+  }));
+  return client;
+}
+
+server.listen(0, common.mustCall(() => {
+  let session;
+  const client = connect(null, common.mustCall((reused, ticket) => {
+    assert.strictEqual(reused, false);
+    session = client.getSession();
+
+    // The previous key still decrypts, the ticket gets renewed.
+    const second = crypto.randomBytes(48);
+    server.rotateTicketKeys(second);
+    assert.deepStrictEqual(server.getTicketKeys(),
+                           Buffer.concat([second, first]));
+
+    connect(session, common.mustCall((reused, renewed) => {
+      assert.strictEqual(reused, true);
+      assert.notDeepStrictEqual(renewed, ticket);
+
+      // Only the last two keys are kept.
+      server.rotateTicketKeys();
+      server.rotateTicketKeys();
+      assert.strictEqual(server.getTicketKeys().length, 96);
+
+      connect(session, common.mustCall((reused) => {
+        assert.strictEqual(reused, false);
+        server.close();
+      }));
+    }));
+  }));
+}));
+
+assert.throws(() => server.rotateTicketKeys(Buffer.alloc(47)),
+              /^TypeError: Ticket key must be a 48-byte Buffer$/);
@@ -0,0 +1,98 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const crypto = require('crypto');
+const zlib = require('zlib');
+
+// Compressible and incompressible parts, spanning several blocks.
+const input = Buffer.concat([
+  Buffer.from('abcdefghijklmnopqrstuvwxyz'.repeat(20000)),
+  crypto.randomBytes(100000),
+  Buffer.from('0123456789'.repeat(30000))
+]);
+
+function compress(data, chunkSize, options, cb) {
+  const gzip = zlib.createParallelGzip(options);
+  const out = [];
+  gzip.on('data', (chunk) => out.push(chunk));
+  gzip.on('end', common.mustCall(() => cb(Buffer.concat(out))));
+  for (let i = 0; i < data.length; i += chunkSize)
+    gzip.write(data.slice(i, i + chunkSize));
+  gzip.end();
+}
+
+const options = { blockSize: 32768, parallel: 3, level: 6 };
+compress(input, 1000, options, (first) => {
+  assert.ok(zlib.gunzipSync(first).equals(input));
+  assert.ok(first.length < input.length);
+
+  // The same bytes whatever the chunking.
+  compress(input, 65537, options, (second) => {
+    assert.ok(second.equals(first));
+  });
+});
+
+// A single large write keeps no more than `parallel` blocks in flight.
+{
+  const gzip = zlib.createParallelGzip({ blockSize: 32768, parallel: 2 });
+  const out = [];
+  gzip.on('data', (chunk) => {
+    assert.ok(gzip._inFlight <= 2);
+    out.push(chunk);
+  });
+  gzip.on('end', common.mustCall(() => {
+    assert.ok(zlib.gunzipSync(Buffer.concat(out)).equals(input));
+  }));
+  gzip.write(input, common.mustCall());
+  assert.strictEqual(gzip._inFlight, 2);
+  gzip.end();
+}
+
+// The writer may reuse its buffer once the write callback has run, without
+// changing the blocks or the dictionaries that are compressed from it.
+{
+  const gzip = zlib.createParallelGzip({ blockSize: 32768, parallel: 2 });
+  const buf = Buffer.from(input);
+  const tail = input.slice(0, 40000);
+  const out = [];
+  gzip.on('data', (chunk) => out.push(chunk));
+  gzip.on('end', common.mustCall(() => {
+    assert.ok(zlib.gunzipSync(Buffer.concat(out))
+                  .equals(Buffer.concat([input, tail])));
+  }));
+  gzip.write(buf, common.mustCall(() => {
+    assert.strictEqual(gzip._inFlight, 0);
+    buf.fill(0);
+    gzip.end(tail);
+  }));
+}
+
+// A single block, and no input at all.
+compress(Buffer.from('hello'), 5, {}, (out) => {
+  assert.strictEqual(zlib.gunzipSync(out).toString(), 'hello');
+});
+compress(Buffer.alloc(0), 1, {}, (out) => {
+  assert.strictEqual(zlib.gunzipSync(out).length, 0);
+});
+
+// Usable with pipes and other compression settings.
+const gzip = zlib.createParallelGzip({
+  blockSize: 65536,
+  level: 1,
+  strategy: zlib.constants.Z_FILTERED
+});
+const gunzip = zlib.createGunzip();
+const out = [];
+gunzip.on('data', (chunk) => out.push(chunk));
+gunzip.on('end', common.mustCall(() => {
+  assert.ok(Buffer.concat(out).equals(input));
+}));
+gzip.pipe(gunzip);
+gzip.end(input);
+
+assert.throws(() => zlib.createParallelGzip({ blockSize: 1024 }),
+              /^RangeError: Invalid block size: 1024$/);
+assert.throws(() => zlib.createParallelGzip({ parallel: 0 }),
+              /^RangeError: Invalid parallel: 0$/);
+assert.throws(() => zlib.createParallelGzip({ level: 10 }),
+              /^Error: Invalid compression level: 10$/);
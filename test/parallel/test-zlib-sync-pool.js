@@ -0,0 +1,102 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const zlib = require('zlib');
+
+const binding = process.binding('zlib');
+const input =
+  Buffer.from('The quick brown fox jumps over the lazy dog. '.repeat(200));
+
+// The one-shot functions agree with the streaming ones.
+[
+  ['deflateSync', 'inflateSync', 'deflate'],
+  ['gzipSync', 'gunzipSync', 'gzip'],
+  ['deflateRawSync', 'inflateRawSync', 'deflateRaw'],
+  ['gzipSync', 'unzipSync', 'gzip'],
+  ['deflateSync', 'unzipSync', 'deflate']
+].forEach(([compress, decompress, async]) => {
+  const options = [
+    {},
+    { level: 1 },
+    { level: 9, strategy: zlib.constants.Z_FILTERED },
+    { windowBits: 9, memLevel: 1 }
+  ];
+  options.forEach((opts) => {
+    const compressed = zlib[compress](input, opts);
+    assert.ok(zlib[decompress](compressed, opts).equals(input));
+    zlib[async](input, opts, common.mustCall((err, result) => {
+      assert.ifError(err);
+      assert.ok(result.equals(compressed));
+    }));
+  });
+});
+
+// Contexts are recycled, and so are those of the streaming classes.
+const before = binding.getStreamPoolStatistics();
+for (let i = 0; i < 10; i++) {
+  zlib.gunzipSync(zlib.gzipSync(input));
+  zlib.inflateSync(zlib.deflateSync(input));
+}
+const after = binding.getStreamPoolStatistics();
+assert.ok(after.reused - before.reused >= 36);
+assert.ok(after.idle > 0);
+assert.ok(after.idle <= 16);
+
+// A pooled stream is only reused for the same level and strategy, including
+// after params() changed them.
+{
+  const expected = zlib.deflateSync(input);
+  const deflate = zlib.createDeflate();
+  deflate.params(1, zlib.constants.Z_HUFFMAN_ONLY, common.mustCall(() => {
+    deflate.end(input);
+    deflate.resume();
+    deflate.on('close', common.mustCall(() => {
+      assert.ok(zlib.deflateSync(input).equals(expected));
+    }));
+  }));
+}
+
+// Empty input, and output larger than the initial guess.
+assert.strictEqual(zlib.inflateSync(zlib.deflateSync(Buffer.alloc(0))).length,
+                   0);
+const zeros = Buffer.alloc(1024 * 1024);
+assert.ok(zlib.gunzipSync(zlib.gzipSync(zeros)).equals(zeros));
+
+// Concatenated members.
+const members = Buffer.concat([zlib.gzipSync('abc'), zlib.gzipSync('def')]);
+assert.strictEqual(zlib.gunzipSync(members).toString(), 'abcdef');
+assert.strictEqual(zlib.unzipSync(members).toString(), 'abcdef');
+
+// Dictionaries.
+const dictionary = Buffer.from('quick brown fox lazy dog');
+const withDictionary = zlib.deflateSync(input, { dictionary });
+assert.ok(zlib.inflateSync(withDictionary, { dictionary }).equals(input));
+assert.throws(() => zlib.inflateSync(withDictionary),
+              (err) => err.message === 'Missing dictionary' &&
+                       err.code === 'Z_NEED_DICT');
+assert.throws(() => zlib.inflateSync(withDictionary,
+                                     { dictionary: Buffer.from('nope') }),
+              (err) => err.message === 'Bad dictionary');
+
+// Errors carry the zlib error code.
+const compressed = zlib.gzipSync(input);
+assert.throws(() => zlib.gunzipSync(compressed.slice(0, 80)),
+              (err) => err.message === 'unexpected end of file' &&
+                       err.code === 'Z_BUF_ERROR' &&
+                       err.errno === zlib.constants.Z_BUF_ERROR);
+assert.throws(() => zlib.inflateSync(Buffer.from('not zlib data')),
+              (err) => err.message === 'incorrect header check' &&
+                       err.code === 'Z_DATA_ERROR');
+
+// A truncated stream can still be read up to where it stops.
+const partial = zlib.gunzipSync(compressed.slice(0, 80), {
+  finishFlush: zlib.constants.Z_SYNC_FLUSH
+});
+assert.ok(partial.length > 0);
+assert.ok(input.slice(0, partial.length).equals(partial));
+
+// Options are validated like they are for the classes.
+assert.throws(() => zlib.deflateSync(input, { level: 10 }),
+              /^Error: Invalid compression level: 10$/);
+assert.throws(() => zlib.deflateSync(input, { chunkSize: 1 }),
+              /^Error: Invalid chunk size: 1$/);